@@ -0,0 +1,84 @@
+# Run by the bench target with cmake -P. Every shape is generated at each of its sizes and synthesised
+# with --stats, one CSV row per netlist goes to RESULTS. Times are wall milliseconds, the fastest of REPEAT runs.
+# Emission throughput is in module ports written per millisecond of the emit phase, wide netlists have thousands.
+
+set( shapes chain tree dag if mixed wide )
+set( phases read asap alap fds_iteration link minimize emit )
+
+file( MAKE_DIRECTORY ${WORK_DIR} )
+set( header "shape,size,components,ports,latency,force_evaluations" )
+foreach( phase ${phases} )
+    set( header "${header},${phase}_ms" )
+endforeach()
+set( header "${header},emit_ports_per_ms" )
+file( WRITE ${RESULTS} "${header}\n" )
+message( "${header}" )
+
+foreach( shape ${shapes} )
+    string( TOUPPER ${shape} shape_var )
+    string( REPLACE "," ";" sizes "${${shape_var}_SIZES}" )
+    foreach( size ${sizes} )
+        set( netlist ${WORK_DIR}/${shape}${size}.c )
+        execute_process( COMMAND ${NETGEN} ${shape} ${size} ${netlist}
+            RESULT_VARIABLE gen_result OUTPUT_VARIABLE critical_path OUTPUT_STRIP_TRAILING_WHITESPACE )
+        if(NOT gen_result EQUAL 0)
+            message( "${shape},${size},skipped: ${critical_path}" )
+        else()
+            file( STRINGS ${netlist} declarations REGEX "^(input|output) " )
+            set( ports 0 )
+            foreach( declaration ${declarations} )
+                string( REGEX MATCHALL "," commas "${declaration}" )
+                list( LENGTH commas num_commas )
+                math( EXPR ports "${ports} + ${num_commas} + 1" )
+            endforeach()
+            math( EXPR latency "${critical_path} + ${SLACK}" )
+            if(latency GREATER 250)
+                set( latency 250 )
+            endif()
+            foreach( phase ${phases} )
+                unset( best_${phase} )
+            endforeach()
+            set( row_status "" )
+            foreach( run RANGE 1 ${REPEAT} )
+                set( stats_file ${WORK_DIR}/${shape}${size}.stats.json )
+                file( REMOVE ${stats_file} )
+                execute_process( COMMAND ${HLSYN} ${netlist} ${latency} ${WORK_DIR}/${shape}${size}.v --stats ${stats_file} --report-format json
+                    RESULT_VARIABLE run_result OUTPUT_QUIET ERROR_QUIET TIMEOUT ${TIMEOUT} )
+                if(NOT EXISTS ${stats_file})
+                    set( row_status "failed: ${run_result}" )
+                    break()
+                endif()
+                file( READ ${stats_file} stats )
+                foreach( phase ${phases} )
+                    string( REGEX MATCH "\"name\": \"${phase}\", \"calls\": [0-9]+, \"wall_ms\": ([0-9.]+)" match "${stats}" )
+                    if(NOT DEFINED best_${phase} OR CMAKE_MATCH_1 LESS best_${phase})
+                        set( best_${phase} ${CMAKE_MATCH_1} )
+                    endif()
+                endforeach()
+            endforeach()
+            if(NOT row_status STREQUAL "")
+                message( "${shape},${size},${row_status}" )
+            else()
+                string( REGEX MATCH "\"components\": ([0-9]+)" match "${stats}" )
+                set( row "${shape},${size},${CMAKE_MATCH_1},${ports},${latency}" )
+                string( REGEX MATCH "\"force_evaluations\": ([0-9]+)" match "${stats}" )
+                set( row "${row},${CMAKE_MATCH_1}" )
+                foreach( phase ${phases} )
+                    set( row "${row},${best_${phase}}" )
+                endforeach()
+                #Times have three decimals, so dropping the point gives microseconds
+                string( REPLACE "." "" emit_us "${best_emit}" )
+                string( REGEX MATCH "[1-9][0-9]*$" emit_us "${emit_us}" )
+                if(NOT emit_us STREQUAL "")
+                    math( EXPR ports_per_ms "${ports} * 1000 / ${emit_us}" )
+                    set( row "${row},${ports_per_ms}" )
+                else()
+                    set( row "${row}," )
+                endif()
+                file( APPEND ${RESULTS} "${row}\n" )
+                message( "${row}" )
+            endif()
+        endif()
+    endforeach()
+endforeach()
+message( "Results written to ${RESULTS}" )
@@ -0,0 +1,360 @@
+/*
+ * complexity.c
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define SUCCESS 0
+#define FAILURE 1
+
+#define FALSE 0
+#define TRUE 1
+
+#define COMPLEXITY_MAX_ENTRIES 64
+#define COMPLEXITY_MAX_STEPS 12
+#define COMPLEXITY_MIN_POINTS 3
+#define COMPLEXITY_MAX_LATENCY 250
+
+//One metric of one shape, fitted over sizes first_size * 2^k for k below steps
+typedef struct {
+	char shape[16];
+	uint32_t first_size;
+	uint32_t steps;
+	char metric[32];
+	double baseline;
+	uint8_t has_baseline; //FALSE for a - in the baseline, a metric too fast to fit when it was recorded
+	double measured;
+	uint8_t fitted;
+	uint32_t num_points;
+	double sizes[COMPLEXITY_MAX_STEPS];
+	double values[COMPLEXITY_MAX_STEPS];
+} complexity_entry;
+
+typedef struct {
+	const char* hlsyn;
+	const char* netgen;
+	const char* baseline_file;
+	const char* work_dir;
+	uint8_t update;
+	double tolerance;
+	double floor_ms; //Phase times below this are timer noise and left out of the fit
+	uint32_t slack;
+	uint32_t repeat;
+	complexity_entry entries[COMPLEXITY_MAX_ENTRIES];
+	uint32_t num_entries;
+} complexity;
+
+static uint8_t Complexity_ReadBaseline(complexity* self);
+static uint8_t Complexity_WriteBaseline(complexity* self);
+static uint8_t Complexity_IsCounter(const char* metric);
+static uint8_t Complexity_ReadMetric(const char* stats, const char* metric, double* value);
+static char* Complexity_ReadFile(const char* file_name);
+static uint8_t Complexity_Generate(complexity* self, const char* shape, uint32_t size, const char* netlist, uint32_t* critical_path);
+static uint8_t Complexity_RunLadder(complexity* self, uint32_t first_entry);
+static uint8_t Complexity_Fit(complexity_entry* entry);
+
+//Lines are: shape first_size steps metric exponent, # starts a comment. An exponent of - is not checked.
+static uint8_t Complexity_ReadBaseline(complexity* self) {
+	char line[256];
+	char exponent[32];
+	char* end;
+	complexity_entry* entry;
+	FILE* fp = fopen(self->baseline_file, "r");
+	if(NULL == fp) {
+		printf("ERROR: Cannot open baseline %s.\n", self->baseline_file);
+		return FAILURE;
+	}
+	while(NULL != fgets(line, sizeof(line), fp)) {
+		if('#' == line[0] || '\n' == line[0]) continue;
+		if(COMPLEXITY_MAX_ENTRIES <= self->num_entries) {
+			printf("ERROR: More than %u baseline entries.\n", COMPLEXITY_MAX_ENTRIES);
+			fclose(fp);
+			return FAILURE;
+		}
+		entry = &self->entries[self->num_entries];
+		memset(entry, 0, sizeof(complexity_entry));
+		if(5 != sscanf(line, "%15s %u %u %31s %31s", entry->shape, &entry->first_size, &entry->steps, entry->metric, exponent) ||
+				0 == entry->first_size || COMPLEXITY_MIN_POINTS > entry->steps || COMPLEXITY_MAX_STEPS < entry->steps) {
+			printf("ERROR: Bad baseline line: %s", line);
+			fclose(fp);
+			return FAILURE;
+		}
+		entry->has_baseline = (0 == strcmp(exponent, "-")) ? FALSE : TRUE;
+		if(TRUE == entry->has_baseline) {
+			entry->baseline = strtod(exponent, &end);
+			if(end == exponent || '\0' != *end) {
+				printf("ERROR: Bad baseline line: %s", line);
+				fclose(fp);
+				return FAILURE;
+			}
+		}
+		self->num_entries++;
+	}
+	fclose(fp);
+	return SUCCESS;
+}
+
+static uint8_t Complexity_WriteBaseline(complexity* self) {
+	uint32_t idx;
+	FILE* fp = fopen(self->baseline_file, "w");
+	if(NULL == fp) {
+		printf("ERROR: Cannot write baseline %s.\n", self->baseline_file);
+		return FAILURE;
+	}
+	fprintf(fp, "# Empirical complexity exponents of hlsyn on generated netlists, regenerate with --update.\n");
+	fprintf(fp, "# shape first_size steps metric exponent, - for a metric too fast to fit when recorded\n");
+	for(idx = 0; idx < self->num_entries; idx++) {
+		fprintf(fp, "%s %u %u %s ", self->entries[idx].shape, self->entries[idx].first_size, self->entries[idx].steps, self->entries[idx].metric);
+		if(TRUE == self->entries[idx].fitted) {
+			fprintf(fp, "%.2f\n", self->entries[idx].measured);
+		} else if(TRUE == self->entries[idx].has_baseline) {
+			fprintf(fp, "%.2f\n", self->entries[idx].baseline);
+		} else {
+			fprintf(fp, "-\n");
+		}
+	}
+	return (0 == fclose(fp)) ? SUCCESS : FAILURE;
+}
+
+//Counters are exact, phases are wall times
+static uint8_t Complexity_IsCounter(const char* metric) {
+	return (0 == strcmp(metric, "force_evaluations") || 0 == strcmp(metric, "fds_candidates") ||
+			0 == strcmp(metric, "distribution_rebuilds") || 0 == strcmp(metric, "link_visits") ||
+			0 == strcmp(metric, "minimize_visits")) ? TRUE : FALSE;
+}
+
+//Reads one metric from the --stats JSON of a run
+static uint8_t Complexity_ReadMetric(const char* stats, const char* metric, double* value) {
+	char key[64];
+	unsigned long long count;
+	unsigned int calls;
+	const char* cur;
+	if(TRUE == Complexity_IsCounter(metric) || 0 == strcmp(metric, "components")) {
+		snprintf(key, sizeof(key), "\"%s\": ", metric);
+		cur = strstr(stats, key);
+		if(NULL == cur || 1 != sscanf(cur + strlen(key), "%llu", &count)) return FAILURE;
+		*value = (double) count;
+	} else {
+		snprintf(key, sizeof(key), "\"name\": \"%s\", ", metric);
+		cur = strstr(stats, key);
+		if(NULL == cur || 2 != sscanf(cur + strlen(key), "\"calls\": %u, \"wall_ms\": %lf", &calls, value)) return FAILURE;
+	}
+	return SUCCESS;
+}
+
+static char* Complexity_ReadFile(const char* file_name) {
+	char* content;
+	long length;
+	FILE* fp = fopen(file_name, "rb");
+	if(NULL == fp) return NULL;
+	fseek(fp, 0, SEEK_END);
+	length = ftell(fp);
+	rewind(fp);
+	content = (0 <= length) ? (char*) malloc(length + 1) : NULL;
+	if(NULL != content) {
+		if((size_t) length != fread(content, 1, length, fp)) {
+			free(content);
+			content = NULL;
+		} else {
+			content[length] = '\0';
+		}
+	}
+	fclose(fp);
+	return content;
+}
+
+static uint8_t Complexity_Generate(complexity* self, const char* shape, uint32_t size, const char* netlist, uint32_t* critical_path) {
+	char command[1024];
+	FILE* pipe;
+	uint8_t ret_value = FAILURE;
+	snprintf(command, sizeof(command), "\"%s\" %s %u \"%s\"", self->netgen, shape, size, netlist);
+	pipe = popen(command, "r");
+	if(NULL == pipe) return FAILURE;
+	if(1 == fscanf(pipe, "%u", critical_path)) ret_value = SUCCESS;
+	if(0 != pclose(pipe)) ret_value = FAILURE;
+	return ret_value;
+}
+
+//Runs every size of the ladder of entries[first_entry] once and records all of the entries that share it
+static uint8_t Complexity_RunLadder(complexity* self, uint32_t first_entry) {
+	complexity_entry* ladder = &self->entries[first_entry];
+	complexity_entry* entry;
+	char netlist[512];
+	char verilog[512];
+	char stats_file[512];
+	char command[2048];
+	char* stats;
+	double value;
+	double best[COMPLEXITY_MAX_ENTRIES];
+	double components;
+	uint32_t step, run, idx, size, critical_path, latency;
+
+	snprintf(netlist, sizeof(netlist), "%s/%s.c", self->work_dir, ladder->shape);
+	snprintf(verilog, sizeof(verilog), "%s/%s.v", self->work_dir, ladder->shape);
+	snprintf(stats_file, sizeof(stats_file), "%s/%s.stats.json", self->work_dir, ladder->shape);
+	for(step = 0; step < ladder->steps; step++) {
+		size = ladder->first_size << step;
+		if(SUCCESS != Complexity_Generate(self, ladder->shape, size, netlist, &critical_path)) {
+			printf("ERROR: Cannot generate a %s of size %u.\n", ladder->shape, size);
+			return FAILURE;
+		}
+		latency = critical_path + self->slack;
+		if(COMPLEXITY_MAX_LATENCY < latency) latency = COMPLEXITY_MAX_LATENCY;
+		snprintf(command, sizeof(command), "\"%s\" \"%s\" %u \"%s\" --stats \"%s\" --report-format json > /dev/null 2>&1",
+				self->hlsyn, netlist, latency, verilog, stats_file);
+		for(idx = first_entry; idx < self->num_entries; idx++) best[idx] = -1.0;
+		components = 0.0;
+		for(run = 0; run < self->repeat; run++) {
+			remove(stats_file);
+			if(0 != system(command) || NULL == (stats = Complexity_ReadFile(stats_file))) {
+				printf("ERROR: hlsyn failed on a %s of size %u at latency %u.\n", ladder->shape, size, latency);
+				return FAILURE;
+			}
+			Complexity_ReadMetric(stats, "components", &components);
+			for(idx = first_entry; idx < self->num_entries; idx++) {
+				entry = &self->entries[idx];
+				if(0 != strcmp(entry->shape, ladder->shape) || entry->first_size != ladder->first_size || entry->steps != ladder->steps) continue;
+				if(SUCCESS != Complexity_ReadMetric(stats, entry->metric, &value)) {
+					printf("ERROR: No metric %s in the statistics.\n", entry->metric);
+					free(stats);
+					return FAILURE;
+				}
+				if(0.0 > best[idx] || value < best[idx]) best[idx] = value;
+			}
+			free(stats);
+		}
+		for(idx = first_entry; idx < self->num_entries; idx++) {
+			entry = &self->entries[idx];
+			if(0 != strcmp(entry->shape, ladder->shape) || entry->first_size != ladder->first_size || entry->steps != ladder->steps) continue;
+			if((TRUE == Complexity_IsCounter(entry->metric)) ? (0.0 < best[idx]) : (self->floor_ms <= best[idx])) {
+				entry->sizes[entry->num_points] = components;
+				entry->values[entry->num_points] = best[idx];
+				entry->num_points++;
+			}
+		}
+	}
+	return SUCCESS;
+}
+
+//Least squares slope of log(value) over log(components), the exponent k of value ~ n^k
+static uint8_t Complexity_Fit(complexity_entry* entry) {
+	double sum_x = 0.0, sum_y = 0.0, sum_xx = 0.0, sum_xy = 0.0;
+	double x, y, denominator;
+	uint32_t idx;
+	entry->fitted = FALSE;
+	if(COMPLEXITY_MIN_POINTS > entry->num_points) return FAILURE;
+	for(idx = 0; idx < entry->num_points; idx++) {
+		x = log(entry->sizes[idx]);
+		y = log(entry->values[idx]);
+		sum_x += x;
+		sum_y += y;
+		sum_xx += x * x;
+		sum_xy += x * y;
+	}
+	denominator = entry->num_points * sum_xx - sum_x * sum_x;
+	if(1e-12 > fabs(denominator)) return FAILURE;
+	entry->measured = (entry->num_points * sum_xy - sum_x * sum_y) / denominator;
+	entry->fitted = TRUE;
+	return SUCCESS;
+}
+
+static void Complexity_PrintUsage() {
+	printf("Usage: hlsyn_complexity hlsyn hlsyn_netgen baselineFile workDir [--update] [--tolerance t] [--slack n] [--repeat n]\n");
+	printf("Fits the exponent k of runtime ~ n^k for every shape and metric in the baseline and fails when one exceeds it by more than t\n");
+	printf("A baseline exponent of - is reported but not checked, --update records it once it can be fitted\n\n");
+	printf("\t--update\t\tRewrite the baseline with the measured exponents\n");
+	printf("\t--tolerance t\t\tAllowed growth of an exponent (default 0.3)\n");
+	printf("\t--slack n\t\tCycles of latency above the critical path (default 2)\n");
+	printf("\t--repeat n\t\tRuns per netlist, the fastest is kept (default 3)\n");
+}
+
+int main(int argc, char *argv[]) {
+	static complexity harness;
+	complexity_entry* entry;
+	uint32_t idx, prev;
+	uint32_t num_regressions = 0;
+	char baseline[16];
+	int arg_idx;
+	uint8_t ran;
+
+	if(5 > argc) {
+		Complexity_PrintUsage();
+		return EXIT_FAILURE;
+	}
+	harness.hlsyn = argv[1];
+	harness.netgen = argv[2];
+	harness.baseline_file = argv[3];
+	harness.work_dir = argv[4];
+	harness.update = FALSE;
+	harness.tolerance = 0.3;
+	harness.floor_ms = 0.05;
+	harness.slack = 2;
+	harness.repeat = 3;
+	for(arg_idx = 5; arg_idx < argc; arg_idx++) {
+		if(0 == strcmp(argv[arg_idx], "--update")) {
+			harness.update = TRUE;
+		} else if(arg_idx + 1 < argc && 0 == strcmp(argv[arg_idx], "--tolerance")) {
+			harness.tolerance = strtod(argv[++arg_idx], NULL);
+		} else if(arg_idx + 1 < argc && 0 == strcmp(argv[arg_idx], "--slack")) {
+			harness.slack = (uint32_t) strtoul(argv[++arg_idx], NULL, 10);
+		} else if(arg_idx + 1 < argc && 0 == strcmp(argv[arg_idx], "--repeat")) {
+			harness.repeat = (uint32_t) strtoul(argv[++arg_idx], NULL, 10);
+		} else {
+			Complexity_PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+	if(0 == harness.repeat) harness.repeat = 1;
+	if(SUCCESS != Complexity_ReadBaseline(&harness)) return EXIT_FAILURE;
+
+	printf("%-8s %-22s %8s %8s  %s\n", "Shape", "Metric", "Measured", "Baseline", "Points (components: value)");
+	for(idx = 0; idx < harness.num_entries; idx++) {
+		entry = &harness.entries[idx];
+		ran = FALSE;
+		for(prev = 0; prev < idx; prev++) {
+			if(0 == strcmp(harness.entries[prev].shape, entry->shape) && harness.entries[prev].first_size == entry->first_size &&
+					harness.entries[prev].steps == entry->steps) {
+				ran = TRUE;
+				break;
+			}
+		}
+		if(FALSE == ran && SUCCESS != Complexity_RunLadder(&harness, idx)) return EXIT_FAILURE;
+	}
+	for(idx = 0; idx < harness.num_entries; idx++) {
+		entry = &harness.entries[idx];
+		if(TRUE == entry->has_baseline) {
+			snprintf(baseline, sizeof(baseline), "%.2f", entry->baseline);
+		} else {
+			snprintf(baseline, sizeof(baseline), "-");
+		}
+		if(SUCCESS != Complexity_Fit(entry)) {
+			printf("%-8s %-22s %8s %8s  too fast to fit\n", entry->shape, entry->metric, "-", baseline);
+			continue;
+		}
+		printf("%-8s %-22s %8.2f %8s ", entry->shape, entry->metric, entry->measured, baseline);
+		for(prev = 0; prev < entry->num_points; prev++) {
+			printf(" %.0f: %.*f", entry->sizes[prev], (TRUE == Complexity_IsCounter(entry->metric)) ? 0 : 3, entry->values[prev]);
+		}
+		if(FALSE == harness.update && TRUE == entry->has_baseline && entry->measured > entry->baseline + harness.tolerance) {
+			printf("  REGRESSION");
+			num_regressions++;
+		}
+		printf("\n");
+	}
+
+	if(TRUE == harness.update) {
+		if(SUCCESS != Complexity_WriteBaseline(&harness)) return EXIT_FAILURE;
+		printf("Baseline %s updated.\n", harness.baseline_file);
+	} else if(0 < num_regressions) {
+		printf("%u metrics scale worse than the baseline.\n", num_regressions);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
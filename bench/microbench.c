@@ -0,0 +1,381 @@
+/*
+ * microbench.c
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "global.h"
+#include "logger.h"
+#include "circuit.h"
+#include "component.h"
+#include "net.h"
+#include "netlist_reader.h"
+
+#define MICROBENCH_LAYERS 6 //Successor forces recurse through every later layer, so sizes widen the layers instead
+#define MICROBENCH_SLACK 4 //Cycles of mobility each operation gets
+#define MICROBENCH_MAX_SIZES 8
+
+typedef enum {
+	kernel_self_force=0,
+	kernel_successor_force,
+	kernel_predecessor_force,
+	kernel_distribution_graphs,
+	kernel_time_frame_start,
+	kernel_time_frame_end,
+	kernel_find_net,
+	kernel_log_disabled,
+	kernel_log_enabled,
+	num_kernels
+} microbench_kernel;
+
+static const char* const kernel_names[num_kernels] = {"self_force", "successor_force", "predecessor_force", "distribution_graphs",
+		"time_frame_start", "time_frame_end", "find_net", "log_disabled", "log_enabled"};
+
+//A parsed and time-framed circuit with the scheduler state needed to undo time frame updates
+typedef struct {
+	circuit* circ;
+	uint16_t num_components;
+	uint16_t num_nets;
+	component_schedule* schedules;
+	uint8_t* net_cycles; //ASAP and ALAP cycle of every net
+	char** net_names;
+} microbench_circuit;
+
+static double MicroBench_Now();
+static int MicroBench_OpenCacheMisses();
+static uint64_t MicroBench_ReadCounter(int fd);
+static char* MicroBench_Netlist(uint32_t size, uint8_t* latency);
+static uint8_t MicroBench_Load(microbench_circuit* self, FILE* fp, uint8_t latency);
+static void MicroBench_Restore(microbench_circuit* self);
+static uint64_t MicroBench_Pass(microbench_circuit* self, microbench_kernel kernel, int fd, double* update_seconds);
+static void MicroBench_Run(microbench_circuit* self, microbench_kernel kernel, double min_seconds);
+static void MicroBench_Free(microbench_circuit* self);
+
+static double MicroBench_Now() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+}
+
+//Hardware cache misses of this thread, -1 where perf events are missing or not permitted
+static int MicroBench_OpenCacheMisses() {
+#ifdef __linux__
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+	return -1;
+#endif
+}
+
+static uint64_t MicroBench_ReadCounter(int fd) {
+	uint64_t count = 0;
+	if(0 > fd || sizeof(count) != read(fd, &count, sizeof(count))) return 0;
+	return count;
+}
+
+//MICROBENCH_LAYERS layers of adders and subtractors, each reading its own predecessor and a neighbour's
+static char* MicroBench_Netlist(uint32_t size, uint8_t* latency) {
+	uint32_t width = (size + MICROBENCH_LAYERS - 1) / MICROBENCH_LAYERS;
+	uint32_t layer, idx, var;
+	size_t text_size = 0;
+	char* text = NULL;
+	FILE* fp;
+	if(2 > width) width = 2;
+	fp = open_memstream(&text, &text_size);
+	if(NULL == fp) return NULL;
+	for(idx = 0; idx < width; idx++) fprintf(fp, "input Int32 i%u\n", idx);
+	for(idx = 0; idx < width; idx++) fprintf(fp, "output Int32 z%u\n", idx);
+	for(var = 0; var < (MICROBENCH_LAYERS - 1) * width; var++) fprintf(fp, "variable Int32 v%u\n", var);
+	for(layer = 0; layer < MICROBENCH_LAYERS; layer++) {
+		for(idx = 0; idx < width; idx++) {
+			if(layer + 1 == MICROBENCH_LAYERS) {
+				fprintf(fp, "z%u = ", idx);
+			} else {
+				fprintf(fp, "v%u = ", layer * width + idx);
+			}
+			if(0 == layer) {
+				fprintf(fp, "i%u %c i%u\n", idx, (0 == idx % 2) ? '+' : '-', (idx + 1) % width);
+			} else {
+				fprintf(fp, "v%u %c v%u\n", (layer - 1) * width + idx, (0 == (layer + idx) % 2) ? '+' : '-',
+						(layer - 1) * width + (idx + 1 + layer) % width);
+			}
+		}
+	}
+	if(0 != fclose(fp)) {
+		free(text);
+		return NULL;
+	}
+	*latency = MICROBENCH_LAYERS + MICROBENCH_SLACK;
+	return text;
+}
+
+//Parses the netlist, computes its time frames and distribution graphs, and keeps a copy of the scheduler state
+static uint8_t MicroBench_Load(microbench_circuit* self, FILE* fp, uint8_t latency) {
+	uint16_t idx;
+	memset(self, 0, sizeof(microbench_circuit));
+	self->circ = Circuit_Create(latency);
+	if(NULL == self->circ) return FAILURE;
+	if(SUCCESS != ReadNetlistStream(fp, self->circ)) {
+		printf("ERROR: Cannot parse the netlist.\n");
+		return FAILURE;
+	}
+	Circuit_ScheduleASAP(self->circ);
+	if(SUCCESS != Circuit_ScheduleALAP(self->circ)) {
+		printf("ERROR: The netlist does not fit in %u cycles.\n", latency);
+		return FAILURE;
+	}
+	Circuit_CalculateDistributionGraphs(self->circ);
+	self->num_components = Circuit_GetNumComponent(self->circ);
+	self->num_nets = Circuit_GetNumNet(self->circ);
+	self->schedules = (component_schedule*) calloc(self->num_components + 1, sizeof(component_schedule));
+	self->net_cycles = (uint8_t*) calloc(2 * self->num_nets + 2, sizeof(uint8_t));
+	self->net_names = (char**) calloc(self->num_nets + 1, sizeof(char*));
+	if(NULL == self->schedules || NULL == self->net_cycles || NULL == self->net_names) return FAILURE;
+	for(idx = 0; idx < self->num_components; idx++) {
+		Component_GetSchedule(Circuit_GetComponent(self->circ, idx), &self->schedules[idx]);
+	}
+	for(idx = 0; idx < self->num_nets; idx++) {
+		Net_GetScheduleCycles(Circuit_GetNet(self->circ, idx), &self->net_cycles[2 * idx], &self->net_cycles[2 * idx + 1]);
+		self->net_names[idx] = (char*) Net_GetNameRef(Circuit_GetNet(self->circ, idx));
+	}
+	return SUCCESS;
+}
+
+static void MicroBench_Restore(microbench_circuit* self) {
+	uint16_t idx;
+	for(idx = 0; idx < self->num_components; idx++) {
+		Component_SetSchedule(Circuit_GetComponent(self->circ, idx), &self->schedules[idx]);
+	}
+	for(idx = 0; idx < self->num_nets; idx++) {
+		Net_SetScheduleCycles(Circuit_GetNet(self->circ, idx), self->net_cycles[2 * idx], self->net_cycles[2 * idx + 1]);
+	}
+}
+
+//One sweep of the kernel over every operation, or net for find_net. Returns the kernel calls made.
+//The log kernels make one LOG_MESSAGE per operation, below the log level or into /dev/null.
+//Time frame updates narrow each frame by one cycle and are undone after every call, so each call is timed
+//and counted on its own into update_seconds and fd.
+static uint64_t MicroBench_Pass(microbench_circuit* self, microbench_kernel kernel, int fd, double* update_seconds) {
+	volatile float sink = 0.0f;
+	volatile uintptr_t found = 0;
+	uint64_t calls = 0;
+	uint16_t idx;
+	uint8_t cycle, cycle_start, cycle_end;
+	double start;
+	component* comp;
+
+	if(kernel_distribution_graphs == kernel) {
+		Circuit_CalculateDistributionGraphs(self->circ);
+		return 1;
+	}
+	if(kernel_find_net == kernel) {
+		for(idx = 0; idx < self->num_nets; idx++) found ^= (uintptr_t) Circuit_FindNet(self->circ, self->net_names[idx]);
+		return self->num_nets;
+	}
+	if(kernel_log_disabled == kernel || kernel_log_enabled == kernel) {
+		for(idx = 0; idx < self->num_components; idx++) {
+			if(kernel_log_enabled == kernel) {
+				LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "%s: Component %u of %u\n", kernel_names[kernel], idx, self->num_components);
+			} else {
+				LOG_MESSAGE(MESSAGE_LEVEL, "%s: Component %u of %u\n", kernel_names[kernel], idx, self->num_components);
+			}
+		}
+		return self->num_components;
+	}
+	for(idx = 0; idx < self->num_components; idx++) {
+		comp = Circuit_GetComponent(self->circ, idx);
+		cycle_start = Component_GetTimeFrameStart(comp);
+		cycle_end = Component_GetTimeFrameEnd(comp);
+		switch(kernel) {
+			case kernel_time_frame_start:
+			case kernel_time_frame_end:
+				if(cycle_start < cycle_end) {
+#ifdef __linux__
+					if(0 <= fd) ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+					start = MicroBench_Now();
+					if(kernel_time_frame_start == kernel) {
+						Component_UpdateTimeFrameStart(comp, cycle_start + 1);
+					} else {
+						Component_UpdateTimeFrameEnd(comp, cycle_end - 1 + Component_GetDelayCycle(comp));
+					}
+					*update_seconds += MicroBench_Now() - start;
+#ifdef __linux__
+					if(0 <= fd) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+					MicroBench_Restore(self);
+					calls++;
+				}
+				break;
+			default:
+				for(cycle = cycle_start; cycle <= cycle_end; cycle++) {
+					if(kernel_self_force == kernel) {
+						sink += Component_CalculateSelfForce(comp, self->circ, cycle);
+					} else if(kernel_successor_force == kernel) {
+						sink += Component_CalculateSuccessorForce(comp, self->circ, cycle);
+					} else {
+						sink += Component_CalculatePredecessorForce(comp, self->circ, cycle);
+					}
+					calls++;
+				}
+				break;
+		}
+	}
+	return calls;
+}
+
+//Repeats sweeps for at least min_seconds and prints the time and cache misses per kernel call
+static void MicroBench_Run(microbench_circuit* self, microbench_kernel kernel, double min_seconds) {
+	double start, elapsed;
+	double update_seconds = 0.0;
+	uint64_t calls = 0;
+	uint64_t misses;
+	uint8_t per_call = (kernel_time_frame_start == kernel || kernel_time_frame_end == kernel) ? TRUE : FALSE;
+	int fd = MicroBench_OpenCacheMisses();
+	char misses_text[32] = "n/a";
+	logger* null_log = NULL;
+	logger* prev_log = NULL;
+
+	if(kernel_log_enabled == kernel) {
+		null_log = Logger_Open("/dev/null", CIRCUIT_ERROR_LEVEL);
+		if(NULL == null_log) {
+			printf("%-20s %10u %12s %12s %12s\n", kernel_names[kernel], self->num_components, "0", "-", "-");
+			if(0 <= fd) close(fd);
+			return;
+		}
+		prev_log = Logger_Bind(null_log);
+	}
+
+#ifdef __linux__
+	if(0 <= fd) {
+		ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+		if(FALSE == per_call) ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+#endif
+	start = MicroBench_Now();
+	do {
+		calls += MicroBench_Pass(self, kernel, fd, &update_seconds);
+		elapsed = MicroBench_Now() - start;
+	} while(elapsed < min_seconds && 0 < calls);
+#ifdef __linux__
+	if(0 <= fd && FALSE == per_call) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+	if(NULL != null_log) {
+		Logger_Bind(prev_log);
+		Logger_Destroy(&null_log);
+	}
+	misses = MicroBench_ReadCounter(fd);
+	if(TRUE == per_call) elapsed = update_seconds;
+	if(0 == calls) {
+		printf("%-20s %10u %12s %12s %12s\n", kernel_names[kernel], self->num_components, "0", "-", "-");
+	} else {
+		if(0 <= fd) snprintf(misses_text, sizeof(misses_text), "%.2f", (double) misses / (double) calls);
+		printf("%-20s %10u %12llu %12.1f %12s\n", kernel_names[kernel], self->num_components, (unsigned long long) calls,
+				elapsed * 1e9 / (double) calls, misses_text);
+	}
+	if(0 <= fd) close(fd);
+}
+
+static void MicroBench_Free(microbench_circuit* self) {
+	Circuit_Destroy(&self->circ);
+	free(self->schedules);
+	free(self->net_cycles);
+	free(self->net_names);
+}
+
+static void MicroBench_PrintUsage() {
+	printf("Usage: hlsyn_microbench [--size n]... [--netlist cFile latency] [--time seconds]\n");
+	printf("Times the scheduler kernels and logging in isolation, in ns per call and hardware cache misses per call where perf events allow\n\n");
+	printf("\t--size n\t\t\tSynthetic netlist of about n operations in %u layers, repeatable (default 64, 256, 1024)\n", MICROBENCH_LAYERS);
+	printf("\t--netlist cFile latency\t\tTime the kernels on a netlist file instead\n");
+	printf("\t--time seconds\t\t\tMinimum time per kernel (default 0.2)\n");
+}
+
+int main(int argc, char *argv[]) {
+	uint32_t sizes[MICROBENCH_MAX_SIZES] = {64, 256, 1024};
+	uint32_t num_sizes = 3;
+	uint8_t sizes_given = FALSE;
+	char* netlist_file = NULL;
+	long netlist_latency = 0;
+	double min_seconds = 0.2;
+	microbench_circuit bench_circuit;
+	uint32_t size_idx;
+	uint8_t kernel, latency, loaded;
+	char* text;
+	FILE* fp;
+	int arg_idx;
+
+	for(arg_idx = 1; arg_idx < argc; arg_idx++) {
+		if(arg_idx + 1 < argc && 0 == strcmp(argv[arg_idx], "--size")) {
+			if(FALSE == sizes_given) num_sizes = 0;
+			sizes_given = TRUE;
+			if(MICROBENCH_MAX_SIZES <= num_sizes) {
+				printf("ERROR: At most %u sizes.\n", MICROBENCH_MAX_SIZES);
+				return EXIT_FAILURE;
+			}
+			sizes[num_sizes++] = (uint32_t) strtoul(argv[++arg_idx], NULL, 10);
+		} else if(arg_idx + 2 < argc && 0 == strcmp(argv[arg_idx], "--netlist")) {
+			netlist_file = argv[++arg_idx];
+			netlist_latency = strtol(argv[++arg_idx], NULL, 10);
+		} else if(arg_idx + 1 < argc && 0 == strcmp(argv[arg_idx], "--time")) {
+			min_seconds = strtod(argv[++arg_idx], NULL);
+		} else {
+			MicroBench_PrintUsage();
+			return EXIT_FAILURE;
+		}
+	}
+	if(NULL != netlist_file && (0 >= netlist_latency || UINT8_MAX <= netlist_latency)) {
+		printf("ERROR: Latency must be between 1 and %u.\n", UINT8_MAX - 1);
+		return EXIT_FAILURE;
+	}
+	SetLogLevel(CIRCUIT_ERROR_LEVEL);
+
+	printf("%-20s %10s %12s %12s %12s\n", "Kernel", "Components", "Calls", "ns/call", "Misses/call");
+	for(size_idx = 0; size_idx < ((NULL != netlist_file) ? 1 : num_sizes); size_idx++) {
+		text = NULL;
+		if(NULL != netlist_file) {
+			fp = fopen(netlist_file, "r");
+			latency = (uint8_t) netlist_latency;
+		} else {
+			text = MicroBench_Netlist(sizes[size_idx], &latency);
+			fp = (NULL != text) ? fmemopen(text, strlen(text), "r") : NULL;
+		}
+		if(NULL == fp) {
+			printf("ERROR: Cannot open the netlist of size %u.\n", sizes[size_idx]);
+			free(text);
+			return EXIT_FAILURE;
+		}
+		loaded = MicroBench_Load(&bench_circuit, fp, latency);
+		fclose(fp);
+		free(text);
+		if(SUCCESS != loaded) {
+			MicroBench_Free(&bench_circuit);
+			return EXIT_FAILURE;
+		}
+		for(kernel = 0; kernel < num_kernels; kernel++) {
+			MicroBench_Run(&bench_circuit, (microbench_kernel) kernel, min_seconds);
+		}
+		MicroBench_Free(&bench_circuit);
+	}
+	CloseLog();
+	return EXIT_SUCCESS;
+}
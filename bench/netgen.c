@@ -0,0 +1,396 @@
+/*
+ * netgen.c
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define SUCCESS 0
+#define FAILURE 1
+
+#define FALSE 0
+#define TRUE 1
+
+#define NETGEN_MAX_CYCLES 250 //Cycles are 8 bit in hlsyn and 255 marks an unscheduled ALAP start
+#define NETGEN_DAG_WIDTH 16
+#define NETGEN_NAMES_PER_LINE 16
+
+typedef enum {
+	shape_chain=0,
+	shape_tree,
+	shape_dag,
+	shape_if,
+	shape_mixed,
+	shape_wide,
+	shape_error
+} netgen_shape;
+
+//Every generated value is a variable v<n> of Int32 or a condition c<n> of Int1, ready tracks the cycle its producer finishes in
+typedef struct {
+	FILE* body;
+	uint32_t seed;
+	uint32_t num_inputs;
+	uint32_t num_vars;
+	uint32_t num_conds;
+	uint32_t num_outputs;
+	uint16_t* var_ready;
+	uint16_t* cond_ready;
+	uint32_t max_vars;
+	uint32_t max_conds;
+	uint16_t gate; //Operations inside an if start after its condition is known
+	uint16_t critical_path;
+} netgen;
+
+static const char* const shape_names[] = {"chain", "tree", "dag", "if", "mixed", "wide"};
+
+static netgen_shape NetGen_ReadShape(const char* word);
+static uint32_t NetGen_Random(netgen* self, uint32_t range);
+static uint16_t NetGen_Max(uint16_t a, uint16_t b);
+static int32_t NetGen_NewVar(netgen* self, uint16_t ready);
+static int32_t NetGen_NewCond(netgen* self, uint16_t ready);
+static int32_t NetGen_Binary(netgen* self, const char* dest, int32_t left, int32_t right, const char* op, uint16_t delay, uint32_t depth);
+static uint8_t NetGen_Chain(netgen* self, uint32_t size);
+static uint8_t NetGen_Tree(netgen* self, uint32_t size);
+static uint8_t NetGen_Dag(netgen* self, uint32_t size);
+static uint8_t NetGen_If(netgen* self, uint32_t size);
+static uint8_t NetGen_Mixed(netgen* self, uint32_t size);
+static uint8_t NetGen_Wide(netgen* self, uint32_t size);
+static void NetGen_Declare(FILE* fp, const char* kind, const char* type, char prefix, uint32_t first, uint32_t count);
+static uint8_t NetGen_Write(netgen* self, FILE* fp);
+
+static netgen_shape NetGen_ReadShape(const char* word) {
+	uint8_t idx;
+	for(idx = 0; idx < shape_error; idx++) {
+		if(0 == strcmp(word, shape_names[idx])) return (netgen_shape) idx;
+	}
+	return shape_error;
+}
+
+//xorshift32, the same seed always yields the same netlist
+static uint32_t NetGen_Random(netgen* self, uint32_t range) {
+	self->seed ^= self->seed << 13;
+	self->seed ^= self->seed >> 17;
+	self->seed ^= self->seed << 5;
+	return (0 == range) ? 0 : self->seed % range;
+}
+
+static uint16_t NetGen_Max(uint16_t a, uint16_t b) {
+	return (a > b) ? a : b;
+}
+
+static int32_t NetGen_NewVar(netgen* self, uint16_t ready) {
+	uint16_t* new_ready;
+	if(self->num_vars >= self->max_vars) {
+		self->max_vars = (0 == self->max_vars) ? 64 : 2 * self->max_vars;
+		new_ready = (uint16_t*) realloc(self->var_ready, self->max_vars * sizeof(uint16_t));
+		if(NULL == new_ready) return -1;
+		self->var_ready = new_ready;
+	}
+	self->var_ready[self->num_vars] = ready;
+	if(ready > self->critical_path) self->critical_path = ready;
+	return (int32_t) self->num_vars++;
+}
+
+static int32_t NetGen_NewCond(netgen* self, uint16_t ready) {
+	uint16_t* new_ready;
+	if(self->num_conds >= self->max_conds) {
+		self->max_conds = (0 == self->max_conds) ? 16 : 2 * self->max_conds;
+		new_ready = (uint16_t*) realloc(self->cond_ready, self->max_conds * sizeof(uint16_t));
+		if(NULL == new_ready) return -1;
+		self->cond_ready = new_ready;
+	}
+	self->cond_ready[self->num_conds] = ready;
+	if(ready > self->critical_path) self->critical_path = ready;
+	return (int32_t) self->num_conds++;
+}
+
+//Writes v<new> = <left> op <right> where a negative operand -n-1 names input i<n>. dest overrides the output name.
+static int32_t NetGen_Binary(netgen* self, const char* dest, int32_t left, int32_t right, const char* op, uint16_t delay, uint32_t depth) {
+	uint16_t ready = self->gate;
+	int32_t var;
+	uint32_t idx;
+	if(0 <= left) ready = NetGen_Max(ready, self->var_ready[left]);
+	if(0 <= right) ready = NetGen_Max(ready, self->var_ready[right]);
+	var = NetGen_NewVar(self, ready + delay);
+	if(0 > var) return -1;
+	for(idx = 0; idx < depth; idx++) fputc('\t', self->body);
+	if(NULL != dest) {
+		fprintf(self->body, "%s = ", dest);
+	} else {
+		fprintf(self->body, "v%d = ", var);
+	}
+	fprintf(self->body, "%c%d %s %c%d\n", (0 <= left) ? 'v' : 'i', (0 <= left) ? left : -left - 1, op,
+			(0 <= right) ? 'v' : 'i', (0 <= right) ? right : -right - 1);
+	return var;
+}
+
+//One accumulation of size inputs, every operation waits on the previous one
+static uint8_t NetGen_Chain(netgen* self, uint32_t size) {
+	int32_t acc = -1;
+	uint32_t idx;
+	if(2 > size) return FAILURE;
+	self->num_inputs = size + 1;
+	for(idx = 0; idx < size; idx++) {
+		acc = NetGen_Binary(self, (idx + 1 == size) ? "z0" : NULL, acc, -(int32_t) idx - 2, (0 == idx % 2) ? "+" : "-", 1, 0);
+		if(0 > acc) return FAILURE;
+	}
+	self->num_outputs = 1;
+	return SUCCESS;
+}
+
+//Balanced reduction of size inputs, wide at the leaves and one operation at the root
+static uint8_t NetGen_Tree(netgen* self, uint32_t size) {
+	int32_t* level;
+	uint32_t width = size;
+	uint32_t idx;
+	uint8_t ret_value = SUCCESS;
+	if(2 > size) return FAILURE;
+	level = (int32_t*) malloc(size * sizeof(int32_t));
+	if(NULL == level) return FAILURE;
+	self->num_inputs = size;
+	for(idx = 0; idx < size; idx++) level[idx] = -(int32_t) idx - 1;
+	while(1 < width && SUCCESS == ret_value) {
+		for(idx = 0; idx + 1 < width; idx += 2) {
+			level[idx / 2] = NetGen_Binary(self, (2 == width) ? "z0" : NULL, level[idx], level[idx + 1], "+", 1, 0);
+			if(0 > level[idx / 2]) ret_value = FAILURE;
+		}
+		if(1 == width % 2) level[idx / 2] = level[idx]; //The odd value moves up a level unchanged
+		width = (width + 1) / 2;
+	}
+	self->num_outputs = 1;
+	free(level);
+	return ret_value;
+}
+
+//Layers of NETGEN_DAG_WIDTH operations, each reading its own predecessor and a random one so paths split and rejoin
+static uint8_t NetGen_Dag(netgen* self, uint32_t size) {
+	int32_t prev[NETGEN_DAG_WIDTH];
+	int32_t cur[NETGEN_DAG_WIDTH];
+	uint32_t num_layers = (size + NETGEN_DAG_WIDTH - 1) / NETGEN_DAG_WIDTH;
+	uint32_t layer, idx, other;
+	char dest[16];
+	if(0 == num_layers) return FAILURE;
+	self->num_inputs = NETGEN_DAG_WIDTH;
+	for(idx = 0; idx < NETGEN_DAG_WIDTH; idx++) prev[idx] = -(int32_t) idx - 1;
+	for(layer = 0; layer < num_layers; layer++) {
+		for(idx = 0; idx < NETGEN_DAG_WIDTH; idx++) {
+			other = (idx + 1 + NetGen_Random(self, NETGEN_DAG_WIDTH - 1)) % NETGEN_DAG_WIDTH;
+			snprintf(dest, sizeof(dest), "z%u", idx);
+			cur[idx] = NetGen_Binary(self, (layer + 1 == num_layers) ? dest : NULL, prev[idx], prev[other], (0 == (layer + idx) % 2) ? "+" : "-", 1, 0);
+			if(0 > cur[idx]) return FAILURE;
+		}
+		memcpy(prev, cur, sizeof(prev));
+	}
+	self->num_outputs = NETGEN_DAG_WIDTH;
+	return SUCCESS;
+}
+
+//size levels of if/else nested in the taken branch, each branch assigns z0 so the branches merge
+static uint8_t NetGen_If(netgen* self, uint32_t size) {
+	int32_t acc = -1;
+	int32_t cond;
+	int32_t branch;
+	uint32_t level, idx;
+	if(1 > size) return FAILURE;
+	self->num_inputs = 2 * size + 2;
+	for(level = 0; level < size; level++) {
+		cond = NetGen_NewCond(self, ((0 <= acc) ? self->var_ready[acc] : self->gate) + 1);
+		if(0 > cond) return FAILURE;
+		self->gate = self->cond_ready[cond] + 1;
+		for(idx = 0; idx < level; idx++) fputc('\t', self->body);
+		fprintf(self->body, "c%d = %c%d > i%u\n", cond, (0 <= acc) ? 'v' : 'i', (0 <= acc) ? acc : 0, 2 * level + 1);
+		for(idx = 0; idx < level; idx++) fputc('\t', self->body);
+		fprintf(self->body, "if ( c%d ) {\n", cond);
+		acc = NetGen_Binary(self, NULL, acc, -(int32_t) (2 * level + 2), "+", 1, level + 1);
+		if(0 > acc) return FAILURE;
+		acc = NetGen_Binary(self, NULL, acc, -(int32_t) (2 * level + 3), "-", 1, level + 1);
+		if(0 > acc) return FAILURE;
+	}
+	for(level = size; level > 0; level--) {
+		if(0 > NetGen_Binary(self, "z0", acc, -(int32_t) (2 * level), "+", 1, level)) return FAILURE;
+		for(idx = 0; idx < level - 1; idx++) fputc('\t', self->body);
+		fputs("}\n", self->body);
+		for(idx = 0; idx < level - 1; idx++) fputc('\t', self->body);
+		fputs("else {\n", self->body);
+		branch = NetGen_Binary(self, "z0", -(int32_t) (2 * level), -(int32_t) (2 * level + 1), "-", 1, level);
+		if(0 > branch) return FAILURE;
+		for(idx = 0; idx < level - 1; idx++) fputc('\t', self->body);
+		fputs("}\n", self->body);
+	}
+	self->num_outputs = 1;
+	return SUCCESS;
+}
+
+//Random operator kinds over random earlier values, so every resource class and both delay lengths show up
+static uint8_t NetGen_Mixed(netgen* self, uint32_t size) {
+	const char* const ops[] = {"+", "-", "*", "/", "%", "<<", ">>", "*", "+", "-"};
+	const uint16_t delays[] = {1, 1, 2, 3, 3, 1, 1, 2, 1, 1};
+	const uint32_t num_ops = sizeof(ops) / sizeof(ops[0]);
+	const uint32_t num_outputs = 4;
+	uint32_t idx, kind, choice;
+	int32_t left, right, cond;
+	uint16_t ready;
+	char dest[16];
+	if(num_outputs > size) return FAILURE;
+	self->num_inputs = 8;
+	for(idx = 0; idx < size; idx++) {
+		left = (0 == self->num_vars || 0 == NetGen_Random(self, 4)) ? -(int32_t) NetGen_Random(self, self->num_inputs) - 1 : (int32_t) NetGen_Random(self, self->num_vars);
+		right = (0 == self->num_vars || 0 == NetGen_Random(self, 2)) ? -(int32_t) NetGen_Random(self, self->num_inputs) - 1 : (int32_t) NetGen_Random(self, self->num_vars);
+		ready = NetGen_Max((0 <= left) ? self->var_ready[left] : 0, (0 <= right) ? self->var_ready[right] : 0);
+		if(idx + num_outputs >= size) {
+			snprintf(dest, sizeof(dest), "z%u", size - idx - 1);
+		}
+		choice = NetGen_Random(self, 8);
+		if(0 == choice && ready + 2 <= NETGEN_MAX_CYCLES) { //A comparator selecting between its operands
+			cond = NetGen_NewCond(self, ready + 1);
+			if(0 > cond) return FAILURE;
+			fprintf(self->body, "c%d = %c%d %s %c%d\n", cond, (0 <= left) ? 'v' : 'i', (0 <= left) ? left : -left - 1,
+					(0 == NetGen_Random(self, 2)) ? ">" : "<", (0 <= right) ? 'v' : 'i', (0 <= right) ? right : -right - 1);
+			if(0 > NetGen_NewVar(self, ready + 2)) return FAILURE;
+			if(idx + num_outputs >= size) {
+				fprintf(self->body, "%s = ", dest);
+			} else {
+				fprintf(self->body, "v%u = ", self->num_vars - 1);
+			}
+			fprintf(self->body, "c%d ? %c%d : %c%d\n", cond, (0 <= left) ? 'v' : 'i', (0 <= left) ? left : -left - 1,
+					(0 <= right) ? 'v' : 'i', (0 <= right) ? right : -right - 1);
+		} else {
+			kind = NetGen_Random(self, num_ops);
+			if(ready + delays[kind] > NETGEN_MAX_CYCLES) kind = 0; //Keep the critical path schedulable
+			if(0 > NetGen_Binary(self, (idx + num_outputs >= size) ? dest : NULL, left, right, ops[kind], delays[kind], 0)) return FAILURE;
+		}
+	}
+	self->num_outputs = num_outputs;
+	return SUCCESS;
+}
+
+//size independent operations with their own inputs and output, three ports each and nothing to schedule around
+static uint8_t NetGen_Wide(netgen* self, uint32_t size) {
+	uint32_t idx;
+	char dest[16];
+	if(1 > size) return FAILURE;
+	self->num_inputs = 2 * size;
+	for(idx = 0; idx < size; idx++) {
+		snprintf(dest, sizeof(dest), "z%u", idx);
+		if(0 > NetGen_Binary(self, dest, -(int32_t) (2 * idx) - 1, -(int32_t) (2 * idx) - 2, (0 == idx % 2) ? "+" : "-", 1, 0)) return FAILURE;
+	}
+	self->num_outputs = size;
+	return SUCCESS;
+}
+
+static void NetGen_Declare(FILE* fp, const char* kind, const char* type, char prefix, uint32_t first, uint32_t count) {
+	uint32_t idx;
+	for(idx = 0; idx < count; idx++) {
+		if(0 == idx % NETGEN_NAMES_PER_LINE) {
+			fprintf(fp, "%s%s %s ", (0 == idx) ? "" : "\n", kind, type);
+		} else {
+			fputs(", ", fp);
+		}
+		fprintf(fp, "%c%u", prefix, first + idx);
+	}
+	if(0 < count) fputc('\n', fp);
+}
+
+//Declarations go first, so the body is generated into a temporary file and appended once every name is known
+static uint8_t NetGen_Write(netgen* self, FILE* fp) {
+	char buffer[4096];
+	size_t length;
+	NetGen_Declare(fp, "input", "Int32", 'i', 0, self->num_inputs);
+	NetGen_Declare(fp, "output", "Int32", 'z', 0, self->num_outputs);
+	fputc('\n', fp);
+	NetGen_Declare(fp, "variable", "Int32", 'v', 0, self->num_vars);
+	NetGen_Declare(fp, "variable", "Int1", 'c', 0, self->num_conds);
+	fputc('\n', fp);
+	rewind(self->body);
+	while(0 < (length = fread(buffer, 1, sizeof(buffer), self->body))) {
+		if(length != fwrite(buffer, 1, length, fp)) return FAILURE;
+	}
+	return (0 == ferror(self->body)) ? SUCCESS : FAILURE;
+}
+
+static void NetGen_PrintUsage() {
+	printf("Usage: hlsyn_netgen shape size netlistFile [seed]\n");
+	printf("Writes a synthetic netlist for hlsyn and prints its critical path in cycles, the smallest latency it schedules in\n\n");
+	printf("\tchain size\t\tOne dependent chain of size operations\n");
+	printf("\ttree size\t\tBalanced reduction of size inputs\n");
+	printf("\tdag size\t\tAbout size operations in layers of %u with reconvergent paths\n", NETGEN_DAG_WIDTH);
+	printf("\tif size\t\t\tif/else nested size levels deep\n");
+	printf("\tmixed size\t\tsize operations of every kind over random earlier values\n");
+	printf("\twide size\t\tsize independent operations, each with two inputs and an output of its own\n");
+}
+
+int main(int argc, char *argv[]) {
+	netgen generator = {.body = NULL, .seed = 1, .num_inputs = 0, .num_vars = 0, .num_conds = 0, .num_outputs = 0,
+			.var_ready = NULL, .cond_ready = NULL, .max_vars = 0, .max_conds = 0, .gate = 0, .critical_path = 0};
+	netgen_shape shape;
+	long size;
+	uint8_t ret_value = FAILURE;
+	FILE* fp;
+
+	if(4 > argc || 5 < argc) {
+		NetGen_PrintUsage();
+		return EXIT_FAILURE;
+	}
+	shape = NetGen_ReadShape(argv[1]);
+	size = strtol(argv[2], NULL, 10);
+	if(5 == argc) generator.seed = (uint32_t) strtoul(argv[4], NULL, 10);
+	if(0 == generator.seed) generator.seed = 1;
+	if(shape_error == shape || 0 >= size || 60000 < size) {
+		NetGen_PrintUsage();
+		return EXIT_FAILURE;
+	}
+
+	generator.body = tmpfile();
+	if(NULL == generator.body) {
+		printf("ERROR: Cannot create a temporary file.\n");
+		return EXIT_FAILURE;
+	}
+	switch(shape) {
+		case shape_chain:
+			ret_value = NetGen_Chain(&generator, (uint32_t) size);
+			break;
+		case shape_tree:
+			ret_value = NetGen_Tree(&generator, (uint32_t) size);
+			break;
+		case shape_dag:
+			ret_value = NetGen_Dag(&generator, (uint32_t) size);
+			break;
+		case shape_if:
+			ret_value = NetGen_If(&generator, (uint32_t) size);
+			break;
+		case shape_mixed:
+			ret_value = NetGen_Mixed(&generator, (uint32_t) size);
+			break;
+		case shape_wide:
+			ret_value = NetGen_Wide(&generator, (uint32_t) size);
+			break;
+		default:
+			break;
+	}
+	if(SUCCESS != ret_value) {
+		printf("ERROR: Cannot generate a %s of size %ld.\n", argv[1], size);
+	} else if(NETGEN_MAX_CYCLES < generator.critical_path) {
+		printf("ERROR: A %s of size %ld needs %u cycles, hlsyn schedules at most %u.\n", argv[1], size, generator.critical_path, NETGEN_MAX_CYCLES);
+		ret_value = FAILURE;
+	} else {
+		fp = fopen(argv[3], "w");
+		if(NULL == fp) {
+			printf("ERROR: Cannot open %s.\n", argv[3]);
+			ret_value = FAILURE;
+		} else {
+			ret_value = NetGen_Write(&generator, fp);
+			if(0 != fclose(fp)) ret_value = FAILURE;
+			if(SUCCESS == ret_value) printf("%u\n", generator.critical_path);
+		}
+	}
+
+	fclose(generator.body);
+	free(generator.var_ready);
+	free(generator.cond_ready);
+	return (SUCCESS == ret_value) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
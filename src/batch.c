@@ -0,0 +1,258 @@
+/*
+ * batch.c
+ *
+ *  Created on: Dec 12, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "batch.h"
+#include "options.h"
+#include "synthesis.h"
+#include "logger.h"
+#include "timeline.h"
+#include "cache.h"
+
+typedef struct {
+	hlsyn_options options;
+	char* line; //Owns the strings the options point into
+	uint32_t line_number;
+	job_status status;
+	double seconds;
+	uint8_t cached;
+	char* output; //Text the job reported, printed once it finishes
+} batch_job;
+
+typedef struct {
+	batch_job* jobs;
+	uint32_t num_jobs;
+	atomic_uint next_job;
+	uint32_t num_finished;
+	pthread_mutex_t report_lock;
+	FILE* report;
+} batch_queue;
+
+static uint8_t Batch_ReadManifest(char* manifest_file, batch_job** jobs, uint32_t* num_jobs);
+static uint8_t Batch_ParseJob(batch_job* job, char* line, uint32_t line_number);
+static void Batch_RunJob(batch_queue* queue, batch_job* job);
+static void* Batch_Worker(void* context);
+static double Batch_Now();
+
+static double Batch_Now() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+}
+
+uint16_t Batch_GetDefaultWorkers() {
+	long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if(num_cpus < 1) num_cpus = 1;
+	if(num_cpus > 256) num_cpus = 256;
+	return (uint16_t) num_cpus;
+}
+
+//A job line holds the arguments of one hlsyn run: cFile latency verilogFile [options]
+static uint8_t Batch_ParseJob(batch_job* job, char* line, uint32_t line_number) {
+	char* argv[OPTIONS_MAX_ARGS];
+	int argc;
+	job->line = line;
+	job->line_number = line_number;
+	job->status = job_error;
+	job->seconds = 0.0;
+	job->cached = FALSE;
+	job->output = NULL;
+	argc = Options_SplitLine(line, argv, OPTIONS_MAX_ARGS);
+	if(argc < 0) {
+		printf("ERROR: Too many arguments or an open quote on manifest line %u.\n", line_number);
+		return FAILURE;
+	}
+	if(SUCCESS != Options_Parse(&job->options, argc, argv)) {
+		printf("ERROR: Bad job on manifest line %u.\n", line_number);
+		return FAILURE;
+	}
+	if(NULL != job->options.batch_file || NULL != job->options.trace_dir || TRUE == job->options.async_log || 0 != job->options.num_workers ||
+			NULL != job->options.server_socket || NULL != job->options.connect_socket || NULL != job->options.cache_dir ||
+			NULL != job->options.trace_events_file) {
+		printf("ERROR: Manifest line %u sets an option that applies to the whole batch.\n", line_number);
+		return FAILURE;
+	}
+	return SUCCESS;
+}
+
+//One job per line, blank lines and lines starting with # or // are skipped
+static uint8_t Batch_ReadManifest(char* manifest_file, batch_job** jobs, uint32_t* num_jobs) {
+	FILE* fp;
+	char* buff = NULL;
+	size_t buff_size = 0;
+	ssize_t length;
+	char* start;
+	char* line;
+	uint32_t line_number = 0;
+	uint32_t max_jobs = 16;
+	batch_job* new_jobs;
+	uint8_t ret_value = SUCCESS;
+
+	*num_jobs = 0;
+	*jobs = (batch_job*) malloc(max_jobs * sizeof(batch_job));
+	if(NULL == *jobs) return FAILURE;
+	fp = fopen(manifest_file, "r");
+	if(NULL == fp) {
+		printf("ERROR: Cannot open manifest %s.\n", manifest_file);
+		return FAILURE;
+	}
+	while(SUCCESS == ret_value && -1 != (length = getline(&buff, &buff_size, fp))) {
+		line_number++;
+		while(length > 0 && ('\n' == buff[length-1] || '\r' == buff[length-1])) buff[--length] = '\0';
+		start = buff;
+		while(' ' == *start || '\t' == *start) start++;
+		if('\0' == *start || '#' == *start || 0 == strncmp(start, "//", 2)) continue;
+
+		if(*num_jobs >= max_jobs) {
+			new_jobs = (batch_job*) realloc(*jobs, 2 * max_jobs * sizeof(batch_job));
+			if(NULL == new_jobs) {
+				ret_value = FAILURE;
+				break;
+			}
+			*jobs = new_jobs;
+			max_jobs *= 2;
+		}
+		line = (char*) malloc(strlen(start) + 1);
+		if(NULL == line) {
+			ret_value = FAILURE;
+			break;
+		}
+		strcpy(line, start);
+		ret_value = Batch_ParseJob(&(*jobs)[*num_jobs], line, line_number);
+		(*num_jobs)++;
+	}
+	free(buff);
+	fclose(fp);
+	if(SUCCESS == ret_value && 0 == *num_jobs) {
+		printf("ERROR: Manifest %s has no jobs.\n", manifest_file);
+		ret_value = FAILURE;
+	}
+	return ret_value;
+}
+
+//Runs the job with its report captured in memory, so jobs finishing together do not interleave their output.
+//The job logs to its own --log file, or into the captured report without one.
+static void Batch_RunJob(batch_queue* queue, batch_job* job) {
+	char* output = NULL;
+	size_t output_size = 0;
+	FILE* job_report = open_memstream(&output, &output_size);
+	FILE* report = (NULL != job_report) ? job_report : stdout;
+	logger* job_log;
+	synthesis_stats stats = {.num_nets = 0, .num_components = 0, .num_states = 0, .seconds = 0.0, .cached = FALSE};
+	double start = Batch_Now();
+
+	if(NULL != job->options.log_file) {
+		job_log = Logger_Open(job->options.log_file, job->options.log_level);
+	} else {
+		job_log = Logger_Create(report, job->options.log_level);
+	}
+	if(NULL != job_log) {
+		Logger_Bind(job_log);
+		job->status = Synthesis_RunStreams(&job->options, NULL, NULL, report, &stats);
+		job->cached = stats.cached;
+		Logger_Bind(NULL);
+		Logger_Destroy(&job_log);
+	} else {
+		fprintf(report, "ERROR: Cannot open log file %s.\n", job->options.log_file);
+		job->status = job_error;
+	}
+	job->seconds = Batch_Now() - start;
+	if(NULL != job_report) {
+		fclose(job_report);
+		job->output = output;
+	}
+
+	pthread_mutex_lock(&queue->report_lock);
+	queue->num_finished++;
+	fprintf(queue->report, "[%u/%u] %s -> %s: %s%s (%.1f ms)\n", queue->num_finished, queue->num_jobs, job->options.c_file,
+			job->options.verilog_file, Synthesis_GetStatusName(job->status), (TRUE == job->cached) ? ", cached" : "", job->seconds * 1e3);
+	if(NULL != job->output && '\0' != job->output[0]) {
+		fputs(job->output, queue->report);
+	}
+	fflush(queue->report);
+	pthread_mutex_unlock(&queue->report_lock);
+}
+
+static void* Batch_Worker(void* context) {
+	batch_queue* queue = (batch_queue*) context;
+	uint32_t job_idx;
+	Timeline_NameThread("batch worker");
+	for(;;) {
+		job_idx = atomic_fetch_add(&queue->next_job, 1);
+		if(job_idx >= queue->num_jobs) break;
+		Batch_RunJob(queue, &queue->jobs[job_idx]);
+	}
+	return NULL;
+}
+
+//Runs every job of the manifest on num_workers threads and prints a status line per job as it finishes,
+//followed by a summary. Fails if the manifest is unreadable or any job did not succeed.
+uint8_t Batch_Run(char* manifest_file, uint16_t num_workers, FILE* report) {
+	batch_queue queue;
+	pthread_t* workers;
+	uint16_t num_started = 0;
+	uint16_t idx;
+	uint32_t job_idx, num_failed = 0;
+	double start, total_seconds = 0.0;
+	uint8_t ret_value = SUCCESS;
+
+	if(NULL == manifest_file || NULL == report) return FAILURE;
+	if(SUCCESS != Batch_ReadManifest(manifest_file, &queue.jobs, &queue.num_jobs)) {
+		for(job_idx = 0; job_idx < queue.num_jobs; job_idx++) free(queue.jobs[job_idx].line);
+		free(queue.jobs);
+		return FAILURE;
+	}
+	if(0 == num_workers) num_workers = Batch_GetDefaultWorkers();
+	if(num_workers > queue.num_jobs) num_workers = (uint16_t) queue.num_jobs;
+	atomic_init(&queue.next_job, 0);
+	queue.num_finished = 0;
+	queue.report = report;
+	pthread_mutex_init(&queue.report_lock, NULL);
+	LOG_MESSAGE(MESSAGE_LEVEL, "MSG(Batch_Run): %u jobs on %u workers\n", queue.num_jobs, num_workers);
+
+	start = Batch_Now();
+	workers = (pthread_t*) malloc(num_workers * sizeof(pthread_t));
+	if(NULL != workers) {
+		for(idx = 0; idx < num_workers; idx++) {
+			if(0 != pthread_create(&workers[idx], NULL, Batch_Worker, &queue)) break;
+			num_started++;
+		}
+	}
+	if(0 == num_started) {
+		Batch_Worker(&queue); //No thread could be started, run the jobs on this one
+	}
+	for(idx = 0; idx < num_started; idx++) {
+		pthread_join(workers[idx], NULL);
+	}
+	free(workers);
+
+	for(job_idx = 0; job_idx < queue.num_jobs; job_idx++) {
+		if(job_success != queue.jobs[job_idx].status) {
+			if(0 == num_failed) fprintf(report, "Failed jobs:\n");
+			fprintf(report, "\tline %u: %s (%s)\n", queue.jobs[job_idx].line_number, queue.jobs[job_idx].options.c_file,
+					Synthesis_GetStatusName(queue.jobs[job_idx].status));
+			num_failed++;
+		}
+		total_seconds += queue.jobs[job_idx].seconds;
+		free(queue.jobs[job_idx].output);
+		free(queue.jobs[job_idx].line);
+	}
+	fprintf(report, "Batch: %u jobs, %u failed, %u workers, %.1f ms wall, %.1f ms summed over jobs\n",
+			queue.num_jobs, num_failed, (0 == num_started) ? 1 : num_started, (Batch_Now() - start) * 1e3, total_seconds * 1e3);
+	if(TRUE == Cache_IsEnabled()) Cache_PrintStats(report);
+	if(0 != num_failed) ret_value = FAILURE;
+
+	pthread_mutex_destroy(&queue.report_lock);
+	free(queue.jobs);
+	return ret_value;
+}
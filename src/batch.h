@@ -0,0 +1,18 @@
+/*
+ * batch.h
+ *
+ *  Created on: Dec 12, 2020
+ *      Author: cwhos
+ */
+
+#ifndef BATCH_H_
+#define BATCH_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "global.h"
+
+uint8_t Batch_Run(char* manifest_file, uint16_t num_workers, FILE* report);
+uint16_t Batch_GetDefaultWorkers();
+
+#endif /* BATCH_H_ */
@@ -0,0 +1,360 @@
+/*
+ * cache.c
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include "cache.h"
+#include "logger.h"
+#include "string_builder.h"
+
+#define CACHE_FORMAT "hlsyn-cache 1"
+#define CACHE_SUFFIX ".hlc"
+
+typedef struct struct_cache {
+	char* directory;
+	uint64_t max_bytes;
+	char tool_id[64]; //Changes whenever hlsyn is rebuilt, so old results are never reused
+	pthread_mutex_t store_lock;
+	atomic_ullong hits;
+	atomic_ullong misses;
+	atomic_ullong bypassed;
+	atomic_ullong stores;
+	atomic_ullong evictions;
+	atomic_uint next_temp;
+} cache;
+
+cache hlsyn_cache = {.directory = NULL, .max_bytes = CACHE_DEFAULT_SIZE, .store_lock = PTHREAD_MUTEX_INITIALIZER};
+
+typedef struct {
+	char name[32];
+	uint64_t size;
+	struct timespec used;
+} cache_file;
+
+static uint64_t Cache_Hash(const char* text, size_t length);
+static void Cache_EntryPath(string_builder* key, char* path, size_t path_size);
+static uint8_t Cache_ReadSection(FILE* fp, const char* name, char** data, size_t* size);
+static void Cache_WriteSection(FILE* fp, const char* name, const char* data, size_t size);
+static void Cache_Evict();
+static int Cache_CompareUse(const void* a, const void* b);
+
+//Stores results in directory, creating it when missing, and keeps it below max_bytes by evicting the least
+//recently used entries. A NULL directory turns the cache off.
+uint8_t Cache_Configure(const char* directory, uint64_t max_bytes) {
+	char* new_directory;
+	struct stat tool;
+	free(hlsyn_cache.directory);
+	hlsyn_cache.directory = NULL;
+	if(NULL == directory) return SUCCESS;
+
+	if(0 != mkdir(directory, 0777) && EEXIST != errno) {
+		LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR: Cannot create cache directory %s\n", directory);
+		return FAILURE;
+	}
+	new_directory = (char*) malloc(strlen(directory) + 1);
+	if(NULL == new_directory) return FAILURE;
+	strcpy(new_directory, directory);
+	if(0 == stat("/proc/self/exe", &tool)) {
+		snprintf(hlsyn_cache.tool_id, sizeof(hlsyn_cache.tool_id), "%lld-%lld.%09ld", (long long) tool.st_size,
+				(long long) tool.st_mtim.tv_sec, (long) tool.st_mtim.tv_nsec);
+	} else {
+		snprintf(hlsyn_cache.tool_id, sizeof(hlsyn_cache.tool_id), "%s %s", __DATE__, __TIME__);
+	}
+	hlsyn_cache.directory = new_directory;
+	hlsyn_cache.max_bytes = (0 != max_bytes) ? max_bytes : CACHE_DEFAULT_SIZE;
+	Cache_Evict(); //The limit may be lower than on the last run
+	return SUCCESS;
+}
+
+uint8_t Cache_IsEnabled() {
+	return (NULL != hlsyn_cache.directory) ? TRUE : FALSE;
+}
+
+//The cache holds the Verilog, the report and the timing report. Jobs that write other files, trace dumps
+//included, read vectors from a file or measure themselves always run.
+uint8_t Cache_IsCacheable(hlsyn_options* options) {
+	if(NULL == options || NULL != options->c_model_file || NULL != options->testbench_file || NULL != options->vector_file ||
+			NULL != options->ir_file || NULL != options->stats_file || NULL != options->trace_dir) return FALSE;
+	if(NULL != options->timing_file && 0 == strcmp(options->timing_file, "-")) return FALSE;
+	return TRUE;
+}
+
+//Key text of a job: the tool build, latency, the options that change the outputs and the netlist with comment
+//lines dropped and separators collapsed, so edits that do not change the parse still hit
+string_builder* Cache_BuildKey(hlsyn_options* options, const char* netlist, size_t netlist_size) {
+	string_builder* key;
+	hlsyn_options key_options;
+	size_t idx = 0;
+	size_t line_start, word_start;
+	uint8_t first_word;
+
+	if(NULL == options || NULL == netlist) return NULL;
+	key = StringBuilder_Create(netlist_size + 256);
+	if(NULL == key) return NULL;
+	key_options = *options;
+	key_options.timing_file = NULL;
+	key_options.log_level = CIRCUIT_ERROR_LEVEL;
+	StringBuilder_AppendString(key, CACHE_FORMAT "\ntool ");
+	StringBuilder_AppendString(key, hlsyn_cache.tool_id);
+	StringBuilder_AppendString(key, "\nlatency ");
+	StringBuilder_AppendUnsigned(key, options->latency);
+	StringBuilder_AppendString(key, "\noptions");
+	Options_AppendJobOptions(&key_options, key);
+	if(NULL != options->timing_file) StringBuilder_AppendString(key, " --timing");
+	StringBuilder_AppendString(key, "\nnetlist\n");
+
+	//Space, comma and carriage return separate every word the netlist reader splits, a tab only the first one.
+	//A NUL byte is skipped like a separator.
+	while(idx < netlist_size) {
+		line_start = StringBuilder_GetLength(key);
+		first_word = TRUE;
+		while(idx < netlist_size && '\n' != netlist[idx]) {
+			while(idx < netlist_size && NULL != strchr((TRUE == first_word) ? " ,\t\r" : " ,\r", netlist[idx])) idx++;
+			if(idx >= netlist_size || '\n' == netlist[idx]) break;
+			word_start = idx;
+			while(idx < netlist_size && NULL == strchr((TRUE == first_word) ? " ,\t\r\n" : " ,\r\n", netlist[idx])) idx++;
+			if(TRUE == first_word && idx - word_start >= 2 && '/' == netlist[word_start] && '/' == netlist[word_start+1]) {
+				while(idx < netlist_size && '\n' != netlist[idx]) idx++;
+				break;
+			}
+			if(FALSE == first_word) StringBuilder_AppendChar(key, ' ');
+			for(; word_start < idx; word_start++) StringBuilder_AppendChar(key, netlist[word_start]);
+			first_word = FALSE;
+		}
+		if(StringBuilder_GetLength(key) != line_start) StringBuilder_AppendChar(key, '\n');
+		idx++;
+	}
+	if(TRUE == StringBuilder_HasError(key)) StringBuilder_Destroy(&key);
+	return key;
+}
+
+//FNV-1a, the key text is stored in the entry and compared on lookup so a collision is only a miss
+static uint64_t Cache_Hash(const char* text, size_t length) {
+	uint64_t hash = 0xcbf29ce484222325ull;
+	size_t idx;
+	for(idx = 0; idx < length; idx++) {
+		hash ^= (uint8_t) text[idx];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static void Cache_EntryPath(string_builder* key, char* path, size_t path_size) {
+	snprintf(path, path_size, "%s/%016llx" CACHE_SUFFIX, hlsyn_cache.directory,
+			(unsigned long long) Cache_Hash(StringBuilder_GetString(key), StringBuilder_GetLength(key)));
+}
+
+static uint8_t Cache_ReadSection(FILE* fp, const char* name, char** data, size_t* size) {
+	char header[64];
+	char section[32];
+	*data = NULL;
+	if(NULL == fgets(header, sizeof(header), fp) || 2 != sscanf(header, "%31s %zu", section, size) || 0 != strcmp(section, name)) {
+		return FAILURE;
+	}
+	*data = (char*) malloc(*size + 1);
+	if(NULL == *data) return FAILURE;
+	if(*size != fread(*data, 1, *size, fp)) {
+		free(*data);
+		*data = NULL;
+		return FAILURE;
+	}
+	(*data)[*size] = '\0';
+	return SUCCESS;
+}
+
+static void Cache_WriteSection(FILE* fp, const char* name, const char* data, size_t size) {
+	fprintf(fp, "%s %zu\n", name, size);
+	if(0 < size) fwrite(data, 1, size, fp);
+}
+
+//Fills entry on a hit and marks it as recently used. The caller frees entry with CacheEntry_Free.
+uint8_t Cache_Lookup(string_builder* key, cache_entry* entry) {
+	char path[4096];
+	char header[64];
+	char* stored_key = NULL;
+	size_t stored_key_size = 0;
+	unsigned int num_nets, num_components, num_states;
+	uint8_t ret_value = FAILURE;
+	FILE* fp;
+
+	if(NULL == hlsyn_cache.directory || NULL == key || NULL == entry) return FAILURE;
+	memset(entry, 0, sizeof(cache_entry));
+	Cache_EntryPath(key, path, sizeof(path));
+	fp = fopen(path, "rb");
+	if(NULL != fp) {
+		if(NULL != fgets(header, sizeof(header), fp) && 0 == strcmp(header, CACHE_FORMAT "\n") &&
+				SUCCESS == Cache_ReadSection(fp, "key", &stored_key, &stored_key_size) &&
+				stored_key_size == StringBuilder_GetLength(key) && 0 == memcmp(stored_key, StringBuilder_GetString(key), stored_key_size) &&
+				NULL != fgets(header, sizeof(header), fp) && 3 == sscanf(header, "stats %u %u %u", &num_nets, &num_components, &num_states) &&
+				SUCCESS == Cache_ReadSection(fp, "verilog", &entry->verilog, &entry->verilog_size) &&
+				SUCCESS == Cache_ReadSection(fp, "report", &entry->report, &entry->report_size) &&
+				SUCCESS == Cache_ReadSection(fp, "timing", &entry->timing, &entry->timing_size)) {
+			entry->num_nets = (uint16_t) num_nets;
+			entry->num_components = (uint16_t) num_components;
+			entry->num_states = (uint16_t) num_states;
+			ret_value = SUCCESS;
+		}
+		free(stored_key);
+		fclose(fp);
+	}
+	if(SUCCESS == ret_value) {
+		utime(path, NULL);
+		atomic_fetch_add(&hlsyn_cache.hits, 1);
+	} else {
+		CacheEntry_Free(entry);
+		atomic_fetch_add(&hlsyn_cache.misses, 1);
+	}
+	return ret_value;
+}
+
+//Writes the entry under a temporary name and renames it into place, so readers never see a partial entry
+void Cache_Store(string_builder* key, cache_entry* entry) {
+	char path[4096];
+	char temp_path[4096];
+	FILE* fp;
+
+	if(NULL == hlsyn_cache.directory || NULL == key || NULL == entry) return;
+	Cache_EntryPath(key, path, sizeof(path));
+	snprintf(temp_path, sizeof(temp_path), "%s/.tmp-%ld-%u", hlsyn_cache.directory, (long) getpid(),
+			atomic_fetch_add(&hlsyn_cache.next_temp, 1));
+	fp = fopen(temp_path, "wb");
+	if(NULL == fp) {
+		LOG_MESSAGE(WARNING_LEVEL, "WARNING(Cache_Store): Cannot write %s\n", temp_path);
+		return;
+	}
+	fputs(CACHE_FORMAT "\n", fp);
+	Cache_WriteSection(fp, "key", StringBuilder_GetString(key), StringBuilder_GetLength(key));
+	fprintf(fp, "stats %u %u %u\n", entry->num_nets, entry->num_components, entry->num_states);
+	Cache_WriteSection(fp, "verilog", entry->verilog, entry->verilog_size);
+	Cache_WriteSection(fp, "report", entry->report, entry->report_size);
+	Cache_WriteSection(fp, "timing", entry->timing, entry->timing_size);
+	if(0 != fclose(fp) || 0 != rename(temp_path, path)) {
+		LOG_MESSAGE(WARNING_LEVEL, "WARNING(Cache_Store): Cannot store %s\n", path);
+		unlink(temp_path);
+		return;
+	}
+	atomic_fetch_add(&hlsyn_cache.stores, 1);
+
+	pthread_mutex_lock(&hlsyn_cache.store_lock);
+	Cache_Evict();
+	pthread_mutex_unlock(&hlsyn_cache.store_lock);
+}
+
+static int Cache_CompareUse(const void* a, const void* b) {
+	const cache_file* file_a = (const cache_file*) a;
+	const cache_file* file_b = (const cache_file*) b;
+	if(file_a->used.tv_sec != file_b->used.tv_sec) return (file_a->used.tv_sec < file_b->used.tv_sec) ? -1 : 1;
+	if(file_a->used.tv_nsec != file_b->used.tv_nsec) return (file_a->used.tv_nsec < file_b->used.tv_nsec) ? -1 : 1;
+	return 0;
+}
+
+//Removes the least recently used entries until the directory is within max_bytes. A hit touches its entry,
+//so the modification time is the time of last use.
+static void Cache_Evict() {
+	DIR* dir;
+	struct dirent* file;
+	struct stat info;
+	cache_file* files = NULL;
+	cache_file* new_files;
+	uint32_t num_files = 0, max_files = 0, idx;
+	uint64_t total_bytes = 0;
+	size_t length;
+	char path[4096];
+
+	dir = opendir(hlsyn_cache.directory);
+	if(NULL == dir) return;
+	while(NULL != (file = readdir(dir))) {
+		length = strlen(file->d_name);
+		if(length >= sizeof(files[0].name) || length <= strlen(CACHE_SUFFIX) ||
+				0 != strcmp(&file->d_name[length - strlen(CACHE_SUFFIX)], CACHE_SUFFIX)) continue;
+		snprintf(path, sizeof(path), "%s/%s", hlsyn_cache.directory, file->d_name);
+		if(0 != stat(path, &info)) continue;
+		if(num_files >= max_files) {
+			new_files = (cache_file*) realloc(files, (0 == max_files ? 64 : 2 * max_files) * sizeof(cache_file));
+			if(NULL == new_files) break;
+			files = new_files;
+			max_files = (0 == max_files) ? 64 : 2 * max_files;
+		}
+		strcpy(files[num_files].name, file->d_name);
+		files[num_files].size = (uint64_t) info.st_size;
+		files[num_files].used = info.st_mtim;
+		total_bytes += (uint64_t) info.st_size;
+		num_files++;
+	}
+	closedir(dir);
+
+	if(total_bytes > hlsyn_cache.max_bytes) {
+		qsort(files, num_files, sizeof(cache_file), Cache_CompareUse);
+		for(idx = 0; idx < num_files && total_bytes > hlsyn_cache.max_bytes; idx++) {
+			snprintf(path, sizeof(path), "%s/%s", hlsyn_cache.directory, files[idx].name);
+			if(0 == unlink(path) || ENOENT == errno) {
+				total_bytes -= files[idx].size;
+				atomic_fetch_add(&hlsyn_cache.evictions, 1);
+			}
+		}
+	}
+	free(files);
+}
+
+void Cache_CountBypass() {
+	atomic_fetch_add(&hlsyn_cache.bypassed, 1);
+}
+
+void Cache_GetStats(cache_stats* stats) {
+	if(NULL == stats) return;
+	stats->hits = atomic_load(&hlsyn_cache.hits);
+	stats->misses = atomic_load(&hlsyn_cache.misses);
+	stats->bypassed = atomic_load(&hlsyn_cache.bypassed);
+	stats->stores = atomic_load(&hlsyn_cache.stores);
+	stats->evictions = atomic_load(&hlsyn_cache.evictions);
+}
+
+void Cache_PrintStats(FILE* report) {
+	cache_stats stats;
+	Cache_GetStats(&stats);
+	fprintf(report, "Cache: %llu hits, %llu misses, %llu not cacheable, %llu stored, %llu evicted\n",
+			(unsigned long long) stats.hits, (unsigned long long) stats.misses, (unsigned long long) stats.bypassed,
+			(unsigned long long) stats.stores, (unsigned long long) stats.evictions);
+}
+
+//Reads a size in bytes with an optional k, M or G suffix, 0 when word is not a size
+uint64_t Cache_ReadSize(char* word) {
+	unsigned long long value;
+	char* end_ptr;
+	if(NULL == word || '\0' == word[0] || '-' == word[0]) return 0;
+	value = strtoull(word, &end_ptr, 10);
+	if('k' == *end_ptr || 'K' == *end_ptr) {
+		value *= 1024ull;
+		end_ptr++;
+	} else if('M' == *end_ptr) {
+		value *= 1024ull * 1024ull;
+		end_ptr++;
+	} else if('G' == *end_ptr) {
+		value *= 1024ull * 1024ull * 1024ull;
+		end_ptr++;
+	}
+	return ('\0' == *end_ptr) ? (uint64_t) value : 0;
+}
+
+void CacheEntry_Free(cache_entry* entry) {
+	if(NULL != entry) {
+		free(entry->verilog);
+		free(entry->report);
+		free(entry->timing);
+		entry->verilog = NULL;
+		entry->report = NULL;
+		entry->timing = NULL;
+	}
+}
@@ -0,0 +1,51 @@
+/*
+ * cache.h
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#ifndef CACHE_H_
+#define CACHE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "global.h"
+#include "options.h"
+
+#define CACHE_DEFAULT_SIZE (256ull * 1024ull * 1024ull)
+
+//Outputs of one successful job, as stored in the cache
+typedef struct {
+	char* verilog;
+	size_t verilog_size;
+	char* report;
+	size_t report_size;
+	char* timing;
+	size_t timing_size;
+	uint16_t num_nets;
+	uint16_t num_components;
+	uint16_t num_states;
+} cache_entry;
+
+typedef struct {
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t bypassed; //Jobs with outputs the cache does not hold
+	uint64_t stores;
+	uint64_t evictions;
+} cache_stats;
+
+uint8_t Cache_Configure(const char* directory, uint64_t max_bytes);
+uint8_t Cache_IsEnabled();
+uint8_t Cache_IsCacheable(hlsyn_options* options);
+string_builder* Cache_BuildKey(hlsyn_options* options, const char* netlist, size_t netlist_size);
+uint8_t Cache_Lookup(string_builder* key, cache_entry* entry);
+void Cache_Store(string_builder* key, cache_entry* entry);
+void Cache_CountBypass();
+void Cache_GetStats(cache_stats* stats);
+void Cache_PrintStats(FILE* report);
+uint64_t Cache_ReadSize(char* word);
+void CacheEntry_Free(cache_entry* entry);
+
+#endif /* CACHE_H_ */
@@ -10,6 +10,11 @@
 #include "component.h"
 #include "logger.h"
 #include "file_writer.h"
+#include "string_builder.h"
+#include "resource.h"
+#include "state.h"
+#include "trace.h"
+#include "stats.h"
 #include <string.h>
 #include <stddef.h>
 #include <stdlib.h>
@@ -20,26 +25,55 @@ typedef struct struct_circuit {
 	net** output_nets;
 	net** netlist;
 	component** component_list;
+	resource** resource_list;
 
-	uint8_t num_nets;
-	uint8_t num_inputs;
-	uint8_t num_outputs;
-	uint8_t num_components;
+	uint16_t num_nets;
+	uint16_t num_inputs;
+	uint16_t num_outputs;
+	uint16_t num_components;
+	uint16_t max_nets; //Input and output lists are subsets of the netlist and share its capacity
+	uint16_t max_components;
+	uint16_t num_resources;
+	uint16_t max_resources;
 
 	float critical_path_ns;
 	float* distribution_graphs[4];
 	uint8_t latency;
 } circuit;
 
+typedef struct {
+	component* op;
+	uint16_t list_idx;
+	uint16_t first_state;
+	uint8_t* states;
+} binding_entry;
+
+typedef struct {
+	net* value_net; //Declared net of the variable, every renamed version prints under its name
+	uint16_t list_idx;
+	uint16_t first_state;
+	uint8_t is_pinned;
+	uint8_t* occupied;
+	net* storage;
+} register_entry;
+
 void Circuit_TestPrint(circuit* self);
 void Circuit_PrintForceSchedule(circuit* self);
 void Circuit_PrintDistributionGraph(circuit* self);
+static const char* Circuit_ResourceName(resource_type type);
+static void Circuit_TraceIteration(circuit* self, FILE* fp, uint16_t iteration);
+static uint16_t Circuit_NextCapacity(uint16_t capacity);
+static uint8_t Circuit_GrowNetlist(circuit* self);
+static int Circuit_CompareBindingAddress(const void* a, const void* b);
+static int Circuit_CompareBindingOrder(const void* a, const void* b);
+static int Circuit_CompareRegisterName(const void* a, const void* b);
+static int Circuit_CompareRegisterOrder(const void* a, const void* b);
+static register_entry* Circuit_FindRegister(register_entry* entries, uint16_t num_entries, net* value);
 
 circuit* Circuit_Create(uint8_t latency) {
-	const uint8_t max_inputs = 64;
-	const uint8_t max_nets = 128;
+	const uint16_t initial_nets = 64;
 	uint8_t idx;
-	circuit* new_circuit = (circuit*) malloc(sizeof(circuit));
+	circuit* new_circuit = (circuit*) calloc(1, sizeof(circuit));
 	if(NULL != new_circuit) {
 		new_circuit->num_nets = 0;
 		new_circuit->num_inputs = 0;
@@ -47,33 +81,55 @@ circuit* Circuit_Create(uint8_t latency) {
 		new_circuit->num_components = 0;
 		new_circuit->critical_path_ns = 0.0f;
 		new_circuit->latency = latency;
-		new_circuit->input_nets = (net**) malloc(max_inputs * sizeof(net*));
-		new_circuit->netlist = (net**) malloc(max_nets * sizeof(net*));
-		new_circuit->output_nets = (net**) malloc(max_nets * sizeof(net*));
-		new_circuit->component_list = (component**) malloc(max_nets * sizeof(component*));
+		new_circuit->max_nets = initial_nets;
+		new_circuit->max_components = initial_nets;
+		new_circuit->input_nets = (net**) malloc(initial_nets * sizeof(net*));
+		new_circuit->netlist = (net**) malloc(initial_nets * sizeof(net*));
+		new_circuit->output_nets = (net**) malloc(initial_nets * sizeof(net*));
+		new_circuit->component_list = (component**) malloc(initial_nets * sizeof(component*));
 		for(idx = 0; idx < 4; idx++) {
-			new_circuit->distribution_graphs[idx] = (float*) malloc(new_circuit->latency * sizeof(float));
-			if(NULL == new_circuit->distribution_graphs[idx]) {
-				Circuit_Destroy(&new_circuit);
-			}
+			new_circuit->distribution_graphs[idx] = (float*) malloc((new_circuit->latency+1) * sizeof(float)); //Time frames end at cycle latency
+		}
+		if(NULL == new_circuit->input_nets || NULL == new_circuit->netlist || NULL == new_circuit->output_nets || NULL == new_circuit->component_list ||
+				NULL == new_circuit->distribution_graphs[0] || NULL == new_circuit->distribution_graphs[1] ||
+				NULL == new_circuit->distribution_graphs[2] || NULL == new_circuit->distribution_graphs[3]) {
+			Circuit_Destroy(&new_circuit);
 		}
-
-	}
-	if(NULL == new_circuit->input_nets || NULL == new_circuit->netlist || NULL == new_circuit->output_nets || NULL == new_circuit->component_list) {
-		Circuit_Destroy(&new_circuit);
 	}
 	return new_circuit;
 }
 
+static uint16_t Circuit_NextCapacity(uint16_t capacity) {
+	return (capacity < 0x8000) ? (2 * capacity) : 0xFFFF;
+}
+
+static uint8_t Circuit_GrowNetlist(circuit* self) {
+	uint16_t new_max = Circuit_NextCapacity(self->max_nets);
+	net** new_list;
+	if(new_max == self->max_nets) {
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR(Circuit_AddNet): Too many nets\n");
+		return FAILURE;
+	}
+	new_list = (net**) realloc(self->netlist, new_max * sizeof(net*));
+	if(NULL == new_list) return FAILURE;
+	self->netlist = new_list;
+	new_list = (net**) realloc(self->input_nets, new_max * sizeof(net*));
+	if(NULL == new_list) return FAILURE;
+	self->input_nets = new_list;
+	new_list = (net**) realloc(self->output_nets, new_max * sizeof(net*));
+	if(NULL == new_list) return FAILURE;
+	self->output_nets = new_list;
+	self->max_nets = new_max;
+	return SUCCESS;
+}
+
 net* Circuit_FindNet(circuit* self, char* name) {
-	uint8_t net_idx = 0;
+	uint16_t net_idx = 0;
 	net* return_net = NULL;
 	uint8_t cur_usage = 0;
-	char node_name[64];
 	if(NULL != self && NULL != name) {
 		while(net_idx < self->num_nets) {
-			Net_GetName(self->netlist[net_idx], node_name);
-			if(0 == strcmp(node_name, name)) {
+			if(0 == strcmp(Net_GetNameRef(self->netlist[net_idx]), name)) {
 				if(Net_GetUsage(self->netlist[net_idx]) > cur_usage) {
 					return_net = self->netlist[net_idx];
 					cur_usage = Net_GetUsage(self->netlist[net_idx]);
@@ -86,13 +142,11 @@ net* Circuit_FindNet(circuit* self, char* name) {
 }
 
 net* Circuit_FindNet_Usage(circuit* self, char* name, uint8_t usage) {
-	uint8_t net_idx = 0;
+	uint16_t net_idx = 0;
 	net* return_net = NULL;
-	char node_name[64];
 	if(NULL != self && NULL != name && usage > 0) {
 		while(net_idx < self->num_nets) {
-			Net_GetName(self->netlist[net_idx], node_name);
-			if(0 == strcmp(node_name, name)) {
+			if(0 == strcmp(Net_GetNameRef(self->netlist[net_idx]), name)) {
 				if(Net_GetUsage(self->netlist[net_idx]) == usage) {
 					return_net = self->netlist[net_idx];
 					break;
@@ -106,6 +160,9 @@ net* Circuit_FindNet_Usage(circuit* self, char* name, uint8_t usage) {
 
 void Circuit_AddNet(circuit* self, net* new_net) {
 	if(NULL != new_net && NULL != self) {
+		if(self->num_nets >= self->max_nets && FAILURE == Circuit_GrowNetlist(self)) {
+			return;
+		}
 		self->netlist[self->num_nets] = new_net;
 		if(net_output == Net_GetType(new_net)) {
 			self->output_nets[self->num_outputs] = new_net;
@@ -119,7 +176,7 @@ void Circuit_AddNet(circuit* self, net* new_net) {
 	return;
 }
 
-net* Circuit_GetNet(circuit* self, uint8_t idx) {
+net* Circuit_GetNet(circuit* self, uint16_t idx) {
 	net* ret_value = NULL;
 	if(NULL != self) {
 		if(idx < self->num_nets) ret_value = self->netlist[idx];
@@ -127,8 +184,8 @@ net* Circuit_GetNet(circuit* self, uint8_t idx) {
 	return ret_value;
 }
 
-uint8_t Circuit_GetNumNet(circuit* self) {
-	uint8_t ret_value = 0;
+uint16_t Circuit_GetNumNet(circuit* self) {
+	uint16_t ret_value = 0;
 	if(NULL != self) {
 		ret_value = self->num_nets;
 	}
@@ -136,13 +193,27 @@ uint8_t Circuit_GetNumNet(circuit* self) {
 }
 
 void Circuit_AddComponent(circuit* self, component* new_component) {
+	component** new_list;
 	if(NULL != self && NULL != new_component) {
+		if(self->num_components >= self->max_components) {
+			if(0xFFFF == self->max_components) {
+				LOG_MESSAGE(ERROR_LEVEL, "ERROR(Circuit_AddComponent): Too many components\n");
+				return;
+			}
+			new_list = (component**) realloc(self->component_list, Circuit_NextCapacity(self->max_components) * sizeof(component*));
+			if(NULL == new_list) {
+				LOG_MESSAGE(ERROR_LEVEL, "ERROR(Circuit_AddComponent): Could not grow component list\n");
+				return;
+			}
+			self->component_list = new_list;
+			self->max_components = Circuit_NextCapacity(self->max_components);
+		}
 		self->component_list[self->num_components] = new_component;
 		self->num_components++;
 	}
 }
 
-component* Circuit_GetComponent(circuit* self, uint8_t idx) {
+component* Circuit_GetComponent(circuit* self, uint16_t idx) {
 	component* ret_value = NULL;
 	if(NULL != self) {
 		if(idx < self->num_components) ret_value = self->component_list[idx];
@@ -150,23 +221,62 @@ component* Circuit_GetComponent(circuit* self, uint8_t idx) {
 	return ret_value;
 }
 
-uint8_t Circuit_GetNumComponent(circuit* self) {
-	uint8_t ret_value = 0;
+uint16_t Circuit_GetNumComponent(circuit* self) {
+	uint16_t ret_value = 0;
 	if(NULL != self) {
 		ret_value = self->num_components;
 	}
 	return ret_value;
 }
 
+void Circuit_AddResource(circuit* self, resource* new_resource) {
+	resource** new_list;
+	uint16_t new_max;
+	if(NULL != self && NULL != new_resource) {
+		if(self->num_resources >= self->max_resources) {
+			new_max = (0 == self->max_resources) ? 8 : Circuit_NextCapacity(self->max_resources);
+			if(new_max == self->max_resources) {
+				LOG_MESSAGE(ERROR_LEVEL, "ERROR(Circuit_AddResource): Too many resources\n");
+				return;
+			}
+			new_list = (resource**) realloc(self->resource_list, new_max * sizeof(resource*));
+			if(NULL == new_list) {
+				LOG_MESSAGE(ERROR_LEVEL, "ERROR(Circuit_AddResource): Could not grow resource list\n");
+				return;
+			}
+			self->resource_list = new_list;
+			self->max_resources = new_max;
+		}
+		self->resource_list[self->num_resources] = new_resource;
+		self->num_resources++;
+	}
+}
+
+resource* Circuit_GetResource(circuit* self, uint16_t idx) {
+	resource* ret_value = NULL;
+	if(NULL != self) {
+		if(idx < self->num_resources) ret_value = self->resource_list[idx];
+	}
+	return ret_value;
+}
+
+uint16_t Circuit_GetNumResource(circuit* self) {
+	uint16_t ret_value = 0;
+	if(NULL != self) {
+		ret_value = self->num_resources;
+	}
+	return ret_value;
+}
+
 void PrintCircuit(circuit* self) {
-	uint8_t net_idx;
+	uint16_t net_idx;
 	for(net_idx = 0; net_idx < self->num_nets; net_idx++) {
 		PrintNet(self->netlist[net_idx]);
 	}
 }
 
 void Circuit_ScheduleASAP(circuit* self) {
-	uint8_t idx;
+	uint16_t idx;
 
 	for(idx = 0;idx < self->num_inputs; idx++) {
 		Net_SchedulePathASAP(self->input_nets[idx], 1);
@@ -174,7 +284,7 @@ void Circuit_ScheduleASAP(circuit* self) {
 }
 
 uint8_t Circuit_ScheduleALAP(circuit* self) {
-	uint8_t idx;
+	uint16_t idx;
 	uint8_t ret_value = SUCCESS;
 	net* cur_output = NULL;
 	for(idx = 0;idx < self->num_outputs; idx++) {
@@ -190,7 +300,7 @@ uint8_t Circuit_ScheduleALAP(circuit* self) {
 			if(0 == Net_GetTimeFrameEnd(cur_output)) {//Wasn't updated since net does not map to output
 				ret_value = Net_SchedulePathALAP(cur_output, (self->latency+1));
 				if(FAILURE == ret_value) {
-					LogMessage("ERROR(Circuit_ScheduleALAP): Could not meet timing constraints\n", CIRCUIT_ERROR_LEVEL);
+					LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR(Circuit_ScheduleALAP): Could not meet timing constraints\n");
 					break;
 				}
 			}
@@ -201,24 +311,36 @@ uint8_t Circuit_ScheduleALAP(circuit* self) {
 
 uint8_t Circuit_ScheduleForceDirected(circuit* self, state_machine* sm) {
 
-	uint8_t s_idx, cycle_idx, comp_idx, min_cycle;
+	uint16_t s_idx, comp_idx;
+	uint8_t cycle_idx, min_cycle;
 	component* min_component;
 	uint8_t first_component = 0;
 	float min_force, self_force, suc_force, pred_force, total_force;
 	uint8_t cycle_start, cycle_end;
-	char log_msg[128], scheduled_net_name[8];
 	net* scheduled_net;
+	FILE* iteration_fp;
 
 	if(NULL != self && NULL != sm) {
+		Stats_BeginPhase(phase_asap);
 		Circuit_ScheduleASAP(self);
+		Stats_EndPhase(phase_asap);
+		Stats_BeginPhase(phase_alap);
 		if(FAILURE == Circuit_ScheduleALAP(self)) {
+			Stats_EndPhase(phase_alap);
 			return FAILURE;
 		}
+		Stats_EndPhase(phase_alap);
 		Circuit_TestPrint(self);
 		Circuit_CalculateDistributionGraphs(self);
 		Circuit_PrintDistributionGraph(self);
+		iteration_fp = Trace_Open(trace_fds_iterations, "fds_iterations.csv");
+		if(NULL != iteration_fp) {
+			fputs("iteration,kind,component,output,resource,cycle,self_force,successor_force,predecessor_force,total_force,distribution\n", iteration_fp);
+		}
 		for(s_idx = 0; s_idx < self->num_components; s_idx++) { //Cycle through every operation so that all get scheduled
+			Stats_BeginPhase(phase_fds_iteration);
 			Circuit_CalculateDistributionGraphs(self);
+			if(NULL != iteration_fp) Circuit_TraceIteration(self, iteration_fp, s_idx);
 			for(comp_idx = 0; comp_idx < self->num_components; comp_idx++) {
 				if(FALSE == Component_GetIsScheduled(self->component_list[comp_idx])) { //Skip component if it's already been scheduled
 
@@ -230,6 +352,14 @@ uint8_t Circuit_ScheduleForceDirected(circuit* self, state_machine* sm) {
 						suc_force = Component_CalculateSuccessorForce(self->component_list[comp_idx], self, cycle_idx);
 						pred_force = Component_CalculatePredecessorForce(self->component_list[comp_idx], self, cycle_idx);
 						total_force = self_force + suc_force + pred_force;
+						Stats_Count(counter_fds_candidates);
+						if(NULL != iteration_fp) {
+							scheduled_net = Component_GetOutputPort(self->component_list[comp_idx], 0).port_net;
+							fprintf(iteration_fp, "%u,candidate,%u,%s,%s,%u,%.4f,%.4f,%.4f,%.4f,\n", s_idx, comp_idx,
+									(NULL != scheduled_net) ? Net_GetNameRef(scheduled_net) : "-",
+									Circuit_ResourceName(Component_GetResourceType(self->component_list[comp_idx])),
+									cycle_idx, self_force, suc_force, pred_force, total_force);
+						}
 						if(0 == first_component || total_force < min_force) {
 							min_force = total_force;
 							min_component = self->component_list[comp_idx];
@@ -241,26 +371,31 @@ uint8_t Circuit_ScheduleForceDirected(circuit* self, state_machine* sm) {
 			}
 			port output_port = Component_GetOutputPort(min_component, 0);
 			scheduled_net = output_port.port_net;
-			Net_GetName(scheduled_net, scheduled_net_name);
 			if(FALSE == Component_GetIsScheduled(min_component)) {
-				sprintf(log_msg, "MSG(Circuit_ScheduleForceDirected): %s scheduled to cycle %d with force %.2f\n", scheduled_net_name, min_cycle, min_force);
-				LogMessage(log_msg, MESSAGE_LEVEL);
+				LOG_MESSAGE(MESSAGE_LEVEL, "MSG(Circuit_ScheduleForceDirected): %s scheduled to cycle %d with force %.2f\n", Net_GetNameRef(scheduled_net), min_cycle, min_force);
+				if(NULL != iteration_fp) {
+					fprintf(iteration_fp, "%u,scheduled,,%s,%s,%u,,,,%.4f,\n", s_idx, Net_GetNameRef(scheduled_net),
+							Circuit_ResourceName(Component_GetResourceType(min_component)), min_cycle, min_force);
+				}
 				StateMachine_ScheduleOperation(sm, min_component, min_cycle);
 			} else {
+				Stats_EndPhase(phase_fds_iteration);
 				break;
 			}
 			first_component = 0;
+			Stats_EndPhase(phase_fds_iteration);
 		}
+		if(NULL != iteration_fp) fclose(iteration_fp);
 		Circuit_ScheduleConditionals(self, sm);
 		Circuit_PrintForceSchedule(self);
 	} else {
-		LogMessage("ERROR(Circuit_ScheduleForceDirected): Invalid input pointers\n", ERROR_LEVEL);
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR(Circuit_ScheduleForceDirected): Invalid input pointers\n");
 	}
 	return SUCCESS;
 }
 
 void Circuit_ScheduleConditionals(circuit* self, state_machine* sm) {
-	uint8_t comp_idx;
+	uint16_t comp_idx;
 	component* cur_component;
 	for(comp_idx = 0; comp_idx < self->num_components; comp_idx++) {
 		cur_component = self->component_list[comp_idx];
@@ -270,13 +405,334 @@ void Circuit_ScheduleConditionals(circuit* self, state_machine* sm) {
 	}
 }
 
+//Left-edge binding: operations are taken in schedule order and placed on the first compatible unit
+//that is idle in every state the operation runs in, so each kind of unit is only duplicated as
+//often as operations of that kind overlap in one state
+uint8_t Circuit_BindResources(circuit* self, state_machine* sm) {
+	uint16_t num_states, num_entries, entry_idx, state_idx, op_idx, r_idx, unit_index, num_bound;
+	binding_entry* entries;
+	binding_entry* found;
+	binding_entry key;
+	uint8_t* state_flags;
+	state* cur_state;
+	resource* cur_resource;
+	component* op;
+	uint8_t ret_value = SUCCESS;
+
+	if(NULL == self || NULL == sm) {
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR(Circuit_BindResources): Invalid input pointers\n");
+		return FAILURE;
+	}
+	num_states = StateMachine_GetNumStates(sm);
+	if(0 == self->num_components || 0 == num_states) return SUCCESS;
+
+	entries = (binding_entry*) malloc(self->num_components * sizeof(binding_entry));
+	state_flags = (uint8_t*) calloc((size_t) self->num_components * num_states, sizeof(uint8_t));
+	if(NULL == entries || NULL == state_flags) {
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR(Circuit_BindResources): Cannot allocate binding table\n");
+		free(entries);
+		free(state_flags);
+		return FAILURE;
+	}
+
+	num_entries = 0;
+	for(op_idx = 0; op_idx < self->num_components; op_idx++) {
+		if(TRUE == Resource_IsBindable(self->component_list[op_idx])) {
+			entries[num_entries].op = self->component_list[op_idx];
+			entries[num_entries].list_idx = op_idx;
+			entries[num_entries].first_state = 0xFFFF;
+			entries[num_entries].states = &state_flags[(size_t) num_entries * num_states];
+			num_entries++;
+		}
+	}
+
+	//Mark every state each operation runs in, branches can place one operation in several states
+	qsort(entries, num_entries, sizeof(binding_entry), Circuit_CompareBindingAddress);
+	for(state_idx = 0; state_idx < num_states; state_idx++) {
+		cur_state = StateMachine_GetState(sm, state_idx);
+		for(op_idx = 0; op_idx < State_GetNumOperations(cur_state); op_idx++) {
+			key.op = State_GetOperation(cur_state, op_idx);
+			found = (binding_entry*) bsearch(&key, entries, num_entries, sizeof(binding_entry), Circuit_CompareBindingAddress);
+			if(NULL != found) {
+				found->states[state_idx] = TRUE;
+				if(state_idx < found->first_state) found->first_state = state_idx;
+			}
+		}
+	}
+	qsort(entries, num_entries, sizeof(binding_entry), Circuit_CompareBindingOrder);
+
+	num_bound = 0;
+	for(entry_idx = 0; entry_idx < num_entries && SUCCESS == ret_value; entry_idx++) {
+		op = entries[entry_idx].op;
+		if(0xFFFF == entries[entry_idx].first_state) continue; //Never reaches a state, nothing to bind
+
+		cur_resource = NULL;
+		unit_index = 0;
+		for(r_idx = 0; r_idx < self->num_resources; r_idx++) {
+			if(TRUE == Resource_IsCompatible(self->resource_list[r_idx], op) &&
+					TRUE == Resource_IsFree(self->resource_list[r_idx], entries[entry_idx].states)) {
+				cur_resource = self->resource_list[r_idx];
+				break;
+			}
+			//Units are numbered per name, ALUs carry both adders and subtractors
+			if(Resource_GetResourceType(self->resource_list[r_idx]) == Component_GetResourceType(op) &&
+					(resource_alu == Component_GetResourceType(op) || Resource_GetType(self->resource_list[r_idx]) == Component_GetType(op))) {
+				unit_index++;
+			}
+		}
+		if(NULL == cur_resource) {
+			cur_resource = Resource_Create(op, unit_index, num_states);
+			if(NULL == cur_resource) {
+				LOG_MESSAGE(ERROR_LEVEL, "ERROR(Circuit_BindResources): Cannot create resource\n");
+				ret_value = FAILURE;
+				break;
+			}
+			Circuit_AddResource(self, cur_resource);
+			if(cur_resource != Circuit_GetResource(self, self->num_resources - 1)) {
+				Resource_Destroy(&cur_resource);
+				ret_value = FAILURE;
+				break;
+			}
+		}
+		ret_value = Resource_Bind(cur_resource, op, entries[entry_idx].states);
+		if(SUCCESS == ret_value) num_bound++;
+	}
+
+	LOG_MESSAGE(MESSAGE_LEVEL, "MSG(Circuit_BindResources): %d operations bound to %d functional units\n", num_bound, self->num_resources);
+
+	free(entries);
+	free(state_flags);
+	return ret_value;
+}
+
+static int Circuit_CompareBindingAddress(const void* a, const void* b) {
+	uintptr_t op_a = (uintptr_t) ((const binding_entry*) a)->op;
+	uintptr_t op_b = (uintptr_t) ((const binding_entry*) b)->op;
+	return (op_a > op_b) - (op_a < op_b);
+}
+
+static int Circuit_CompareBindingOrder(const void* a, const void* b) {
+	const binding_entry* entry_a = (const binding_entry*) a;
+	const binding_entry* entry_b = (const binding_entry*) b;
+	uint8_t cycle_a = Component_GetTimeFrameStart(entry_a->op);
+	uint8_t cycle_b = Component_GetTimeFrameStart(entry_b->op);
+	if(cycle_a != cycle_b) return (cycle_a > cycle_b) ? 1 : -1;
+	if(entry_a->first_state != entry_b->first_state) return (entry_a->first_state > entry_b->first_state) ? 1 : -1;
+	return (entry_a->list_idx > entry_b->list_idx) - (entry_a->list_idx < entry_b->list_idx);
+}
+
+static uint8_t Circuit_IsRegisterNet(net* value) {
+	return (net_variable == Net_GetType(value) || net_reg == Net_GetType(value)) ? TRUE : FALSE;
+}
+
+//Liveness over the linked states followed by left-edge allocation: variables of the same width and
+//sign whose lifetimes never overlap are stored in one register. A variable occupies its register in
+//every state that writes it or after which it is still read. Assignments are non-blocking, so a state
+//may read one variable and write another that shares its register.
+uint8_t Circuit_ShareRegisters(circuit* self, state_machine* sm, uint16_t* num_before, uint16_t* num_after) {
+	uint16_t num_states, num_entries, num_physical, state_idx, op_idx, entry_idx, p_idx, next_idx;
+	size_t table_size, row;
+	uint8_t changed, is_free, value;
+	uint8_t port_idx, num_next;
+	register_entry* entries;
+	register_entry** order;
+	register_entry** physical;
+	register_entry* found;
+	net** storage;
+	uint8_t *use, *def, *live_in, *live_out, *occupied;
+	state* cur_state;
+	state* next_state;
+	component* op;
+	port cur_port;
+	uint8_t ret_value = SUCCESS;
+
+	if(NULL == self || NULL == sm) {
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR(Circuit_ShareRegisters): Invalid input pointers\n");
+		return FAILURE;
+	}
+	num_states = StateMachine_GetNumStates(sm);
+	num_entries = 0;
+	for(entry_idx = 0; entry_idx < self->num_nets; entry_idx++) {
+		if(TRUE == Circuit_IsRegisterNet(self->netlist[entry_idx]) && 1 == Net_GetUsage(self->netlist[entry_idx])) num_entries++;
+	}
+	if(NULL != num_before) *num_before = num_entries;
+	if(NULL != num_after) *num_after = num_entries;
+	if(0 == num_entries || 0 == num_states) return SUCCESS;
+
+	table_size = (size_t) num_entries * num_states;
+	entries = (register_entry*) calloc(num_entries, sizeof(register_entry));
+	order = (register_entry**) malloc(num_entries * sizeof(register_entry*));
+	physical = (register_entry**) malloc(num_entries * sizeof(register_entry*));
+	use = (uint8_t*) calloc(table_size, sizeof(uint8_t));
+	def = (uint8_t*) calloc(table_size, sizeof(uint8_t));
+	live_in = (uint8_t*) calloc(table_size, sizeof(uint8_t));
+	live_out = (uint8_t*) calloc(table_size, sizeof(uint8_t));
+	occupied = (uint8_t*) calloc(table_size, sizeof(uint8_t));
+	storage = (net**) calloc(self->num_nets, sizeof(net*));
+	if(NULL == entries || NULL == order || NULL == physical || NULL == use || NULL == def ||
+			NULL == live_in || NULL == live_out || NULL == occupied || NULL == storage) {
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR(Circuit_ShareRegisters): Cannot allocate liveness tables\n");
+		ret_value = FAILURE;
+	}
+
+	if(SUCCESS == ret_value) {
+		num_entries = 0;
+		for(entry_idx = 0; entry_idx < self->num_nets; entry_idx++) {
+			if(TRUE == Circuit_IsRegisterNet(self->netlist[entry_idx]) && 1 == Net_GetUsage(self->netlist[entry_idx])) {
+				entries[num_entries].value_net = self->netlist[entry_idx];
+				entries[num_entries].list_idx = entry_idx;
+				entries[num_entries].first_state = 0xFFFF;
+				num_entries++;
+			}
+		}
+		qsort(entries, num_entries, sizeof(register_entry), Circuit_CompareRegisterName);
+
+		//Reads and writes per state, tables are indexed [state][variable]
+		for(state_idx = 0; state_idx < num_states; state_idx++) {
+			cur_state = StateMachine_GetState(sm, state_idx);
+			row = (size_t) state_idx * num_entries;
+			for(op_idx = 0; op_idx < State_GetNumOperations(cur_state); op_idx++) {
+				op = State_GetOperation(cur_state, op_idx);
+				for(port_idx = 0; port_idx < Component_GetNumInputs(op); port_idx++) {
+					cur_port = Component_GetInputPort(op, port_idx);
+					found = Circuit_FindRegister(entries, num_entries, cur_port.port_net);
+					if(NULL == found) continue;
+					if(component_if_else == Component_GetType(op)) {
+						found->is_pinned = TRUE; //Branch conditions are read by the transitions, keep them in place
+					} else if(datapath_a == cur_port.type || datapath_b == cur_port.type || mux_sel == cur_port.type || shift_amount == cur_port.type) {
+						use[row + (found - entries)] = TRUE;
+					}
+				}
+				if(component_if_else != Component_GetType(op)) {
+					found = Circuit_FindRegister(entries, num_entries, Component_GetOutputPort(op, 0).port_net);
+					if(NULL != found) def[row + (found - entries)] = TRUE;
+				}
+			}
+		}
+
+		//Backward dataflow to a fixed point, the last state loops back to the wait state
+		do {
+			changed = FALSE;
+			state_idx = num_states;
+			while(state_idx > 0) {
+				state_idx--;
+				cur_state = StateMachine_GetState(sm, state_idx);
+				row = (size_t) state_idx * num_entries;
+				num_next = State_GetNumStates(cur_state);
+				for(next_idx = 0; next_idx < num_next || (0 == num_next && 0 == next_idx); next_idx++) {
+					next_state = (0 == num_next) ? StateMachine_GetState(sm, 0) : State_GetNextState(cur_state, next_idx);
+					if(NULL == next_state) continue;
+					for(entry_idx = 0; entry_idx < num_entries; entry_idx++) {
+						live_out[row + entry_idx] |= live_in[(size_t) State_GetStateNumber(next_state) * num_entries + entry_idx];
+					}
+				}
+				for(entry_idx = 0; entry_idx < num_entries; entry_idx++) {
+					value = use[row + entry_idx] | (live_out[row + entry_idx] & (uint8_t) !def[row + entry_idx]);
+					if(value != live_in[row + entry_idx]) {
+						live_in[row + entry_idx] = value;
+						changed = TRUE;
+					}
+				}
+			}
+		} while(TRUE == changed);
+
+		for(entry_idx = 0; entry_idx < num_entries; entry_idx++) {
+			entries[entry_idx].occupied = &occupied[(size_t) entry_idx * num_states];
+			if(TRUE == live_in[entry_idx]) entries[entry_idx].is_pinned = TRUE; //Read before any write, holds its value between runs
+			for(state_idx = 0; state_idx < num_states; state_idx++) {
+				row = (size_t) state_idx * num_entries;
+				if(TRUE == def[row + entry_idx] || TRUE == live_out[row + entry_idx]) {
+					entries[entry_idx].occupied[state_idx] = TRUE;
+					if(0xFFFF == entries[entry_idx].first_state) entries[entry_idx].first_state = state_idx;
+				}
+			}
+			order[entry_idx] = &entries[entry_idx];
+		}
+		qsort(order, num_entries, sizeof(register_entry*), Circuit_CompareRegisterOrder);
+
+		//Left edge: take variables by first write and reuse the first register that is free for their lifetime
+		num_physical = 0;
+		for(entry_idx = 0; entry_idx < num_entries; entry_idx++) {
+			found = NULL;
+			for(p_idx = 0; p_idx < num_physical && FALSE == order[entry_idx]->is_pinned; p_idx++) {
+				if(TRUE == physical[p_idx]->is_pinned ||
+						Net_GetWidth(physical[p_idx]->value_net) != Net_GetWidth(order[entry_idx]->value_net) ||
+						Net_GetSign(physical[p_idx]->value_net) != Net_GetSign(order[entry_idx]->value_net)) {
+					continue;
+				}
+				is_free = TRUE;
+				for(state_idx = 0; state_idx < num_states && TRUE == is_free; state_idx++) {
+					if(TRUE == physical[p_idx]->occupied[state_idx] && TRUE == order[entry_idx]->occupied[state_idx]) is_free = FALSE;
+				}
+				if(TRUE == is_free) {
+					found = physical[p_idx];
+					break;
+				}
+			}
+			if(NULL == found) {
+				physical[num_physical] = order[entry_idx];
+				num_physical++;
+			} else {
+				order[entry_idx]->storage = found->value_net;
+				for(state_idx = 0; state_idx < num_states; state_idx++) {
+					found->occupied[state_idx] |= order[entry_idx]->occupied[state_idx];
+				}
+			}
+		}
+
+		//Every renamed version of a shared variable follows it into the register. Lookups go by name,
+		//so all of them are resolved before any net is renamed.
+		for(entry_idx = 0; entry_idx < self->num_nets; entry_idx++) {
+			found = Circuit_FindRegister(entries, num_entries, self->netlist[entry_idx]);
+			if(NULL != found) storage[entry_idx] = found->storage;
+		}
+		for(entry_idx = 0; entry_idx < self->num_nets; entry_idx++) {
+			if(NULL != storage[entry_idx]) Net_SetStorage(self->netlist[entry_idx], storage[entry_idx]);
+		}
+
+		LOG_MESSAGE(MESSAGE_LEVEL, "MSG(Circuit_ShareRegisters): %d variables stored in %d registers\n", num_entries, num_physical);
+		if(NULL != num_after) *num_after = num_physical;
+	}
+
+	free(entries);
+	free(order);
+	free(physical);
+	free(use);
+	free(def);
+	free(live_in);
+	free(live_out);
+	free(occupied);
+	free(storage);
+	return ret_value;
+}
+
+static int Circuit_CompareRegisterName(const void* a, const void* b) {
+	return strcmp(Net_GetNameRef(((const register_entry*) a)->value_net), Net_GetNameRef(((const register_entry*) b)->value_net));
+}
+
+static int Circuit_CompareRegisterOrder(const void* a, const void* b) {
+	const register_entry* entry_a = *((register_entry* const*) a);
+	const register_entry* entry_b = *((register_entry* const*) b);
+	if(entry_a->first_state != entry_b->first_state) return (entry_a->first_state > entry_b->first_state) ? 1 : -1;
+	return (entry_a->list_idx > entry_b->list_idx) - (entry_a->list_idx < entry_b->list_idx);
+}
+
+static register_entry* Circuit_FindRegister(register_entry* entries, uint16_t num_entries, net* value) {
+	register_entry key;
+	if(NULL == value || FALSE == Circuit_IsRegisterNet(value)) return NULL;
+	key.value_net = value;
+	return (register_entry*) bsearch(&key, entries, num_entries, sizeof(register_entry), Circuit_CompareRegisterName);
+}
+
 void Circuit_CalculateDistributionGraphs(circuit* self) {
-	uint8_t rsrc_idx, comp_idx, cycle_idx;
+	uint8_t rsrc_idx, cycle_idx;
+	uint16_t comp_idx;
 	component* cur_comp = NULL;
 	float probability;
 	uint8_t cycle_start, cycle_end;
+	Stats_Count(counter_distribution_rebuilds);
 	for(rsrc_idx = 0; rsrc_idx < resource_none;rsrc_idx++) {
-		for(cycle_idx=0;cycle_idx<self->latency;cycle_idx++) { //Zero out dg before calculating
+		for(cycle_idx=0;cycle_idx<=self->latency;cycle_idx++) { //Zero out dg before calculating
 			self->distribution_graphs[rsrc_idx][cycle_idx] = 0;
 		}
 		for(comp_idx=0;comp_idx < self->num_components;comp_idx++) {
@@ -301,13 +757,51 @@ float Circuit_GetDistributionGraph(circuit* self, resource_type type, uint8_t cy
 			ret_value = self->distribution_graphs[type][cycle_idx];
 		}
 	} else {
-		LogMessage("Error(Circuit_GetDistributionGraph): Invalid Input", ERROR_LEVEL);
+		LOG_MESSAGE(ERROR_LEVEL, "Error(Circuit_GetDistributionGraph): Invalid Input");
 	}
 	return ret_value;
 }
 
+//Fills peak_usage[resource_none] with the most operations of each class busy in one cycle and length with the last busy cycle
+uint8_t Circuit_GetScheduleUsage(circuit* self, uint16_t* peak_usage, uint8_t* length) {
+	uint16_t usage[resource_none][UINT8_MAX + DIVIDER_CYCLE_DELAY + 1];
+	uint16_t comp_idx, cycle_idx;
+	uint16_t cycle_start, cycle_end;
+	resource_type type;
+	component* cur_comp;
+	if(NULL == self || NULL == peak_usage || NULL == length) return FAILURE;
+	memset(usage, 0, sizeof(usage));
+	memset(peak_usage, 0, resource_none * sizeof(uint16_t));
+	*length = 0;
+	for(comp_idx = 0; comp_idx < self->num_components; comp_idx++) {
+		cur_comp = self->component_list[comp_idx];
+		type = Component_GetResourceType(cur_comp);
+		if(type >= resource_none || FALSE == Component_GetIsScheduled(cur_comp)) continue;
+		cycle_start = Component_GetTimeFrameStart(cur_comp);
+		cycle_end = cycle_start + Component_GetDelayCycle(cur_comp) - 1;
+		if(cycle_end > *length) *length = (cycle_end > UINT8_MAX) ? UINT8_MAX : (uint8_t) cycle_end;
+		for(cycle_idx = cycle_start; cycle_idx <= cycle_end && cycle_idx < UINT8_MAX + DIVIDER_CYCLE_DELAY + 1; cycle_idx++) {
+			usage[type][cycle_idx]++;
+			if(usage[type][cycle_idx] > peak_usage[type]) peak_usage[type] = usage[type][cycle_idx];
+		}
+	}
+	return SUCCESS;
+}
+
+//Fills bound_units[resource_none] with the functional units of each class binding created
+void Circuit_GetBindingUsage(circuit* self, uint16_t* bound_units) {
+	uint16_t idx;
+	resource_type type;
+	if(NULL == self || NULL == bound_units) return;
+	memset(bound_units, 0, resource_none * sizeof(uint16_t));
+	for(idx = 0; idx < self->num_resources; idx++) {
+		type = Resource_GetResourceType(self->resource_list[idx]);
+		if(type < resource_none) bound_units[type]++;
+	}
+}
+
 void Circuit_Destroy(circuit** self) {
-	uint8_t idx = 0;
+	uint16_t idx = 0;
 	if(NULL != (*self)) {
 		while(idx < (*self)->num_nets) {
 			Net_Destroy(&((*self)->netlist[idx]));
@@ -323,6 +817,11 @@ void Circuit_Destroy(circuit** self) {
 		free((*self)->output_nets);
 		free((*self)->input_nets);
 		free((*self)->netlist);
+		while((*self)->num_resources > 0) {
+			(*self)->num_resources--;
+			Resource_Destroy(&((*self)->resource_list[(*self)->num_resources]));
+		}
+		free((*self)->resource_list);
 		free((*self)->component_list);
 		free((*self));
 		*self = NULL;
@@ -330,88 +829,96 @@ void Circuit_Destroy(circuit** self) {
 }
 
 void Circuit_TestPrint(circuit* self) {
-	uint8_t idx;
-	char line_buffer[512];
+	uint16_t idx;
+	string_builder* line_buffer;
 	FILE* fp;
-	uint8_t asap, alap;
 	if(NULL != self) {
-		fp = fopen("./test/time_frame.txt", "w+");
-		if(NULL == fp) {
-			LogMessage("Error: Cannot open output file\n", ERROR_LEVEL);
-			return;
-		}
+		fp = Trace_Open(trace_time_frames, "time_frame.txt");
+		if(NULL == fp) return;
+		line_buffer = StringBuilder_Create(4096);
 		for(idx=0;idx<self->num_components;idx++) {
 			DeclareComponent(self->component_list[idx], line_buffer, idx);
-			asap = Component_GetTimeFrameStart(self->component_list[idx]);
-			alap = Component_GetTimeFrameEnd(self->component_list[idx]);
-			fprintf(fp, "%s\tASAP: %d\n\tALAP: %d\n\n", line_buffer, asap, alap);
+			StringBuilder_AppendString(line_buffer, "\tASAP: ");
+			StringBuilder_AppendUnsigned(line_buffer, Component_GetTimeFrameStart(self->component_list[idx]));
+			StringBuilder_AppendString(line_buffer, "\n\tALAP: ");
+			StringBuilder_AppendUnsigned(line_buffer, Component_GetTimeFrameEnd(self->component_list[idx]));
+			StringBuilder_AppendString(line_buffer, "\n\n");
 		}
+		StringBuilder_Flush(line_buffer, fp);
+		StringBuilder_Destroy(&line_buffer);
 		fclose(fp);
 	}
 }
 
 void Circuit_PrintForceSchedule(circuit* self) {
-	uint8_t idx;
-	char line_buffer[512];
+	uint16_t idx;
+	string_builder* line_buffer;
 	FILE* fp;
-	uint8_t cycle;
 	if(NULL != self) {
-		fp = fopen("./test/fds.txt", "w+");
-		if(NULL == fp) {
-			LogMessage("Error: Cannot open output file\n", ERROR_LEVEL);
-			return;
-		}
+		fp = Trace_Open(trace_force_schedule, "fds.txt");
+		if(NULL == fp) return;
+		line_buffer = StringBuilder_Create(4096);
 		for(idx=0;idx<self->num_components;idx++) {
 			DeclareComponent(self->component_list[idx], line_buffer, idx);
-			cycle = Component_GetTimeFrameStart(self->component_list[idx]);
-			fprintf(fp, "%s\n\tCycle: %d\n\n", line_buffer, cycle);
+			StringBuilder_AppendString(line_buffer, "\n\tCycle: ");
+			StringBuilder_AppendUnsigned(line_buffer, Component_GetTimeFrameStart(self->component_list[idx]));
+			StringBuilder_AppendString(line_buffer, "\n\n");
 		}
+		StringBuilder_Flush(line_buffer, fp);
+		StringBuilder_Destroy(&line_buffer);
 		fclose(fp);
 	}
 }
 
+//One row per resource and cycle with the distribution graph the iteration's forces are computed from
+static void Circuit_TraceIteration(circuit* self, FILE* fp, uint16_t iteration) {
+	uint8_t idx, r_idx;
+	for(r_idx=resource_multiplier;r_idx<resource_none;r_idx++) {
+		for(idx=0;idx<self->latency;idx++) {
+			fprintf(fp, "%u,distribution,,,%s,%u,,,,,%.4f\n", iteration, Circuit_ResourceName(r_idx), (idx+1), self->distribution_graphs[r_idx][idx]);
+		}
+	}
+}
+
+static const char* Circuit_ResourceName(resource_type type) {
+	const char* name = "none";
+	switch(type) {
+	case resource_multiplier:
+		name = "multiplier";
+		break;
+	case resource_divider:
+		name = "divider";
+		break;
+	case resource_logical:
+		name = "logical";
+		break;
+	case resource_alu:
+		name = "ALU";
+		break;
+	default:
+		break;
+	}
+	return name;
+}
+
 void Circuit_PrintDistributionGraph(circuit* self) {
 	uint8_t idx, r_idx;
-	char line_buffer[512], cell_buffer[32];
 	FILE* fp;
 	if(NULL != self) {
-		fp = fopen("./test/distribution_graph.csv", "w+");
-		if(NULL == fp) {
-			LogMessage("Error: Cannot open output file\n", ERROR_LEVEL);
-			return;
-		}
-		strcpy(line_buffer, "Cycle");
+		fp = Trace_Open(trace_distribution, "distribution_graph.csv");
+		if(NULL == fp) return;
+		fputs("Cycle", fp);
 		for(idx=0;idx<self->latency;idx++) {
-			sprintf(cell_buffer, ",%d", (idx+1));
-			strcat(line_buffer, cell_buffer);
+			fprintf(fp, ",%d", (idx+1));
 		}
-		strcat(line_buffer, "\n");
-		fprintf(fp, line_buffer);
+		fputs("\n", fp);
 
 		for(r_idx=resource_multiplier;r_idx<resource_none;r_idx++) {
-			switch(r_idx) {
-			case resource_multiplier:
-				sprintf(line_buffer, "multiplier");
-				break;
-			case resource_divider:
-				sprintf(line_buffer, "divider");
-				break;
-			case resource_logical:
-				sprintf(line_buffer, "logical");
-				break;
-			case resource_alu:
-				sprintf(line_buffer, "ALU");
-					break;
-			default:
-				sprintf(line_buffer, "none");
-				break;
-			}
+			fputs(Circuit_ResourceName(r_idx), fp);
 			for(idx=0;idx<self->latency;idx++) {
-				sprintf(cell_buffer, ",%.2f", self->distribution_graphs[r_idx][idx]);
-				strcat(line_buffer, cell_buffer);
+				fprintf(fp, ",%.2f", self->distribution_graphs[r_idx][idx]);
 			}
-			strcat(line_buffer, "\n");
-			fprintf(fp, line_buffer);
+			fputs("\n", fp);
 		}
 		fclose(fp);
 	}
@@ -15,16 +15,18 @@
 circuit* Circuit_Create(uint8_t latency);
 net* Circuit_FindNet(circuit* self, char* name);
 net* Circuit_FindNet_Usage(circuit* self, char* name, uint8_t usage);
-component* Circuit_GetComponent(circuit* self, uint8_t idx);
-uint8_t Circuit_GetNumComponent(circuit* self);
-net* Circuit_GetNet(circuit* self, uint8_t idx);
-uint8_t Circuit_GetNumNet(circuit* self);
+component* Circuit_GetComponent(circuit* self, uint16_t idx);
+uint16_t Circuit_GetNumComponent(circuit* self);
+net* Circuit_GetNet(circuit* self, uint16_t idx);
+uint16_t Circuit_GetNumNet(circuit* self);
 void Circuit_AddNet(circuit* self, net* new_net);
 void Circuit_AddComponent(circuit* self, component* new_component);
 void Circuit_Destroy(circuit** self);
 void PrintCircuit(circuit* self);
 
 float Circuit_GetDistributionGraph(circuit* self, resource_type type, uint8_t cycle);
+uint8_t Circuit_GetScheduleUsage(circuit* self, uint16_t* peak_usage, uint8_t* length);
+void Circuit_GetBindingUsage(circuit* self, uint16_t* bound_units);
 void Circuit_CalculateDistributionGraphs(circuit* self);
 uint8_t Circuit_ScheduleALAP(circuit* self);
 void Circuit_ScheduleASAP(circuit* self);
@@ -32,5 +34,9 @@ uint8_t Circuit_ScheduleForceDirected(circuit* self, state_machine* sm);
 void Circuit_ScheduleOperation(circuit* self, component* operation, uint8_t cycle);
 void Circuit_ScheduleConditionals(circuit* self, state_machine* sm);
 void Circuit_AddResource(circuit* self, resource* new_resource);
+resource* Circuit_GetResource(circuit* self, uint16_t idx);
+uint16_t Circuit_GetNumResource(circuit* self);
+uint8_t Circuit_BindResources(circuit* self, state_machine* sm);
+uint8_t Circuit_ShareRegisters(circuit* self, state_machine* sm, uint16_t* num_before, uint16_t* num_after);
 
 #endif /* CIRCUIT_H_ */
@@ -0,0 +1,168 @@
+/*
+ * client.c
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "client.h"
+#include "server.h"
+#include "logger.h"
+#include "string_builder.h"
+
+static char* Client_ReadFile(char* file_name, size_t* size);
+static char* Client_AbsolutePath(char* path);
+static uint8_t Client_Copy(FILE* in, FILE* out, size_t size);
+
+static char* Client_ReadFile(char* file_name, size_t* size) {
+	FILE* fp = fopen(file_name, "rb");
+	char* text = NULL;
+	long length;
+	if(NULL == fp) return NULL;
+	if(0 == fseek(fp, 0, SEEK_END) && 0 <= (length = ftell(fp)) && 0 == fseek(fp, 0, SEEK_SET)) {
+		text = (char*) malloc((size_t) length + 1);
+		if(NULL != text && (size_t) length != fread(text, 1, (size_t) length, fp)) {
+			free(text);
+			text = NULL;
+		}
+		*size = (size_t) length;
+	}
+	fclose(fp);
+	return text;
+}
+
+//The server resolves paths against its own working directory, so relative paths are sent from this one
+static char* Client_AbsolutePath(char* path) {
+	char* cwd;
+	char* absolute;
+	if(NULL == path || '/' == path[0] || 0 == strcmp(path, "-")) return path;
+	cwd = getcwd(NULL, 0);
+	if(NULL == cwd) return path;
+	absolute = (char*) malloc(strlen(cwd) + strlen(path) + 2);
+	if(NULL != absolute) sprintf(absolute, "%s/%s", cwd, path);
+	free(cwd);
+	return (NULL != absolute) ? absolute : path;
+}
+
+static uint8_t Client_Copy(FILE* in, FILE* out, size_t size) {
+	char buff[4096];
+	size_t chunk;
+	while(0 < size) {
+		chunk = (size < sizeof(buff)) ? size : sizeof(buff);
+		if(chunk != fread(buff, 1, chunk, in)) return FAILURE;
+		if(NULL != out) fwrite(buff, 1, chunk, out);
+		size -= chunk;
+	}
+	return SUCCESS;
+}
+
+//Sends the netlist text of options->c_file to the server on socket_path and writes the returned Verilog to
+//options->verilog_file and the returned report to report. The other output files are written by the server.
+job_status Client_Run(char* socket_path, hlsyn_options* options, FILE* report) {
+	struct sockaddr_un address;
+	hlsyn_options remote_options;
+	string_builder* header;
+	char* netlist_text;
+	size_t netlist_size = 0;
+	char* line = NULL;
+	size_t line_size = 0;
+	size_t verilog_size, report_size;
+	int status_code = (int) job_error;
+	job_status status = job_error;
+	FILE* connection = NULL;
+	FILE* verilog;
+	int fd;
+
+	if(NULL == socket_path || NULL == options || NULL == report) return job_error;
+	if(strlen(socket_path) >= sizeof(address.sun_path)) {
+		fprintf(report, "ERROR: Socket path %s is too long.\n", socket_path);
+		return job_error;
+	}
+	netlist_text = Client_ReadFile(options->c_file, &netlist_size);
+	if(NULL == netlist_text || 0 == netlist_size || netlist_size > SERVER_MAX_NETLIST) {
+		fprintf(report, "ERROR: Cannot read %s.\n", options->c_file);
+		free(netlist_text);
+		return job_read_failed;
+	}
+
+	remote_options = *options;
+	remote_options.c_model_file = Client_AbsolutePath(options->c_model_file);
+	remote_options.testbench_file = Client_AbsolutePath(options->testbench_file);
+	remote_options.timing_file = Client_AbsolutePath(options->timing_file);
+	remote_options.vector_file = Client_AbsolutePath(options->vector_file);
+	remote_options.ir_file = Client_AbsolutePath(options->ir_file);
+	remote_options.stats_file = Client_AbsolutePath(options->stats_file);
+	header = StringBuilder_Create(256);
+	if(NULL != header) {
+		StringBuilder_AppendString(header, "netlist ");
+		StringBuilder_AppendUnsigned(header, netlist_size);
+		StringBuilder_AppendChar(header, ' ');
+		StringBuilder_AppendUnsigned(header, options->latency);
+		Options_AppendJobOptions(&remote_options, header);
+		StringBuilder_AppendChar(header, '\n');
+	}
+	if(remote_options.c_model_file != options->c_model_file) free(remote_options.c_model_file);
+	if(remote_options.testbench_file != options->testbench_file) free(remote_options.testbench_file);
+	if(remote_options.timing_file != options->timing_file) free(remote_options.timing_file);
+	if(remote_options.vector_file != options->vector_file) free(remote_options.vector_file);
+	if(remote_options.ir_file != options->ir_file) free(remote_options.ir_file);
+	if(remote_options.stats_file != options->stats_file) free(remote_options.stats_file);
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socket_path);
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(NULL == header || TRUE == StringBuilder_HasError(header) || fd < 0) {
+		fprintf(report, "ERROR: Cannot build the request.\n");
+	} else if(0 != connect(fd, (struct sockaddr*) &address, sizeof(address))) {
+		fprintf(report, "ERROR: Cannot connect to %s: %s\n", socket_path, strerror(errno));
+	} else {
+		connection = fdopen(fd, "r+");
+	}
+	if(NULL != connection) {
+		fd = -1; //Closed with connection
+		fwrite(StringBuilder_GetString(header), 1, StringBuilder_GetLength(header), connection);
+		fwrite(netlist_text, 1, netlist_size, connection);
+		fflush(connection);
+
+		if(-1 != getline(&line, &line_size, connection) && 1 == sscanf(line, "status %d", &status_code) &&
+				-1 != getline(&line, &line_size, connection) && 0 == strncmp(line, "stats ", 6)) {
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG(Client_Run): %s", line);
+		} else {
+			status_code = -1;
+		}
+		if(-1 != status_code && -1 != getline(&line, &line_size, connection) && 1 == sscanf(line, "verilog %zu", &verilog_size)) {
+			status = (status_code >= (int) job_success && status_code <= (int) job_error) ? (job_status) status_code : job_error;
+			verilog = NULL;
+			if(0 < verilog_size) {
+				verilog = fopen(options->verilog_file, "w+");
+				if(NULL == verilog) {
+					fprintf(report, "ERROR: Cannot open %s.\n", options->verilog_file);
+					status = job_error;
+				}
+			}
+			if(SUCCESS != Client_Copy(connection, verilog, verilog_size)) status = job_error;
+			if(NULL != verilog) fclose(verilog);
+			if(-1 != getline(&line, &line_size, connection) && 1 == sscanf(line, "report %zu", &report_size)) {
+				if(SUCCESS != Client_Copy(connection, report, report_size)) status = job_error;
+			} else {
+				status = job_error;
+			}
+		} else {
+			fprintf(report, "ERROR: No valid response from %s.\n", socket_path);
+		}
+		fclose(connection);
+	}
+	if(0 <= fd) close(fd);
+	free(line);
+	StringBuilder_Destroy(&header);
+	free(netlist_text);
+	return status;
+}
@@ -0,0 +1,18 @@
+/*
+ * client.h
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#ifndef CLIENT_H_
+#define CLIENT_H_
+
+#include <stdio.h>
+#include "global.h"
+#include "options.h"
+#include "synthesis.h"
+
+job_status Client_Run(char* socket_path, hlsyn_options* options, FILE* report);
+
+#endif /* CLIENT_H_ */
@@ -12,6 +12,8 @@
 #include "logger.h"
 #include "net.h"
 #include "circuit.h"
+#include "string_builder.h"
+#include "stats.h"
 
 const uint8_t max_dp_inputs = 2;
 const uint8_t max_ctrl_inputs = 1;
@@ -36,6 +38,7 @@ typedef struct struct_component {
 	uint8_t num_inputs;
 	uint8_t num_outputs;
 	condition conditional;
+	resource* bound_resource; //Shared functional unit, NULL when printed as its own operator
 } component;
 
 component* Component_Create(component_type type) {
@@ -58,6 +61,7 @@ component* Component_Create(component_type type) {
 				new_component->cycle_started_asap = 0;
 				new_component->time_frame[0] = 0;
 				new_component->time_frame[1] = 0;
+				new_component->bound_resource = NULL;
 				if(adder == type || subtractor == type) {
 					new_component->resource_class = resource_alu;
 					new_component->delay_cycle = ALU_CYCLE_DELAY;
@@ -84,18 +88,18 @@ component* Component_Create(component_type type) {
 void Component_SchedulePathASAP(component* self, uint8_t cycle) {
 	uint8_t output_idx;
 	uint8_t cycle_completed;
-	char log_msg[128];
 	if(NULL != self) {
 		if(cycle > self->cycle_started_asap) {
+			Stats_Enter(depth_schedule_path);
 			self->cycle_started_asap = cycle;
 			self->time_frame[0] = self->cycle_started_asap;
 			cycle_completed = cycle + self->delay_cycle;
-			sprintf(log_msg, "MSG: Component scheduled from cycle %d to %d\n", cycle, cycle_completed);
-			LogMessage(log_msg, MESSAGE_LEVEL);
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Component scheduled from cycle %d to %d\n", cycle, cycle_completed);
 
 			for(output_idx = 0; output_idx < self->num_outputs; output_idx++) {
 				Net_SchedulePathASAP(self->output_ports[output_idx].port_net, cycle_completed);
 			}
+			Stats_Leave(depth_schedule_path);
 		}
 	}
 }
@@ -103,17 +107,16 @@ void Component_SchedulePathASAP(component* self, uint8_t cycle) {
 uint8_t Component_SchedulePathALAP(component* self, uint8_t cycle) {
 	uint8_t ret_value = SUCCESS;
 	uint8_t input_idx;
-	char log_msg[128];
 	if(NULL != self) {
 		uint8_t cycle_started = cycle - self->delay_cycle;
 		if(cycle <= self->delay_cycle) {
-			LogMessage("Error(Component_SchedulePathALAP): Circuit cannot meet latency\n", CIRCUIT_ERROR_LEVEL);
+			LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "Error(Component_SchedulePathALAP): Circuit cannot meet latency\n");
 			ret_value = FAILURE;
 		} else if(cycle_started < self->cycle_started_alap){
+			Stats_Enter(depth_schedule_path);
 			self->cycle_started_alap = cycle_started;
 			self->time_frame[1] = self->cycle_started_alap;
-			sprintf(log_msg, "MSG(Component_SchedulePathALAP): Component scheduled from cycle %d to %d\n", self->cycle_started_alap, cycle);
-			LogMessage(log_msg, MESSAGE_LEVEL);
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG(Component_SchedulePathALAP): Component scheduled from cycle %d to %d\n", self->cycle_started_alap, cycle);
 
 			for(input_idx = 0; input_idx < self->num_inputs; input_idx++) {
 				ret_value = Net_SchedulePathALAP(self->input_ports[input_idx].port_net, self->cycle_started_alap);
@@ -121,6 +124,7 @@ uint8_t Component_SchedulePathALAP(component* self, uint8_t cycle) {
 					break;
 				}
 			}
+			Stats_Leave(depth_schedule_path);
 		}
 	}
 	return ret_value;
@@ -130,7 +134,7 @@ void Component_SchedulePathFDS(component* self, uint8_t cycle) {
 	uint8_t idx;
 	if(NULL != self) {
 		if(cycle > self->time_frame[1] || cycle < self->time_frame[0]) {
-			LogMessage("ERROR: Component scheduled outside of time frame\n", ERROR_LEVEL);
+			LOG_MESSAGE(ERROR_LEVEL, "ERROR: Component scheduled outside of time frame\n");
 		} else if(self->is_scheduled == FALSE || self->type == component_if_else) {
 			self->time_frame[0] = cycle;
 			self->time_frame[1] = cycle;
@@ -151,6 +155,7 @@ float Component_CalculateSelfForce(component* self, circuit* circ, uint8_t cycle
 	if(NULL == self || NULL == circ) return 0.0f;
 	uint8_t idx;
 	float dg, prob, sf, partial_sum;
+	Stats_Count(counter_force_evaluations);
 	prob = 1.0f / ((float) ((self->time_frame[1] - self->time_frame[0]) + 1.0f));
 	sf = 0.0f;
 	if(cycle > self->time_frame[1] || cycle < self->time_frame[0]) return 0.0f;
@@ -173,6 +178,7 @@ float Component_CalculateSuccessorForce(component* self, circuit* circ, uint8_t
 	uint8_t net_cycle = cycle + self->delay_cycle;
 	float successor_force = 0.0f;
 	if(cycle > self->cycle_started_asap) {
+		Stats_Enter(depth_force);
 		successor_force = Component_CalculateSelfForce(self, circ, cycle);
 		for(idx = 0; idx < self->num_outputs; idx++) {
 			successor_net = self->output_ports[idx].port_net;
@@ -180,6 +186,7 @@ float Component_CalculateSuccessorForce(component* self, circuit* circ, uint8_t
 				successor_force += Net_CalculateSuccessorForce(successor_net, circ, net_cycle);
 			}
 		}
+		Stats_Leave(depth_force);
 	}
 	return successor_force;
 }
@@ -191,6 +198,7 @@ float Component_CalculatePredecessorForce(component* self, circuit* circ, uint8_
 	uint8_t net_cycle = cycle + self->delay_cycle;
 	float predecessor_force = 0.0f;
 	if(cycle < self->cycle_started_alap) {
+		Stats_Enter(depth_force);
 		predecessor_force = Component_CalculateSelfForce(self, circ, cycle);
 		for(idx = 0; idx < self->num_inputs; idx++) {
 			predecessor_net = self->input_ports[idx].port_net;
@@ -198,6 +206,7 @@ float Component_CalculatePredecessorForce(component* self, circuit* circ, uint8_
 				predecessor_force += Net_CalculatePredecessorForce(predecessor_net, circ, net_cycle);
 			}
 		}
+		Stats_Leave(depth_force);
 	}
 	return predecessor_force;
 }
@@ -402,84 +411,155 @@ net_sign Component_GetSign(component* self) {
 	return ret_value;
 }
 
+void Component_SetResource(component* self, resource* bound_resource) {
+	if(NULL != self) {
+		self->bound_resource = bound_resource;
+	}
+}
+
+resource* Component_GetResource(component* self) {
+	resource* ret_value = NULL;
+	if(NULL != self) {
+		ret_value = self->bound_resource;
+	}
+	return ret_value;
+}
+
+void Component_GetSchedule(component* self, component_schedule* schedule) {
+	if(NULL != self && NULL != schedule) {
+		schedule->cycle_started_asap = self->cycle_started_asap;
+		schedule->cycle_started_alap = self->cycle_started_alap;
+		schedule->time_frame[0] = self->time_frame[0];
+		schedule->time_frame[1] = self->time_frame[1];
+		schedule->cycle_scheduled = self->cycle_scheduled;
+		schedule->is_scheduled = self->is_scheduled;
+	}
+}
+
+//Overwrites the scheduler state as is, neighbouring time frames are not updated
+void Component_SetSchedule(component* self, component_schedule* schedule) {
+	if(NULL != self && NULL != schedule) {
+		self->cycle_started_asap = schedule->cycle_started_asap;
+		self->cycle_started_alap = schedule->cycle_started_alap;
+		self->time_frame[0] = schedule->time_frame[0];
+		self->time_frame[1] = schedule->time_frame[1];
+		self->cycle_scheduled = schedule->cycle_scheduled;
+		self->is_scheduled = schedule->is_scheduled;
+	}
+}
+
 void Component_Destroy(component** self) {
+	uint8_t idx;
 	if(NULL != *self) {
+		if(component_if_else == (*self)->type) { //Branch nets are created with the conditional and are not part of the netlist
+			for(idx = 0; idx < (*self)->num_outputs; idx++) {
+				Net_Destroy(&((*self)->output_ports[idx].port_net));
+			}
+		}
 		free((*self));
 		*self = NULL;
 	}
 }
 
-uint8_t Component_PrintOperation(component* op, char* equ) {
+size_t Component_PrintOperation(component* op, string_builder* equ) {
 	int idx = 0;
-	char o[16];
-	char a[16];
-	char b[16];
-	char sh[16];
-	char sel[16];
-	char eqn[64];
+	const char* o;
+	const char* a = "";
+	const char* b = "";
+	const char* sh = "";
+	const char* sel = "";
+	const char* op_symbol = NULL;
+	size_t start_length;
 	if(NULL == op || NULL == equ) return 0;
 
 	//Get Inputs
 	for(idx=0;idx<op->num_inputs;idx++) {
 		switch(op->input_ports[idx].type) {
 		case datapath_a:
-			Net_GetName(op->input_ports[idx].port_net, a);
+			a = Net_GetNameRef(op->input_ports[idx].port_net);
 			break;
 		case datapath_b:
-			Net_GetName(op->input_ports[idx].port_net, b);
+			b = Net_GetNameRef(op->input_ports[idx].port_net);
 			break;
 		case mux_sel:
-			Net_GetName(op->input_ports[idx].port_net, sel);
+			sel = Net_GetNameRef(op->input_ports[idx].port_net);
 			break;
 		case shift_amount:
-			Net_GetName(op->input_ports[idx].port_net, sh);
+			sh = Net_GetNameRef(op->input_ports[idx].port_net);
 			break;
 		default:
 			break;
 		}
 	}
 	//Get output name
-	Net_GetName(op->output_ports[0].port_net, o);
+	o = Net_GetNameRef(op->output_ports[0].port_net);
 
 	switch(op->type) {
 	case adder:
-		sprintf(eqn,"%s <= %s + %s;", o, a, b);
+		op_symbol = " + ";
 		break;
 	case subtractor:
-		sprintf(eqn,"%s <= %s - %s;", o, a, b);
+		op_symbol = " - ";
 		break;
 	case multiplier:
-		sprintf(eqn,"%s <= %s * %s;", o, a, b);
+		op_symbol = " * ";
 		break;
 	case comparator:
 		if(greater_than_out == op->output_ports[0].type) {
-			sprintf(eqn,"%s <= %s > %s;", o, a, b);
+			op_symbol = " > ";
 		} else if(less_than_out == op->output_ports[0].type) {
-			sprintf(eqn,"%s <= %s < %s;", o, a, b);
+			op_symbol = " < ";
 		} else if(equal_out == op->output_ports[0].type) {
-			sprintf(eqn,"%s <= %s == %s;", o, a, b);
+			op_symbol = " == ";
 		}
 		break;
 	case mux2x1:
-		sprintf(eqn,"%s <= %s ? %s : %s;", o, sel, a, b);
+		op_symbol = " ? ";
 		break;
 	case shift_right:
-		sprintf(eqn,"%s <= %s >> %s;", o, a, sh);
+		op_symbol = " >> ";
+		b = sh;
 		break;
 	case shift_left:
-		sprintf(eqn,"%s <= %s << %s;", o, a, sh);
+		op_symbol = " << ";
+		b = sh;
 		break;
 	case divider:
-		sprintf(eqn,"%s <= %s / %s;", o, a, b);
+		op_symbol = " / ";
 		break;
 	case modulo:
-		sprintf(eqn,"%s <= %s %% %s;", o, a, b);
+		op_symbol = " % ";
+		break;
+	case load_register:
+		op_symbol = "";
+		break;
+	case incrementer:
+		op_symbol = " + ";
+		b = "1";
+		break;
+	case decrementer:
+		op_symbol = " - ";
+		b = "1";
 		break;
 	default:
-		return 0;
 		break;
 	}
-	strcpy(equ, eqn);
-	return strlen(eqn);
-
+	if(NULL == op_symbol) return 0;
+
+	start_length = StringBuilder_GetLength(equ);
+	StringBuilder_AppendString(equ, o);
+	StringBuilder_AppendString(equ, " <= ");
+	if(mux2x1 == op->type) {
+		StringBuilder_AppendString(equ, sel);
+		StringBuilder_AppendString(equ, op_symbol);
+		StringBuilder_AppendString(equ, a);
+		StringBuilder_AppendString(equ, " : ");
+		StringBuilder_AppendString(equ, b);
+	} else {
+		StringBuilder_AppendString(equ, a);
+		StringBuilder_AppendString(equ, op_symbol);
+		StringBuilder_AppendString(equ, b);
+	}
+	StringBuilder_AppendChar(equ, ';');
+	return StringBuilder_GetLength(equ) - start_length;
 }
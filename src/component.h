@@ -9,10 +9,20 @@
 #define COMPONENT_H_
 
 #include <stdint.h>
+#include <stddef.h>
 #include "global.h"
 
 
 
+//Scheduler state of a component, kept by the binary IR so a schedule can be restored without rescheduling
+typedef struct {
+	uint8_t cycle_started_asap;
+	uint8_t cycle_started_alap;
+	uint8_t time_frame[2];
+	uint8_t cycle_scheduled;
+	uint8_t is_scheduled;
+} component_schedule;
+
 component* Component_Create(component_type type);
 
 void Component_SchedulePathASAP(component* self, uint8_t cycle);
@@ -42,9 +52,13 @@ port Component_GetInputPort(component* self, uint8_t idx);
 port Component_GetOutputPort(component* self, uint8_t idx);
 net_sign Component_GetSign(component* self);
 condition Component_GetCondition(component* self);
+void Component_SetResource(component* self, resource* bound_resource);
+resource* Component_GetResource(component* self);
+void Component_GetSchedule(component* self, component_schedule* schedule);
+void Component_SetSchedule(component* self, component_schedule* schedule);
 
 
 void Component_Destroy(component** self);
-uint8_t Component_PrintOperation(component* op, char* equ);
+size_t Component_PrintOperation(component* op, string_builder* equ);
 
 #endif /* COMPONENT_H_ */
@@ -6,393 +6,664 @@
 #include "logger.h"
 #include "state_machine.h"
 #include "state.h"
+#include "string_builder.h"
+#include "resource.h"
 #include <string.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
-#include <math.h>
 
-void Print_StateList(state* cur_state, FILE* print_file, uint8_t latency);
+void Print_StateList(state_machine* sm, string_builder* print_file);
+static void Print_State(state* cur_state, string_builder* print_file, uint8_t latency, state_encoding encoding, uint16_t state_width, const char** conditional_net_name);
+static void Print_StateCode(string_builder* print_file, state_encoding encoding, uint16_t state_width, uint16_t state_number);
+static void Print_StateTest(string_builder* print_file, state_encoding encoding, uint16_t state_width, uint16_t state_number);
+static const char* DeclareComponent_TypeName(component_type type);
 
 void PrintStateMachine(char* file_name, circuit* circ, state_machine* sm) {
 	if(NULL == file_name || NULL == circ) return;
 
 	FILE* fp;
-	uint8_t idx;
-	uint8_t num_nets = Circuit_GetNumNet(circ);
-	uint8_t num_ins = 0;
-	uint8_t num_outs = 0;
-	uint8_t num_vars = 0;
-	int print_return;
-
-	char log_msg[128];
-	char in_list[256] = "";
-	char out_list[256] = "";
-	char format[] = ", ";
-	char net_name[64];
-	char line_buffer[512];
+
+	fp = fopen(file_name, "w+");
+	if(NULL == fp) {
+		LOG_MESSAGE(ERROR_LEVEL, "Error: Cannot open output file\n");
+		return;
+	}
+	PrintStateMachineStream(fp, circ, sm);
+	fclose(fp);
+}
+
+//Writes the Verilog module to an open stream, which stays open
+uint8_t PrintStateMachineStream(FILE* fp, circuit* circ, state_machine* sm) {
+	if(NULL == fp || NULL == circ) return FAILURE;
+
+	uint8_t ret_value = SUCCESS;
+	uint16_t idx;
+	uint16_t num_nets = Circuit_GetNumNet(circ);
+	uint16_t num_ins = 0;
+	uint16_t num_outs = 0;
+	uint16_t num_vars = 0;
+	string_builder* module_buffer;
 	net* list_temp = NULL;
 	net* temp_net = NULL;
 
 
-	LogMessage("MSG: Writing Circuit to file\n", MESSAGE_LEVEL);
+	LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Writing Circuit to file\n");
 
-	fp = fopen(file_name, "w+");
-	if(NULL == fp) {
-		LogMessage("Error: Cannot open output file\n", ERROR_LEVEL);
-		return;
+	//The whole module is built in memory and written with a single call
+	module_buffer = StringBuilder_Create(4096);
+	if(NULL == module_buffer) {
+		LOG_MESSAGE(ERROR_LEVEL, "Error: Cannot allocate output buffer\n");
+		return FAILURE;
 	}
 
-	// Create inputs list
 	for(idx = 0; idx < num_nets; idx++) {
 		list_temp = Circuit_GetNet(circ, idx);
 		if(net_input == Net_GetType(list_temp)) {
-			Net_GetName(list_temp, net_name);
-			strcat(net_name, format);
-			strcat(in_list, net_name);
 			num_ins++;
 		}
 		else if(net_input != Net_GetType(list_temp) && net_output != Net_GetType(list_temp)) {
 			num_vars++;
 		}
 	}
-
-	// Create outputs list
 	num_outs = num_nets - num_ins - num_vars;
 
+	StringBuilder_AppendString(module_buffer, "`timescale 1ns/1ps\n");
+	StringBuilder_AppendString(module_buffer, "\n");
+	StringBuilder_AppendString(module_buffer, "module HLSM(Clk, Rst, Start, ");
+	// Create inputs list
+	for(idx = 0; idx < num_nets; idx++) {
+		list_temp = Circuit_GetNet(circ, idx);
+		if(net_input == Net_GetType(list_temp)) {
+			StringBuilder_AppendString(module_buffer, Net_GetNameRef(list_temp));
+			StringBuilder_AppendString(module_buffer, ", ");
+		}
+	}
+	StringBuilder_AppendString(module_buffer, "Done, ");
+	// Create outputs list
 	for(idx = 0; idx < num_nets; idx++) {
 		list_temp = Circuit_GetNet(circ, idx);
 		if(net_output == Net_GetType(list_temp)) {
-			Net_GetName(list_temp, net_name);
+			StringBuilder_AppendString(module_buffer, Net_GetNameRef(list_temp));
 			if(num_outs > 1) {
-				strcat(net_name, format);
+				StringBuilder_AppendString(module_buffer, ", ");
 				num_outs--;
 			}
-			strcat(out_list, net_name);
 		}
 	}
-
-
-	fputs("`timescale 1ns/1ps\n", fp);
-	fputs("\n", fp);
-	fprintf(fp, "module HLSM(Clk, Rst, Start, %sDone, %s);\n", in_list, out_list);
-	fputs("\n", fp);
-	fputs("\n", fp);
+	StringBuilder_AppendString(module_buffer, ");\n");
+	StringBuilder_AppendString(module_buffer, "\n");
+	StringBuilder_AppendString(module_buffer, "\n");
 
 	// List inputs
-	LogMessage("MSG: Writing I/O\n", MESSAGE_LEVEL);
-	fputs("\tinput Clk, Rst, Start;\n", fp);
+	LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Writing I/O\n");
+	StringBuilder_AppendString(module_buffer, "\tinput Clk, Rst, Start;\n");
 	for(idx = 0; idx < num_nets; idx++) {
 		temp_net = Circuit_GetNet(circ, idx);
 		if(NULL == temp_net) {
-			LogMessage("Error: Could not retrieve net\n", ERROR_LEVEL);
+			LOG_MESSAGE(ERROR_LEVEL, "Error: Could not retrieve net\n");
 			break;
 		}
 		else if(net_input == Net_GetType(temp_net)) {
-			DeclareNet(temp_net, line_buffer);
-			print_return = fprintf(fp, line_buffer);
-			if(0 >= print_return) {
-				sprintf(log_msg, "Error: Could not print to file - %d\n", print_return);
-				LogMessage(log_msg, ERROR_LEVEL);
-				break;
-			}
+			DeclareNet(temp_net, module_buffer);
 		}
 	}
 
-	fputs("\n", fp);
+	StringBuilder_AppendString(module_buffer, "\n");
 
 	// List outputs
-	fputs("\toutput reg Done;\n", fp);
+	StringBuilder_AppendString(module_buffer, "\toutput reg Done;\n");
 	for(idx = 0; idx < num_nets; idx++) {
 		temp_net = Circuit_GetNet(circ, idx);
 		if(NULL == temp_net) {
-			LogMessage("Error: Could not retrieve net\n", ERROR_LEVEL);
+			LOG_MESSAGE(ERROR_LEVEL, "Error: Could not retrieve net\n");
 			break;
 		}
 		else if(net_output == Net_GetType(temp_net) && 1== Net_GetUsage(temp_net)) {
-			DeclareNet(temp_net, line_buffer);
-			print_return = fprintf(fp, line_buffer);
-			if(0 >= print_return) {
-				sprintf(log_msg, "Error: Could not print to file - %d\n", print_return);
-				LogMessage(log_msg, ERROR_LEVEL);
-				break;
-			}
+			DeclareNet(temp_net, module_buffer);
 		}
 	}
 
-	fputs("\n", fp);
+	StringBuilder_AppendString(module_buffer, "\n");
 
 	// List variables
-	LogMessage("MSG: Writing internal nets\n", MESSAGE_LEVEL);
+	LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Writing internal nets\n");
 	for(idx = 0; idx < num_nets; idx++) {
 		temp_net = Circuit_GetNet(circ, idx);
 		if(NULL == temp_net) {
-			LogMessage("Error: Could not retrieve net\n", ERROR_LEVEL);
+			LOG_MESSAGE(ERROR_LEVEL, "Error: Could not retrieve net\n");
 			break;
 		}
 		else if(net_input != Net_GetType(temp_net) && net_output != Net_GetType(temp_net)) {
-			if(1 == Net_GetUsage(temp_net)) {
-				DeclareNet(temp_net, line_buffer);
-				print_return = fprintf(fp, line_buffer);
-				if(0 >= print_return) {
-					sprintf(log_msg, "Error: Could not print to file - %d\n", print_return);
-					LogMessage(log_msg, ERROR_LEVEL);
-					break;
-				}
+			if(1 == Net_GetUsage(temp_net) && NULL == Net_GetStorage(temp_net)) { //Shared variables are declared by their register
+				DeclareNet(temp_net, module_buffer);
 			}
 		}
 	}
-	uint8_t num_states = StateMachine_GetNumStates(sm);
-	uint8_t state_width;
-	//CMake complains about log2
-	if(4 >= num_states) {
-		state_width = 2;
-	} else if(8 >= num_states) {
-		state_width = 3;
-	} else if(16 >= num_states) {
-		state_width = 4;
-	} else {
-		state_width = 5;
+	state_encoding encoding = StateMachine_GetEncoding(sm);
+	uint16_t state_width = StateMachine_GetStateWidth(sm);
+	StringBuilder_AppendString(module_buffer, "\treg [");
+	StringBuilder_AppendUnsigned(module_buffer, state_width-1);
+	StringBuilder_AppendString(module_buffer, ":0] state;\n");
+
+	StringBuilder_AppendString(module_buffer, "\n");
+
+	// Shared functional units, their input muxes are driven by the state register
+	if(0 < Circuit_GetNumResource(circ)) {
+		LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Writing datapath\n");
+		for(idx = 0; idx < Circuit_GetNumResource(circ); idx++) {
+			DeclareResource(Circuit_GetResource(circ, idx), sm, module_buffer);
+			StringBuilder_AppendString(module_buffer, "\n");
+		}
 	}
-	//uint8_t state_width = (uint8_t) (1.0f + log2f(num_states));
-	fprintf(fp, "\treg [%d:0] state;\n", (state_width-1));
-
-	fputs("\n", fp);
 
-	fputs("\t always @(posedge Clk) begin\n", fp);
-	fputs("\t\t if(Rst) begin\n", fp);
-	fputs("\t\t\t state <= 0;\n", fp);
-	fputs("\t\t end else begin\n", fp);
-	fputs("\t\t\t case(state)\n", fp);
+	StringBuilder_AppendString(module_buffer, "\t always @(posedge Clk) begin\n");
+	StringBuilder_AppendString(module_buffer, "\t\t if(Rst) begin\n");
+	StringBuilder_AppendString(module_buffer, "\t\t\t state <= ");
+	Print_StateCode(module_buffer, encoding, state_width, 0);
+	StringBuilder_AppendString(module_buffer, ";\n");
+	StringBuilder_AppendString(module_buffer, "\t\t end else begin\n");
+	if(encoding_onehot == encoding) {
+		StringBuilder_AppendString(module_buffer, "\t\t\t case(1'b1)\n"); //Each state only checks its own bit
+	} else {
+		StringBuilder_AppendString(module_buffer, "\t\t\t case(state)\n");
+	}
 
-	state* head = StateMachine_Search(sm, 0);
-	Print_StateList(head, fp, StateMachine_GetLatency(sm));
+	Print_StateList(sm, module_buffer);
 
-	fputs("\t\t\t endcase\n", fp);
-	fputs("\t\t end\n", fp);
-	fputs("\t end\n", fp);
-	fputs("endmodule\n", fp);
+	StringBuilder_AppendString(module_buffer, "\t\t\t endcase\n");
+	StringBuilder_AppendString(module_buffer, "\t\t end\n");
+	StringBuilder_AppendString(module_buffer, "\t end\n");
+	StringBuilder_AppendString(module_buffer, "endmodule\n");
 
-	fputs("\n", fp);
+	StringBuilder_AppendString(module_buffer, "\n");
 
-	fputs("`default_nettype wire\n", fp);
+	StringBuilder_AppendString(module_buffer, "`default_nettype wire\n");
 
-	fclose(fp);
+	if(SUCCESS != StringBuilder_Flush(module_buffer, fp)) {
+		LOG_MESSAGE(ERROR_LEVEL, "Error: Could not print to file\n");
+		ret_value = FAILURE;
+	}
+	StringBuilder_Destroy(&module_buffer);
+	return ret_value;
 }
 
-void DeclareNet(net* self, char* line_buffer) {
+void DeclareNet(net* self, string_builder* line_buffer) {
 	if(NULL == self || NULL == line_buffer) return;
 	net_type type = Net_GetType(self);
 	uint8_t net_width = Net_GetWidth(self);
-	char net_type_keyword[32];
-	char net_name[64];
-	Net_GetName(self, net_name);
+	const char* net_type_keyword;
 
 	switch(type) {
 	case net_input:
-		strcpy(net_type_keyword, "input");
+		net_type_keyword = "input";
 		break;
 	case net_output:
-		strcpy(net_type_keyword, "output reg");
+		net_type_keyword = "output reg";
 		break;
 	case net_wire:
-		strcpy(net_type_keyword, "wire");
+		net_type_keyword = "wire";
 		break;
 	case net_reg:
-		strcpy(net_type_keyword, "reg");
+		net_type_keyword = "reg";
 		break;
 	case net_variable:
-		strcpy(net_type_keyword, "reg");
+		net_type_keyword = "reg";
 		break;
 	default:
-		strcpy(net_type_keyword, "err");
+		net_type_keyword = "err";
 		break;
 	}
 
+	StringBuilder_AppendChar(line_buffer, '\t');
+	StringBuilder_AppendString(line_buffer, net_type_keyword);
 	if(net_signed == Net_GetSign(self)) {
-		strcat(net_type_keyword, " signed");
+		StringBuilder_AppendString(line_buffer, " signed");
 	}
+	StringBuilder_AppendString(line_buffer, " [");
+	StringBuilder_AppendInt(line_buffer, (net_width-1));
+	StringBuilder_AppendString(line_buffer, ":0] ");
+	StringBuilder_AppendString(line_buffer, Net_GetNameRef(self));
+	StringBuilder_AppendString(line_buffer, ";\n");
 
-	sprintf(line_buffer, "\t%s [%d:0] %s;\n", net_type_keyword, (net_width-1), net_name);
+}
 
+static const char* DeclareComponent_PortName(port temp_port, component_type type, uint8_t is_input) {
+	const char* port_declaration = NULL;
+	switch(temp_port.type) {
+	case datapath_a:
+		port_declaration = (load_register == type) ? ".d(" : ".a(";
+		break;
+	case datapath_b:
+		port_declaration = ".b(";
+		break;
+	case datapath_out:
+		port_declaration = ".d(";
+		break;
+	case mux_sel:
+		port_declaration = ".sel(";
+		break;
+	case shift_amount:
+		port_declaration = ".sh_amt(";
+		break;
+	case greater_than_out:
+		port_declaration = ".gt(";
+		break;
+	case less_than_out:
+		port_declaration = ".lt(";
+		break;
+	case equal_out:
+		port_declaration = ".eq(";
+		break;
+	case reg_out:
+		port_declaration = ".q(";
+		break;
+	case sum_out:
+		port_declaration = ".sum(";
+		break;
+	case diff_out:
+		port_declaration = ".diff(";
+		break;
+	case prod_out:
+		port_declaration = ".prod(";
+		break;
+	case quot_out:
+		port_declaration = ".quot(";
+		break;
+	case rem_out:
+		port_declaration = ".rem(";
+		break;
+	case port_if:
+		port_declaration = is_input ? ".if_i(" : ".if_o(";
+		break;
+	case port_else:
+		port_declaration = is_input ? ".else_i(" : ".else_o(";
+		break;
+	case port_prev_op:
+		port_declaration = ".prev_op(";
+		break;
+	case port_conditional:
+		port_declaration = ".cond(";
+		break;
+	default:
+		break;
+	}
+	return port_declaration;
+}
+
+static const char* DeclareComponent_TypeName(component_type type) {
+	const char* type_declaration = "";
+	switch(type) {
+	case load_register:
+		type_declaration = "Reg";
+		break;
+	case adder:
+		type_declaration = "Add";
+		break;
+	case subtractor:
+		type_declaration = "Sub";
+		break;
+	case multiplier:
+		type_declaration = "Mul";
+		break;
+	case divider:
+		type_declaration = "Div";
+		break;
+	case modulo:
+		type_declaration = "Mod";
+		break;
+	case mux2x1:
+		type_declaration = "Mux2x1";
+		break;
+	case comparator:
+		type_declaration = "Comp";
+		break;
+	case shift_right:
+		type_declaration = "SHR";
+		break;
+	case shift_left:
+		type_declaration = "SHL";
+		break;
+	case incrementer:
+		type_declaration = "Inc";
+		break;
+	case decrementer:
+		type_declaration = "Dec";
+		break;
+	case component_if_else:
+		type_declaration = "If_Else";
+		break;
+	default:
+		break;
+	}
+	return type_declaration;
 }
 
-void DeclareComponent(component* self, char* line_buffer, uint8_t comp_idx) {
+void DeclareComponent(component* self, string_builder* line_buffer, uint16_t comp_idx) {
 	if(NULL == self || NULL == line_buffer) return;
 
 	component_type type;
-	net_sign component_sign;
 	uint8_t width, padding_length, padding_bit;
-	uint8_t io_idx, num_ports;
+	uint8_t io_idx, num_ports, is_input;
 	port temp_port;
-	char type_declaration[32];
-	char component_name[128];
-	char port_declaration[512] = "";
-	char temp_port_declaration[128];
-	char port_net_name[16];
-	char port_name[64];
-
-	if(NULL != self) {
+	const char* type_declaration;
+	const char* port_declaration;
+	const char* port_net_name;
 
-		width = Component_GetWidth(self);
-		component_sign = Component_GetSign(self);
-		type = Component_GetType(self);
+	width = Component_GetWidth(self);
+	type = Component_GetType(self);
+	type_declaration = DeclareComponent_TypeName(type);
 
-		num_ports = Component_GetNumOutputs(self) + Component_GetNumInputs(self);
-		for(io_idx = 0; io_idx < num_ports; io_idx++) {
-
-			if(io_idx < Component_GetNumInputs(self)) {
-				temp_port = Component_GetInputPort(self, io_idx);
-			} else {
-				temp_port = Component_GetOutputPort(self, (io_idx - Component_GetNumInputs(self)));
-			}
+	StringBuilder_AppendChar(line_buffer, '\t');
+	if(net_signed == Component_GetSign(self)) {
+		StringBuilder_AppendChar(line_buffer, 'S');
+	}
+	StringBuilder_AppendString(line_buffer, type_declaration);
+	StringBuilder_AppendString(line_buffer, " #(.DATA_WIDTH(");
+	StringBuilder_AppendUnsigned(line_buffer, width);
+	StringBuilder_AppendString(line_buffer, ")) ");
+	StringBuilder_AppendString(line_buffer, type_declaration);
+	StringBuilder_AppendChar(line_buffer, '_');
+	StringBuilder_AppendUnsigned(line_buffer, comp_idx);
+	StringBuilder_AppendString(line_buffer, " (");
+
+	num_ports = Component_GetNumOutputs(self) + Component_GetNumInputs(self);
+	for(io_idx = 0; io_idx < num_ports; io_idx++) {
+
+		is_input = (io_idx < Component_GetNumInputs(self)) ? TRUE : FALSE;
+		if(TRUE == is_input) {
+			temp_port = Component_GetInputPort(self, io_idx);
+		} else {
+			temp_port = Component_GetOutputPort(self, (io_idx - Component_GetNumInputs(self)));
+		}
 
-			Net_GetName(temp_port.port_net, port_net_name);
-			if((Component_GetWidth(self) > Net_GetWidth(temp_port.port_net)) &&
+		port_declaration = DeclareComponent_PortName(temp_port, type, is_input);
+		if(NULL != port_declaration) {
+			StringBuilder_AppendString(line_buffer, port_declaration);
+			port_net_name = Net_GetNameRef(temp_port.port_net);
+			if((width > Net_GetWidth(temp_port.port_net)) &&
 					(datapath_a == temp_port.type || datapath_b == temp_port.type)) {
 
-				padding_length = Component_GetWidth(self) - Net_GetWidth(temp_port.port_net);
+				padding_length = width - Net_GetWidth(temp_port.port_net);
 				padding_bit = Net_GetWidth(temp_port.port_net) - 1;
+				StringBuilder_AppendString(line_buffer, "{{");
+				StringBuilder_AppendUnsigned(line_buffer, padding_length);
 				if(net_signed == Net_GetSign(temp_port.port_net)) {
-					sprintf(port_name, "{{%d{%s[%d]}}, %s}", padding_length, port_net_name, padding_bit, port_net_name);
-				} else if(net_unsigned == Net_GetSign(temp_port.port_net)) {
-					sprintf(port_name, "{{%d{1'b0}}, %s}", padding_length, port_net_name);
+					StringBuilder_AppendChar(line_buffer, '{');
+					StringBuilder_AppendString(line_buffer, port_net_name);
+					StringBuilder_AppendChar(line_buffer, '[');
+					StringBuilder_AppendUnsigned(line_buffer, padding_bit);
+					StringBuilder_AppendString(line_buffer, "]}}, ");
+				} else {
+					StringBuilder_AppendString(line_buffer, "{1'b0}}, ");
 				}
+				StringBuilder_AppendString(line_buffer, port_net_name);
+				StringBuilder_AppendChar(line_buffer, '}');
 			} else {
-				strcpy(port_name, port_net_name);
+				StringBuilder_AppendString(line_buffer, port_net_name);
 			}
+			StringBuilder_AppendChar(line_buffer, ')');
+		}
+		if(io_idx != (num_ports - 1)) {
+			StringBuilder_AppendString(line_buffer, ", ");
+		}
+	}
 
-			switch(temp_port.type) {
-			case datapath_a:
-				if(load_register == type) {
-					sprintf(temp_port_declaration, ".d(%s)", port_name);
-				} else {
-					sprintf(temp_port_declaration, ".a(%s)", port_name);
-				}
-				break;
-			case datapath_b:
-				sprintf(temp_port_declaration, ".b(%s)", port_name);
-				break;
-			case datapath_out:
-				sprintf(temp_port_declaration, ".d(%s)", port_name);
-				break;
-			case mux_sel:
-				sprintf(temp_port_declaration, ".sel(%s)", port_name);
-				break;
-			case shift_amount:
-				sprintf(temp_port_declaration, ".sh_amt(%s)", port_name);
-				break;
-			case greater_than_out:
-				sprintf(temp_port_declaration, ".gt(%s)", port_name);
-				break;
-			case less_than_out:
-				sprintf(temp_port_declaration, ".lt(%s)", port_name);
-				break;
-			case equal_out:
-				sprintf(temp_port_declaration, ".eq(%s)", port_name);
-				break;
-			case reg_out:
-				sprintf(temp_port_declaration, ".q(%s)", port_name);
-				break;
-			case sum_out:
-				sprintf(temp_port_declaration, ".sum(%s)", port_name);
-				break;
-			case diff_out:
-				sprintf(temp_port_declaration, ".diff(%s)", port_name);
-				break;
-			case prod_out:
-				sprintf(temp_port_declaration, ".prod(%s)", port_name);
-				break;
-			case quot_out:
-				sprintf(temp_port_declaration, ".quot(%s)", port_name);
-				break;
-			case rem_out:
-				sprintf(temp_port_declaration, ".rem(%s)", port_name);
-				break;
-			case port_if:
-				if(io_idx < Component_GetNumInputs(self))
-					sprintf(temp_port_declaration, ".if_i(%s)", port_name);
-				else
-					sprintf(temp_port_declaration, ".if_o(%s)", port_name);
-				break;
-			case port_else:
-				if(io_idx < Component_GetNumInputs(self))
-					sprintf(temp_port_declaration, ".else_i(%s)", port_name);
-				else
-					sprintf(temp_port_declaration, ".else_o(%s)", port_name);
-				break;
-			case port_prev_op:
-				sprintf(temp_port_declaration, ".prev_op(%s)", port_name);
-				break;
-			case port_conditional:
-				sprintf(temp_port_declaration, ".cond(%s)", port_name);
-				break;
-			default:
+	StringBuilder_AppendString(line_buffer, ");\n");
+
+}
+
+static void DeclareResource_Name(resource* self, string_builder* line_buffer) {
+	if(resource_alu == Resource_GetResourceType(self)) {
+		StringBuilder_AppendString(line_buffer, "Alu");
+	} else {
+		StringBuilder_AppendString(line_buffer, DeclareComponent_TypeName(Resource_GetType(self)));
+	}
+	StringBuilder_AppendChar(line_buffer, '_');
+	StringBuilder_AppendUnsigned(line_buffer, Resource_GetIndex(self));
+}
+
+void DeclareResource_PortName(resource* self, port_type type, string_builder* line_buffer) {
+	if(NULL == self || NULL == line_buffer) return;
+	DeclareResource_Name(self, line_buffer);
+	switch(type) {
+	case datapath_a:
+		StringBuilder_AppendString(line_buffer, "_a");
+		break;
+	case datapath_b:
+	case shift_amount:
+		StringBuilder_AppendString(line_buffer, "_b");
+		break;
+	case mux_sel:
+		StringBuilder_AppendString(line_buffer, "_sel");
+		break;
+	default:
+		StringBuilder_AppendString(line_buffer, "_y");
+		break;
+	}
+}
+
+//Function select of a unit shared by adders and subtractors
+static void DeclareResource_SelectName(resource* self, string_builder* line_buffer) {
+	DeclareResource_Name(self, line_buffer);
+	StringBuilder_AppendString(line_buffer, "_sub");
+}
+
+static void DeclareResource_Wire(resource* self, port_type type, net_sign sign, uint8_t width, string_builder* line_buffer) {
+	StringBuilder_AppendString(line_buffer, "\twire ");
+	if(net_signed == sign) {
+		StringBuilder_AppendString(line_buffer, "signed ");
+	}
+	StringBuilder_AppendChar(line_buffer, '[');
+	StringBuilder_AppendUnsigned(line_buffer, width - 1);
+	StringBuilder_AppendString(line_buffer, ":0] ");
+	DeclareResource_PortName(self, type, line_buffer);
+	StringBuilder_AppendString(line_buffer, ";\n");
+}
+
+//Operand as seen by the unit, extended to the unit width the same way the behavioural operator would
+static void DeclareResource_Operand(net* operand, port_type type, net_sign sign, uint8_t width, string_builder* line_buffer) {
+	uint8_t net_width = Net_GetWidth(operand);
+	const char* net_name = Net_GetNameRef(operand);
+	if(mux_sel == type) {
+		if(net_width > 1) StringBuilder_AppendChar(line_buffer, '|');
+		StringBuilder_AppendString(line_buffer, net_name);
+	} else if(width > net_width) {
+		StringBuilder_AppendString(line_buffer, "{{");
+		StringBuilder_AppendUnsigned(line_buffer, width - net_width);
+		if(net_signed == sign && shift_amount != type) {
+			StringBuilder_AppendChar(line_buffer, '{');
+			StringBuilder_AppendString(line_buffer, net_name);
+			StringBuilder_AppendChar(line_buffer, '[');
+			StringBuilder_AppendUnsigned(line_buffer, net_width - 1);
+			StringBuilder_AppendString(line_buffer, "]}}, ");
+		} else {
+			StringBuilder_AppendString(line_buffer, "{1'b0}}, ");
+		}
+		StringBuilder_AppendString(line_buffer, net_name);
+		StringBuilder_AppendChar(line_buffer, '}');
+	} else {
+		StringBuilder_AppendString(line_buffer, net_name);
+	}
+}
+
+static net* DeclareResource_GetOperand(component* op, port_type type) {
+	uint8_t idx;
+	port cur_port;
+	for(idx = 0; idx < Component_GetNumInputs(op); idx++) {
+		cur_port = Component_GetInputPort(op, idx);
+		if(type == cur_port.type) return cur_port.port_net;
+	}
+	return NULL;
+}
+
+//Renamed versions and variables sharing a register are read through the same mux input
+static uint8_t DeclareResource_SameOperand(net* operand, net* other) {
+	if(operand == other) return TRUE;
+	if(NULL == operand || NULL == other) return FALSE;
+	return (0 == strcmp(Net_GetNameRef(operand), Net_GetNameRef(other))) ? TRUE : FALSE;
+}
+
+//OR of every state where one of the unit's operations reading operand (or any operation of op_type) runs
+static void DeclareResource_StateCondition(resource* self, state_machine* sm, port_type type, net* operand, component_type op_type, string_builder* line_buffer) {
+	uint16_t state_idx, op_idx;
+	uint8_t first_term = TRUE;
+	component* op;
+	state_encoding encoding = StateMachine_GetEncoding(sm);
+	uint16_t state_width = StateMachine_GetStateWidth(sm);
+	for(state_idx = 0; state_idx < Resource_GetNumStates(self); state_idx++) {
+		for(op_idx = 0; op_idx < Resource_GetNumOperations(self); op_idx++) {
+			op = Resource_GetOperation(self, op_idx);
+			if(TRUE == Resource_IsOperationActive(self, op_idx, state_idx) &&
+					((NULL != operand && TRUE == DeclareResource_SameOperand(operand, DeclareResource_GetOperand(op, type))) ||
+					(NULL == operand && op_type == Component_GetType(op)))) {
+				if(FALSE == first_term) StringBuilder_AppendString(line_buffer, " || ");
+				Print_StateTest(line_buffer, encoding, state_width, state_idx);
+				first_term = FALSE;
 				break;
 			}
-			strcat(port_declaration, temp_port_declaration);
-			if(io_idx != (num_ports - 1)) {
-				strcat(port_declaration, ", ");
-			}
 		}
+	}
+	if(TRUE == first_term) StringBuilder_AppendString(line_buffer, "1'b0");
+}
+
+static void DeclareResource_InputMux(resource* self, state_machine* sm, port_type type, string_builder* line_buffer) {
+	uint16_t op_idx, prev_idx, num_operands;
+	net* operand;
+	net* last_operand = NULL;
+	uint8_t width = Resource_GetPortWidth(self, type);
+	net_sign sign = Resource_GetSign(self);
+
+	num_operands = 0;
+	for(op_idx = 0; op_idx < Resource_GetNumOperations(self); op_idx++) {
+		operand = DeclareResource_GetOperand(Resource_GetOperation(self, op_idx), type);
+		for(prev_idx = 0; prev_idx < op_idx; prev_idx++) {
+			if(TRUE == DeclareResource_SameOperand(operand, DeclareResource_GetOperand(Resource_GetOperation(self, prev_idx), type))) break;
+		}
+		if(prev_idx == op_idx && NULL != operand) {
+			num_operands++;
+			last_operand = operand;
+		}
+	}
+	if(NULL == last_operand) return;
+
+	StringBuilder_AppendString(line_buffer, "\tassign ");
+	DeclareResource_PortName(self, type, line_buffer);
+	StringBuilder_AppendString(line_buffer, " = ");
+	//One mux input per distinct operand, the last one doubles as the idle value
+	for(op_idx = 0; op_idx < Resource_GetNumOperations(self) && num_operands > 1; op_idx++) {
+		operand = DeclareResource_GetOperand(Resource_GetOperation(self, op_idx), type);
+		for(prev_idx = 0; prev_idx < op_idx; prev_idx++) {
+			if(TRUE == DeclareResource_SameOperand(operand, DeclareResource_GetOperand(Resource_GetOperation(self, prev_idx), type))) break;
+		}
+		if(prev_idx == op_idx && NULL != operand && FALSE == DeclareResource_SameOperand(last_operand, operand)) {
+			StringBuilder_AppendChar(line_buffer, '(');
+			DeclareResource_StateCondition(self, sm, type, operand, component_unknown, line_buffer);
+			StringBuilder_AppendString(line_buffer, ") ? ");
+			DeclareResource_Operand(operand, type, sign, width, line_buffer);
+			StringBuilder_AppendString(line_buffer, " : ");
+		}
+	}
+	DeclareResource_Operand(last_operand, type, sign, width, line_buffer);
+	StringBuilder_AppendString(line_buffer, ";\n");
+}
+
+void DeclareResource(resource* self, state_machine* sm, string_builder* line_buffer) {
+	if(NULL == self || NULL == sm || NULL == line_buffer) return;
 
+	component_type type = Resource_GetType(self);
+	net_sign sign = Resource_GetSign(self);
+	port_type b_port = (shift_left == type || shift_right == type) ? shift_amount : datapath_b;
+	const char* op_symbol = "";
+
+	DeclareResource_Wire(self, datapath_a, sign, Resource_GetPortWidth(self, datapath_a), line_buffer);
+	DeclareResource_Wire(self, b_port, (shift_amount == b_port) ? net_unsigned : sign, Resource_GetPortWidth(self, b_port), line_buffer);
+	if(mux2x1 == type) {
+		DeclareResource_Wire(self, mux_sel, net_unsigned, 1, line_buffer);
+	}
+	if(TRUE == Resource_HasFunctionSelect(self)) {
+		StringBuilder_AppendString(line_buffer, "\twire [0:0] ");
+		DeclareResource_SelectName(self, line_buffer);
+		StringBuilder_AppendString(line_buffer, ";\n");
+	}
+	DeclareResource_Wire(self, datapath_out, (comparator == type) ? net_unsigned : sign, Resource_GetPortWidth(self, datapath_out), line_buffer);
+
+	DeclareResource_InputMux(self, sm, datapath_a, line_buffer);
+	DeclareResource_InputMux(self, sm, b_port, line_buffer);
+	if(mux2x1 == type) {
+		DeclareResource_InputMux(self, sm, mux_sel, line_buffer);
+	}
+	if(TRUE == Resource_HasFunctionSelect(self)) {
+		StringBuilder_AppendString(line_buffer, "\tassign ");
+		DeclareResource_SelectName(self, line_buffer);
+		StringBuilder_AppendString(line_buffer, " = ");
+		DeclareResource_StateCondition(self, sm, datapath_out, NULL, subtractor, line_buffer);
+		StringBuilder_AppendString(line_buffer, ";\n");
+	}
+
+	StringBuilder_AppendString(line_buffer, "\tassign ");
+	DeclareResource_PortName(self, datapath_out, line_buffer);
+	StringBuilder_AppendString(line_buffer, " = ");
+	if(TRUE == Resource_HasFunctionSelect(self)) {
+		DeclareResource_SelectName(self, line_buffer);
+		StringBuilder_AppendString(line_buffer, " ? ");
+		DeclareResource_PortName(self, datapath_a, line_buffer);
+		StringBuilder_AppendString(line_buffer, " - ");
+		DeclareResource_PortName(self, datapath_b, line_buffer);
+		StringBuilder_AppendString(line_buffer, " : ");
+		DeclareResource_PortName(self, datapath_a, line_buffer);
+		StringBuilder_AppendString(line_buffer, " + ");
+		DeclareResource_PortName(self, datapath_b, line_buffer);
+	} else if(mux2x1 == type) {
+		DeclareResource_PortName(self, mux_sel, line_buffer);
+		StringBuilder_AppendString(line_buffer, " ? ");
+		DeclareResource_PortName(self, datapath_a, line_buffer);
+		StringBuilder_AppendString(line_buffer, " : ");
+		DeclareResource_PortName(self, datapath_b, line_buffer);
+	} else {
 		switch(type) {
-		case load_register:
-			strcpy(type_declaration, "Reg");
-			break;
 		case adder:
-			strcpy(type_declaration, "Add");
+			op_symbol = " + ";
 			break;
 		case subtractor:
-			strcpy(type_declaration, "Sub");
+			op_symbol = " - ";
 			break;
 		case multiplier:
-			strcpy(type_declaration, "Mul");
+			op_symbol = " * ";
 			break;
 		case divider:
-			strcpy(type_declaration, "Div");
+			op_symbol = " / ";
 			break;
 		case modulo:
-			strcpy(type_declaration, "Mod");
-			break;
-		case mux2x1:
-			strcpy(type_declaration, "Mux2x1");
-			break;
-		case comparator:
-			strcpy(type_declaration, "Comp");
-			break;
-		case shift_right:
-			strcpy(type_declaration, "SHR");
+			op_symbol = " % ";
 			break;
 		case shift_left:
-			strcpy(type_declaration, "SHL");
-			break;
-		case incrementer:
-			strcpy(type_declaration, "Inc");
+			op_symbol = " << ";
 			break;
-		case decrementer:
-			strcpy(type_declaration, "Dec");
+		case shift_right:
+			op_symbol = " >> ";
 			break;
-		case component_if_else:
-			strcpy(type_declaration, "If_Else");
+		case comparator:
+			if(greater_than_out == Component_GetOutputPort(Resource_GetOperation(self, 0), 0).type) {
+				op_symbol = " > ";
+			} else if(less_than_out == Component_GetOutputPort(Resource_GetOperation(self, 0), 0).type) {
+				op_symbol = " < ";
+			} else {
+				op_symbol = " == ";
+			}
 			break;
 		default:
 			break;
 		}
+		DeclareResource_PortName(self, datapath_a, line_buffer);
+		StringBuilder_AppendString(line_buffer, op_symbol);
+		DeclareResource_PortName(self, b_port, line_buffer);
 	}
-
-	sprintf(component_name, "%s_%d", type_declaration, comp_idx);
-
-	if(net_signed == component_sign) {
-		sprintf(line_buffer, "\tS%s #(.DATA_WIDTH(%d)) %s (%s);\n", type_declaration, width, component_name, port_declaration);
-	} else {
-		sprintf(line_buffer, "\t%s #(.DATA_WIDTH(%d)) %s (%s);\n", type_declaration, width, component_name, port_declaration);
-	}
-
+	StringBuilder_AppendString(line_buffer, ";\n");
 }
 
 void TestComponentDeclaration() {
-	char comp_line[1024];
+	string_builder* comp_line = StringBuilder_Create(1024);
 	component_type uut_type;
 	component* uut;
 	net* a;
@@ -461,72 +732,147 @@ void TestComponentDeclaration() {
 			break;
 		}
 		DeclareComponent(uut, comp_line, comp_idx);
-		printf(comp_line);
+		StringBuilder_Flush(comp_line, stdout);
 		Component_Destroy(&uut);
 		comp_idx++;
 	}
+	StringBuilder_Destroy(&comp_line);
 }
 
-void Print_StateList(state* cur_state, FILE* print_file, uint8_t latency) {
-	uint8_t cycle, num_op, idx, next_cycle, num_next_state;
+void Print_StateList(state_machine* sm, string_builder* print_file) {
+	uint16_t idx;
+	uint8_t latency = StateMachine_GetLatency(sm);
+	state_encoding encoding = StateMachine_GetEncoding(sm);
+	uint16_t state_width = StateMachine_GetStateWidth(sm);
+	const char* conditional_net_name = ""; //Branching states without their own if_else reuse the last condition
+	for(idx = 0; idx < StateMachine_GetNumStates(sm); idx++) {
+		Print_State(StateMachine_GetState(sm, idx), print_file, latency, encoding, state_width, &conditional_net_name);
+	}
+}
+
+static void Print_StateCode(string_builder* print_file, state_encoding encoding, uint16_t state_width, uint16_t state_number) {
+	uint16_t gray_code, digit_idx, num_digits;
+	int8_t bit_idx;
+	StringBuilder_AppendUnsigned(print_file, state_width);
+	if(encoding_onehot == encoding) {
+		//Print as hex so wide state registers stay readable
+		num_digits = (state_width + 3) / 4;
+		StringBuilder_AppendString(print_file, "'h");
+		for(digit_idx = num_digits; digit_idx > 0; digit_idx--) {
+			if((state_number / 4) == (digit_idx - 1)) {
+				StringBuilder_AppendChar(print_file, "1248"[state_number % 4]);
+			} else {
+				StringBuilder_AppendChar(print_file, '0');
+			}
+		}
+	} else if(encoding_gray == encoding) {
+		gray_code = state_number ^ (state_number >> 1);
+		StringBuilder_AppendString(print_file, "'b");
+		for(bit_idx = (int8_t) (state_width - 1); bit_idx >= 0; bit_idx--) {
+			StringBuilder_AppendChar(print_file, (gray_code & (1 << bit_idx)) ? '1' : '0');
+		}
+	} else {
+		StringBuilder_AppendString(print_file, "'d");
+		StringBuilder_AppendUnsigned(print_file, state_number);
+	}
+}
+
+//Condition that is true while the state register holds state_number
+static void Print_StateTest(string_builder* print_file, state_encoding encoding, uint16_t state_width, uint16_t state_number) {
+	if(encoding_onehot == encoding) {
+		StringBuilder_AppendString(print_file, "state[");
+		StringBuilder_AppendUnsigned(print_file, state_number);
+		StringBuilder_AppendChar(print_file, ']');
+	} else {
+		StringBuilder_AppendString(print_file, "state == ");
+		Print_StateCode(print_file, encoding, state_width, state_number);
+	}
+}
+
+static void Print_State(state* cur_state, string_builder* print_file, uint8_t latency, state_encoding encoding, uint16_t state_width, const char** conditional_net_name) {
+	uint8_t cycle, idx, num_next_state;
+	uint16_t op_idx, num_op, next_state_number;
 	component* op;
-	char eqn[32], conditional_net_name[32];
+	size_t line_start;
 	state* next_state;
-	net* conditional_net;
 	if(NULL != cur_state && NULL != print_file) {
 		cycle = State_GetCycle(cur_state);
 		num_next_state = State_GetNumStates(cur_state);
-		fprintf(print_file, "\t\t\t 4'd%d: begin\n", State_GetStateNumber(cur_state));
+		StringBuilder_AppendString(print_file, "\t\t\t ");
+		if(encoding_onehot == encoding) {
+			StringBuilder_AppendString(print_file, "state[");
+			StringBuilder_AppendUnsigned(print_file, State_GetStateNumber(cur_state));
+			StringBuilder_AppendChar(print_file, ']');
+		} else {
+			Print_StateCode(print_file, encoding, state_width, State_GetStateNumber(cur_state));
+		}
+		StringBuilder_AppendString(print_file, ": begin\n");
 
 		if(0 == cycle) {
-			fputs("\t\t\t\t Done <= 0;\n", print_file);
-			fputs("\t\t\t\t if(~Start) begin\n", print_file);
-			fputs("\t\t\t\t\t state <= 0;\n", print_file);
-			fputs("\t\t\t\t end else begin\n", print_file);
-			fputs("\t\t\t\t\t state <= 1;\n", print_file);
-			fputs("\t\t\t\t end\n", print_file);
-			fputs("\t\t\t\t end\n", print_file);
+			next_state_number = (num_next_state > 0) ? State_GetStateNumber(State_GetNextState(cur_state, 0)) : 0;
+			StringBuilder_AppendString(print_file, "\t\t\t\t Done <= 0;\n");
+			StringBuilder_AppendString(print_file, "\t\t\t\t if(~Start) begin\n");
+			StringBuilder_AppendString(print_file, "\t\t\t\t\t state <= ");
+			Print_StateCode(print_file, encoding, state_width, State_GetStateNumber(cur_state));
+			StringBuilder_AppendString(print_file, ";\n");
+			StringBuilder_AppendString(print_file, "\t\t\t\t end else begin\n");
+			StringBuilder_AppendString(print_file, "\t\t\t\t\t state <= ");
+			Print_StateCode(print_file, encoding, state_width, next_state_number);
+			StringBuilder_AppendString(print_file, ";\n");
+			StringBuilder_AppendString(print_file, "\t\t\t\t end\n");
+			StringBuilder_AppendString(print_file, "\t\t\t\t end\n");
 		} else if(cycle < (latency+1)) {
 			num_op = State_GetNumOperations(cur_state);
-			for(idx = 0; idx < num_op; idx++) {
-				op = State_GetOperation(cur_state, idx);
+			for(op_idx = 0; op_idx < num_op; op_idx++) {
+				op = State_GetOperation(cur_state, op_idx);
 				if(component_if_else == Component_GetType(op)) {
 					port temp = Component_GetInputPort(op, 0);
-					conditional_net = temp.port_net;
-					Net_GetName(conditional_net, conditional_net_name);
+					*conditional_net_name = Net_GetNameRef(temp.port_net);
 				} else {
-					if(0 != Component_PrintOperation(op, eqn))
-						fprintf(print_file, "\t\t\t\t %s\n", eqn);
+					line_start = StringBuilder_GetLength(print_file);
+					StringBuilder_AppendString(print_file, "\t\t\t\t ");
+					if(NULL != Component_GetResource(op)) {
+						StringBuilder_AppendString(print_file, Net_GetNameRef(Component_GetOutputPort(op, 0).port_net));
+						StringBuilder_AppendString(print_file, " <= ");
+						DeclareResource_PortName(Component_GetResource(op), datapath_out, print_file);
+						StringBuilder_AppendString(print_file, ";\n");
+					} else if(0 != Component_PrintOperation(op, print_file)) {
+						StringBuilder_AppendChar(print_file, '\n');
+					} else {
+						StringBuilder_Truncate(print_file, line_start);
+					}
 				}
 			}
 
 			if(1 == num_next_state) {
 				next_state = State_GetNextState(cur_state, 0);
-				next_cycle = State_GetStateNumber(next_state);
-				fprintf(print_file, "\t\t\t\t state <= %d;\n", next_cycle);
+				next_state_number = State_GetStateNumber(next_state);
+				StringBuilder_AppendString(print_file, "\t\t\t\t state <= ");
+				Print_StateCode(print_file, encoding, state_width, next_state_number);
+				StringBuilder_AppendString(print_file, ";\n");
 			} else if(2 == num_next_state) {
 				for(idx=0;idx<num_next_state;idx++) {
 					next_state = State_GetNextState(cur_state, idx);
-					next_cycle = State_GetStateNumber(next_state);
+					next_state_number = State_GetStateNumber(next_state);
 					if(0 == idx) {
-						fprintf(print_file, "\t\t\t\t if(%s) begin \n\t\t\t\t\t state <= %d;\n", conditional_net_name, next_cycle);
+						StringBuilder_AppendString(print_file, "\t\t\t\t if(");
+						StringBuilder_AppendString(print_file, *conditional_net_name);
+						StringBuilder_AppendString(print_file, ") begin \n\t\t\t\t\t state <= ");
 					} else {
-						fprintf(print_file, "\t\t\t\t end else if(%s) begin \n\t\t\t\t\t state <= %d;\n", conditional_net_name, next_cycle);
-						fputs("\t\t\t\t end\n", print_file);
+						StringBuilder_AppendString(print_file, "\t\t\t\t end else begin \n\t\t\t\t\t state <= ");
 					}
+					Print_StateCode(print_file, encoding, state_width, next_state_number);
+					StringBuilder_AppendString(print_file, ";\n");
 				}
+				StringBuilder_AppendString(print_file, "\t\t\t\t end\n");
 			}
-			fputs("\t\t\t\t end\n", print_file);
+			StringBuilder_AppendString(print_file, "\t\t\t\t end\n");
 		} else if(cycle == latency+1) {
-			fputs("\t\t\t\t Done <= 1;\n", print_file);
-			fputs("\t\t\t\t state <= 0;\n", print_file);
-			fputs("\t\t\t\t end\n", print_file);
-		}
-
-		for(idx=0;idx<num_next_state;idx++) {
-			next_state = State_GetNextState(cur_state, idx);
-			if(State_GetStateNumber(next_state) > State_GetStateNumber(cur_state))
-				Print_StateList(next_state, print_file, latency);
+			StringBuilder_AppendString(print_file, "\t\t\t\t Done <= 1;\n");
+			StringBuilder_AppendString(print_file, "\t\t\t\t state <= ");
+			Print_StateCode(print_file, encoding, state_width, 0);
+			StringBuilder_AppendString(print_file, ";\n");
+			StringBuilder_AppendString(print_file, "\t\t\t\t end\n");
 		}
 	}
 
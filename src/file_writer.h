@@ -1,11 +1,15 @@
 #ifndef FILE_WRITER_H
 #define FILE_WRITER_H
 
+#include <stdio.h>
 #include "global.h"
 
 void PrintStateMachine(char* file_name, circuit* circ, state_machine* sm);
-void DeclareNet(net* self, char* line_buffer);
-void DeclareComponent(component* self, char* line_buffer, uint8_t comp_idx);
+uint8_t PrintStateMachineStream(FILE* fp, circuit* circ, state_machine* sm);
+void DeclareNet(net* self, string_builder* line_buffer);
+void DeclareComponent(component* self, string_builder* line_buffer, uint16_t comp_idx);
+void DeclareResource(resource* self, state_machine* sm, string_builder* line_buffer);
+void DeclareResource_PortName(resource* self, port_type type, string_builder* line_buffer);
 void TestComponentDeclaration();
 
 #endif
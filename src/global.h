@@ -27,8 +27,6 @@
 #define MULTIPLIER_CYCLE_DELAY 2
 #define LOGICAL_CYCLE_DELAY 1
 
-#define DEBUG_MODE 0
-
 //Net
 typedef enum enum_net_type {
 	net_wire=0,
@@ -154,6 +152,26 @@ typedef struct struct_resource resource;
 typedef struct struct_state state;
 typedef struct struct_state_machine state_machine;
 
+//Output
+typedef struct struct_string_builder string_builder;
+
+//Simulation
+typedef struct struct_simulator simulator;
+
+typedef enum {
+	encoding_binary=0,
+	encoding_onehot,
+	encoding_gray,
+	encoding_error
+} state_encoding;
+
+//Reports
+typedef enum {
+	format_text=0,
+	format_json,
+	format_error
+} report_format;
+
 
 
 #endif /* GLOBAL_H_ */
@@ -12,167 +12,64 @@
 #include <stdlib.h>
 #include "global.h"
 #include "logger.h"
-#include "netlist_reader.h"
-#include "circuit.h"
-#include "state_machine.h"
-#include "file_writer.h"
+#include "options.h"
+#include "trace.h"
+#include "synthesis.h"
+#include "batch.h"
+#include "server.h"
+#include "client.h"
+#include "cache.h"
+#include "timeline.h"
 
 int main(int argc, char *argv[]) {
+	hlsyn_options options;
+	const uint32_t async_log_capacity = 65536;
+	int exit_status = EXIT_SUCCESS;
+	job_status status;
 
-	char* c_file = NULL;
-	char* verilog_file = NULL;
-	char* latency_val = NULL;
-
-#if DEBUG_MODE == 1
-
-
-	const uint8_t test_standard = TRUE;
-#define num_standard_cases 7
-	const uint8_t test_latency = TRUE;
-#define num_latency_cases 6
-	const uint8_t test_if = TRUE;
-#define num_if_cases 4
-	const uint8_t test_error = TRUE;
-#define num_error_cases 3
-
-	uint8_t idx;
-	circuit* netlist_circuit;
-	state_machine* sm;
-
-	SetLogFile("./test/output.txt");
-	SetLogLevel(CIRCUIT_ERROR_LEVEL);
-	LogMessage("hlsyn started\n\0", MESSAGE_LEVEL);
-
-
-	if(TRUE == test_standard) {
-		uint8_t latency[num_standard_cases] = {4, 6, 10, 8, 11, 34, 8};
-		for(idx = 0; idx < num_standard_cases; idx++) {
-			//Create structs for iteration
-			netlist_circuit = Circuit_Create(latency[idx]);
-			sm = StateMachine_Create(latency[idx]);
-			//Spell out file names
-			sprintf(c_file, "./test/standard/hls_test%d.c", (idx+1));
-			sprintf(verilog_file, "./test/outputs/standard%d.v", (idx+1));
-
-			if(FAILURE != ReadNetlist(c_file, netlist_circuit)) {
-				if(FAILURE != Circuit_ScheduleForceDirected(netlist_circuit, sm)) {
-					StateMachine_Link(sm);
-					PrintStateMachine(verilog_file, netlist_circuit, sm);
-				} else {
-					LogMessage("ERROR: Scheduling Failed\n", ERROR_LEVEL);
-				}
-			} else {
-				break;
-			}
-			//Destroy structs for this iteration to prep for next
-			Circuit_Destroy(&netlist_circuit);
-			StateMachine_Destroy(&sm);
-		}
-	}
-
-	if(TRUE == test_latency) {
-		uint8_t latency[num_latency_cases] = {4, 9, 2, 4, 6, 6};
-		for(idx = 1; idx <= num_latency_cases; idx++) {
-			netlist_circuit = Circuit_Create(latency[idx]);
-			sm = StateMachine_Create(latency[idx]);
-			sprintf(c_file, "./test/latency/hls_test%d.c", idx);
-			sprintf(verilog_file, "./test/outputs/latency%d.v", idx);
-			if(FAILURE != ReadNetlist(c_file, netlist_circuit)) {
-				if(FAILURE != Circuit_ScheduleForceDirected(netlist_circuit, sm)) {
-					StateMachine_Link(sm);
-					PrintStateMachine(verilog_file, netlist_circuit, sm);
-				} else {
-					LogMessage("ERROR: Scheduling Failed\n", ERROR_LEVEL);
-				}
-			}
-			Circuit_Destroy(&netlist_circuit);
-			StateMachine_Destroy(&sm);
-		}
-	}
-
-	if(TRUE == test_if) {
-		uint8_t latency[num_if_cases] = {4, 4, 8, 4};
-		for(idx = 1; idx <= num_if_cases; idx++) {
-			netlist_circuit = Circuit_Create(latency[idx-1]);
-			sm = StateMachine_Create(latency[idx-1]);
-			sprintf(c_file, "./test/if/hls_test%d.c", idx);
-			sprintf(verilog_file, "./test/outputs/if%d.v", idx);
-			ClearConditionalStack();
-			if(FAILURE != ReadNetlist(c_file, netlist_circuit)) {
-				if(FAILURE != Circuit_ScheduleForceDirected(netlist_circuit, sm)) {
-					StateMachine_Link(sm);
-					PrintStateMachine(verilog_file, netlist_circuit, sm);
-				} else {
-					LogMessage("ERROR: Scheduling Failed\n", ERROR_LEVEL);
-				}
-
-			}
-			Circuit_Destroy(&netlist_circuit);
-			StateMachine_Destroy(&sm);
-		}
-	}
-
-	if(TRUE == test_error) {
-		uint8_t latency[num_error_cases] = {10, 10, 10}; //Doesn't matter just for function calls
-		for(idx = 1; idx <= num_error_cases; idx++) {
-			netlist_circuit = Circuit_Create(latency[idx]);
-			sm = StateMachine_Create(latency[idx]);
-			sprintf(c_file, "./test/error/hls_test%d.c", idx);
-			sprintf(verilog_file, "./test/outputs/error%d.v", idx);
-			if(FAILURE != ReadNetlist(c_file, netlist_circuit)) {
-				if(FAILURE != Circuit_ScheduleForceDirected(netlist_circuit, sm)) {
-					StateMachine_Link(sm);
-					PrintStateMachine(verilog_file, netlist_circuit, sm);
-				} else {
-					LogMessage("ERROR: Scheduling Failed\n", ERROR_LEVEL);
-				}
-			}
-			Circuit_Destroy(&netlist_circuit);
-			StateMachine_Destroy(&sm);
-		}
+	if(SUCCESS != Options_Parse(&options, argc, argv)) {
+		Options_PrintUsage();
+		return FAILURE;
 	}
 
-	CloseLog();
-
-	return EXIT_SUCCESS;
-
-#else
-
-	int latency;
-
-	if(argc < 4) {
-		printf("ERROR: Not enough arguments.\n");
-		return FAILURE;
+	SetLogFile(options.log_file);
+	SetLogLevel(options.log_level);
+	if(TRUE == options.async_log && SUCCESS != StartAsyncLog(async_log_capacity)) {
+		printf("ERROR: Cannot start the log writer thread.\n");
 	}
-	else if (argc > 4) {
-		printf("ERROR: Too many arguments.\n");
+	LOG_MESSAGE(MESSAGE_LEVEL, "hlsyn started\n");
+	if(SUCCESS != Trace_Configure(options.trace_dir, options.trace_artifacts) ||
+			SUCCESS != Cache_Configure(options.cache_dir, options.cache_size) ||
+			(NULL != options.trace_events_file && SUCCESS != Timeline_Open(options.trace_events_file))) {
+		CloseLog();
 		return FAILURE;
 	}
-	else {
-		c_file = argv[1];
-		latency_val = argv[2];
-		verilog_file = argv[3];
-		latency = atoi(latency_val);
-	}
-
-	SetLogFile(NULL);
-	SetLogLevel(CIRCUIT_ERROR_LEVEL);
-	LogMessage("hlsyn started\n\0", MESSAGE_LEVEL);
-
-	circuit* netlist_circuit = Circuit_Create(latency);
-	state_machine* sm = StateMachine_Create(latency);
+	Timeline_NameThread("main");
 
-	if(SUCCESS == ReadNetlist(c_file, netlist_circuit)) {
-		if(SUCCESS == Circuit_ScheduleForceDirected(netlist_circuit, sm)) {
-			StateMachine_Link(sm);
-			PrintStateMachine(verilog_file, netlist_circuit, sm);
+	if(NULL != options.batch_file) {
+		if(SUCCESS != Batch_Run(options.batch_file, options.num_workers, stdout)) {
+			exit_status = EXIT_FAILURE;
+		}
+	} else if(NULL != options.server_socket) {
+		if(SUCCESS != Server_Run(options.server_socket, options.num_workers)) {
+			exit_status = EXIT_FAILURE;
+		}
+	} else {
+		status = (NULL != options.connect_socket) ? Client_Run(options.connect_socket, &options, stdout) : Synthesis_Run(&options, stdout);
+		if(job_success != status) {
+			exit_status = EXIT_FAILURE;
 		}
 	}
 
+	if(TRUE == Cache_IsEnabled() && NULL == options.batch_file && NULL == options.server_socket) {
+		cache_stats stats;
+		Cache_GetStats(&stats);
+		LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Cache %s\n", (0 < stats.hits) ? "hit" : ((0 < stats.misses) ? "miss" : "not used"));
+	}
+	if(SUCCESS != Timeline_Close()) exit_status = EXIT_FAILURE;
 	CloseLog();
-	Circuit_Destroy(&netlist_circuit);
-
-	return EXIT_SUCCESS;
+	Trace_Configure(NULL, trace_none);
+	Cache_Configure(NULL, 0);
 
-#endif
+	return exit_status;
 }
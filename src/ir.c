@@ -0,0 +1,474 @@
+/*
+ * ir.c
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ir.h"
+#include "circuit.h"
+#include "component.h"
+#include "net.h"
+#include "state.h"
+#include "state_machine.h"
+#include "logger.h"
+
+#define IR_FNV_OFFSET 2166136261u
+#define IR_FNV_PRIME 16777619u
+#define IR_MAX_BRANCHES 8 //Outputs of one if/else component
+#define IR_MAX_IDS 0xFFFF
+
+typedef struct {
+	FILE* fp;
+	uint32_t checksum;
+	uint8_t error;
+} ir_stream;
+
+typedef struct {
+	const void* address;
+	uint16_t id;
+} ir_index;
+
+static void Ir_Hash(ir_stream* stream, const uint8_t* data, size_t size);
+static void Ir_PutBytes(ir_stream* stream, const void* data, size_t size);
+static void Ir_PutU8(ir_stream* stream, uint8_t value);
+static void Ir_PutU16(ir_stream* stream, uint16_t value);
+static void Ir_PutNet(ir_stream* stream, net* cur_net);
+static void Ir_GetBytes(ir_stream* stream, void* data, size_t size);
+static uint8_t Ir_GetU8(ir_stream* stream);
+static uint16_t Ir_GetU16(ir_stream* stream);
+static net* Ir_GetNet(ir_stream* stream);
+static int Ir_CompareAddress(const void* a, const void* b);
+static int32_t Ir_FindId(ir_index* index, uint32_t num_entries, const void* address);
+
+static void Ir_Hash(ir_stream* stream, const uint8_t* data, size_t size) {
+	size_t idx;
+	for(idx = 0; idx < size; idx++) {
+		stream->checksum = (stream->checksum ^ data[idx]) * IR_FNV_PRIME;
+	}
+}
+
+static void Ir_PutBytes(ir_stream* stream, const void* data, size_t size) {
+	if(size != fwrite(data, 1, size, stream->fp)) stream->error = TRUE;
+	Ir_Hash(stream, (const uint8_t*) data, size);
+}
+
+static void Ir_PutU8(ir_stream* stream, uint8_t value) {
+	Ir_PutBytes(stream, &value, 1);
+}
+
+static void Ir_PutU16(ir_stream* stream, uint16_t value) {
+	uint8_t bytes[2] = {(uint8_t) (value & 0xFF), (uint8_t) (value >> 8)};
+	Ir_PutBytes(stream, bytes, 2);
+}
+
+static void Ir_PutNet(ir_stream* stream, net* cur_net) {
+	const char* name = Net_GetName(cur_net);
+	size_t length = strlen(name);
+	if(UINT16_MAX < length) {
+		stream->error = TRUE;
+		return;
+	}
+	Ir_PutU16(stream, (uint16_t) length);
+	Ir_PutBytes(stream, name, length);
+	Ir_PutU8(stream, (uint8_t) Net_GetType(cur_net));
+	Ir_PutU8(stream, (uint8_t) Net_GetSign(cur_net));
+	Ir_PutU8(stream, Net_GetWidth(cur_net));
+	Ir_PutU8(stream, Net_GetUsage(cur_net));
+}
+
+//A short read leaves zeros and marks the stream, callers check once per record
+static void Ir_GetBytes(ir_stream* stream, void* data, size_t size) {
+	if(TRUE == stream->error || size != fread(data, 1, size, stream->fp)) {
+		stream->error = TRUE;
+		memset(data, 0, size);
+		return;
+	}
+	Ir_Hash(stream, (const uint8_t*) data, size);
+}
+
+static uint8_t Ir_GetU8(ir_stream* stream) {
+	uint8_t value;
+	Ir_GetBytes(stream, &value, 1);
+	return value;
+}
+
+static uint16_t Ir_GetU16(ir_stream* stream) {
+	uint8_t bytes[2];
+	Ir_GetBytes(stream, bytes, 2);
+	return (uint16_t) (bytes[0] | (bytes[1] << 8));
+}
+
+static net* Ir_GetNet(ir_stream* stream) {
+	char* name;
+	uint16_t length;
+	uint8_t type, sign, width, usage;
+	net* new_net = NULL;
+	length = Ir_GetU16(stream);
+	name = (char*) malloc((size_t) length + 1);
+	if(NULL == name) {
+		stream->error = TRUE;
+		return NULL;
+	}
+	Ir_GetBytes(stream, name, length);
+	name[length] = '\0';
+	type = Ir_GetU8(stream);
+	sign = Ir_GetU8(stream);
+	width = Ir_GetU8(stream);
+	usage = Ir_GetU8(stream);
+	if(FALSE == stream->error && 0 < length && type < net_error && sign < sign_error && 0 < width && 64 >= width && 0 < usage) {
+		new_net = Net_Create(name, (net_type) type, (net_sign) sign, width);
+		Net_SetUsage(new_net, usage);
+	}
+	free(name);
+	return new_net;
+}
+
+static int Ir_CompareAddress(const void* a, const void* b) {
+	const ir_index* entry_a = (const ir_index*) a;
+	const ir_index* entry_b = (const ir_index*) b;
+	if(entry_a->address < entry_b->address) return -1;
+	return (entry_a->address > entry_b->address) ? 1 : 0;
+}
+
+static int32_t Ir_FindId(ir_index* index, uint32_t num_entries, const void* address) {
+	ir_index key = {.address = address, .id = 0};
+	ir_index* found = (ir_index*) bsearch(&key, index, num_entries, sizeof(ir_index), Ir_CompareAddress);
+	return (NULL != found) ? (int32_t) found->id : -1;
+}
+
+//Writes circ to fp, with the schedule held by sm and the components when sm is not NULL
+uint8_t Ir_Write(FILE* fp, circuit* circ, state_machine* sm) {
+	ir_stream stream = {.fp = fp, .checksum = IR_FNV_OFFSET, .error = FALSE};
+	uint16_t num_nets, num_components, comp_idx, op_idx, num_ops, cycle;
+	uint32_t idx, num_ids, max_ids;
+	uint8_t port_idx, latency, asap, alap;
+	uint8_t checksum[4];
+	int32_t id;
+	net** nets;
+	ir_index* net_index;
+	ir_index* component_index;
+	component* cur_component;
+	component_schedule schedule;
+	port cur_port;
+	state* cur_state;
+
+	if(NULL == fp || NULL == circ) return FAILURE;
+	num_nets = Circuit_GetNumNet(circ);
+	num_components = Circuit_GetNumComponent(circ);
+	latency = (NULL != sm) ? StateMachine_GetLatency(sm) : 0;
+	max_ids = num_nets + IR_MAX_BRANCHES * (uint32_t) num_components + 1;
+	nets = (net**) malloc(max_ids * sizeof(net*));
+	net_index = (ir_index*) malloc(max_ids * sizeof(ir_index));
+	component_index = (ir_index*) malloc((num_components + 1) * sizeof(ir_index));
+	if(NULL == nets || NULL == net_index || NULL == component_index) {
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR(Ir_Write): Out of memory\n");
+		free(nets);
+		free(net_index);
+		free(component_index);
+		return FAILURE;
+	}
+
+	//Number the netlist first, then the branch nets owned by if/else components in component order
+	num_ids = 0;
+	for(idx = 0; idx < num_nets; idx++) {
+		nets[num_ids] = Circuit_GetNet(circ, idx);
+		num_ids++;
+	}
+	for(comp_idx = 0; comp_idx < num_components; comp_idx++) {
+		cur_component = Circuit_GetComponent(circ, comp_idx);
+		component_index[comp_idx].address = cur_component;
+		component_index[comp_idx].id = comp_idx;
+		if(component_if_else == Component_GetType(cur_component)) {
+			for(port_idx = 0; port_idx < Component_GetNumOutputs(cur_component); port_idx++) {
+				nets[num_ids] = Component_GetOutputPort(cur_component, port_idx).port_net;
+				num_ids++;
+			}
+		}
+	}
+	if(num_ids > IR_MAX_IDS) {
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR(Ir_Write): Too many nets\n");
+		stream.error = TRUE;
+		num_ids = 0;
+	}
+	for(idx = 0; idx < num_ids; idx++) {
+		net_index[idx].address = nets[idx];
+		net_index[idx].id = (uint16_t) idx;
+	}
+	qsort(net_index, num_ids, sizeof(ir_index), Ir_CompareAddress);
+	qsort(component_index, num_components, sizeof(ir_index), Ir_CompareAddress);
+
+	if(FALSE == stream.error) {
+		Ir_PutBytes(&stream, IR_MAGIC, 4);
+		Ir_PutU8(&stream, IR_VERSION);
+		Ir_PutU8(&stream, (NULL != sm) ? IR_HAS_SCHEDULE : 0);
+		Ir_PutU8(&stream, latency);
+		Ir_PutU16(&stream, num_nets);
+		Ir_PutU16(&stream, num_components);
+		for(idx = 0; idx < num_nets; idx++) {
+			Ir_PutNet(&stream, nets[idx]);
+		}
+	}
+	for(comp_idx = 0; comp_idx < num_components && FALSE == stream.error; comp_idx++) {
+		cur_component = Circuit_GetComponent(circ, comp_idx);
+		Ir_PutU8(&stream, (uint8_t) Component_GetType(cur_component));
+		Ir_PutU8(&stream, Component_GetNumInputs(cur_component));
+		Ir_PutU8(&stream, Component_GetNumOutputs(cur_component));
+		for(port_idx = 0; port_idx < Component_GetNumInputs(cur_component); port_idx++) {
+			cur_port = Component_GetInputPort(cur_component, port_idx);
+			id = Ir_FindId(net_index, num_ids, cur_port.port_net);
+			if(id < 0) {
+				LOG_MESSAGE(ERROR_LEVEL, "ERROR(Ir_Write): Component input is not a net of the circuit\n");
+				stream.error = TRUE;
+				break;
+			}
+			Ir_PutU16(&stream, (uint16_t) id);
+			Ir_PutU8(&stream, (uint8_t) cur_port.type);
+		}
+		for(port_idx = 0; port_idx < Component_GetNumOutputs(cur_component) && FALSE == stream.error; port_idx++) {
+			cur_port = Component_GetOutputPort(cur_component, port_idx);
+			Ir_PutU8(&stream, (uint8_t) cur_port.type);
+			if(component_if_else == Component_GetType(cur_component)) {
+				Ir_PutNet(&stream, cur_port.port_net);
+			} else {
+				id = Ir_FindId(net_index, num_ids, cur_port.port_net);
+				if(id < 0 || id >= num_nets) {
+					LOG_MESSAGE(ERROR_LEVEL, "ERROR(Ir_Write): Component output is not a net of the netlist\n");
+					stream.error = TRUE;
+				}
+				Ir_PutU16(&stream, (uint16_t) id);
+			}
+		}
+	}
+
+	if(NULL != sm && FALSE == stream.error) {
+		for(comp_idx = 0; comp_idx < num_components; comp_idx++) {
+			Component_GetSchedule(Circuit_GetComponent(circ, comp_idx), &schedule);
+			Ir_PutU8(&stream, schedule.cycle_started_asap);
+			Ir_PutU8(&stream, schedule.cycle_started_alap);
+			Ir_PutU8(&stream, schedule.time_frame[0]);
+			Ir_PutU8(&stream, schedule.time_frame[1]);
+			Ir_PutU8(&stream, schedule.cycle_scheduled);
+			Ir_PutU8(&stream, schedule.is_scheduled);
+		}
+		for(idx = 0; idx < num_ids; idx++) {
+			Net_GetScheduleCycles(nets[idx], &asap, &alap);
+			Ir_PutU8(&stream, asap);
+			Ir_PutU8(&stream, alap);
+		}
+		for(cycle = 1; cycle <= latency && FALSE == stream.error; cycle++) {
+			cur_state = StateMachine_GetCycle(sm, (uint8_t) cycle);
+			num_ops = State_GetNumOperations(cur_state);
+			Ir_PutU16(&stream, num_ops);
+			for(op_idx = 0; op_idx < num_ops; op_idx++) {
+				id = Ir_FindId(component_index, num_components, State_GetOperation(cur_state, op_idx));
+				if(id < 0) {
+					LOG_MESSAGE(ERROR_LEVEL, "ERROR(Ir_Write): Scheduled operation is not a component of the circuit\n");
+					stream.error = TRUE;
+					break;
+				}
+				Ir_PutU16(&stream, (uint16_t) id);
+			}
+		}
+	}
+
+	checksum[0] = (uint8_t) (stream.checksum & 0xFF);
+	checksum[1] = (uint8_t) ((stream.checksum >> 8) & 0xFF);
+	checksum[2] = (uint8_t) ((stream.checksum >> 16) & 0xFF);
+	checksum[3] = (uint8_t) (stream.checksum >> 24);
+	if(FALSE == stream.error && 4 != fwrite(checksum, 1, 4, fp)) stream.error = TRUE;
+	free(nets);
+	free(net_index);
+	free(component_index);
+	return (FALSE == stream.error) ? SUCCESS : FAILURE;
+}
+
+uint8_t Ir_WriteFile(char* file_name, circuit* circ, state_machine* sm) {
+	uint8_t ret_value;
+	FILE* fp = fopen(file_name, "wb");
+	if(NULL == fp) {
+		LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "Error: Cannot open IR file %s\n", file_name);
+		return FAILURE;
+	}
+	ret_value = Ir_Write(fp, circ, sm);
+	if(0 != fclose(fp)) ret_value = FAILURE;
+	if(SUCCESS != ret_value) {
+		LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "Error: Cannot write IR file %s\n", file_name);
+	}
+	return ret_value;
+}
+
+//TRUE when the next byte of fp starts an IR image, nothing is consumed
+uint8_t Ir_IsIr(FILE* fp) {
+	int first;
+	if(NULL == fp) return FALSE;
+	first = getc(fp);
+	if(EOF == first) return FALSE;
+	ungetc(first, fp);
+	return ((char) first == IR_MAGIC[0]) ? TRUE : FALSE;
+}
+
+//Rebuilds the circuit written by Ir_Write into the empty circ. The schedule is restored into the empty sm when
+//the image has one for the latency of sm, restored then tells whether the circuit still has to be scheduled.
+uint8_t Ir_Read(FILE* fp, circuit* circ, state_machine* sm, uint8_t* restored) {
+	ir_stream stream = {.fp = fp, .checksum = IR_FNV_OFFSET, .error = FALSE};
+	char magic[4];
+	uint8_t version, flags, latency, num_inputs, num_outputs, port_idx, type, apply, asap, alap;
+	uint8_t stored[4];
+	uint16_t num_nets, num_components, comp_idx, op_idx, num_ops, cycle, id;
+	uint32_t idx, num_ids, max_ids;
+	uint32_t expected;
+	const char* error = NULL;
+	net** nets = NULL;
+	net* new_net;
+	component* new_component;
+	component* driver;
+	component_schedule schedule;
+
+	if(NULL != restored) *restored = FALSE;
+	if(NULL == fp || NULL == circ) return FAILURE;
+	Ir_GetBytes(&stream, magic, 4);
+	version = Ir_GetU8(&stream);
+	flags = Ir_GetU8(&stream);
+	latency = Ir_GetU8(&stream);
+	num_nets = Ir_GetU16(&stream);
+	num_components = Ir_GetU16(&stream);
+	if(TRUE == stream.error || 0 != memcmp(magic, IR_MAGIC, 4)) {
+		error = "Not an IR file";
+	} else if(IR_VERSION != version) {
+		error = "Unsupported IR version";
+	} else {
+		max_ids = num_nets + IR_MAX_BRANCHES * (uint32_t) num_components + 1;
+		nets = (net**) malloc(max_ids * sizeof(net*));
+		if(NULL == nets) error = "Out of memory";
+	}
+
+	num_ids = 0;
+	for(idx = 0; idx < num_nets && NULL == error; idx++) {
+		new_net = Ir_GetNet(&stream);
+		if(NULL == new_net || net_conditional == Net_GetType(new_net)) {
+			Net_Destroy(&new_net);
+			error = "Invalid net";
+			break;
+		}
+		Circuit_AddNet(circ, new_net);
+		if(Circuit_GetNumNet(circ) != idx + 1) {
+			Net_Destroy(&new_net);
+			error = "Too many nets";
+			break;
+		}
+		nets[num_ids] = new_net;
+		num_ids++;
+	}
+
+	//Ports are added in their original order so every net gets its receivers back in the same order
+	for(comp_idx = 0; comp_idx < num_components && NULL == error; comp_idx++) {
+		type = Ir_GetU8(&stream);
+		num_inputs = Ir_GetU8(&stream);
+		num_outputs = Ir_GetU8(&stream);
+		new_component = (type < component_unknown) ? Component_Create((component_type) type) : NULL;
+		if(TRUE == stream.error || NULL == new_component || IR_MAX_BRANCHES < num_inputs || IR_MAX_BRANCHES < num_outputs) {
+			Component_Destroy(&new_component);
+			error = "Invalid component";
+			break;
+		}
+		Circuit_AddComponent(circ, new_component);
+		if(Circuit_GetNumComponent(circ) != comp_idx + 1) {
+			Component_Destroy(&new_component);
+			error = "Too many components";
+			break;
+		}
+		for(port_idx = 0; port_idx < num_inputs; port_idx++) {
+			id = Ir_GetU16(&stream);
+			type = Ir_GetU8(&stream);
+			if(TRUE == stream.error || id >= num_ids || type >= port_error) {
+				error = "Invalid component input";
+				break;
+			}
+			if(port_if == type || port_else == type) { //Branch inputs name the if/else component they depend on
+				driver = Net_GetDriver(nets[id]);
+				if(NULL == driver || component_if_else != Component_GetType(driver)) {
+					error = "Invalid branch input";
+					break;
+				}
+			}
+			Component_AddInputPort(new_component, nets[id], (port_type) type);
+		}
+		for(port_idx = 0; port_idx < num_outputs && NULL == error; port_idx++) {
+			type = Ir_GetU8(&stream);
+			if(type >= port_error) {
+				error = "Invalid component output";
+			} else if(component_if_else == Component_GetType(new_component)) {
+				new_net = Ir_GetNet(&stream);
+				if(NULL == new_net || net_conditional != Net_GetType(new_net) || num_ids >= IR_MAX_IDS) {
+					Net_Destroy(&new_net);
+					error = "Invalid branch net";
+				} else {
+					Component_AddOutputPort(new_component, new_net, (port_type) type);
+					nets[num_ids] = new_net;
+					num_ids++;
+				}
+			} else {
+				id = Ir_GetU16(&stream);
+				if(TRUE == stream.error || id >= num_nets) {
+					error = "Invalid component output";
+				} else {
+					Component_AddOutputPort(new_component, nets[id], (port_type) type);
+				}
+			}
+		}
+	}
+
+	apply = (NULL != sm && latency == StateMachine_GetLatency(sm)) ? TRUE : FALSE;
+	if(NULL == error && 0 != (flags & IR_HAS_SCHEDULE)) {
+		if(FALSE == apply) {
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG(Ir_Read): Schedule for latency %u ignored\n", latency);
+		}
+		for(comp_idx = 0; comp_idx < num_components; comp_idx++) {
+			schedule.cycle_started_asap = Ir_GetU8(&stream);
+			schedule.cycle_started_alap = Ir_GetU8(&stream);
+			schedule.time_frame[0] = Ir_GetU8(&stream);
+			schedule.time_frame[1] = Ir_GetU8(&stream);
+			schedule.cycle_scheduled = Ir_GetU8(&stream);
+			schedule.is_scheduled = Ir_GetU8(&stream);
+			if(TRUE == apply) Component_SetSchedule(Circuit_GetComponent(circ, comp_idx), &schedule);
+		}
+		for(idx = 0; idx < num_ids; idx++) {
+			asap = Ir_GetU8(&stream);
+			alap = Ir_GetU8(&stream);
+			if(TRUE == apply) Net_SetScheduleCycles(nets[idx], asap, alap);
+		}
+		for(cycle = 1; cycle <= latency && NULL == error; cycle++) {
+			num_ops = Ir_GetU16(&stream);
+			for(op_idx = 0; op_idx < num_ops; op_idx++) {
+				id = Ir_GetU16(&stream);
+				if(TRUE == stream.error || id >= num_components) {
+					error = "Invalid schedule";
+					break;
+				}
+				if(TRUE == apply && SUCCESS != StateMachine_RestoreOperation(sm, Circuit_GetComponent(circ, id), (uint8_t) cycle)) {
+					error = "Cannot restore schedule";
+					break;
+				}
+			}
+		}
+	}
+
+	if(NULL == error) {
+		expected = stream.checksum;
+		if(4 != fread(stored, 1, 4, fp) || TRUE == stream.error ||
+				expected != ((uint32_t) stored[0] | ((uint32_t) stored[1] << 8) | ((uint32_t) stored[2] << 16) | ((uint32_t) stored[3] << 24))) {
+			error = "Checksum mismatch";
+		}
+	}
+	free(nets);
+	if(NULL != error) {
+		LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR(Ir_Read): %s\n", error);
+		return FAILURE;
+	}
+	if(NULL != restored && TRUE == apply && 0 != (flags & IR_HAS_SCHEDULE)) *restored = TRUE;
+	return SUCCESS;
+}
@@ -0,0 +1,35 @@
+/*
+ * ir.h
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#ifndef IR_H_
+#define IR_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "global.h"
+
+//Binary image of a parsed circuit and optionally its schedule, read back without parsing or scheduling.
+//All numbers are little endian.
+//Header:    magic 0x89 'H' 'I' 'R', u8 version, u8 flags, u8 latency of the schedule (0 without one),
+//           u16 nets, u16 components
+//Net:       u16 name length, name, u8 type, u8 sign, u8 width, u8 usage
+//Component: u8 type, u8 inputs, u8 outputs, per input u16 net and u8 port type, per output u8 port type
+//           followed by u16 net, or by a net record for the branch nets an if/else component owns
+//           Net numbers count the netlist first, then branch nets in the order they appear.
+//Schedule:  per component u8 asap, alap, time frame start, time frame end, cycle, scheduled flag,
+//           per net u8 asap and alap cycle, per cycle 1..latency u16 operations and a u16 component each
+//Trailer:   u32 FNV-1a checksum of everything before it
+#define IR_MAGIC "\x89HIR"
+#define IR_VERSION 2
+#define IR_HAS_SCHEDULE 0x01
+
+uint8_t Ir_Write(FILE* fp, circuit* circ, state_machine* sm);
+uint8_t Ir_WriteFile(char* file_name, circuit* circ, state_machine* sm);
+uint8_t Ir_IsIr(FILE* fp);
+uint8_t Ir_Read(FILE* fp, circuit* circ, state_machine* sm, uint8_t* restored);
+
+#endif /* IR_H_ */
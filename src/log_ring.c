@@ -0,0 +1,530 @@
+/*
+ * log_ring.c
+ *
+ *  Created on: Dec 11, 2020
+ *      Author: cwhos
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include "log_ring.h"
+
+#define LOG_RECORD_PAYLOAD 232 //Makes a record four cache lines
+#define LOG_RECORD_SPILLED 0xFFFF //Length of a record whose text did not fit, the payload holds a heap pointer to it
+
+typedef enum {
+	arg_signed=0,
+	arg_unsigned,
+	arg_char,
+	arg_double,
+	arg_string,
+	arg_pointer,
+	arg_percent,
+	arg_unsupported
+} log_arg;
+
+typedef enum {
+	length_none=0,
+	length_hh,
+	length_h,
+	length_l,
+	length_ll,
+	length_j,
+	length_z,
+	length_t,
+	length_L
+} log_length;
+
+typedef struct {
+	const char* start; //The '%' of the conversion
+	const char* modifier; //First character after flags, width and precision
+	const char* end; //One past the conversion character
+	log_arg kind;
+	log_length length;
+} log_conversion;
+
+typedef struct {
+	atomic_size_t sequence; //Equal to the ring position when free, position + 1 once the record is published
+	const char* format; //NULL when the payload holds finished text
+	uint16_t length;
+	uint8_t level;
+	unsigned char payload[LOG_RECORD_PAYLOAD];
+} log_record;
+
+_Static_assert(0 == sizeof(log_record) % 64, "log records must fill whole cache lines");
+
+typedef struct struct_log_ring {
+	log_record* records;
+	size_t mask;
+	char pad_producer[64]; //Keeps the producer and consumer positions on separate cache lines
+	atomic_size_t enqueue_pos;
+	char pad_consumer[64];
+	size_t dequeue_pos; //Only touched by the consumer
+	atomic_uint_least64_t full_waits;
+} log_ring;
+
+static const char* LogRing_NextConversion(const char* cur, log_conversion* conv);
+static log_record* LogRing_Claim(log_ring* self, size_t* position);
+static void LogRing_Publish(log_record* record, size_t position);
+static void LogRing_Format(log_record* record, FILE* output_file);
+static void LogRing_Spill(log_record* record, char* text);
+
+log_ring* LogRing_Create(uint32_t capacity) {
+	log_ring* new_ring = NULL;
+	size_t num_records = 2;
+	size_t idx;
+	if(capacity >= 2 && capacity <= 0x1000000) {
+		while(num_records < capacity) num_records *= 2;
+		new_ring = (log_ring*) calloc(1, sizeof(log_ring));
+		if(NULL != new_ring) {
+			new_ring->records = (log_record*) aligned_alloc(64, num_records * sizeof(log_record));
+			if(NULL == new_ring->records) {
+				free(new_ring);
+				return NULL;
+			}
+			new_ring->mask = num_records - 1;
+			for(idx = 0; idx < num_records; idx++) {
+				atomic_init(&new_ring->records[idx].sequence, idx);
+			}
+			atomic_init(&new_ring->enqueue_pos, 0);
+			atomic_init(&new_ring->full_waits, 0);
+			new_ring->dequeue_pos = 0;
+		}
+	}
+	return new_ring;
+}
+
+//Finds the next conversion specification after cur and returns the character following it, NULL at the end
+static const char* LogRing_NextConversion(const char* cur, log_conversion* conv) {
+	while('\0' != *cur && '%' != *cur) cur++;
+	if('\0' == *cur) return NULL;
+	conv->start = cur;
+	conv->length = length_none;
+	cur++;
+	while('-' == *cur || '+' == *cur || ' ' == *cur || '#' == *cur || '0' == *cur) cur++;
+	if('*' == *cur) {
+		conv->kind = arg_unsupported; //Widths passed as arguments are rare enough to format on the caller
+		conv->modifier = cur;
+		conv->end = cur + 1;
+		return conv->end;
+	}
+	while(*cur >= '0' && *cur <= '9') cur++;
+	if('.' == *cur) {
+		cur++;
+		if('*' == *cur) {
+			conv->kind = arg_unsupported;
+			conv->modifier = cur;
+			conv->end = cur + 1;
+			return conv->end;
+		}
+		while(*cur >= '0' && *cur <= '9') cur++;
+	}
+	conv->modifier = cur;
+	switch(*cur) {
+	case 'h':
+		cur++;
+		if('h' == *cur) {
+			cur++;
+			conv->length = length_hh;
+		} else {
+			conv->length = length_h;
+		}
+		break;
+	case 'l':
+		cur++;
+		if('l' == *cur) {
+			cur++;
+			conv->length = length_ll;
+		} else {
+			conv->length = length_l;
+		}
+		break;
+	case 'j':
+		cur++;
+		conv->length = length_j;
+		break;
+	case 'z':
+		cur++;
+		conv->length = length_z;
+		break;
+	case 't':
+		cur++;
+		conv->length = length_t;
+		break;
+	case 'L':
+		cur++;
+		conv->length = length_L;
+		break;
+	default:
+		break;
+	}
+	switch(*cur) {
+	case 'd':
+	case 'i':
+		conv->kind = arg_signed;
+		break;
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+		conv->kind = arg_unsigned;
+		break;
+	case 'c':
+		conv->kind = (length_none == conv->length) ? arg_char : arg_unsupported;
+		break;
+	case 'f':
+	case 'F':
+	case 'e':
+	case 'E':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		conv->kind = arg_double;
+		break;
+	case 's':
+		conv->kind = (length_none == conv->length) ? arg_string : arg_unsupported;
+		break;
+	case 'p':
+		conv->kind = arg_pointer;
+		break;
+	case '%':
+		conv->kind = arg_percent;
+		break;
+	default:
+		conv->kind = arg_unsupported;
+		break;
+	}
+	if('\0' == *cur) {
+		conv->kind = arg_unsupported;
+		conv->end = cur;
+	} else {
+		conv->end = cur + 1;
+	}
+	return conv->end;
+}
+
+static log_record* LogRing_Claim(log_ring* self, size_t* position) {
+	log_record* record;
+	size_t pos = atomic_load_explicit(&self->enqueue_pos, memory_order_relaxed);
+	size_t seq;
+	for(;;) {
+		record = &self->records[pos & self->mask];
+		seq = atomic_load_explicit(&record->sequence, memory_order_acquire);
+		if(seq == pos) {
+			if(atomic_compare_exchange_weak_explicit(&self->enqueue_pos, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+				*position = pos;
+				return record;
+			}
+		} else if((intptr_t) (seq - pos) < 0) {
+			//The consumer has not freed this slot yet. Messages are never dropped, a full ring waits for the writer.
+			atomic_fetch_add_explicit(&self->full_waits, 1, memory_order_relaxed);
+			sched_yield();
+			pos = atomic_load_explicit(&self->enqueue_pos, memory_order_relaxed);
+		} else {
+			pos = atomic_load_explicit(&self->enqueue_pos, memory_order_relaxed);
+		}
+	}
+}
+
+static void LogRing_Publish(log_record* record, size_t position) {
+	atomic_store_explicit(&record->sequence, position + 1, memory_order_release);
+}
+
+//Text longer than the payload stays whole on the heap, the consumer writes and frees it
+static void LogRing_Spill(log_record* record, char* text) {
+	record->format = NULL;
+	record->length = LOG_RECORD_SPILLED;
+	memcpy(record->payload, &text, sizeof(text));
+}
+
+//Copies the arguments format consumes into a record. A message whose arguments do not fit the record, or that
+//uses a conversion the consumer cannot replay, is formatted here instead, on the heap when it is too long.
+uint8_t LogRing_Push(log_ring* self, uint8_t level, const char* format, va_list args) {
+	log_record* record;
+	size_t position;
+	size_t used = 0;
+	size_t str_length;
+	int text_length;
+	char* text;
+	const char* cur;
+	const char* str;
+	log_conversion conv;
+	int64_t signed_value;
+	uint64_t unsigned_value;
+	double double_value;
+	void* pointer_value;
+	uint8_t fits = TRUE;
+	va_list replay, spill;
+
+	if(NULL == self || NULL == format) return FAILURE;
+	record = LogRing_Claim(self, &position);
+
+	va_copy(replay, args);
+	va_copy(spill, args);
+	cur = format;
+	while(TRUE == fits && NULL != (cur = LogRing_NextConversion(cur, &conv))) {
+		switch(conv.kind) {
+		case arg_signed:
+		case arg_char:
+			switch(conv.length) {
+			case length_l:
+				signed_value = va_arg(args, long);
+				break;
+			case length_ll:
+				signed_value = va_arg(args, long long);
+				break;
+			case length_j:
+				signed_value = va_arg(args, intmax_t);
+				break;
+			case length_z:
+				signed_value = (int64_t) va_arg(args, size_t);
+				break;
+			case length_t:
+				signed_value = va_arg(args, ptrdiff_t);
+				break;
+			default:
+				signed_value = va_arg(args, int);
+				if(length_h == conv.length) signed_value = (short) signed_value;
+				if(length_hh == conv.length) signed_value = (signed char) signed_value;
+				break;
+			}
+			if(used + sizeof(signed_value) > LOG_RECORD_PAYLOAD) {
+				fits = FALSE;
+			} else {
+				memcpy(&record->payload[used], &signed_value, sizeof(signed_value));
+				used += sizeof(signed_value);
+			}
+			break;
+		case arg_unsigned:
+			switch(conv.length) {
+			case length_l:
+				unsigned_value = va_arg(args, unsigned long);
+				break;
+			case length_ll:
+				unsigned_value = va_arg(args, unsigned long long);
+				break;
+			case length_j:
+				unsigned_value = va_arg(args, uintmax_t);
+				break;
+			case length_z:
+				unsigned_value = va_arg(args, size_t);
+				break;
+			case length_t:
+				unsigned_value = (uint64_t) va_arg(args, ptrdiff_t);
+				break;
+			default:
+				unsigned_value = va_arg(args, unsigned int);
+				if(length_h == conv.length) unsigned_value = (unsigned short) unsigned_value;
+				if(length_hh == conv.length) unsigned_value = (unsigned char) unsigned_value;
+				break;
+			}
+			if(used + sizeof(unsigned_value) > LOG_RECORD_PAYLOAD) {
+				fits = FALSE;
+			} else {
+				memcpy(&record->payload[used], &unsigned_value, sizeof(unsigned_value));
+				used += sizeof(unsigned_value);
+			}
+			break;
+		case arg_double:
+			double_value = (length_L == conv.length) ? (double) va_arg(args, long double) : va_arg(args, double);
+			if(used + sizeof(double_value) > LOG_RECORD_PAYLOAD) {
+				fits = FALSE;
+			} else {
+				memcpy(&record->payload[used], &double_value, sizeof(double_value));
+				used += sizeof(double_value);
+			}
+			break;
+		case arg_pointer:
+			pointer_value = va_arg(args, void*);
+			if(used + sizeof(pointer_value) > LOG_RECORD_PAYLOAD) {
+				fits = FALSE;
+			} else {
+				memcpy(&record->payload[used], &pointer_value, sizeof(pointer_value));
+				used += sizeof(pointer_value);
+			}
+			break;
+		case arg_string:
+			//Names belong to nets that can be freed before the writer runs, so the characters are copied
+			str = va_arg(args, const char*);
+			if(NULL == str) str = "(null)";
+			str_length = strlen(str) + 1;
+			if(used + str_length > LOG_RECORD_PAYLOAD) {
+				fits = FALSE;
+			} else {
+				memcpy(&record->payload[used], str, str_length);
+				used += str_length;
+			}
+			break;
+		case arg_percent:
+			break;
+		default:
+			fits = FALSE;
+			break;
+		}
+	}
+
+	record->level = level;
+	if(TRUE == fits) {
+		record->format = format;
+		record->length = (uint16_t) used;
+	} else {
+		record->format = NULL;
+		text_length = vsnprintf((char*) record->payload, LOG_RECORD_PAYLOAD, format, replay);
+		if(text_length >= LOG_RECORD_PAYLOAD && NULL != (text = (char*) malloc((size_t) text_length + 1))) {
+			vsnprintf(text, (size_t) text_length + 1, format, spill);
+			LogRing_Spill(record, text);
+		} else {
+			record->length = (uint16_t) strlen((char*) record->payload);
+		}
+	}
+	va_end(replay);
+	va_end(spill);
+	LogRing_Publish(record, position);
+	return SUCCESS;
+}
+
+uint8_t LogRing_PushText(log_ring* self, uint8_t level, const char* text) {
+	log_record* record;
+	size_t position;
+	size_t length;
+	char* spilled_text;
+	if(NULL == self || NULL == text) return FAILURE;
+	record = LogRing_Claim(self, &position);
+	record->level = level;
+	length = strlen(text);
+	if(length >= LOG_RECORD_PAYLOAD && NULL != (spilled_text = (char*) malloc(length + 1))) {
+		memcpy(spilled_text, text, length + 1);
+		LogRing_Spill(record, spilled_text);
+		LogRing_Publish(record, position);
+		return SUCCESS;
+	}
+	if(length > LOG_RECORD_PAYLOAD - 1) length = LOG_RECORD_PAYLOAD - 1; //Only when out of memory
+	memcpy(record->payload, text, length);
+	record->payload[length] = '\0';
+	record->format = NULL;
+	record->length = (uint16_t) length;
+	LogRing_Publish(record, position);
+	return SUCCESS;
+}
+
+//Replays the format of the record against the stored arguments, one conversion at a time
+static void LogRing_Format(log_record* record, FILE* output_file) {
+	const char* cur;
+	const char* next;
+	const char* segment;
+	log_conversion conv;
+	char spec[32];
+	size_t spec_length;
+	size_t used = 0;
+	int64_t signed_value;
+	uint64_t unsigned_value;
+	double double_value;
+	void* pointer_value;
+	char* text;
+
+	if(NULL == record->format && LOG_RECORD_SPILLED == record->length) {
+		memcpy(&text, record->payload, sizeof(text));
+		fputs(text, output_file);
+		return;
+	}
+	if(NULL == record->format) {
+		fwrite(record->payload, 1, record->length, output_file);
+		return;
+	}
+	segment = record->format;
+	cur = record->format;
+	while(NULL != (next = LogRing_NextConversion(cur, &conv))) {
+		fwrite(segment, 1, (size_t) (conv.start - segment), output_file);
+		segment = conv.end;
+		cur = next;
+		if(arg_percent == conv.kind) {
+			fputc('%', output_file);
+			continue;
+		}
+		//Flags, width and precision as written, integers always widened to long long
+		spec_length = (size_t) (conv.modifier - conv.start);
+		if(spec_length > sizeof(spec) - 4) spec_length = sizeof(spec) - 4;
+		memcpy(spec, conv.start, spec_length);
+		if(arg_signed == conv.kind || arg_unsigned == conv.kind) {
+			spec[spec_length++] = 'l';
+			spec[spec_length++] = 'l';
+		}
+		spec[spec_length++] = conv.end[-1];
+		spec[spec_length] = '\0';
+
+		switch(conv.kind) {
+		case arg_signed:
+			memcpy(&signed_value, &record->payload[used], sizeof(signed_value));
+			used += sizeof(signed_value);
+			fprintf(output_file, spec, (long long) signed_value);
+			break;
+		case arg_char:
+			memcpy(&signed_value, &record->payload[used], sizeof(signed_value));
+			used += sizeof(signed_value);
+			fprintf(output_file, spec, (int) signed_value);
+			break;
+		case arg_unsigned:
+			memcpy(&unsigned_value, &record->payload[used], sizeof(unsigned_value));
+			used += sizeof(unsigned_value);
+			fprintf(output_file, spec, (unsigned long long) unsigned_value);
+			break;
+		case arg_double:
+			memcpy(&double_value, &record->payload[used], sizeof(double_value));
+			used += sizeof(double_value);
+			fprintf(output_file, spec, double_value);
+			break;
+		case arg_pointer:
+			memcpy(&pointer_value, &record->payload[used], sizeof(pointer_value));
+			used += sizeof(pointer_value);
+			fprintf(output_file, spec, pointer_value);
+			break;
+		case arg_string:
+			fprintf(output_file, spec, (const char*) &record->payload[used]);
+			used += strlen((const char*) &record->payload[used]) + 1;
+			break;
+		default:
+			break;
+		}
+	}
+	fputs(segment, output_file);
+}
+
+//Consumer side, writes the oldest published record. Returns FALSE when there is none.
+uint8_t LogRing_Pop(log_ring* self, FILE* output_file) {
+	log_record* record;
+	size_t seq;
+	char* text;
+	if(NULL == self) return FALSE;
+	record = &self->records[self->dequeue_pos & self->mask];
+	seq = atomic_load_explicit(&record->sequence, memory_order_acquire);
+	if(seq != self->dequeue_pos + 1) return FALSE;
+	if(NULL != output_file) LogRing_Format(record, output_file);
+	if(NULL == record->format && LOG_RECORD_SPILLED == record->length) {
+		memcpy(&text, record->payload, sizeof(text));
+		free(text);
+	}
+	atomic_store_explicit(&record->sequence, self->dequeue_pos + self->mask + 1, memory_order_release);
+	self->dequeue_pos++;
+	return TRUE;
+}
+
+uint64_t LogRing_GetFullWaits(log_ring* self) {
+	uint64_t ret_value = 0;
+	if(NULL != self) {
+		ret_value = atomic_load_explicit(&self->full_waits, memory_order_relaxed);
+	}
+	return ret_value;
+}
+
+void LogRing_Destroy(log_ring** self) {
+	if(NULL != self && NULL != *self) {
+		while(TRUE == LogRing_Pop(*self, NULL)); //Frees the text of records nobody wrote
+		free((*self)->records);
+		free(*self);
+		*self = NULL;
+	}
+}
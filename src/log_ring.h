@@ -0,0 +1,29 @@
+/*
+ * log_ring.h
+ *
+ *  Created on: Dec 11, 2020
+ *      Author: cwhos
+ */
+
+#ifndef LOG_RING_H_
+#define LOG_RING_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include "global.h"
+
+//Bounded multi-producer single-consumer queue of binary log records. Producers store the format pointer
+//and the raw arguments, the consumer does all formatting. Formats must be string literals.
+typedef struct struct_log_ring log_ring;
+
+log_ring* LogRing_Create(uint32_t capacity);
+
+uint8_t LogRing_Push(log_ring* self, uint8_t level, const char* format, va_list args);
+uint8_t LogRing_PushText(log_ring* self, uint8_t level, const char* text);
+uint8_t LogRing_Pop(log_ring* self, FILE* output_file);
+uint64_t LogRing_GetFullWaits(log_ring* self);
+
+void LogRing_Destroy(log_ring** self);
+
+#endif /* LOG_RING_H_ */
@@ -5,35 +5,172 @@
  *      Author: cwhos
  */
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
 #include "logger.h"
+#include "log_ring.h"
 
 typedef struct struct_logger {
 	FILE* log_file;
+	uint8_t owns_file; //Closed with the logger, stdout and files handed to Logger_Create are not
 	uint8_t minimum_log_level;
+	log_ring* ring; //Non-NULL while the background writer owns log_file
+	pthread_t writer;
+	atomic_int stop_writer;
 } logger;
 
-logger dpgen_log;
+static logger dpgen_log;
+//Logger of the job running on this thread, NULL for the default context
+static _Thread_local logger* bound_log = NULL;
+
+static void* Logger_WriterThread(void* context);
+
+static logger* Logger_Current() {
+	return (NULL != bound_log) ? bound_log : &dpgen_log;
+}
+
+//Logs to log_file, which stays open when the logger is destroyed
+logger* Logger_Create(FILE* log_file, uint8_t level) {
+	logger* self = (logger*) calloc(1, sizeof(logger));
+	if(NULL != self) {
+		self->log_file = log_file;
+		self->owns_file = FALSE;
+		self->minimum_log_level = level;
+		self->ring = NULL;
+	}
+	return self;
+}
+
+//Logs to a new file at file_path, closed when the logger is destroyed
+logger* Logger_Open(char* file_path, uint8_t level) {
+	logger* self;
+	FILE* log_file = fopen(file_path, "w+");
+	if(NULL == log_file) return NULL;
+	self = Logger_Create(log_file, level);
+	if(NULL == self) {
+		fclose(log_file);
+		return NULL;
+	}
+	self->owns_file = TRUE;
+	return self;
+}
+
+//Sends the calling thread's messages to self, NULL returns it to the default context. Returns the previous logger.
+logger* Logger_Bind(logger* self) {
+	logger* prev_log = bound_log;
+	bound_log = self;
+	return prev_log;
+}
+
+void Logger_Destroy(logger** self) {
+	if(NULL != self && NULL != *self) {
+		if(bound_log == *self) bound_log = NULL;
+		if(TRUE == (*self)->owns_file) fclose((*self)->log_file);
+		free(*self);
+		*self = NULL;
+	}
+}
 
 void SetLogFile(char* file_path) {
+	FILE* log_file = stdout;
 	if(NULL != file_path) {
-		dpgen_log.log_file = fopen(file_path, "w+");
-		if(NULL == dpgen_log.log_file) {
+		log_file = fopen(file_path, "w+");
+		if(NULL == log_file) {
 		   printf("Error: Logging Failure\r\n");
 		   return;
 		}
-	} else {
-		dpgen_log.log_file = stdout;
 	}
+	if(TRUE == dpgen_log.owns_file) fclose(dpgen_log.log_file);
+	dpgen_log.log_file = log_file;
+	dpgen_log.owns_file = (stdout != log_file) ? TRUE : FALSE;
 }
 void SetLogLevel(uint8_t level) {
 	dpgen_log.minimum_log_level = level;
 }
+
+uint8_t LogIsEnabled(uint8_t level) {
+	logger* self = Logger_Current();
+	return (level >= self->minimum_log_level && NULL != self->log_file) ? TRUE : FALSE;
+}
+
+//Formats without checking the level, LOG_MESSAGE checks LogIsEnabled before calling it
+void LogPrintf(uint8_t level, const char* format, ...) {
+	va_list args;
+	logger* self = Logger_Current();
+	va_start(args, format);
+	if(NULL != self->ring) {
+		LogRing_Push(self->ring, level, format, args);
+	} else {
+		vfprintf(self->log_file, format, args);
+	}
+	va_end(args);
+}
+
+//Writes message unformatted, for text that is already built
 void LogMessage(char* message, uint8_t level) {
-	if(level >= dpgen_log.minimum_log_level) {
-		fprintf(dpgen_log.log_file, message);
+	logger* self = Logger_Current();
+	if(NULL != message && TRUE == LogIsEnabled(level)) {
+		if(NULL != self->ring) {
+			LogRing_PushText(self->ring, level, message);
+		} else {
+			fputs(message, self->log_file);
+		}
 	}
 }
 
+//Drains the ring until asked to stop, the stop flag is read before the last drain so nothing published earlier is lost
+static void* Logger_WriterThread(void* context) {
+	logger* self = (logger*) context;
+	const struct timespec idle_wait = {.tv_sec = 0, .tv_nsec = 1000000};
+	uint8_t stop, wrote;
+	for(;;) {
+		stop = (0 != atomic_load(&self->stop_writer)) ? TRUE : FALSE;
+		wrote = FALSE;
+		while(TRUE == LogRing_Pop(self->ring, self->log_file)) wrote = TRUE;
+		if(TRUE == stop) break;
+		if(FALSE == wrote) {
+			fflush(self->log_file);
+			nanosleep(&idle_wait, NULL);
+		}
+	}
+	fflush(self->log_file);
+	return NULL;
+}
+
+//Hands the default log file to a background writer. Messages are queued as binary records in a ring of capacity
+//entries, a producer only waits for the writer when the ring is full.
+uint8_t StartAsyncLog(uint32_t capacity) {
+	if(NULL != dpgen_log.ring || NULL == dpgen_log.log_file) return FAILURE;
+	dpgen_log.ring = LogRing_Create(capacity);
+	if(NULL == dpgen_log.ring) return FAILURE;
+	atomic_store(&dpgen_log.stop_writer, 0);
+	if(0 != pthread_create(&dpgen_log.writer, NULL, Logger_WriterThread, &dpgen_log)) {
+		LogRing_Destroy(&dpgen_log.ring);
+		return FAILURE;
+	}
+	return SUCCESS;
+}
+
+//Writes every queued message and returns the log file to synchronous writes. Producers must have finished.
+void StopAsyncLog() {
+	if(NULL != dpgen_log.ring) {
+		atomic_store(&dpgen_log.stop_writer, 1);
+		pthread_join(dpgen_log.writer, NULL);
+		LogRing_Destroy(&dpgen_log.ring);
+	}
+}
+
+//Flushes the default context and closes its file unless it is stdout, later messages are discarded
 void CloseLog() {
-	fclose(dpgen_log.log_file);
+	StopAsyncLog();
+	if(TRUE == dpgen_log.owns_file) {
+		fclose(dpgen_log.log_file);
+	} else if(NULL != dpgen_log.log_file) {
+		fflush(dpgen_log.log_file);
+	}
+	dpgen_log.log_file = NULL;
+	dpgen_log.owns_file = FALSE;
 }
@@ -8,11 +8,47 @@
 #ifndef LOGGER_H_
 #define LOGGER_H_
 
+#include <stdio.h>
 #include <stdint.h>
+#include "global.h"
 
+//Messages below this level are removed at compile time, build with -DLOG_COMPILE_LEVEL=ERROR_LEVEL for release
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL MESSAGE_LEVEL
+#endif
+
+#if defined(__GNUC__)
+#define LOG_FORMAT_CHECK __attribute__((format(printf, 2, 3)))
+#else
+#define LOG_FORMAT_CHECK
+#endif
+
+//Checks the level before any argument is formatted, a disabled message costs one comparison. This is the only
+//level check on the way to the log, so LogPrintf is only called through it.
+//Messages go to the logger bound to the calling thread, the default context unless Logger_Bind was called.
+#define LOG_MESSAGE(level, ...) \
+	do { \
+		if((level) >= LOG_COMPILE_LEVEL && TRUE == LogIsEnabled(level)) { \
+			LogPrintf((level), __VA_ARGS__); \
+		} \
+	} while(0)
+
+typedef struct struct_logger logger;
+
+//Per-job contexts, each used by one thread at a time so writing needs no locking
+logger* Logger_Create(FILE* log_file, uint8_t level);
+logger* Logger_Open(char* file_path, uint8_t level);
+logger* Logger_Bind(logger* self);
+void Logger_Destroy(logger** self);
+
+//Default context, and the messages of the logger bound to the calling thread
 void SetLogFile(char* file_path);
 void SetLogLevel(uint8_t level);
+uint8_t LogIsEnabled(uint8_t level);
+void LogPrintf(uint8_t level, const char* format, ...) LOG_FORMAT_CHECK;
 void LogMessage(char* message, uint8_t level);
+uint8_t StartAsyncLog(uint32_t capacity);
+void StopAsyncLog();
 void CloseLog();
 
 
@@ -0,0 +1,410 @@
+/*
+ * model_writer.c
+ *
+ *  Created on: Dec 9, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include "model_writer.h"
+#include "circuit.h"
+#include "component.h"
+#include "net.h"
+#include "resource.h"
+#include "state.h"
+#include "state_machine.h"
+#include "string_builder.h"
+#include "logger.h"
+
+static void CModel_TypeName(net* self, string_builder* sb);
+static void CModel_DeclareField(net* self, string_builder* sb);
+static void CModel_Operand(net* self, net_sign expression_sign, string_builder* sb);
+static void CModel_Amount(net* self, string_builder* sb);
+static void CModel_PrintOperation(component* op, string_builder* sb);
+static void CModel_PrintState(state* cur_state, string_builder* sb, uint8_t latency, const char** conditional_net_name);
+static void CModel_PrintDriver(circuit* circ, string_builder* sb);
+
+static const char* cmodel_helpers =
+	"static inline uint64_t HLSM_Mask(uint64_t value, unsigned width) {\n"
+	"\treturn (width >= 64) ? value : (value & ((1ULL << width) - 1));\n"
+	"}\n"
+	"\n"
+	"static inline int64_t HLSM_Signed(uint64_t value, unsigned width) {\n"
+	"\tvalue = HLSM_Mask(value, width);\n"
+	"\tif(width < 64 && 0 != (value >> (width - 1))) value |= ~0ULL << width;\n"
+	"\treturn (int64_t) value;\n"
+	"}\n"
+	"\n"
+	"/* Division by zero is undefined in the RTL and yields zero here */\n"
+	"static inline uint64_t HLSM_Divide(uint64_t a, uint64_t b, unsigned width, int is_signed, int remainder) {\n"
+	"\tint64_t signed_a, signed_b;\n"
+	"\tif(0 == HLSM_Mask(b, width)) return 0;\n"
+	"\tif(is_signed) {\n"
+	"\t\tsigned_a = HLSM_Signed(a, width);\n"
+	"\t\tsigned_b = HLSM_Signed(b, width);\n"
+	"\t\tif(-1 == signed_b) return remainder ? 0 : (0 - a);\n"
+	"\t\treturn (uint64_t) (remainder ? (signed_a % signed_b) : (signed_a / signed_b));\n"
+	"\t}\n"
+	"\ta = HLSM_Mask(a, width);\n"
+	"\tb = HLSM_Mask(b, width);\n"
+	"\treturn remainder ? (a % b) : (a / b);\n"
+	"}\n"
+	"\n"
+	"static inline uint64_t HLSM_ShiftLeft(uint64_t a, uint64_t amount, unsigned width) {\n"
+	"\treturn (amount >= width) ? 0 : (a << amount);\n"
+	"}\n"
+	"\n"
+	"static inline uint64_t HLSM_ShiftRight(uint64_t a, uint64_t amount, unsigned width) {\n"
+	"\treturn (amount >= width) ? 0 : (HLSM_Mask(a, width) >> amount);\n"
+	"}\n"
+	"\n";
+
+//Writes a standalone C file that models the state machine printed by PrintStateMachine clock for clock.
+//Every value is kept in the smallest C integer that holds it, sign extended or masked to its exact width.
+void PrintCModel(char* file_name, circuit* circ, state_machine* sm) {
+	FILE* fp;
+	uint16_t idx;
+	net* cur_net;
+	string_builder* model_buffer;
+	const char* conditional_net_name = "0";
+
+	if(NULL == file_name || NULL == circ || NULL == sm) return;
+	LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Writing C model to file\n");
+
+	fp = fopen(file_name, "w+");
+	if(NULL == fp) {
+		LOG_MESSAGE(ERROR_LEVEL, "Error: Cannot open C model file\n");
+		return;
+	}
+	model_buffer = StringBuilder_Create(4096);
+	if(NULL == model_buffer) {
+		LOG_MESSAGE(ERROR_LEVEL, "Error: Cannot allocate output buffer\n");
+		fclose(fp);
+		return;
+	}
+
+	StringBuilder_AppendString(model_buffer, "/*\n");
+	StringBuilder_AppendString(model_buffer, " * Cycle-accurate C model of module HLSM, generated by hlsyn.\n");
+	StringBuilder_AppendString(model_buffer, " *\n");
+	StringBuilder_AppendString(model_buffer, " * HLSM_Step advances the model by one rising Clk edge and samples Rst and Start like the RTL.\n");
+	StringBuilder_AppendString(model_buffer, " * HLSM_Run starts one computation from the idle state and clocks it to Done.\n");
+	StringBuilder_AppendString(model_buffer, " * Build with -DHLSM_MAIN for a driver that reads one input vector per line from stdin.\n");
+	StringBuilder_AppendString(model_buffer, " */\n\n");
+	StringBuilder_AppendString(model_buffer, "#include <stdint.h>\n");
+	StringBuilder_AppendString(model_buffer, "#include <string.h>\n\n");
+
+	StringBuilder_AppendString(model_buffer, "typedef struct {\n");
+	StringBuilder_AppendString(model_buffer, "\tuint8_t Rst;\n");
+	StringBuilder_AppendString(model_buffer, "\tuint8_t Start;\n");
+	for(idx = 0; idx < Circuit_GetNumNet(circ); idx++) {
+		cur_net = Circuit_GetNet(circ, idx);
+		if(net_input == Net_GetType(cur_net) && 1 == Net_GetUsage(cur_net)) CModel_DeclareField(cur_net, model_buffer);
+	}
+	StringBuilder_AppendString(model_buffer, "\tuint8_t Done;\n");
+	for(idx = 0; idx < Circuit_GetNumNet(circ); idx++) {
+		cur_net = Circuit_GetNet(circ, idx);
+		if(net_output == Net_GetType(cur_net) && 1 == Net_GetUsage(cur_net)) CModel_DeclareField(cur_net, model_buffer);
+	}
+	for(idx = 0; idx < Circuit_GetNumNet(circ); idx++) {
+		cur_net = Circuit_GetNet(circ, idx);
+		if(net_input != Net_GetType(cur_net) && net_output != Net_GetType(cur_net) &&
+				1 == Net_GetUsage(cur_net) && NULL == Net_GetStorage(cur_net)) { //Shared variables live in their register
+			CModel_DeclareField(cur_net, model_buffer);
+		}
+	}
+	StringBuilder_AppendString(model_buffer, "\tuint16_t state;\n");
+	StringBuilder_AppendString(model_buffer, "} HLSM_Model;\n\n");
+
+	StringBuilder_AppendString(model_buffer, cmodel_helpers);
+
+	StringBuilder_AppendString(model_buffer, "void HLSM_Init(HLSM_Model* m) {\n");
+	StringBuilder_AppendString(model_buffer, "\tmemset(m, 0, sizeof(HLSM_Model));\n");
+	StringBuilder_AppendString(model_buffer, "}\n\n");
+
+	//Every assignment reads the registers of m and writes next, like the non-blocking assignments of the RTL
+	StringBuilder_AppendString(model_buffer, "void HLSM_Step(HLSM_Model* m) {\n");
+	StringBuilder_AppendString(model_buffer, "\tHLSM_Model next = *m;\n");
+	StringBuilder_AppendString(model_buffer, "\tif(m->Rst) {\n");
+	StringBuilder_AppendString(model_buffer, "\t\tnext.state = 0;\n");
+	StringBuilder_AppendString(model_buffer, "\t} else {\n");
+	StringBuilder_AppendString(model_buffer, "\t\tswitch(m->state) {\n");
+	for(idx = 0; idx < StateMachine_GetNumStates(sm); idx++) {
+		CModel_PrintState(StateMachine_GetState(sm, idx), model_buffer, StateMachine_GetLatency(sm), &conditional_net_name);
+	}
+	StringBuilder_AppendString(model_buffer, "\t\tdefault:\n");
+	StringBuilder_AppendString(model_buffer, "\t\t\tbreak;\n");
+	StringBuilder_AppendString(model_buffer, "\t\t}\n");
+	StringBuilder_AppendString(model_buffer, "\t}\n");
+	StringBuilder_AppendString(model_buffer, "\t*m = next;\n");
+	StringBuilder_AppendString(model_buffer, "}\n\n");
+
+	//Between Start and Done no state repeats, a longer run means the model is stuck
+	StringBuilder_AppendString(model_buffer, "/* Returns the clock edges from the one that samples Start to the one that raises Done, 0 if Done never rises */\n");
+	StringBuilder_AppendString(model_buffer, "uint32_t HLSM_Run(HLSM_Model* m) {\n");
+	StringBuilder_AppendString(model_buffer, "\tuint32_t cycles = 0;\n");
+	StringBuilder_AppendString(model_buffer, "\tm->Rst = 0;\n");
+	StringBuilder_AppendString(model_buffer, "\tm->Start = 1;\n");
+	StringBuilder_AppendString(model_buffer, "\tdo {\n");
+	StringBuilder_AppendString(model_buffer, "\t\tHLSM_Step(m);\n");
+	StringBuilder_AppendString(model_buffer, "\t\tm->Start = 0;\n");
+	StringBuilder_AppendString(model_buffer, "\t\tcycles++;\n");
+	StringBuilder_AppendString(model_buffer, "\t} while(0 == m->Done && cycles < ");
+	StringBuilder_AppendUnsigned(model_buffer, (unsigned long long) StateMachine_GetNumStates(sm) + 1);
+	StringBuilder_AppendString(model_buffer, ");\n");
+	StringBuilder_AppendString(model_buffer, "\treturn m->Done ? cycles : 0;\n");
+	StringBuilder_AppendString(model_buffer, "}\n");
+
+	CModel_PrintDriver(circ, model_buffer);
+
+	if(SUCCESS != StringBuilder_Flush(model_buffer, fp)) {
+		LOG_MESSAGE(ERROR_LEVEL, "Error: Could not print to file\n");
+	}
+	StringBuilder_Destroy(&model_buffer);
+	fclose(fp);
+}
+
+static void CModel_TypeName(net* self, string_builder* sb) {
+	uint8_t width = Net_GetWidth(self);
+	StringBuilder_AppendString(sb, (net_signed == Net_GetSign(self)) ? "int" : "uint");
+	if(width <= 8) {
+		StringBuilder_AppendString(sb, "8_t");
+	} else if(width <= 16) {
+		StringBuilder_AppendString(sb, "16_t");
+	} else if(width <= 32) {
+		StringBuilder_AppendString(sb, "32_t");
+	} else {
+		StringBuilder_AppendString(sb, "64_t");
+	}
+}
+
+static void CModel_DeclareField(net* self, string_builder* sb) {
+	StringBuilder_AppendChar(sb, '\t');
+	CModel_TypeName(self, sb);
+	StringBuilder_AppendChar(sb, ' ');
+	StringBuilder_AppendString(sb, Net_GetNameRef(self));
+	StringBuilder_AppendString(sb, "; /* ");
+	StringBuilder_AppendUnsigned(sb, Net_GetWidth(self));
+	StringBuilder_AppendString(sb, (net_signed == Net_GetSign(self)) ? " bit signed */\n" : " bit */\n");
+}
+
+//Fields hold sign extended values, so a cast extends signed operands. An unsigned expression
+//zero extends every operand, signed ones are masked back to their width first.
+static void CModel_Operand(net* self, net_sign expression_sign, string_builder* sb) {
+	if(NULL == self) {
+		StringBuilder_AppendChar(sb, '0');
+	} else if(net_signed == Net_GetSign(self) && net_signed != expression_sign) {
+		StringBuilder_AppendString(sb, "HLSM_Mask((uint64_t) m->");
+		StringBuilder_AppendString(sb, Net_GetNameRef(self));
+		StringBuilder_AppendString(sb, ", ");
+		StringBuilder_AppendUnsigned(sb, Net_GetWidth(self));
+		StringBuilder_AppendChar(sb, ')');
+	} else {
+		StringBuilder_AppendString(sb, "(uint64_t) m->");
+		StringBuilder_AppendString(sb, Net_GetNameRef(self));
+	}
+}
+
+//Shift amounts are self-determined and always unsigned
+static void CModel_Amount(net* self, string_builder* sb) {
+	CModel_Operand(self, net_unsigned, sb);
+}
+
+static void CModel_PrintOperation(component* op, string_builder* sb) {
+	uint8_t idx;
+	port cur_port;
+	net* a = NULL;
+	net* b = NULL;
+	net* control = NULL;
+	net* out = Component_GetOutputPort(op, 0).port_net;
+	port_type relation = Component_GetOutputPort(op, 0).type;
+	net_sign sign = Resource_GetOperationSign(op);
+	uint8_t width = Resource_GetOperationWidth(op);
+	const char* symbol = NULL;
+
+	if(NULL == out) return;
+	for(idx = 0; idx < Component_GetNumInputs(op); idx++) {
+		cur_port = Component_GetInputPort(op, idx);
+		if(datapath_a == cur_port.type) a = cur_port.port_net;
+		else if(datapath_b == cur_port.type) b = cur_port.port_net;
+		else if(mux_sel == cur_port.type || shift_amount == cur_port.type) control = cur_port.port_net;
+	}
+
+	StringBuilder_AppendString(sb, "\t\t\tnext.");
+	StringBuilder_AppendString(sb, Net_GetNameRef(out));
+	StringBuilder_AppendString(sb, " = (");
+	CModel_TypeName(out, sb);
+	StringBuilder_AppendString(sb, (net_signed == Net_GetSign(out)) ? ") HLSM_Signed(" : ") HLSM_Mask(");
+
+	switch(Component_GetType(op)) {
+	case load_register:
+		CModel_Operand(a, Net_GetSign(a), sb);
+		break;
+	case adder:
+	case incrementer:
+		symbol = " + ";
+		break;
+	case subtractor:
+	case decrementer:
+		symbol = " - ";
+		break;
+	case multiplier:
+		symbol = " * ";
+		break;
+	case divider:
+	case modulo:
+		StringBuilder_AppendString(sb, "HLSM_Divide(");
+		CModel_Operand(a, sign, sb);
+		StringBuilder_AppendString(sb, ", ");
+		CModel_Operand(b, sign, sb);
+		StringBuilder_AppendString(sb, ", ");
+		StringBuilder_AppendUnsigned(sb, width);
+		StringBuilder_AppendString(sb, (net_signed == sign) ? ", 1" : ", 0");
+		StringBuilder_AppendString(sb, (modulo == Component_GetType(op)) ? ", 1)" : ", 0)");
+		break;
+	case comparator:
+		StringBuilder_AppendString(sb, (net_signed == sign) ? "(uint64_t) (HLSM_Signed(" : "(uint64_t) (HLSM_Mask(");
+		CModel_Operand(a, sign, sb);
+		StringBuilder_AppendString(sb, ", ");
+		StringBuilder_AppendUnsigned(sb, width);
+		if(greater_than_out == relation) StringBuilder_AppendString(sb, ") > ");
+		else if(less_than_out == relation) StringBuilder_AppendString(sb, ") < ");
+		else StringBuilder_AppendString(sb, ") == ");
+		StringBuilder_AppendString(sb, (net_signed == sign) ? "HLSM_Signed(" : "HLSM_Mask(");
+		CModel_Operand(b, sign, sb);
+		StringBuilder_AppendString(sb, ", ");
+		StringBuilder_AppendUnsigned(sb, width);
+		StringBuilder_AppendString(sb, "))");
+		break;
+	case mux2x1:
+		StringBuilder_AppendString(sb, "(m->");
+		StringBuilder_AppendString(sb, Net_GetNameRef(control));
+		StringBuilder_AppendString(sb, " ? ");
+		CModel_Operand(a, sign, sb);
+		StringBuilder_AppendString(sb, " : ");
+		CModel_Operand(b, sign, sb);
+		StringBuilder_AppendChar(sb, ')');
+		break;
+	case shift_left:
+	case shift_right:
+		StringBuilder_AppendString(sb, (shift_left == Component_GetType(op)) ? "HLSM_ShiftLeft(" : "HLSM_ShiftRight(");
+		CModel_Operand(a, sign, sb);
+		StringBuilder_AppendString(sb, ", ");
+		CModel_Amount(control, sb);
+		StringBuilder_AppendString(sb, ", ");
+		StringBuilder_AppendUnsigned(sb, width);
+		StringBuilder_AppendChar(sb, ')');
+		break;
+	default:
+		break;
+	}
+	if(NULL != symbol) {
+		CModel_Operand(a, sign, sb);
+		StringBuilder_AppendString(sb, symbol);
+		if(incrementer == Component_GetType(op) || decrementer == Component_GetType(op)) {
+			StringBuilder_AppendChar(sb, '1');
+		} else {
+			CModel_Operand(b, sign, sb);
+		}
+	}
+	StringBuilder_AppendString(sb, ", ");
+	StringBuilder_AppendUnsigned(sb, Net_GetWidth(out));
+	StringBuilder_AppendString(sb, ");\n");
+}
+
+//Same states, operations and transitions as Print_State, state numbers replace the encoded state codes
+static void CModel_PrintState(state* cur_state, string_builder* sb, uint8_t latency, const char** conditional_net_name) {
+	uint8_t cycle, num_next_state;
+	uint16_t op_idx;
+	component* op;
+	if(NULL == cur_state) return;
+	cycle = State_GetCycle(cur_state);
+	num_next_state = State_GetNumStates(cur_state);
+
+	StringBuilder_AppendString(sb, "\t\tcase ");
+	StringBuilder_AppendUnsigned(sb, State_GetStateNumber(cur_state));
+	StringBuilder_AppendString(sb, ":\n");
+	if(0 == cycle) {
+		StringBuilder_AppendString(sb, "\t\t\tnext.Done = 0;\n");
+		StringBuilder_AppendString(sb, "\t\t\tnext.state = m->Start ? ");
+		StringBuilder_AppendUnsigned(sb, (num_next_state > 0) ? State_GetStateNumber(State_GetNextState(cur_state, 0)) : 0);
+		StringBuilder_AppendString(sb, " : ");
+		StringBuilder_AppendUnsigned(sb, State_GetStateNumber(cur_state));
+		StringBuilder_AppendString(sb, ";\n");
+	} else if(cycle < (latency+1)) {
+		for(op_idx = 0; op_idx < State_GetNumOperations(cur_state); op_idx++) {
+			op = State_GetOperation(cur_state, op_idx);
+			if(component_if_else == Component_GetType(op)) {
+				*conditional_net_name = Net_GetNameRef(Component_GetInputPort(op, 0).port_net);
+			} else {
+				CModel_PrintOperation(op, sb);
+			}
+		}
+		if(1 == num_next_state) {
+			StringBuilder_AppendString(sb, "\t\t\tnext.state = ");
+			StringBuilder_AppendUnsigned(sb, State_GetStateNumber(State_GetNextState(cur_state, 0)));
+			StringBuilder_AppendString(sb, ";\n");
+		} else if(2 == num_next_state) {
+			StringBuilder_AppendString(sb, "\t\t\tnext.state = m->");
+			StringBuilder_AppendString(sb, *conditional_net_name);
+			StringBuilder_AppendString(sb, " ? ");
+			StringBuilder_AppendUnsigned(sb, State_GetStateNumber(State_GetNextState(cur_state, 0)));
+			StringBuilder_AppendString(sb, " : ");
+			StringBuilder_AppendUnsigned(sb, State_GetStateNumber(State_GetNextState(cur_state, 1)));
+			StringBuilder_AppendString(sb, ";\n");
+		}
+	} else if(cycle == latency+1) {
+		StringBuilder_AppendString(sb, "\t\t\tnext.Done = 1;\n");
+		StringBuilder_AppendString(sb, "\t\t\tnext.state = 0;\n");
+	}
+	StringBuilder_AppendString(sb, "\t\t\tbreak;\n");
+}
+
+//Optional main: each line holds the inputs in declaration order, the driver prints the outputs and cycle count
+static void CModel_PrintDriver(circuit* circ, string_builder* sb) {
+	uint16_t idx;
+	net* cur_net;
+	StringBuilder_AppendString(sb, "\n#ifdef HLSM_MAIN\n");
+	StringBuilder_AppendString(sb, "#include <stdio.h>\n");
+	StringBuilder_AppendString(sb, "#include <stdlib.h>\n");
+	StringBuilder_AppendString(sb, "#include <inttypes.h>\n\n");
+	StringBuilder_AppendString(sb, "int main(void) {\n");
+	StringBuilder_AppendString(sb, "\tHLSM_Model model;\n");
+	StringBuilder_AppendString(sb, "\tchar line[4096];\n");
+	StringBuilder_AppendString(sb, "\tchar* cursor;\n");
+	StringBuilder_AppendString(sb, "\tuint32_t cycles;\n");
+	StringBuilder_AppendString(sb, "\twhile(NULL != fgets(line, sizeof(line), stdin)) {\n");
+	StringBuilder_AppendString(sb, "\t\tif('\\n' == line[0] || '#' == line[0]) continue;\n");
+	StringBuilder_AppendString(sb, "\t\tHLSM_Init(&model);\n");
+	StringBuilder_AppendString(sb, "\t\tcursor = line;\n");
+	for(idx = 0; idx < Circuit_GetNumNet(circ); idx++) {
+		cur_net = Circuit_GetNet(circ, idx);
+		if(net_input != Net_GetType(cur_net) || 1 != Net_GetUsage(cur_net)) continue;
+		StringBuilder_AppendString(sb, "\t\tmodel.");
+		StringBuilder_AppendString(sb, Net_GetNameRef(cur_net));
+		StringBuilder_AppendString(sb, " = (");
+		CModel_TypeName(cur_net, sb);
+		StringBuilder_AppendString(sb, (net_signed == Net_GetSign(cur_net)) ? ") HLSM_Signed(" : ") HLSM_Mask(");
+		StringBuilder_AppendString(sb, "strtoull(cursor, &cursor, 0), ");
+		StringBuilder_AppendUnsigned(sb, Net_GetWidth(cur_net));
+		StringBuilder_AppendString(sb, ");\n");
+	}
+	StringBuilder_AppendString(sb, "\t\tcycles = HLSM_Run(&model);\n");
+	for(idx = 0; idx < Circuit_GetNumNet(circ); idx++) {
+		cur_net = Circuit_GetNet(circ, idx);
+		if(net_output != Net_GetType(cur_net) || 1 != Net_GetUsage(cur_net)) continue;
+		StringBuilder_AppendString(sb, "\t\tprintf(\"");
+		StringBuilder_AppendString(sb, Net_GetNameRef(cur_net));
+		if(net_signed == Net_GetSign(cur_net)) {
+			StringBuilder_AppendString(sb, "=%\" PRId64 \" \", (int64_t) model.");
+		} else {
+			StringBuilder_AppendString(sb, "=%\" PRIu64 \" \", (uint64_t) model.");
+		}
+		StringBuilder_AppendString(sb, Net_GetNameRef(cur_net));
+		StringBuilder_AppendString(sb, ");\n");
+	}
+	StringBuilder_AppendString(sb, "\t\tprintf(\"cycles=%\" PRIu32 \"\\n\", cycles);\n");
+	StringBuilder_AppendString(sb, "\t}\n");
+	StringBuilder_AppendString(sb, "\treturn 0;\n");
+	StringBuilder_AppendString(sb, "}\n");
+	StringBuilder_AppendString(sb, "#endif\n");
+}
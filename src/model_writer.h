@@ -0,0 +1,15 @@
+/*
+ * model_writer.h
+ *
+ *  Created on: Dec 9, 2020
+ *      Author: cwhos
+ */
+
+#ifndef MODEL_WRITER_H_
+#define MODEL_WRITER_H_
+
+#include "global.h"
+
+void PrintCModel(char* file_name, circuit* circ, state_machine* sm);
+
+#endif /* MODEL_WRITER_H_ */
@@ -15,38 +15,43 @@
 
 typedef struct struct_net {
 	net_type type;
-	char name[64];
+	char* name;
 	uint8_t width;
 	uint8_t usage;
 	uint8_t is_scheduled;
 	net_sign sign;
 	component* driver;
 	component** receivers;
-	uint8_t num_receivers;
+	uint16_t num_receivers;
+	uint16_t max_receivers;
 	float delay_ns;
 	uint8_t cycle_assigned_asap;
 	uint8_t cycle_assigned_alap;
 	uint8_t cycle_scheduled;
+	net* storage; //Register this value lives in when it shares one with another variable
 } net;
 
-const uint8_t max_receivers = 32;
+const uint16_t initial_receivers = 8;
 
 net* Net_Create(char* name, net_type type, net_sign sign, uint8_t width) {
 
 	net* new_net = (net*) malloc(sizeof(net));
 	if(NULL != new_net) {
-		strcpy(new_net->name, name);
+		new_net->name = (char*) malloc(strlen(name) + 1);
+		if(NULL != new_net->name) strcpy(new_net->name, name);
 		new_net->usage = 1;
 		new_net->type = type;
 		new_net->sign = sign;
 		new_net->width = width;
 		new_net->driver = NULL;
+		new_net->storage = NULL;
 		new_net->delay_ns = -1.0f;
 		new_net->num_receivers = 0;
+		new_net->max_receivers = initial_receivers;
 		new_net->cycle_assigned_alap = 255;
 		new_net->cycle_assigned_asap = 0;
-		new_net->receivers = (component**) malloc(max_receivers * sizeof(component*));
-		if(NULL == new_net->receivers) {
+		new_net->receivers = (component**) malloc(initial_receivers * sizeof(component*));
+		if(NULL == new_net->receivers || NULL == new_net->name) {
 			Net_Destroy(&new_net);
 		}
 	}
@@ -55,9 +60,7 @@ net* Net_Create(char* name, net_type type, net_sign sign, uint8_t width) {
 
 void Net_ResetDelay(net* self) {
 	if(NULL != self) {
-		char log_msg[256];
-		sprintf(log_msg,"MSG: Net %s Delay Reset\n", self->name);
-		LogMessage(log_msg, MESSAGE_LEVEL);
+		LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Net %s Delay Reset\n", self->name);
 		self->delay_ns = -1.0f;
 	}
 }
@@ -77,12 +80,10 @@ uint8_t Net_GetUsage(net* self) {
 }
 
 void Net_SchedulePathASAP(net* self, uint8_t cycle) {
-	uint8_t idx;
+	uint16_t idx;
 	if(NULL != self) {
 		if(cycle > self->cycle_assigned_asap) {
-			char log_msg[256];
-			sprintf(log_msg,"MSG: Net %s assigned at cycle %d\n", self->name, cycle);
-			LogMessage(log_msg, MESSAGE_LEVEL);
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Net %s assigned at cycle %d\n", self->name, cycle);
 
 			self->cycle_assigned_asap = cycle;
 			for(idx = 0; idx < self->num_receivers;idx++) {
@@ -96,9 +97,7 @@ uint8_t Net_SchedulePathALAP(net* self, uint8_t cycle) {
 	uint8_t ret_value = SUCCESS;
 	if(NULL != self) {
 		if(cycle < self->cycle_assigned_alap) {
-			char log_msg[256];
-			sprintf(log_msg,"MSG: Net %s assigned at cycle %d\n", self->name, cycle);
-			LogMessage(log_msg, MESSAGE_LEVEL);
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Net %s assigned at cycle %d\n", self->name, cycle);
 
 			self->cycle_assigned_alap = cycle;
 			if(NULL != self->driver) {
@@ -113,7 +112,8 @@ uint8_t Net_SchedulePathALAP(net* self, uint8_t cycle) {
 
 float Net_CalculateSuccessorForce(net* self, circuit* circ, uint8_t cycle) {
 	if(NULL == self || NULL == circ) return 0.0f;
-	uint8_t idx, cycle_idx, alap_time, asap_time;
+	uint16_t idx;
+	uint8_t cycle_idx, alap_time, asap_time;
 	component* successor = NULL;
 	float successor_force = 0.0f;
 	for(idx = 0; idx < self->num_receivers; idx++) {
@@ -152,7 +152,7 @@ float Net_CalculatePredecessorForce(net* self, circuit* circ, uint8_t cycle) {
 }
 
 void Net_UpdateTimeFrameStart(net* self, uint8_t cycle) {
-	uint8_t idx;
+	uint16_t idx;
 	if(NULL != self) {
 		for(idx = 0; idx < self->num_receivers; idx++) {
 			if(NULL != self->receivers[idx]) {
@@ -178,11 +178,50 @@ uint8_t Net_GetTimeFrameEnd(net* self) {
 	return ret_value;
 }
 
-void Net_GetName(net* self, char* buffer) {
+void Net_GetScheduleCycles(net* self, uint8_t* cycle_asap, uint8_t* cycle_alap) {
+	if(NULL != self && NULL != cycle_asap && NULL != cycle_alap) {
+		*cycle_asap = self->cycle_assigned_asap;
+		*cycle_alap = self->cycle_assigned_alap;
+	}
+}
+
+void Net_SetScheduleCycles(net* self, uint8_t cycle_asap, uint8_t cycle_alap) {
 	if(NULL != self) {
-		strcpy(buffer, self->name);
+		self->cycle_assigned_asap = cycle_asap;
+		self->cycle_assigned_alap = cycle_alap;
+	}
+}
+
+//Declared name, whatever register the net is stored in
+const char* Net_GetName(net* self) {
+	const char* ret_value = "";
+	if(NULL != self) {
+		ret_value = self->name;
+	}
+	return ret_value;
+}
+
+//Name the value is emitted under, nets sharing a register print as the register
+const char* Net_GetNameRef(net* self) {
+	const char* ret_value = "";
+	if(NULL != self) {
+		ret_value = (NULL != self->storage) ? self->storage->name : self->name;
+	}
+	return ret_value;
+}
+
+void Net_SetStorage(net* self, net* storage) {
+	if(NULL != self && self != storage) {
+		self->storage = storage;
 	}
-	return;
+}
+
+net* Net_GetStorage(net* self) {
+	net* ret_value = NULL;
+	if(NULL != self) {
+		ret_value = self->storage;
+	}
+	return ret_value;
 }
 
 net_type Net_GetType(net* self) {
@@ -234,17 +273,26 @@ void Net_AddDriver(net* self, component* new_driver) {
 }
 
 void Net_AddReceiver(net* self, component* new_receiver) {
+	component** new_list;
 	if(NULL != self && NULL != new_receiver) {
-		if(self->num_receivers < max_receivers) {
-			self->receivers[self->num_receivers] = new_receiver;
-			self->num_receivers++;
+		if(self->num_receivers >= self->max_receivers) {
+			new_list = (component**) realloc(self->receivers, 2 * self->max_receivers * sizeof(component*));
+			if(NULL == new_list) {
+				LOG_MESSAGE(ERROR_LEVEL, "ERROR(Net_AddReceiver): Could not grow receiver list\n");
+				return;
+			}
+			self->receivers = new_list;
+			self->max_receivers = 2 * self->max_receivers;
 		}
+		self->receivers[self->num_receivers] = new_receiver;
+		self->num_receivers++;
 	}
 }
 
 void Net_Destroy(net** self) {
 	if(NULL != *self) {
 		free((*self)->receivers);
+		free((*self)->name);
 		free((*self));
 		*self = NULL;
 	}
@@ -13,7 +13,10 @@
 
 net* Net_Create(char* name, net_type type, net_sign sign, uint8_t width);
 
-void Net_GetName(net* self, char* buffer);
+const char* Net_GetName(net* self);
+const char* Net_GetNameRef(net* self);
+void Net_SetStorage(net* self, net* storage);
+net* Net_GetStorage(net* self);
 net_type Net_GetType(net* self);
 net_sign Net_GetSign(net* self);
 uint8_t Net_GetWidth(net* self);
@@ -29,6 +32,8 @@ float Net_CalculatePredecessorForce(net* self, circuit* circ, uint8_t cycle);
 void Net_UpdateTimeFrameStart(net* self, uint8_t cycle);
 void Net_UpdateTimeFrameEnd(net* self, uint8_t cycle);
 uint8_t Net_GetTimeFrameEnd(net* self);
+void Net_GetScheduleCycles(net* self, uint8_t* cycle_asap, uint8_t* cycle_alap);
+void Net_SetScheduleCycles(net* self, uint8_t cycle_asap, uint8_t cycle_alap);
 
 void Net_AddReceiver(net* self, component* new_receiver);
 void Net_AddDriver(net* self, component* new_driver);
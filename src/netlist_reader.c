@@ -10,55 +10,109 @@
 #include "circuit.h"
 #include "logger.h"
 #include "component.h"
+#include "timeline.h"
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
 
-static uint8_t ParseNetlistLine(char* line, circuit* netlist_circuit);
-static uint8_t ParseAssignmentLine(char* first_word, circuit* netlist_circuit);
-static uint8_t ParseDeclarationLine(char* first_word, circuit* netlist_circuit);
+//Everything one parse needs between lines and between words, so files can be read concurrently
+typedef struct {
+	circuit* netlist_circuit;
+	component* condition_stack; //Innermost open if/else
+	uint8_t queue_pop; //A closing brace was read, pop unless an else follows
+	char* word_ptr; //strtok_r position in the current line
+} netlist_parser;
 
-static uint8_t ParseConditionalLine(char* first_word, circuit* netlist_circuit);
-static void ConditionStack_Push(net* cond_net, transition_type type, circuit* circ);
-static void ConditionStack_Pop();
+static char* ReadNetlist_GetLine(char** buff, size_t* buff_size, FILE* fp);
+static char* NextWord(netlist_parser* parser, const char* delimiters);
+static uint8_t ParseNetlistLine(netlist_parser* parser, char* line);
+static uint8_t ParseAssignmentLine(netlist_parser* parser, char* first_word);
+static uint8_t ParseDeclarationLine(netlist_parser* parser, char* first_word);
 
-component* condition_stack = NULL;
-component* prev_condition = NULL;
+static uint8_t ParseConditionalLine(netlist_parser* parser, char* first_word);
+static void ConditionStack_Push(netlist_parser* parser, net* cond_net, transition_type type);
+static void ConditionStack_Pop(netlist_parser* parser);
+static net* ConditionStack_CreateBranchNet(net* cond_net, const char* suffix);
 
 uint8_t ReadNetlist(char* file_name, circuit* netlist_circuit) {
-
-
 	   FILE* fp;
-	   char buff[255];
-	   char message[32];
-	   uint8_t line_number = 1;
-	   uint8_t ret = SUCCESS;
+	   uint8_t ret;
 	   fp = fopen(file_name, "r");
 	   if(NULL == fp) {
-		   printf("Error: File Open\n");
+		   LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "Error: File Open\n");
+		   return FAILURE;
+	   }
+	   ret = ReadNetlistStream(fp, netlist_circuit);
+	   fclose(fp);
+	   return ret;
+}
+
+//Parses netlist text from an open stream, which stays open
+uint8_t ReadNetlistStream(FILE* fp, circuit* netlist_circuit) {
+	   char* buff;
+	   size_t buff_size = 256;
+	   uint32_t line_number = 1;
+	   const uint32_t lines_per_span = 256; //Timeline spans cover batches of lines
+	   uint8_t ret = SUCCESS;
+	   netlist_parser parser = {.netlist_circuit = netlist_circuit, .condition_stack = NULL, .queue_pop = FALSE, .word_ptr = NULL};
+	   if(NULL == fp) return FAILURE;
+	   buff = (char*) malloc(buff_size * sizeof(char));
+	   if(NULL == buff) {
+		   LOG_MESSAGE(ERROR_LEVEL, "ERROR(ReadNetlist): Cannot allocate line buffer\n");
 		   return FAILURE;
 	   }
 
-	   char* fget_rtn = fgets(&buff[0], 250, fp);
+	   Timeline_Begin("parse_lines", NULL);
+	   char* fget_rtn = ReadNetlist_GetLine(&buff, &buff_size, fp);
 	   while(NULL != fget_rtn) {
 		   //Log info
-		   sprintf(message, "MSG: Parsing Line # %d\n", line_number);
-		   LogMessage(&message[0], MESSAGE_LEVEL);
+		   LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Parsing Line # %lu\n", (unsigned long) line_number);
 
-		   ret = ParseNetlistLine(&buff[0], netlist_circuit);
+		   ret = ParseNetlistLine(&parser, buff);
 		   if(SUCCESS != ret) break;
 
-		   fget_rtn = fgets(&buff[0], 250, fp);
+		   if(0 == line_number % lines_per_span) {
+			   Timeline_End("parse_lines");
+			   Timeline_Begin("parse_lines", NULL);
+		   }
+		   fget_rtn = ReadNetlist_GetLine(&buff, &buff_size, fp);
 		   line_number++;
 	   }
+	   Timeline_End("parse_lines");
 
-	   fclose(fp);
+	   free(buff);
 	   return ret;
 }
 
-uint8_t ParseAssignmentLine(char* first_word, circuit* netlist_circuit) {
+//Reads a full line of any length, growing the buffer when fgets fills it
+static char* ReadNetlist_GetLine(char** buff, size_t* buff_size, FILE* fp) {
+	size_t length = 0;
+	char* new_buff;
+	if(NULL == fgets(*buff, (int) *buff_size, fp)) return NULL;
+	length = strlen(*buff);
+	while(length == (*buff_size - 1) && '\n' != (*buff)[length - 1]) {
+		new_buff = (char*) realloc(*buff, (*buff_size * 2) * sizeof(char));
+		if(NULL == new_buff) {
+			LOG_MESSAGE(ERROR_LEVEL, "ERROR(ReadNetlist_GetLine): Cannot grow line buffer\n");
+			return NULL;
+		}
+		*buff = new_buff;
+		*buff_size *= 2;
+		if(NULL == fgets(&(*buff)[length], (int) (*buff_size - length), fp)) break;
+		length += strlen(&(*buff)[length]);
+	}
+	return *buff;
+}
+
+//Next word of the line ParseNetlistLine started on
+static char* NextWord(netlist_parser* parser, const char* delimiters) {
+	return strtok_r(NULL, delimiters, &parser->word_ptr);
+}
+
+uint8_t ParseAssignmentLine(netlist_parser* parser, char* first_word) {
+	circuit* netlist_circuit = parser->netlist_circuit;
 	//Determine inputs, outputs, and component type
 	net* component_nets[4] = {NULL, NULL, NULL, NULL};
 	component_type type;
@@ -69,12 +123,12 @@ uint8_t ParseAssignmentLine(char* first_word, circuit* netlist_circuit) {
 	uint8_t ret = SUCCESS;
 	port_type output_type = datapath_out;
 	port prev_op = {.port_net = NULL, .type = port_prev_op};
-	LogMessage("MSG: Parsing Variable Assignment\n", MESSAGE_LEVEL);
+	LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Parsing Variable Assignment\n");
 	while(NULL != word) {
 		if(1 == word_idx || 3 == word_idx || 5 == word_idx || 7 == word_idx) { //output variable
 			uint8_t port_idx;
 			uint8_t link_ops = TRUE;
-			port cur_condition = Component_GetOutputPort(condition_stack, (0));
+			port cur_condition = Component_GetOutputPort(parser->condition_stack, (0));
 			component* prev_driver;
 			if(1 == word_idx) {
 				component_nets[net_idx] = Circuit_FindNet(netlist_circuit, first_word);
@@ -103,9 +157,9 @@ uint8_t ParseAssignmentLine(char* first_word, circuit* netlist_circuit) {
 				}
 			} else {
 				component_nets[net_idx] = Circuit_FindNet(netlist_circuit, word);
-				port cond_port = Component_GetOutputPort(condition_stack, (Component_GetNumOutputs(condition_stack)-1));
+				port cond_port = Component_GetOutputPort(parser->condition_stack, (Component_GetNumOutputs(parser->condition_stack)-1));
 				//Check if previous usage is exclusive to this one
-				if(NULL != condition_stack) {
+				if(NULL != parser->condition_stack) {
 					if(port_else == cond_port.type) {
 						prev_driver = Net_GetDriver(component_nets[net_idx]);
 						for(port_idx=0; port_idx < Component_GetNumInputs(prev_driver); port_idx++) {
@@ -124,12 +178,12 @@ uint8_t ParseAssignmentLine(char* first_word, circuit* netlist_circuit) {
 					} else if(subtractor == type) {
 						type = decrementer;
 					} else {
-						LogMessage("ERROR: Unknown Component\n", ERROR_LEVEL);
+						LOG_MESSAGE(ERROR_LEVEL, "ERROR: Unknown Component\n");
 						ret = FAILURE;
 						break;
 					}
 				} else {
-					LogMessage("ERROR: Undeclared variable used\n", CIRCUIT_ERROR_LEVEL);
+					LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR: Undeclared variable %s used\n", word);
 					ret = FAILURE;
 					break;
 				}
@@ -137,7 +191,7 @@ uint8_t ParseAssignmentLine(char* first_word, circuit* netlist_circuit) {
 			net_idx++;
 		} else if(2 == word_idx) { //= sign
 			if(0 != strcmp(word, "=")) {
-				LogMessage("ERROR: Syntax - Assignment\n", ERROR_LEVEL);
+				LOG_MESSAGE(ERROR_LEVEL, "ERROR: Syntax - Assignment\n");
 				ret = FAILURE;
 				break;
 			} else {
@@ -146,10 +200,10 @@ uint8_t ParseAssignmentLine(char* first_word, circuit* netlist_circuit) {
 		} else if(4 == word_idx) {
 			type = ReadComponentType(word);
 			if(component_unknown == type) {
-				LogMessage("ERROR: Unknown Component\n", CIRCUIT_ERROR_LEVEL);
+				LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR: Unknown Component\n");
 				ret = FAILURE;
 			} else if(comparator == type) {
-				LogMessage("MSG: Component is comparator\n", MESSAGE_LEVEL);
+				LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Component is comparator\n");
 				if(0 == strcmp("<", word)) {
 					output_type = less_than_out;
 				} else if(0 == strcmp("==", word)) {
@@ -160,18 +214,18 @@ uint8_t ParseAssignmentLine(char* first_word, circuit* netlist_circuit) {
 			}
 		} else if(6 == word_idx) {
 			if(0 != strcmp(":", word)) {
-				LogMessage("ERROR: Mux Syntax\n", ERROR_LEVEL);
+				LOG_MESSAGE(ERROR_LEVEL, "ERROR: Mux Syntax\n");
 				ret = FAILURE;
 				break;
 			} else {
-				LogMessage("MSG: Component is mux\n", MESSAGE_LEVEL);
+				LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Component is mux\n");
 			}
 		} else {
-			LogMessage("ERROR: Syntax\n", ERROR_LEVEL);
+			LOG_MESSAGE(ERROR_LEVEL, "ERROR: Syntax\n");
 			ret = FAILURE;
 			break;
 		}
-		word = strtok(NULL," ,\r\n");
+		word = NextWord(parser, " ,\r\n");
 		word_idx++;
 	}
 
@@ -190,42 +244,42 @@ uint8_t ParseAssignmentLine(char* first_word, circuit* netlist_circuit) {
 			input_ctrl_idx = 1;
 			break;
 		case load_register:
-			LogMessage("MSG: Component is register\n", MESSAGE_LEVEL);
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Component is register\n");
 			output_type = reg_out;
 			break;
 		case shift_left:
-			LogMessage("MSG: Component is SHL\n", MESSAGE_LEVEL);
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Component is SHL\n");
 			control_type = shift_amount;
 			break;
 		case shift_right:
-			LogMessage("MSG: Component is SHR\n", MESSAGE_LEVEL);
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Component is SHR\n");
 			control_type = shift_amount;
 			break;
 		case adder:
-			LogMessage("MSG: Component is +\n", MESSAGE_LEVEL);
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Component is +\n");
 			output_type = sum_out;
 			break;
 		case subtractor:
-			LogMessage("MSG: Component is -\n", MESSAGE_LEVEL);
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Component is -\n");
 			output_type = diff_out;
 			break;
 		case multiplier:
-			LogMessage("MSG: Component is *\n", MESSAGE_LEVEL);
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Component is *\n");
 			output_type = prod_out;
 			break;
 		case divider:
-			LogMessage("MSG: Component is divider\n", MESSAGE_LEVEL);
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Component is divider\n");
 			output_type = quot_out;
 			break;
 		case modulo:
-			LogMessage("MSG: Component is modulo\n", MESSAGE_LEVEL);
+			LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Component is modulo\n");
 			output_type = rem_out;
 			break;
 		default:
 			break;
 		}
-		if(NULL != condition_stack) {
-			port cur_condition = Component_GetOutputPort(condition_stack, (Component_GetNumOutputs(condition_stack)-1));
+		if(NULL != parser->condition_stack) {
+			port cur_condition = Component_GetOutputPort(parser->condition_stack, (Component_GetNumOutputs(parser->condition_stack)-1));
 			Component_AddInputPort(new_component, cur_condition.port_net, cur_condition.type);
 		}
 		if(NULL != prev_op.port_net) {
@@ -237,13 +291,14 @@ uint8_t ParseAssignmentLine(char* first_word, circuit* netlist_circuit) {
 		Component_AddOutputPort(new_component, component_nets[output_idx], output_type);
 		Circuit_AddComponent(netlist_circuit, new_component);
 	} else {
-		LogMessage("ERROR: Component could not be created\n", ERROR_LEVEL);
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR: Component could not be created\n");
 		ret = FAILURE;
 	}
 	return ret;
 }
 
-uint8_t ParseDeclarationLine(char* first_word, circuit* netlist_circuit) {
+uint8_t ParseDeclarationLine(netlist_parser* parser, char* first_word) {
+	circuit* netlist_circuit = parser->netlist_circuit;
 	//Determine width, net type, names
 	char* word;
 	net_type declare_type;
@@ -252,43 +307,44 @@ uint8_t ParseDeclarationLine(char* first_word, circuit* netlist_circuit) {
 	net* new_net;
 	uint8_t ret = SUCCESS;
 
-	LogMessage("MSG: Parsing Net Declaration\n", MESSAGE_LEVEL);
+	LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Parsing Net Declaration\n");
 
 	//Get Declaration Type (i.e. reg, wire, input, output)
 	declare_type = ReadNetType(first_word);
 	if(net_error == declare_type) {
-		LogMessage("ERROR: Unknown Net Type\n", ERROR_LEVEL);
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR: Unknown Net Type\n");
 		return FAILURE;
 	}
 
 	//Determine Declaration sign
-	word = strtok (NULL," ,\r\n");
+	word = NextWord(parser, " ,\r\n");
 	declare_sign = ReadNetSign(word);
 
 	//Determine Declaration Width
 	declare_width = ReadNetWidth(word);
 	if(0 == declare_width) {
-		LogMessage("ERROR: Unknown Net Width\n", ERROR_LEVEL);
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR: Unknown Net Width\n");
 		return FAILURE;
 	}
 
 	//Get all variable declarations in current line
-	word = strtok (NULL," ,\r\n\t");
+	word = NextWord(parser, " ,\r\n\t");
 	while(NULL != word) {
 		if(VARIABLE != CheckWordType(word)) break;
 		if(NULL != Circuit_FindNet(netlist_circuit, word)) { //Declared Variable already exists
-			LogMessage("ERROR: Variable redefined\n", ERROR_LEVEL);
+			LOG_MESSAGE(ERROR_LEVEL, "ERROR: Variable redefined\n");
 			ret = FAILURE;
 			break;
 		}
 		new_net = Net_Create(word, declare_type, declare_sign, declare_width);
 		Circuit_AddNet(netlist_circuit, new_net);
-		word = strtok (NULL," ,\r\n\t");
+		word = NextWord(parser, " ,\r\n\t");
 	}
 	return ret;
 }
 
-uint8_t ParseConditionalLine(char* first_word, circuit* netlist_circuit) {
+uint8_t ParseConditionalLine(netlist_parser* parser, char* first_word) {
+	circuit* netlist_circuit = parser->netlist_circuit;
 	uint8_t ret = SUCCESS;
 	uint8_t word_idx = 0;
 	transition_type type;
@@ -298,32 +354,32 @@ uint8_t ParseConditionalLine(char* first_word, circuit* netlist_circuit) {
 	if(NULL != first_word && NULL != netlist_circuit) {
 		if(0 == strcmp(first_word, "if")) {
 			type = transition_if;
-			word = strtok(NULL," ,\r\n");
+			word = NextWord(parser, " ,\r\n");
 			while(NULL != word) {
 				if((0 == word_idx && 0 == strcmp(word, "(")) || (2 == word_idx && 0 == strcmp(word, ")")) || (3 == word_idx && 0 == strcmp(word, "{"))) {
 					//Do nothing (Expected)
 				} else if(1 == word_idx) {
 					cond_net = Circuit_FindNet(netlist_circuit, word);
 					if(NULL == cond_net) {
-						LogMessage("ERROR(ParseConditionalLine): Undeclared variable used\n", CIRCUIT_ERROR_LEVEL);
+						LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR(ParseConditionalLine): Undeclared variable %s used\n", word);
 						ret = FAILURE;
 						break;
 					} else {
-						ConditionStack_Push(cond_net, type, netlist_circuit);
+						ConditionStack_Push(parser, cond_net, type);
 					}
 				} else {
-					LogMessage("ERROR(ParseConditionalLine): Invalid syntax\n", CIRCUIT_ERROR_LEVEL);
+					LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR(ParseConditionalLine): Invalid syntax\n");
 					ret = FAILURE;
 					break;
 				}
-				word = strtok(NULL," ,\r\n");
+				word = NextWord(parser, " ,\r\n");
 				word_idx++;
 			}
 		} else if(0 == strcmp(first_word, "else")) {
 			type = transition_else;
-			ConditionStack_Push(NULL, type, netlist_circuit);
+			ConditionStack_Push(parser, NULL, type);
 		} else {
-			LogMessage("ERROR(ParseConditionalLine): Invalid syntax\n", CIRCUIT_ERROR_LEVEL);
+			LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR(ParseConditionalLine): Invalid syntax\n");
 			ret = FAILURE;
 		}
 	}
@@ -331,56 +387,56 @@ uint8_t ParseConditionalLine(char* first_word, circuit* netlist_circuit) {
 }
 
 
-uint8_t ParseNetlistLine(char* line, circuit* netlist_circuit) {
+uint8_t ParseNetlistLine(netlist_parser* parser, char* line) {
+	circuit* netlist_circuit = parser->netlist_circuit;
 
 	uint8_t ret = SUCCESS;
 	char* word;
 	word_class word_type;
-	static uint8_t queue_pop = FALSE;
 
 	if(NULL != line) {
-	   word = strtok(line," ,\r\n\t");
+	   word = strtok_r(line," ,\r\n\t", &parser->word_ptr);
 
 	   //First Word determines reading behavior
 	   word_type = CheckWordType(word); //Determine what type of word is (Variable, Net Declarative, Component Declarative, Width Declarative)
 	   switch(word_type) {
 	   case VARIABLE:
 		   //If var exists, assignment, otherwise error
-		   if(TRUE == queue_pop) {
-			   ConditionStack_Pop();
-			   queue_pop = FALSE;
+		   if(TRUE == parser->queue_pop) {
+			   ConditionStack_Pop(parser);
+			   parser->queue_pop = FALSE;
 		   }
 		   if(NULL != Circuit_FindNet(netlist_circuit, word)) {
-			   ret = ParseAssignmentLine(word, netlist_circuit);
+			   ret = ParseAssignmentLine(parser, word);
 		   } else {
-			   LogMessage("ERROR: Undeclared variable used\n", CIRCUIT_ERROR_LEVEL);
+			   LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR: Undeclared variable %s used\n", word);
 			   ret = FAILURE;
 		   }
 		   break;
 	   case NET_DECLARATION:
-		   ret = ParseDeclarationLine(line, netlist_circuit);
+		   ret = ParseDeclarationLine(parser, line);
 		   break;
 	   case COMMENT_DECLARATION:
-		   LogMessage("MSG: Line Ignored - Comment\n", MESSAGE_LEVEL);
+		   LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Line Ignored - Comment\n");
 		   break;
 	   case IF_DECLARATION:
-		   LogMessage("MSG: If Declaration\n", MESSAGE_LEVEL);
-		   if(TRUE == queue_pop) {
-			   ConditionStack_Pop();
-			   queue_pop = FALSE;
+		   LOG_MESSAGE(MESSAGE_LEVEL, "MSG: If Declaration\n");
+		   if(TRUE == parser->queue_pop) {
+			   ConditionStack_Pop(parser);
+			   parser->queue_pop = FALSE;
 		   }
-		   ret = ParseConditionalLine(word, netlist_circuit);
+		   ret = ParseConditionalLine(parser, word);
 		   break;
 	   case ELSE_DECLARATION:
-		   LogMessage("MSG: Else Declaration\n", MESSAGE_LEVEL);
-		   ret = ParseConditionalLine(word, netlist_circuit);
-		   queue_pop = FALSE;
+		   LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Else Declaration\n");
+		   ret = ParseConditionalLine(parser, word);
+		   parser->queue_pop = FALSE;
 		   break;
 	   case CONDITIONAL_END:
-		   queue_pop = TRUE;
+		   parser->queue_pop = TRUE;
 		   break;
 	   default://Error
-		   LogMessage("ERROR: Unknown Line\n", ERROR_LEVEL);
+		   LOG_MESSAGE(ERROR_LEVEL, "ERROR: Unknown Line\n");
 		   ret = FAILURE;
 		   break;
 	   }
@@ -486,52 +542,57 @@ net_sign ReadNetSign(char* word) {
 }
 
 
-void ConditionStack_Push(net* cond_net, transition_type type, circuit* circ) {
+void ConditionStack_Push(netlist_parser* parser, net* cond_net, transition_type type) {
+	circuit* circ = parser->netlist_circuit;
 	component* conditional = NULL;
 	net* new_net;
-	char net_name[32];
 	port prev_cond;
 	if(NULL != circ) {
 		if(transition_if == type) {
 			conditional = Component_Create(component_if_else);
 			Circuit_AddComponent(circ, conditional);
 			Component_AddInputPort(conditional, cond_net, port_conditional);
-			Net_GetName(cond_net, net_name);
-			strcat(net_name, "_if");
-			new_net = Net_Create(net_name, net_conditional, net_unsigned, 1);
+			new_net = ConditionStack_CreateBranchNet(cond_net, "_if");
 			Component_AddOutputPort(conditional, new_net, port_if);
-			if(NULL != condition_stack) {
-				port cur_condition = Component_GetOutputPort(condition_stack, (Component_GetNumOutputs(condition_stack)-1));
+			if(NULL != parser->condition_stack) {
+				port cur_condition = Component_GetOutputPort(parser->condition_stack, (Component_GetNumOutputs(parser->condition_stack)-1));
 				Component_AddInputPort(conditional, cur_condition.port_net, cur_condition.type);
 			}
-			condition_stack = conditional;
+			parser->condition_stack = conditional;
 		} else if(transition_else == type) {
-			prev_cond = Component_GetInputPort(condition_stack, 0);
-			Net_GetName(prev_cond.port_net, net_name);
-			strcat(net_name, "_else");
-			new_net = Net_Create(net_name, net_conditional, net_unsigned, 1);
-			Component_AddOutputPort(condition_stack, new_net, port_else);
+			prev_cond = Component_GetInputPort(parser->condition_stack, 0);
+			new_net = ConditionStack_CreateBranchNet(prev_cond.port_net, "_else");
+			Component_AddOutputPort(parser->condition_stack, new_net, port_else);
 		} else {
-			LogMessage("ERROR(ConditionStack_Push): Syntax Error", ERROR_LEVEL);
+			LOG_MESSAGE(ERROR_LEVEL, "ERROR(ConditionStack_Push): Syntax Error");
 		}
 	}
 }
 
-void ConditionStack_Pop() {
+void ConditionStack_Pop(netlist_parser* parser) {
 	uint8_t num_inputs;
 	port prev_port;
-	if(NULL != condition_stack) {
-		num_inputs = Component_GetNumInputs(condition_stack);
+	if(NULL != parser->condition_stack) {
+		num_inputs = Component_GetNumInputs(parser->condition_stack);
 		if(1 < num_inputs) {
-			prev_port = Component_GetInputPort(condition_stack, (num_inputs-1));
-			condition_stack = Net_GetDriver(prev_port.port_net);
+			prev_port = Component_GetInputPort(parser->condition_stack, (num_inputs-1));
+			parser->condition_stack = Net_GetDriver(prev_port.port_net);
 		} else {
-			condition_stack = NULL;
+			parser->condition_stack = NULL;
 		}
 	}
 }
 
-void ClearConditionalStack() {
-	condition_stack = NULL;
+//Branch nets are named after the condition they test
+static net* ConditionStack_CreateBranchNet(net* cond_net, const char* suffix) {
+	const char* cond_name = Net_GetName(cond_net);
+	size_t length = strlen(cond_name) + strlen(suffix) + 1;
+	net* new_net = NULL;
+	char* net_name = (char*) malloc(length);
+	if(NULL != net_name) {
+		snprintf(net_name, length, "%s%s", cond_name, suffix);
+		new_net = Net_Create(net_name, net_conditional, net_unsigned, 1);
+		free(net_name);
+	}
+	return new_net;
 }
-
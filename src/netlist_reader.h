@@ -8,9 +8,11 @@
 #ifndef NETLIST_READER_H_
 #define NETLIST_READER_H_
 
+#include <stdio.h>
 #include "global.h"
 
 uint8_t ReadNetlist(char* file_name, circuit* netlist_circuit);
+uint8_t ReadNetlistStream(FILE* fp, circuit* netlist_circuit);
 
 word_class CheckWordType(char* word);
 component_type ReadComponentType(char* word);
@@ -18,8 +20,6 @@ uint8_t ReadNetWidth(char* word);
 net_type ReadNetType(char* word);
 net_sign ReadNetSign(char* word);
 
-void ClearConditionalStack();
-
 void TestNetlistReader();
 void TestComponentParsing();
 void TestDeclarations();
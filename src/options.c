@@ -0,0 +1,520 @@
+/*
+ * options.c
+ *
+ *  Created on: Dec 2, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "options.h"
+#include "trace.h"
+#include "string_builder.h"
+#include "cache.h"
+
+void Options_SetDefaults(hlsyn_options* self) {
+	if(NULL != self) {
+		self->c_file = NULL;
+		self->verilog_file = NULL;
+		self->c_model_file = NULL;
+		self->testbench_file = NULL;
+		self->timing_file = NULL;
+		self->ir_file = NULL;
+		self->stats_file = NULL;
+		self->trace_events_file = NULL;
+		self->format = format_text;
+		self->latency = 0;
+		self->fsm_encoding = encoding_binary;
+		self->bind_resources = FALSE;
+		self->share_registers = FALSE;
+		self->num_random_vectors = 0;
+		self->vector_file = NULL;
+		self->seed = 1;
+		self->log_file = NULL;
+		self->log_level = CIRCUIT_ERROR_LEVEL;
+		self->async_log = FALSE;
+		self->trace_dir = NULL;
+		self->trace_artifacts = trace_none;
+		self->batch_file = NULL;
+		self->num_workers = 0;
+		self->server_socket = NULL;
+		self->connect_socket = NULL;
+		self->cache_dir = NULL;
+		self->cache_size = 0;
+	}
+}
+
+uint8_t Options_Parse(hlsyn_options* self, int argc, char* argv[]) {
+	int arg_idx;
+	int num_positional = 0;
+	long latency;
+	unsigned long long value;
+	char* end_ptr;
+	char* positional[3];
+
+	if(NULL == self || NULL == argv) return FAILURE;
+	Options_SetDefaults(self);
+
+	for(arg_idx = 1; arg_idx < argc; arg_idx++) {
+		if(0 == strncmp(argv[arg_idx], "--", 2)) {
+			if(0 == strcmp(argv[arg_idx], "--fsm-encoding")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --fsm-encoding needs a value.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->fsm_encoding = Options_ReadEncoding(argv[arg_idx]);
+				if(encoding_error == self->fsm_encoding) {
+					printf("ERROR: Unknown FSM encoding %s.\n", argv[arg_idx]);
+					return FAILURE;
+				}
+			} else if(0 == strcmp(argv[arg_idx], "--bind")) {
+				self->bind_resources = TRUE;
+			} else if(0 == strcmp(argv[arg_idx], "--share-registers")) {
+				self->share_registers = TRUE;
+			} else if(0 == strcmp(argv[arg_idx], "--simulate") || 0 == strcmp(argv[arg_idx], "--seed")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: %s needs a value.\n", argv[arg_idx]);
+					return FAILURE;
+				}
+				value = strtoull(argv[arg_idx+1], &end_ptr, 0);
+				if('\0' != *end_ptr || '-' == argv[arg_idx+1][0] || '\0' == argv[arg_idx+1][0]) {
+					printf("ERROR: %s needs a positive number.\n", argv[arg_idx]);
+					return FAILURE;
+				}
+				if(0 == strcmp(argv[arg_idx], "--seed")) {
+					self->seed = (uint64_t) value;
+				} else if(value > UINT32_MAX) {
+					printf("ERROR: Too many simulation vectors.\n");
+					return FAILURE;
+				} else {
+					self->num_random_vectors = (uint32_t) value;
+				}
+				arg_idx++;
+			} else if(0 == strcmp(argv[arg_idx], "--c-model")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --c-model needs a file.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->c_model_file = argv[arg_idx];
+			} else if(0 == strcmp(argv[arg_idx], "--testbench")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --testbench needs a file.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->testbench_file = argv[arg_idx];
+			} else if(0 == strcmp(argv[arg_idx], "--timing")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --timing needs a file.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->timing_file = argv[arg_idx];
+			} else if(0 == strcmp(argv[arg_idx], "--stats")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --stats needs a file.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->stats_file = argv[arg_idx];
+			} else if(0 == strcmp(argv[arg_idx], "--trace-events")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --trace-events needs a file.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->trace_events_file = argv[arg_idx];
+			} else if(0 == strcmp(argv[arg_idx], "--save-ir")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --save-ir needs a file.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->ir_file = argv[arg_idx];
+			} else if(0 == strcmp(argv[arg_idx], "--report-format")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --report-format needs a value.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->format = Options_ReadFormat(argv[arg_idx]);
+				if(format_error == self->format) {
+					printf("ERROR: Unknown report format %s.\n", argv[arg_idx]);
+					return FAILURE;
+				}
+			} else if(0 == strcmp(argv[arg_idx], "--log")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --log needs a file.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->log_file = argv[arg_idx];
+			} else if(0 == strcmp(argv[arg_idx], "--log-level")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --log-level needs a value.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->log_level = Options_ReadLogLevel(argv[arg_idx]);
+				if(NO_LOG == self->log_level) {
+					printf("ERROR: Unknown log level %s.\n", argv[arg_idx]);
+					return FAILURE;
+				}
+			} else if(0 == strcmp(argv[arg_idx], "--async-log")) {
+				self->async_log = TRUE;
+			} else if(0 == strcmp(argv[arg_idx], "--trace-dir")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --trace-dir needs a directory.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->trace_dir = argv[arg_idx];
+			} else if(0 == strcmp(argv[arg_idx], "--trace")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --trace needs a list of artifacts.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->trace_artifacts = Trace_ReadArtifacts(argv[arg_idx]);
+				if(trace_error == self->trace_artifacts) {
+					printf("ERROR: Unknown trace artifact in %s.\n", argv[arg_idx]);
+					return FAILURE;
+				}
+			} else if(0 == strcmp(argv[arg_idx], "--batch")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --batch needs a manifest file.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->batch_file = argv[arg_idx];
+			} else if(0 == strcmp(argv[arg_idx], "--server")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --server needs a socket path.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->server_socket = argv[arg_idx];
+			} else if(0 == strcmp(argv[arg_idx], "--connect")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --connect needs a socket path.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->connect_socket = argv[arg_idx];
+			} else if(0 == strcmp(argv[arg_idx], "--cache")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --cache needs a directory.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->cache_dir = argv[arg_idx];
+			} else if(0 == strcmp(argv[arg_idx], "--cache-size")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --cache-size needs a value.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->cache_size = Cache_ReadSize(argv[arg_idx]);
+				if(0 == self->cache_size) {
+					printf("ERROR: --cache-size must be a number of bytes, optionally followed by k, M or G.\n");
+					return FAILURE;
+				}
+			} else if(0 == strcmp(argv[arg_idx], "--jobs")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --jobs needs a value.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				value = strtoull(argv[arg_idx], &end_ptr, 10);
+				if('\0' != *end_ptr || '-' == argv[arg_idx][0] || '\0' == argv[arg_idx][0] || value < 1 || value > 256) {
+					printf("ERROR: --jobs must be between 1 and 256.\n");
+					return FAILURE;
+				}
+				self->num_workers = (uint16_t) value;
+			} else if(0 == strcmp(argv[arg_idx], "--vectors")) {
+				if(arg_idx+1 >= argc) {
+					printf("ERROR: --vectors needs a file.\n");
+					return FAILURE;
+				}
+				arg_idx++;
+				self->vector_file = argv[arg_idx];
+			} else {
+				printf("ERROR: Unknown option %s.\n", argv[arg_idx]);
+				return FAILURE;
+			}
+		} else {
+			if(num_positional >= 3) {
+				printf("ERROR: Too many arguments.\n");
+				return FAILURE;
+			}
+			positional[num_positional] = argv[arg_idx];
+			num_positional++;
+		}
+	}
+
+	if(0 != self->cache_size && NULL == self->cache_dir) {
+		printf("ERROR: --cache-size needs --cache.\n");
+		return FAILURE;
+	}
+
+	//A batch or a server takes its jobs from elsewhere, only process-wide options are allowed next to it
+	if(NULL != self->batch_file || NULL != self->server_socket) {
+		if(NULL != self->batch_file && NULL != self->server_socket) {
+			printf("ERROR: --batch and --server cannot be combined.\n");
+			return FAILURE;
+		}
+		if(num_positional > 0) {
+			printf("ERROR: %s takes no input or output files.\n", (NULL != self->batch_file) ? "--batch" : "--server");
+			return FAILURE;
+		}
+		if(NULL != self->trace_dir || NULL != self->connect_socket) {
+			printf("ERROR: --trace-dir and --connect are not supported with %s.\n", (NULL != self->batch_file) ? "--batch" : "--server");
+			return FAILURE;
+		}
+		if(TRUE == Options_HasJobOptions(self)) {
+			printf("ERROR: Job options belong on the job lines of the manifest or in the requests.\n");
+			return FAILURE;
+		}
+		return SUCCESS;
+	}
+	if(0 != self->num_workers) {
+		printf("ERROR: --jobs needs --batch or --server.\n");
+		return FAILURE;
+	}
+	if(NULL != self->connect_socket && NULL != self->trace_dir) {
+		printf("ERROR: --trace-dir is not supported with --connect.\n");
+		return FAILURE;
+	}
+
+	if(num_positional < 3) {
+		printf("ERROR: Not enough arguments.\n");
+		return FAILURE;
+	}
+
+	if(NULL == self->trace_dir && trace_none != self->trace_artifacts) {
+		printf("ERROR: --trace needs --trace-dir.\n");
+		return FAILURE;
+	}
+	if(NULL != self->trace_dir && trace_none == self->trace_artifacts) {
+		self->trace_artifacts = trace_default;
+	}
+
+	latency = strtol(positional[1], &end_ptr, 10);
+	if('\0' != *end_ptr || latency < 1 || latency > 255) {
+		printf("ERROR: Latency must be between 1 and 255.\n");
+		return FAILURE;
+	}
+	self->c_file = positional[0];
+	self->latency = (uint8_t) latency;
+	self->verilog_file = positional[2];
+	return SUCCESS;
+}
+
+//Splits line in place at spaces and tabs outside double quotes into argv[1..], argv[0] is the program name. A
+//backslash takes the next character as it is, so words can hold quotes and paths can hold spaces either way.
+//Returns argc, or -1 when the line has more than max_args-1 words or a quote is left open.
+int Options_SplitLine(char* line, char* argv[], int max_args) {
+	int argc = 1;
+	char* cur = line;
+	char* out;
+	uint8_t quoted;
+	if(NULL == line || NULL == argv || max_args < 1) return -1;
+	argv[0] = "hlsyn";
+	while('\0' != *cur) {
+		while(' ' == *cur || '\t' == *cur) cur++;
+		if('\0' == *cur) break;
+		if(argc >= max_args) return -1;
+		argv[argc] = cur;
+		argc++;
+		out = cur; //Unquoted text is moved down over the quotes and backslashes
+		quoted = FALSE;
+		while('\0' != *cur && (TRUE == quoted || (' ' != *cur && '\t' != *cur))) {
+			if('"' == *cur) {
+				quoted = (TRUE == quoted) ? FALSE : TRUE;
+				cur++;
+			} else if('\\' == *cur && '\0' != cur[1]) {
+				*out++ = cur[1];
+				cur += 2;
+			} else {
+				*out++ = *cur++;
+			}
+		}
+		if(TRUE == quoted) return -1;
+		if('\0' != *cur) cur++;
+		*out = '\0';
+	}
+	return argc;
+}
+
+//Appends word so that Options_SplitLine reads it back as one word, quoted when it holds separators or quotes
+void Options_AppendWord(string_builder* sb, const char* word) {
+	const char* cur;
+	if(NULL == sb || NULL == word) return;
+	if('\0' != word[0] && NULL == strpbrk(word, " \t\"\\")) {
+		StringBuilder_AppendString(sb, word);
+		return;
+	}
+	StringBuilder_AppendChar(sb, '"');
+	for(cur = word; '\0' != *cur; cur++) {
+		if('"' == *cur || '\\' == *cur) StringBuilder_AppendChar(sb, '\\');
+		StringBuilder_AppendChar(sb, *cur);
+	}
+	StringBuilder_AppendChar(sb, '"');
+}
+
+//TRUE when any option that only affects a single synthesis job differs from its default
+uint8_t Options_HasJobOptions(hlsyn_options* self) {
+	if(NULL != self->c_model_file || NULL != self->testbench_file || NULL != self->timing_file || NULL != self->vector_file || NULL != self->ir_file || NULL != self->stats_file ||
+			TRUE == self->bind_resources || TRUE == self->share_registers || 0 != self->num_random_vectors ||
+			encoding_binary != self->fsm_encoding || format_text != self->format || 1 != self->seed) {
+		return TRUE;
+	}
+	return FALSE;
+}
+
+//Appends the job options that differ from their defaults as command line arguments, each preceded by a space
+void Options_AppendJobOptions(hlsyn_options* self, string_builder* sb) {
+	const char* encoding_names[] = {"binary", "onehot", "gray"};
+	const char* format_names[] = {"text", "json"};
+	if(NULL == self || NULL == sb) return;
+	if(encoding_binary != self->fsm_encoding && encoding_error != self->fsm_encoding) {
+		StringBuilder_AppendString(sb, " --fsm-encoding ");
+		StringBuilder_AppendString(sb, encoding_names[self->fsm_encoding]);
+	}
+	if(TRUE == self->bind_resources) StringBuilder_AppendString(sb, " --bind");
+	if(TRUE == self->share_registers) StringBuilder_AppendString(sb, " --share-registers");
+	if(NULL != self->c_model_file) {
+		StringBuilder_AppendString(sb, " --c-model ");
+		Options_AppendWord(sb, self->c_model_file);
+	}
+	if(NULL != self->testbench_file) {
+		StringBuilder_AppendString(sb, " --testbench ");
+		Options_AppendWord(sb, self->testbench_file);
+	}
+	if(NULL != self->timing_file) {
+		StringBuilder_AppendString(sb, " --timing ");
+		Options_AppendWord(sb, self->timing_file);
+	}
+	if(NULL != self->stats_file) {
+		StringBuilder_AppendString(sb, " --stats ");
+		Options_AppendWord(sb, self->stats_file);
+	}
+	if(NULL != self->ir_file) {
+		StringBuilder_AppendString(sb, " --save-ir ");
+		Options_AppendWord(sb, self->ir_file);
+	}
+	if(format_text != self->format && format_error != self->format) {
+		StringBuilder_AppendString(sb, " --report-format ");
+		StringBuilder_AppendString(sb, format_names[self->format]);
+	}
+	if(0 != self->num_random_vectors) {
+		StringBuilder_AppendString(sb, " --simulate ");
+		StringBuilder_AppendUnsigned(sb, self->num_random_vectors);
+	}
+	if(NULL != self->vector_file) {
+		StringBuilder_AppendString(sb, " --vectors ");
+		Options_AppendWord(sb, self->vector_file);
+	}
+	if(1 != self->seed) {
+		StringBuilder_AppendString(sb, " --seed ");
+		StringBuilder_AppendUnsigned(sb, self->seed);
+	}
+	if(CIRCUIT_ERROR_LEVEL != self->log_level) {
+		StringBuilder_AppendString(sb, " --log-level ");
+		switch(self->log_level) {
+		case MESSAGE_LEVEL:
+			StringBuilder_AppendString(sb, "message");
+			break;
+		case WARNING_LEVEL:
+			StringBuilder_AppendString(sb, "warning");
+			break;
+		default:
+			StringBuilder_AppendString(sb, "error");
+			break;
+		}
+	}
+}
+
+state_encoding Options_ReadEncoding(char* word) {
+	state_encoding encoding = encoding_error;
+	if(NULL != word) {
+		if(0 == strcmp(word, "binary")) {
+			encoding = encoding_binary;
+		} else if(0 == strcmp(word, "onehot") || 0 == strcmp(word, "one-hot")) {
+			encoding = encoding_onehot;
+		} else if(0 == strcmp(word, "gray")) {
+			encoding = encoding_gray;
+		}
+	}
+	return encoding;
+}
+
+report_format Options_ReadFormat(char* word) {
+	report_format format = format_error;
+	if(NULL != word) {
+		if(0 == strcmp(word, "text")) {
+			format = format_text;
+		} else if(0 == strcmp(word, "json")) {
+			format = format_json;
+		}
+	}
+	return format;
+}
+
+uint8_t Options_ReadLogLevel(char* word) {
+	uint8_t level = NO_LOG;
+	if(NULL != word) {
+		if(0 == strcmp(word, "message")) {
+			level = MESSAGE_LEVEL;
+		} else if(0 == strcmp(word, "warning")) {
+			level = WARNING_LEVEL;
+		} else if(0 == strcmp(word, "error")) {
+			level = ERROR_LEVEL;
+		} else if(0 == strcmp(word, "circuit")) {
+			level = CIRCUIT_ERROR_LEVEL;
+		}
+	}
+	return level;
+}
+
+void Options_PrintUsage() {
+	printf("Usage: hlsyn cFile latency verilogFile [options]\n");
+	printf("       hlsyn --batch manifest [--jobs n] [--cache dir] [--trace-events file] [--log file] [--log-level level] [--async-log]\n");
+	printf("       hlsyn --server socket [--jobs n] [--cache dir] [--trace-events file] [--log file] [--log-level level] [--async-log]\n");
+	printf("       hlsyn --connect socket cFile latency verilogFile [options]\n");
+	printf("\t--fsm-encoding binary|onehot|gray\tState register encoding (default binary)\n");
+	printf("\t--bind\t\t\t\t\tShare functional units between states and emit a structural datapath\n");
+	printf("\t--share-registers\t\t\tStore variables with disjoint lifetimes in one register\n");
+	printf("\t--c-model file\t\t\t\tAlso write a cycle-accurate C model of the state machine\n");
+	printf("\t--testbench file\t\t\tAlso write a self-checking testbench, vectors as for --simulate/--vectors (default 16 random)\n");
+	printf("\t--timing file\t\t\t\tWrite the per-state critical path and estimated fmax to file, - for stdout\n");
+	printf("\t--save-ir file\t\t\t\tAlso write the parsed and scheduled circuit as binary IR, which can be given as cFile\n");
+	printf("\t\t\t\t\t\tThe schedule in it is reused at the same latency, other latencies reschedule\n");
+	printf("\t--stats file\t\t\t\tWrite wall and CPU time per phase and scheduler counters to file, - for the report\n");
+	printf("\t--report-format text|json\t\tFormat of the written reports (default text)\n");
+	printf("\t--simulate count\t\t\tCheck the state machine against the netlist on count random vectors\n");
+	printf("\t--vectors file\t\t\t\tCheck the state machine on the input vectors of file, one per line\n");
+	printf("\t--log file\t\t\t\tWrite log messages to file instead of stdout\n");
+	printf("\t--log-level message|warning|error|circuit\tLowest level logged (default circuit)\n");
+	printf("\t--async-log\t\t\t\tFormat and write log messages on a background thread\n");
+	printf("\t--trace-dir dir\t\t\t\tWrite scheduler debug dumps to dir, nothing is written without it\n");
+	printf("\t--trace list\t\t\t\tComma separated dumps: time-frames, distribution, fds, state-machine,\n");
+	printf("\t\t\t\t\t\tstate-cycles, fds-iterations, default (all but fds-iterations) or all\n");
+	printf("\t--trace-events file\t\t\tWrite a timeline of parsing, scheduling and emission per thread and job to file\n");
+	printf("\t\t\t\t\t\tas Chrome trace_event JSON, for Perfetto or chrome://tracing\n");
+	printf("\t--batch manifest\t\t\tRun every job of manifest, one line of cFile latency verilogFile [options] each\n");
+	printf("\t\t\t\t\t\tWords with spaces go in double quotes, a backslash escapes the next character\n");
+	printf("\t\t\t\t\t\tEach job logs to its own --log file at its own --log-level, or into its report\n");
+	printf("\t--server socket\t\t\t\tServe synthesis requests on a Unix domain socket until interrupted\n");
+	printf("\t\t\t\t\t\tRequests write their --c-model, --testbench, --timing, --save-ir and --stats files\n");
+	printf("\t\t\t\t\t\tand read --vectors at any path they name, with the permissions of the server.\n");
+	printf("\t\t\t\t\t\tAnyone who can connect to socket can do the same, keep it where only trusted users can\n");
+	printf("\t--connect socket\t\t\tHave the server on socket synthesize cFile, output files are written by the server\n");
+	printf("\t--cache dir\t\t\t\tReuse the outputs of earlier runs with the same netlist and options, stored in dir\n");
+	printf("\t--cache-size size\t\t\tEvict the least recently used results above size bytes, k, M or G suffix (default 256M)\n");
+	printf("\t--jobs n\t\t\t\tWorker threads for --batch and --server (default one per processor)\n");
+	printf("\t--seed n\t\t\t\tSeed for the random simulation vectors (default 1)\n");
+}
@@ -0,0 +1,56 @@
+/*
+ * options.h
+ *
+ *  Created on: Dec 2, 2020
+ *      Author: cwhos
+ */
+
+#ifndef OPTIONS_H_
+#define OPTIONS_H_
+
+#include "global.h"
+
+typedef struct struct_options {
+	char* c_file;
+	char* verilog_file;
+	char* c_model_file;
+	char* testbench_file;
+	char* timing_file;
+	char* ir_file;
+	char* stats_file;
+	char* trace_events_file;
+	report_format format;
+	uint8_t latency;
+	state_encoding fsm_encoding;
+	uint8_t bind_resources;
+	uint8_t share_registers;
+	uint32_t num_random_vectors;
+	char* vector_file;
+	uint64_t seed;
+	char* log_file;
+	uint8_t log_level;
+	uint8_t async_log;
+	char* trace_dir;
+	uint8_t trace_artifacts;
+	char* batch_file;
+	uint16_t num_workers;
+	char* server_socket;
+	char* connect_socket;
+	char* cache_dir;
+	uint64_t cache_size;
+} hlsyn_options;
+
+#define OPTIONS_MAX_ARGS 64
+
+void Options_SetDefaults(hlsyn_options* self);
+uint8_t Options_Parse(hlsyn_options* self, int argc, char* argv[]);
+int Options_SplitLine(char* line, char* argv[], int max_args);
+uint8_t Options_HasJobOptions(hlsyn_options* self);
+void Options_AppendJobOptions(hlsyn_options* self, string_builder* sb);
+void Options_AppendWord(string_builder* sb, const char* word);
+state_encoding Options_ReadEncoding(char* word);
+report_format Options_ReadFormat(char* word);
+uint8_t Options_ReadLogLevel(char* word);
+void Options_PrintUsage();
+
+#endif /* OPTIONS_H_ */
@@ -0,0 +1,311 @@
+/*
+ * resource.c
+ *
+ *  Created on: Dec 6, 2020
+ *      Author: cwhos
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "resource.h"
+#include "component.h"
+#include "net.h"
+#include "logger.h"
+
+typedef struct struct_resource {
+	component_type type;
+	resource_type resource_class;
+	net_sign sign; //Signedness of the operations, every bound operation extends its operands the same way
+	port_type relation; //Comparator output the unit computes
+	uint8_t width;
+	uint8_t output_width;
+	uint8_t shift_width;
+	uint8_t has_adder;
+	uint8_t has_subtractor;
+	uint16_t index;
+	uint16_t num_states;
+	uint8_t* busy_states; //One flag per state of the linked state machine
+	component** operations;
+	uint8_t* operation_states; //num_states flags per bound operation
+	uint16_t num_operations;
+	uint16_t max_operations;
+} resource;
+
+const uint16_t initial_resource_ops = 4;
+
+static uint8_t Resource_PortWidth(component* op, port_type type);
+
+resource* Resource_Create(component* first_op, uint16_t index, uint16_t num_states) {
+	resource* new_resource = NULL;
+	port out_port;
+	if(NULL != first_op && TRUE == Resource_IsBindable(first_op) && num_states > 0) {
+		new_resource = (resource*) calloc(1, sizeof(resource));
+		if(NULL != new_resource) {
+			out_port = Component_GetOutputPort(first_op, 0);
+			new_resource->type = Component_GetType(first_op);
+			new_resource->resource_class = Component_GetResourceType(first_op);
+			new_resource->sign = Resource_GetOperationSign(first_op);
+			new_resource->relation = out_port.type;
+			new_resource->index = index;
+			new_resource->num_states = num_states;
+			new_resource->max_operations = initial_resource_ops;
+			new_resource->busy_states = (uint8_t*) calloc(num_states, sizeof(uint8_t));
+			new_resource->operations = (component**) malloc(initial_resource_ops * sizeof(component*));
+			new_resource->operation_states = (uint8_t*) malloc(initial_resource_ops * num_states * sizeof(uint8_t));
+			if(NULL == new_resource->busy_states || NULL == new_resource->operations || NULL == new_resource->operation_states) {
+				Resource_Destroy(&new_resource);
+			}
+		}
+	}
+	return new_resource;
+}
+
+//Only operations the state machine prints as a single operator can move onto a shared unit
+uint8_t Resource_IsBindable(component* op) {
+	uint8_t ret_value = FALSE;
+	switch(Component_GetType(op)) {
+	case adder:
+	case subtractor:
+	case multiplier:
+	case divider:
+	case modulo:
+	case mux2x1:
+	case shift_left:
+	case shift_right:
+		ret_value = TRUE;
+		break;
+	case comparator:
+		ret_value = (greater_than_out == Component_GetOutputPort(op, 0).type ||
+				less_than_out == Component_GetOutputPort(op, 0).type ||
+				equal_out == Component_GetOutputPort(op, 0).type) ? TRUE : FALSE;
+		break;
+	default:
+		break;
+	}
+	return ret_value;
+}
+
+uint8_t Resource_IsCompatible(resource* self, component* op) {
+	if(NULL == self || NULL == op) return FALSE;
+	if(FALSE == Resource_IsBindable(op)) return FALSE;
+	if(self->resource_class != Component_GetResourceType(op)) return FALSE;
+	if(self->sign != Resource_GetOperationSign(op)) return FALSE;
+	if(resource_alu == self->resource_class) return TRUE; //Adders and subtractors share one add/sub unit
+	if(self->type != Component_GetType(op)) return FALSE;
+	if(comparator == self->type) {
+		return (self->relation == Component_GetOutputPort(op, 0).type) ? TRUE : FALSE;
+	}
+	if(shift_right == self->type && 0 != self->width) {
+		//Extension bits shift into the result, so right shifts only share at the same width
+		return (self->width == Resource_GetOperationWidth(op)) ? TRUE : FALSE;
+	}
+	return TRUE;
+}
+
+uint8_t Resource_IsFree(resource* self, const uint8_t* op_states) {
+	uint16_t idx;
+	if(NULL == self || NULL == op_states) return FALSE;
+	for(idx = 0; idx < self->num_states; idx++) {
+		if(TRUE == self->busy_states[idx] && TRUE == op_states[idx]) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+uint8_t Resource_Bind(resource* self, component* op, const uint8_t* op_states) {
+	uint8_t ret_value = FAILURE;
+	uint16_t idx;
+	uint8_t width;
+	component** new_ops;
+	uint8_t* new_states;
+	if(NULL != self && NULL != op && NULL != op_states) {
+		if(self->num_operations >= self->max_operations) {
+			if(0x8000 <= self->max_operations) {
+				LOG_MESSAGE(ERROR_LEVEL, "ERROR(Resource_Bind): Too many operations on one unit\n");
+				return FAILURE;
+			}
+			new_ops = (component**) realloc(self->operations, 2 * self->max_operations * sizeof(component*));
+			if(NULL == new_ops) return FAILURE;
+			self->operations = new_ops;
+			new_states = (uint8_t*) realloc(self->operation_states, 2 * self->max_operations * self->num_states * sizeof(uint8_t));
+			if(NULL == new_states) return FAILURE;
+			self->operation_states = new_states;
+			self->max_operations *= 2;
+		}
+		self->operations[self->num_operations] = op;
+		memcpy(&self->operation_states[self->num_operations * self->num_states], op_states, self->num_states * sizeof(uint8_t));
+		self->num_operations++;
+		for(idx = 0; idx < self->num_states; idx++) {
+			if(TRUE == op_states[idx]) self->busy_states[idx] = TRUE;
+		}
+
+		width = Resource_GetOperationWidth(op);
+		if(width > self->width) self->width = width;
+		width = Resource_PortWidth(op, shift_amount);
+		if(width > self->shift_width) self->shift_width = width;
+		self->output_width = (comparator == self->type) ? 1 : self->width;
+		if(adder == Component_GetType(op)) self->has_adder = TRUE;
+		if(subtractor == Component_GetType(op)) self->has_subtractor = TRUE;
+
+		Component_SetResource(op, self);
+		ret_value = SUCCESS;
+	}
+	return ret_value;
+}
+
+resource_type Resource_GetResourceType(resource* self) {
+	resource_type ret_value = resource_error;
+	if(NULL != self) {
+		ret_value = self->resource_class;
+	}
+	return ret_value;
+}
+
+component_type Resource_GetType(resource* self) {
+	component_type ret_value = component_unknown;
+	if(NULL != self) {
+		ret_value = self->type;
+	}
+	return ret_value;
+}
+
+net_sign Resource_GetSign(resource* self) {
+	net_sign ret_value = sign_error;
+	if(NULL != self) {
+		ret_value = self->sign;
+	}
+	return ret_value;
+}
+
+//Verilog only evaluates an operator as signed when every data operand is signed,
+//shifts take their sign from the shifted operand alone
+net_sign Resource_GetOperationSign(component* op) {
+	uint8_t idx;
+	uint8_t num_operands = 0;
+	uint8_t is_shift = (shift_left == Component_GetType(op) || shift_right == Component_GetType(op)) ? TRUE : FALSE;
+	net_sign sign = net_signed;
+	port cur_port;
+	for(idx = 0; idx < Component_GetNumInputs(op); idx++) {
+		cur_port = Component_GetInputPort(op, idx);
+		if(datapath_a == cur_port.type || (datapath_b == cur_port.type && FALSE == is_shift)) {
+			num_operands++;
+			if(net_signed != Net_GetSign(cur_port.port_net)) {
+				sign = net_unsigned;
+			}
+		}
+	}
+	return (0 == num_operands) ? net_unsigned : sign;
+}
+
+//Width the operator is evaluated at in the behavioural assignment
+uint8_t Resource_GetOperationWidth(component* op) {
+	uint8_t width = Resource_PortWidth(op, datapath_a);
+	uint8_t other_width = 0;
+	if(shift_left != Component_GetType(op) && shift_right != Component_GetType(op)) {
+		other_width = Resource_PortWidth(op, datapath_b); //Shifts repeat the amount on datapath_b
+	}
+	if(other_width > width) width = other_width;
+	if(comparator != Component_GetType(op)) {
+		other_width = Net_GetWidth(Component_GetOutputPort(op, 0).port_net);
+		if(other_width > width) width = other_width;
+	}
+	return width;
+}
+
+uint8_t Resource_GetPortWidth(resource* self, port_type type) {
+	uint8_t ret_value = 0;
+	if(NULL != self) {
+		switch(type) {
+		case datapath_a:
+		case datapath_b:
+			ret_value = self->width;
+			break;
+		case shift_amount:
+			ret_value = self->shift_width;
+			break;
+		case mux_sel:
+			ret_value = 1;
+			break;
+		case datapath_out:
+			ret_value = self->output_width;
+			break;
+		default:
+			break;
+		}
+	}
+	return ret_value;
+}
+
+uint16_t Resource_GetIndex(resource* self) {
+	uint16_t ret_value = 0;
+	if(NULL != self) {
+		ret_value = self->index;
+	}
+	return ret_value;
+}
+
+uint16_t Resource_GetNumOperations(resource* self) {
+	uint16_t ret_value = 0;
+	if(NULL != self) {
+		ret_value = self->num_operations;
+	}
+	return ret_value;
+}
+
+component* Resource_GetOperation(resource* self, uint16_t idx) {
+	component* ret_value = NULL;
+	if(NULL != self) {
+		if(idx < self->num_operations) ret_value = self->operations[idx];
+	}
+	return ret_value;
+}
+
+uint8_t Resource_IsOperationActive(resource* self, uint16_t op_idx, uint16_t state_number) {
+	uint8_t ret_value = FALSE;
+	if(NULL != self) {
+		if(op_idx < self->num_operations && state_number < self->num_states) {
+			ret_value = self->operation_states[op_idx * self->num_states + state_number];
+		}
+	}
+	return ret_value;
+}
+
+uint8_t Resource_HasFunctionSelect(resource* self) {
+	uint8_t ret_value = FALSE;
+	if(NULL != self) {
+		ret_value = (TRUE == self->has_adder && TRUE == self->has_subtractor) ? TRUE : FALSE;
+	}
+	return ret_value;
+}
+
+uint16_t Resource_GetNumStates(resource* self) {
+	uint16_t ret_value = 0;
+	if(NULL != self) {
+		ret_value = self->num_states;
+	}
+	return ret_value;
+}
+
+void Resource_Destroy(resource** self) {
+	if(NULL != *self) {
+		free((*self)->busy_states);
+		free((*self)->operations);
+		free((*self)->operation_states);
+		free((*self));
+		*self = NULL;
+	}
+}
+
+static uint8_t Resource_PortWidth(component* op, port_type type) {
+	uint8_t idx;
+	uint8_t width = 0;
+	port cur_port;
+	for(idx = 0; idx < Component_GetNumInputs(op); idx++) {
+		cur_port = Component_GetInputPort(op, idx);
+		if(type == cur_port.type && Net_GetWidth(cur_port.port_net) > width) {
+			width = Net_GetWidth(cur_port.port_net);
+		}
+	}
+	return width;
+}
@@ -0,0 +1,36 @@
+/*
+ * resource.h
+ *
+ *  Created on: Dec 6, 2020
+ *      Author: cwhos
+ */
+
+#ifndef RESOURCE_H_
+#define RESOURCE_H_
+
+#include <stdint.h>
+#include "global.h"
+
+resource* Resource_Create(component* first_op, uint16_t index, uint16_t num_states);
+
+uint8_t Resource_IsBindable(component* op);
+uint8_t Resource_IsCompatible(resource* self, component* op);
+uint8_t Resource_IsFree(resource* self, const uint8_t* op_states);
+uint8_t Resource_Bind(resource* self, component* op, const uint8_t* op_states);
+
+resource_type Resource_GetResourceType(resource* self);
+component_type Resource_GetType(resource* self);
+net_sign Resource_GetSign(resource* self);
+net_sign Resource_GetOperationSign(component* op);
+uint8_t Resource_GetOperationWidth(component* op);
+uint8_t Resource_GetPortWidth(resource* self, port_type type);
+uint16_t Resource_GetIndex(resource* self);
+uint16_t Resource_GetNumOperations(resource* self);
+component* Resource_GetOperation(resource* self, uint16_t idx);
+uint8_t Resource_IsOperationActive(resource* self, uint16_t op_idx, uint16_t state_number);
+uint8_t Resource_HasFunctionSelect(resource* self);
+uint16_t Resource_GetNumStates(resource* self);
+
+void Resource_Destroy(resource** self);
+
+#endif /* RESOURCE_H_ */
@@ -0,0 +1,438 @@
+/*
+ * server.c
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "server.h"
+#include "batch.h"
+#include "options.h"
+#include "synthesis.h"
+#include "logger.h"
+#include "timeline.h"
+#include "cache.h"
+
+#define SERVER_QUEUE_SIZE 64
+#define SERVER_POLL_MS 100
+#define SERVER_READ_SIZE 4096
+
+//Accepted connections waiting for a worker
+typedef struct {
+	int connections[SERVER_QUEUE_SIZE];
+	uint16_t head;
+	uint16_t count;
+	uint8_t stopping;
+	pthread_mutex_t lock;
+	pthread_cond_t not_empty;
+	pthread_cond_t not_full;
+	atomic_int stop; //Set when the server shuts down, idle connections are dropped
+	atomic_uint num_requests;
+	atomic_uint num_failed;
+} server_queue;
+
+//Buffered reads from a connection that give up when the server stops
+typedef struct {
+	int fd;
+	atomic_int* stop;
+	char buff[SERVER_READ_SIZE];
+	size_t start;
+	size_t end;
+} server_reader;
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void Server_OnSignal(int signal_number);
+static int Server_Listen(char* socket_path);
+static uint8_t Server_Push(server_queue* queue, int fd);
+static int Server_Pop(server_queue* queue);
+static void* Server_Worker(void* context);
+static void Server_HandleConnection(server_queue* queue, int fd);
+static uint8_t Server_HandleRequest(server_queue* queue, server_reader* reader, char* header);
+static uint8_t Server_SendResponse(int fd, job_status status, synthesis_stats* stats, char* verilog, size_t verilog_size, char* report, size_t report_size);
+static uint8_t Server_WriteAll(int fd, const char* data, size_t size);
+static uint8_t Server_Fill(server_reader* reader);
+static char* Server_ReadLine(server_reader* reader, char** line, size_t* line_size);
+static uint8_t Server_ReadBytes(server_reader* reader, char* data, size_t size);
+
+static void Server_OnSignal(int signal_number) {
+	(void) signal_number;
+	stop_requested = 1;
+}
+
+//Binds socket_path, replacing a socket file that no server answers on anymore
+static int Server_Listen(char* socket_path) {
+	struct sockaddr_un address;
+	int fd, probe, bound;
+
+	if(strlen(socket_path) >= sizeof(address.sun_path)) {
+		printf("ERROR: Socket path %s is too long.\n", socket_path);
+		return -1;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socket_path);
+
+	fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if(fd < 0) {
+		printf("ERROR: Cannot create socket: %s\n", strerror(errno));
+		return -1;
+	}
+	bound = bind(fd, (struct sockaddr*) &address, sizeof(address));
+	if(0 != bound && EADDRINUSE == errno) {
+		probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+		if(probe >= 0 && 0 == connect(probe, (struct sockaddr*) &address, sizeof(address))) {
+			printf("ERROR: A server is already listening on %s.\n", socket_path);
+			close(probe);
+			close(fd);
+			return -1;
+		}
+		if(probe >= 0) close(probe);
+		unlink(socket_path);
+		bound = bind(fd, (struct sockaddr*) &address, sizeof(address));
+	}
+	if(0 != bound || 0 != listen(fd, SOMAXCONN)) {
+		printf("ERROR: Cannot listen on %s: %s\n", socket_path, strerror(errno));
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+//Waits while the queue is full, fails once the server stops
+static uint8_t Server_Push(server_queue* queue, int fd) {
+	uint8_t ret_value = FAILURE;
+	pthread_mutex_lock(&queue->lock);
+	while(SERVER_QUEUE_SIZE == queue->count && FALSE == queue->stopping) {
+		pthread_cond_wait(&queue->not_full, &queue->lock);
+	}
+	if(FALSE == queue->stopping) {
+		queue->connections[(queue->head + queue->count) % SERVER_QUEUE_SIZE] = fd;
+		queue->count++;
+		pthread_cond_signal(&queue->not_empty);
+		ret_value = SUCCESS;
+	}
+	pthread_mutex_unlock(&queue->lock);
+	return ret_value;
+}
+
+//Next connection, or -1 once the server stops and the queue is empty
+static int Server_Pop(server_queue* queue) {
+	int fd = -1;
+	pthread_mutex_lock(&queue->lock);
+	while(0 == queue->count && FALSE == queue->stopping) {
+		pthread_cond_wait(&queue->not_empty, &queue->lock);
+	}
+	if(0 < queue->count) {
+		fd = queue->connections[queue->head];
+		queue->head = (queue->head + 1) % SERVER_QUEUE_SIZE;
+		queue->count--;
+		pthread_cond_signal(&queue->not_full);
+	}
+	pthread_mutex_unlock(&queue->lock);
+	return fd;
+}
+
+static void* Server_Worker(void* context) {
+	server_queue* queue = (server_queue*) context;
+	int fd;
+	Timeline_NameThread("server worker");
+	while(0 <= (fd = Server_Pop(queue))) {
+		Server_HandleConnection(queue, fd);
+		close(fd);
+	}
+	return NULL;
+}
+
+static void Server_HandleConnection(server_queue* queue, int fd) {
+	server_reader reader = {.fd = fd, .stop = &queue->stop, .start = 0, .end = 0};
+	char* header = NULL;
+	size_t header_size = 0;
+	while(NULL != Server_ReadLine(&reader, &header, &header_size)) {
+		if('\0' == header[0]) continue;
+		if(SUCCESS != Server_HandleRequest(queue, &reader, header)) break;
+	}
+	free(header);
+}
+
+//Runs one request and answers it. Fails when the connection cannot be used for further requests.
+static uint8_t Server_HandleRequest(server_queue* queue, server_reader* reader, char* header) {
+	char* words[OPTIONS_MAX_ARGS];
+	char* job_argv[OPTIONS_MAX_ARGS + 1];
+	int num_words, job_argc, idx;
+	hlsyn_options options;
+	synthesis_stats stats = {.num_nets = 0, .num_components = 0, .num_states = 0, .seconds = 0.0, .cached = FALSE};
+	job_status status = job_error;
+	char* netlist_text = NULL;
+	unsigned long netlist_size = 0;
+	char* end_ptr;
+	FILE* netlist = NULL;
+	char* verilog_text = NULL;
+	size_t verilog_size = 0;
+	FILE* verilog;
+	char* report_text = NULL;
+	size_t report_size = 0;
+	FILE* report;
+	logger* job_log;
+	uint8_t ret_value = SUCCESS;
+
+	report = open_memstream(&report_text, &report_size);
+	verilog = open_memstream(&verilog_text, &verilog_size);
+	if(NULL == report || NULL == verilog) {
+		if(NULL != report) fclose(report);
+		if(NULL != verilog) fclose(verilog);
+		free(report_text);
+		free(verilog_text);
+		return FAILURE;
+	}
+
+	num_words = Options_SplitLine(header, words, OPTIONS_MAX_ARGS);
+	if(num_words < 4 || (0 != strcmp(words[1], "path") && 0 != strcmp(words[1], "netlist"))) {
+		fprintf(report, "ERROR: Expected path cFile latency [options] or netlist bytes latency [options], with quotes closed.\n");
+		ret_value = FAILURE;
+	} else if(0 == strcmp(words[1], "netlist")) {
+		netlist_size = strtoul(words[2], &end_ptr, 10);
+		if('\0' != *end_ptr || 0 == netlist_size || netlist_size > SERVER_MAX_NETLIST) {
+			fprintf(report, "ERROR: Netlist size must be between 1 and %u bytes.\n", SERVER_MAX_NETLIST);
+			ret_value = FAILURE;
+		} else {
+			netlist_text = (char*) malloc(netlist_size);
+			if(NULL == netlist_text || SUCCESS != Server_ReadBytes(reader, netlist_text, netlist_size)) {
+				fprintf(report, "ERROR: Netlist text could not be read.\n");
+				ret_value = FAILURE;
+			} else {
+				netlist = fmemopen(netlist_text, netlist_size, "r");
+			}
+		}
+	}
+
+	//The request reads as the command line: hlsyn cFile latency verilogFile [options]
+	if(SUCCESS == ret_value) {
+		job_argv[0] = words[0];
+		job_argv[1] = (NULL != netlist) ? "-" : words[2];
+		job_argv[2] = words[3];
+		job_argv[3] = "-";
+		job_argc = 4;
+		for(idx = 4; idx < num_words; idx++) job_argv[job_argc++] = words[idx];
+		if(0 == strcmp(words[1], "netlist") && NULL == netlist) {
+			fprintf(report, "ERROR: Cannot open the netlist text.\n");
+		} else if(SUCCESS != Options_Parse(&options, job_argc, job_argv)) {
+			fprintf(report, "ERROR: Bad options in request.\n");
+		} else if(NULL != options.batch_file || NULL != options.server_socket || NULL != options.connect_socket ||
+				NULL != options.log_file || NULL != options.trace_dir || TRUE == options.async_log || 0 != options.num_workers ||
+				NULL != options.cache_dir || NULL != options.trace_events_file) {
+			fprintf(report, "ERROR: Request sets an option that applies to the whole server.\n");
+		} else {
+			job_log = Logger_Create(report, options.log_level);
+			if(NULL != job_log) {
+				Logger_Bind(job_log);
+				status = Synthesis_RunStreams(&options, netlist, verilog, report, &stats);
+				Logger_Bind(NULL);
+				Logger_Destroy(&job_log);
+			}
+		}
+	}
+
+	if(NULL != netlist) fclose(netlist);
+	free(netlist_text);
+	fclose(report);
+	fclose(verilog);
+	if(job_success != status) verilog_size = 0;
+	atomic_fetch_add(&queue->num_requests, 1);
+	if(job_success != status) atomic_fetch_add(&queue->num_failed, 1);
+	if(SUCCESS != Server_SendResponse(reader->fd, status, &stats, verilog_text, verilog_size, report_text, report_size)) {
+		ret_value = FAILURE;
+	}
+	free(report_text);
+	free(verilog_text);
+	return ret_value;
+}
+
+static uint8_t Server_SendResponse(int fd, job_status status, synthesis_stats* stats, char* verilog, size_t verilog_size, char* report, size_t report_size) {
+	char header[256];
+	int length;
+	length = snprintf(header, sizeof(header), "status %d %s\nstats nets=%u components=%u states=%u ms=%.3f cached=%u\nverilog %zu\n",
+			(int) status, Synthesis_GetStatusName(status), stats->num_nets, stats->num_components, stats->num_states,
+			stats->seconds * 1e3, stats->cached, verilog_size);
+	if(SUCCESS != Server_WriteAll(fd, header, (size_t) length)) return FAILURE;
+	if(SUCCESS != Server_WriteAll(fd, verilog, verilog_size)) return FAILURE;
+	length = snprintf(header, sizeof(header), "report %zu\n", report_size);
+	if(SUCCESS != Server_WriteAll(fd, header, (size_t) length)) return FAILURE;
+	return Server_WriteAll(fd, report, report_size);
+}
+
+static uint8_t Server_WriteAll(int fd, const char* data, size_t size) {
+	ssize_t written;
+	while(0 < size) {
+		written = send(fd, data, size, MSG_NOSIGNAL);
+		if(written < 0) {
+			if(EINTR == errno) continue;
+			return FAILURE;
+		}
+		data += written;
+		size -= (size_t) written;
+	}
+	return SUCCESS;
+}
+
+//Refills an empty buffer, polling so that a stopping server does not wait on an idle client
+static uint8_t Server_Fill(server_reader* reader) {
+	struct pollfd ready = {.fd = reader->fd, .events = POLLIN, .revents = 0};
+	ssize_t num_read;
+	for(;;) {
+		if(0 != atomic_load(reader->stop)) return FAILURE;
+		if(0 == poll(&ready, 1, SERVER_POLL_MS)) continue;
+		num_read = read(reader->fd, reader->buff, SERVER_READ_SIZE);
+		if(num_read < 0 && (EINTR == errno || EAGAIN == errno)) continue;
+		if(num_read <= 0) return FAILURE;
+		reader->start = 0;
+		reader->end = (size_t) num_read;
+		return SUCCESS;
+	}
+}
+
+//Reads up to a newline, which is removed along with a carriage return. NULL at the end of the connection.
+static char* Server_ReadLine(server_reader* reader, char** line, size_t* line_size) {
+	size_t length = 0;
+	char* new_line;
+	char c;
+	for(;;) {
+		if(reader->start == reader->end && SUCCESS != Server_Fill(reader)) return NULL;
+		c = reader->buff[reader->start++];
+		if(length + 1 >= *line_size) {
+			new_line = (char*) realloc(*line, (0 == *line_size) ? 256 : 2 * *line_size);
+			if(NULL == new_line) return NULL;
+			*line = new_line;
+			*line_size = (0 == *line_size) ? 256 : 2 * *line_size;
+		}
+		if('\n' == c) break;
+		(*line)[length++] = c;
+	}
+	if(0 < length && '\r' == (*line)[length-1]) length--;
+	(*line)[length] = '\0';
+	return *line;
+}
+
+static uint8_t Server_ReadBytes(server_reader* reader, char* data, size_t size) {
+	size_t chunk;
+	while(0 < size) {
+		if(reader->start == reader->end && SUCCESS != Server_Fill(reader)) return FAILURE;
+		chunk = reader->end - reader->start;
+		if(chunk > size) chunk = size;
+		memcpy(data, &reader->buff[reader->start], chunk);
+		reader->start += chunk;
+		data += chunk;
+		size -= chunk;
+	}
+	return SUCCESS;
+}
+
+//Serves requests on socket_path with num_workers threads, one connection per worker at a time, until
+//SIGINT or SIGTERM. The delay and keyword tables are constant data, nothing is set up per request.
+uint8_t Server_Run(char* socket_path, uint16_t num_workers) {
+	server_queue queue;
+	struct sigaction action;
+	struct pollfd listener;
+	sigset_t block, previous;
+	pthread_t* workers;
+	uint16_t num_started = 0;
+	uint16_t idx;
+	int listen_fd, fd;
+
+	if(NULL == socket_path) return FAILURE;
+	listen_fd = Server_Listen(socket_path);
+	if(listen_fd < 0) return FAILURE;
+	if(0 == num_workers) num_workers = Batch_GetDefaultWorkers();
+
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = Server_OnSignal;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	queue.head = 0;
+	queue.count = 0;
+	queue.stopping = FALSE;
+	pthread_mutex_init(&queue.lock, NULL);
+	pthread_cond_init(&queue.not_empty, NULL);
+	pthread_cond_init(&queue.not_full, NULL);
+	atomic_init(&queue.stop, 0);
+	atomic_init(&queue.num_requests, 0);
+	atomic_init(&queue.num_failed, 0);
+
+	//Workers leave the signals to this thread
+	sigemptyset(&block);
+	sigaddset(&block, SIGINT);
+	sigaddset(&block, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &block, &previous);
+	workers = (pthread_t*) malloc(num_workers * sizeof(pthread_t));
+	if(NULL != workers) {
+		for(idx = 0; idx < num_workers; idx++) {
+			if(0 != pthread_create(&workers[idx], NULL, Server_Worker, &queue)) break;
+			num_started++;
+		}
+	}
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+	if(0 < num_started) {
+		printf("Serving on %s with %u workers\n", socket_path, num_started);
+		fflush(stdout);
+		LOG_MESSAGE(MESSAGE_LEVEL, "MSG(Server_Run): Listening on %s\n", socket_path);
+		listener.fd = listen_fd;
+		listener.events = POLLIN;
+		while(0 == stop_requested) {
+			if(0 >= poll(&listener, 1, SERVER_POLL_MS)) continue;
+			fd = accept(listen_fd, NULL, NULL);
+			if(fd < 0) {
+				if(EINTR != errno && EAGAIN != errno && ECONNABORTED != errno) {
+					LOG_MESSAGE(ERROR_LEVEL, "ERROR(Server_Run): accept failed: %s\n", strerror(errno));
+					break;
+				}
+				continue;
+			}
+			if(SUCCESS != Server_Push(&queue, fd)) close(fd);
+		}
+	} else {
+		printf("ERROR: Cannot start server workers.\n");
+	}
+
+	close(listen_fd);
+	unlink(socket_path);
+	atomic_store(&queue.stop, 1);
+	pthread_mutex_lock(&queue.lock);
+	queue.stopping = TRUE;
+	pthread_cond_broadcast(&queue.not_empty);
+	pthread_cond_broadcast(&queue.not_full);
+	pthread_mutex_unlock(&queue.lock);
+	for(idx = 0; idx < num_started; idx++) {
+		pthread_join(workers[idx], NULL);
+	}
+	free(workers);
+	//Connections accepted but never served
+	while(0 < queue.count) {
+		close(queue.connections[queue.head]);
+		queue.head = (queue.head + 1) % SERVER_QUEUE_SIZE;
+		queue.count--;
+	}
+	if(0 < num_started) {
+		printf("Served %u requests, %u failed\n", atomic_load(&queue.num_requests), atomic_load(&queue.num_failed));
+		if(TRUE == Cache_IsEnabled()) Cache_PrintStats(stdout);
+	}
+
+	pthread_cond_destroy(&queue.not_full);
+	pthread_cond_destroy(&queue.not_empty);
+	pthread_mutex_destroy(&queue.lock);
+	return (0 < num_started) ? SUCCESS : FAILURE;
+}
@@ -0,0 +1,28 @@
+/*
+ * server.h
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#ifndef SERVER_H_
+#define SERVER_H_
+
+#include <stdint.h>
+#include "global.h"
+
+//Requests on a connection are answered in order, a connection may carry any number of them.
+//Request:  path cFile latency [options]\n                      cFile is read by the server
+//     or:  netlist bytes latency [options]\n<bytes of netlist text>
+//Response: status code name\n                                  code is a job_status
+//          stats nets=n components=n states=n ms=time cached=0|1\n
+//          verilog bytes\n<bytes of Verilog>
+//          report bytes\n<bytes of report and log text>
+//Header words are split like a manifest line, so cFile and option paths may be quoted or backslash escaped.
+//Output and --vectors paths in options are used as given, with the server's permissions, so the socket must only
+//be reachable by trusted users.
+#define SERVER_MAX_NETLIST (64u * 1024u * 1024u)
+
+uint8_t Server_Run(char* socket_path, uint16_t num_workers);
+
+#endif /* SERVER_H_ */
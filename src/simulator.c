@@ -0,0 +1,877 @@
+/*
+ * simulator.c
+ *
+ *  Created on: Dec 8, 2020
+ *      Author: cwhos
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "simulator.h"
+#include "circuit.h"
+#include "component.h"
+#include "net.h"
+#include "resource.h"
+#include "state.h"
+#include "state_machine.h"
+#include "logger.h"
+
+#define SIM_NO_SLOT 0xFFFF
+#define SIM_MAX_REPORTED_MISMATCHES 10
+
+typedef struct {
+	uint16_t behaviour_slot; //Every version of a variable shares the slot of its declared name
+	uint16_t machine_slot; //Slot of the register the state machine stores the net in
+	uint8_t width;
+	net_sign sign;
+} sim_operand;
+
+typedef struct {
+	component* op;
+	component_type type;
+	port_type relation;
+	net_sign sign; //Sign the operator is evaluated with
+	uint8_t width; //Width the operator is evaluated at
+	sim_operand a;
+	sim_operand b;
+	sim_operand control;
+	sim_operand out;
+	uint16_t guard; //Index of the if_else the operation is nested in, SIM_NO_SLOT at the top level
+	transition_type guard_branch;
+} sim_operation;
+
+typedef struct {
+	uint8_t cycle;
+	uint8_t num_next;
+	uint16_t next_state[2];
+	sim_operand branch; //Condition register the transition tests when the state branches
+	uint32_t first_op;
+	uint32_t num_ops;
+} sim_state;
+
+typedef struct {
+	net* value_net;
+	const char* name;
+	const char* storage_name;
+	uint16_t behaviour_slot;
+	uint16_t machine_slot;
+} sim_net;
+
+typedef struct {
+	component* op;
+	uint16_t list_idx;
+} sim_component;
+
+typedef struct {
+	FILE* report;
+	uint32_t num_vectors;
+	uint32_t num_mismatch;
+	uint32_t min_cycles;
+	uint32_t max_cycles;
+} sim_report;
+
+typedef struct struct_simulator {
+	uint16_t num_inputs;
+	uint16_t num_outputs;
+	net** inputs;
+	sim_operand* input_operands;
+	net** outputs;
+	sim_operand* output_operands;
+
+	uint16_t num_operations;
+	sim_operation* operations;
+	uint8_t* branch_taken; //Two flags per operation, only if_else operations set them
+	uint8_t* branch_unknown; //Set when an if_else tests an undefined value
+
+	uint16_t num_behaviour_slots;
+	uint16_t num_machine_slots;
+	uint64_t* behaviour_values;
+	uint8_t* behaviour_unknown; //Values the RTL would hold as x
+	uint64_t* machine_values;
+	uint64_t* machine_writes;
+
+	uint16_t num_states;
+	uint8_t latency;
+	sim_state* states;
+	uint16_t* state_ops;
+} simulator;
+
+static int Simulator_CompareName(const void* a, const void* b);
+static int Simulator_CompareStorageName(const void* a, const void* b);
+static int Simulator_CompareNet(const void* a, const void* b);
+static int Simulator_CompareComponent(const void* a, const void* b);
+static sim_operand Simulator_MakeOperand(net* value_net, sim_net* nets, uint16_t num_nets);
+static uint16_t Simulator_FindOperation(sim_component* comps, uint16_t num_comps, component* op);
+static uint16_t Simulator_GetGuard(component* op, sim_component* comps, uint16_t num_comps, transition_type* branch);
+static uint8_t Simulator_CompileOperation(simulator* self, uint16_t op_idx, component* op, sim_net* nets, uint16_t num_nets, sim_component* comps, uint16_t num_comps);
+static uint8_t Simulator_CompileStates(simulator* self, state_machine* sm, sim_net* nets, uint16_t num_nets, sim_component* comps, uint16_t num_comps);
+static uint64_t Simulator_Read(const uint64_t* values, sim_operand operand, uint8_t use_machine);
+static uint8_t Simulator_IsUnknown(simulator* self, sim_operand operand);
+static uint8_t Simulator_IsResultUnknown(simulator* self, sim_operation* op);
+static uint64_t Simulator_Extend(uint64_t value, uint8_t width, net_sign sign, uint8_t to_width);
+static uint64_t Simulator_Compute(sim_operation* op, const uint64_t* values, uint8_t use_machine);
+static void Simulator_PrintValue(FILE* report, uint64_t value, net* value_net);
+static void Simulator_CompareVector(simulator* self, void* context, uint32_t vector_idx, const uint64_t* inputs, const uint64_t* expected, const uint64_t* actual, uint32_t num_cycles);
+static void Simulator_ReportMismatch(simulator* self, FILE* report, uint32_t vector_idx, const uint64_t* inputs, const uint64_t* expected, const uint64_t* actual, uint8_t finished);
+static char* Simulator_GetLine(char** buff, size_t* buff_size, FILE* fp);
+static uint8_t Simulator_ParseVector(simulator* self, char* line, uint64_t* inputs, uint16_t* num_values);
+
+//Compiles the netlist into two views: the behavioural one evaluates the operations in source order under
+//their if/else guards, the state machine one executes the linked states with non-blocking register updates
+simulator* Simulator_Create(circuit* circ, state_machine* sm) {
+	simulator* new_sim;
+	sim_net* nets = NULL;
+	sim_component* comps = NULL;
+	uint16_t num_nets, num_comps, idx, slot;
+	net* cur_net;
+	uint8_t ret_value = SUCCESS;
+
+	if(NULL == circ || NULL == sm) {
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR(Simulator_Create): Invalid input pointers\n");
+		return NULL;
+	}
+	new_sim = (simulator*) calloc(1, sizeof(simulator));
+	if(NULL == new_sim) return NULL;
+
+	num_nets = Circuit_GetNumNet(circ);
+	num_comps = Circuit_GetNumComponent(circ);
+	nets = (sim_net*) calloc((num_nets > 0) ? num_nets : 1, sizeof(sim_net));
+	comps = (sim_component*) calloc((num_comps > 0) ? num_comps : 1, sizeof(sim_component));
+	new_sim->inputs = (net**) calloc((num_nets > 0) ? num_nets : 1, sizeof(net*));
+	new_sim->input_operands = (sim_operand*) calloc((num_nets > 0) ? num_nets : 1, sizeof(sim_operand));
+	new_sim->outputs = (net**) calloc((num_nets > 0) ? num_nets : 1, sizeof(net*));
+	new_sim->output_operands = (sim_operand*) calloc((num_nets > 0) ? num_nets : 1, sizeof(sim_operand));
+	new_sim->operations = (sim_operation*) calloc((num_comps > 0) ? num_comps : 1, sizeof(sim_operation));
+	new_sim->branch_taken = (uint8_t*) calloc(2 * ((num_comps > 0) ? num_comps : 1), sizeof(uint8_t));
+	if(NULL == nets || NULL == comps || NULL == new_sim->inputs || NULL == new_sim->input_operands || NULL == new_sim->outputs ||
+			NULL == new_sim->output_operands || NULL == new_sim->operations || NULL == new_sim->branch_taken) {
+		ret_value = FAILURE;
+	}
+
+	if(SUCCESS == ret_value) {
+		//Slots are numbered by name, once for the declared names and once for the registers after sharing
+		for(idx = 0; idx < num_nets; idx++) {
+			cur_net = Circuit_GetNet(circ, idx);
+			nets[idx].value_net = cur_net;
+			nets[idx].name = Net_GetName(cur_net);
+			nets[idx].storage_name = Net_GetNameRef(cur_net);
+		}
+		qsort(nets, num_nets, sizeof(sim_net), Simulator_CompareName);
+		for(idx = 0, slot = 0; idx < num_nets; idx++) {
+			if(idx > 0 && 0 != strcmp(nets[idx-1].name, nets[idx].name)) slot++;
+			nets[idx].behaviour_slot = slot;
+		}
+		new_sim->num_behaviour_slots = (num_nets > 0) ? slot+1 : 0;
+		qsort(nets, num_nets, sizeof(sim_net), Simulator_CompareStorageName);
+		for(idx = 0, slot = 0; idx < num_nets; idx++) {
+			if(idx > 0 && 0 != strcmp(nets[idx-1].storage_name, nets[idx].storage_name)) slot++;
+			nets[idx].machine_slot = slot;
+		}
+		new_sim->num_machine_slots = (num_nets > 0) ? slot+1 : 0;
+		qsort(nets, num_nets, sizeof(sim_net), Simulator_CompareNet);
+
+		for(idx = 0; idx < num_comps; idx++) {
+			comps[idx].op = Circuit_GetComponent(circ, idx);
+			comps[idx].list_idx = idx;
+		}
+		qsort(comps, num_comps, sizeof(sim_component), Simulator_CompareComponent);
+
+		//Declared ports only, assignments to an output create further versions under the same name
+		for(idx = 0; idx < num_nets; idx++) {
+			cur_net = Circuit_GetNet(circ, idx);
+			if(1 != Net_GetUsage(cur_net)) continue;
+			if(net_input == Net_GetType(cur_net)) {
+				new_sim->inputs[new_sim->num_inputs] = cur_net;
+				new_sim->input_operands[new_sim->num_inputs] = Simulator_MakeOperand(cur_net, nets, num_nets);
+				new_sim->num_inputs++;
+			} else if(net_output == Net_GetType(cur_net)) {
+				new_sim->outputs[new_sim->num_outputs] = cur_net;
+				new_sim->output_operands[new_sim->num_outputs] = Simulator_MakeOperand(cur_net, nets, num_nets);
+				new_sim->num_outputs++;
+			}
+		}
+
+		for(idx = 0; idx < num_comps && SUCCESS == ret_value; idx++) {
+			ret_value = Simulator_CompileOperation(new_sim, idx, Circuit_GetComponent(circ, idx), nets, num_nets, comps, num_comps);
+		}
+		new_sim->num_operations = num_comps;
+	}
+
+	if(SUCCESS == ret_value) {
+		new_sim->behaviour_values = (uint64_t*) calloc(new_sim->num_behaviour_slots + 1, sizeof(uint64_t));
+		new_sim->behaviour_unknown = (uint8_t*) calloc(new_sim->num_behaviour_slots + 1, sizeof(uint8_t));
+		new_sim->branch_unknown = (uint8_t*) calloc((num_comps > 0) ? num_comps : 1, sizeof(uint8_t));
+		new_sim->machine_values = (uint64_t*) calloc(new_sim->num_machine_slots + 1, sizeof(uint64_t));
+		new_sim->machine_writes = (uint64_t*) calloc((num_comps > 0) ? num_comps : 1, sizeof(uint64_t));
+		if(NULL == new_sim->behaviour_values || NULL == new_sim->behaviour_unknown || NULL == new_sim->branch_unknown ||
+				NULL == new_sim->machine_values || NULL == new_sim->machine_writes) {
+			ret_value = FAILURE;
+		}
+	}
+	if(SUCCESS == ret_value) {
+		ret_value = Simulator_CompileStates(new_sim, sm, nets, num_nets, comps, num_comps);
+	}
+
+	free(nets);
+	free(comps);
+	if(SUCCESS != ret_value) {
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR(Simulator_Create): Cannot build simulation model\n");
+		Simulator_Destroy(&new_sim);
+	}
+	return new_sim;
+}
+
+uint16_t Simulator_GetNumInputs(simulator* self) {
+	uint16_t ret_value = 0;
+	if(NULL != self) {
+		ret_value = self->num_inputs;
+	}
+	return ret_value;
+}
+
+uint16_t Simulator_GetNumOutputs(simulator* self) {
+	uint16_t ret_value = 0;
+	if(NULL != self) {
+		ret_value = self->num_outputs;
+	}
+	return ret_value;
+}
+
+net* Simulator_GetInput(simulator* self, uint16_t idx) {
+	net* ret_value = NULL;
+	if(NULL != self) {
+		if(idx < self->num_inputs) ret_value = self->inputs[idx];
+	}
+	return ret_value;
+}
+
+net* Simulator_GetOutput(simulator* self, uint16_t idx) {
+	net* ret_value = NULL;
+	if(NULL != self) {
+		if(idx < self->num_outputs) ret_value = self->outputs[idx];
+	}
+	return ret_value;
+}
+
+//Runs the netlist as written: statements in source order, each one only when its enclosing if/else branches are taken
+uint8_t Simulator_Evaluate(simulator* self, const uint64_t* inputs, uint64_t* outputs) {
+	uint16_t idx;
+	sim_operation* op;
+	uint64_t value;
+	uint8_t guard_taken, unknown;
+	if(NULL == self || NULL == inputs || NULL == outputs) return FAILURE;
+
+	memset(self->behaviour_values, 0, (self->num_behaviour_slots + 1) * sizeof(uint64_t));
+	memset(self->behaviour_unknown, 0, (self->num_behaviour_slots + 1) * sizeof(uint8_t));
+	memset(self->branch_taken, 0, 2 * self->num_operations * sizeof(uint8_t));
+	for(idx = 0; idx < self->num_inputs; idx++) {
+		self->behaviour_values[self->input_operands[idx].behaviour_slot] = Simulator_Mask(inputs[idx], self->input_operands[idx].width);
+	}
+
+	for(idx = 0; idx < self->num_operations; idx++) {
+		op = &self->operations[idx];
+		guard_taken = TRUE;
+		unknown = FALSE;
+		if(SIM_NO_SLOT != op->guard) {
+			guard_taken = self->branch_taken[2 * op->guard + ((transition_else == op->guard_branch) ? 1 : 0)];
+			unknown = self->branch_unknown[op->guard];
+		}
+		if(FALSE == guard_taken) continue;
+		if(component_if_else == op->type) {
+			value = Simulator_Read(self->behaviour_values, op->a, FALSE);
+			self->branch_taken[2 * idx] = (0 != value) ? TRUE : FALSE;
+			self->branch_taken[2 * idx + 1] = (0 != value) ? FALSE : TRUE;
+			self->branch_unknown[idx] = unknown | Simulator_IsUnknown(self, op->a);
+		} else if(SIM_NO_SLOT != op->out.behaviour_slot) {
+			self->behaviour_values[op->out.behaviour_slot] = Simulator_Compute(op, self->behaviour_values, FALSE);
+			self->behaviour_unknown[op->out.behaviour_slot] = unknown | Simulator_IsResultUnknown(self, op);
+		}
+	}
+
+	for(idx = 0; idx < self->num_outputs; idx++) {
+		outputs[idx] = Simulator_Read(self->behaviour_values, self->output_operands[idx], FALSE);
+	}
+	return SUCCESS;
+}
+
+//After Simulator_Evaluate: FALSE when the output depends on a division by zero, which the RTL leaves undefined
+uint8_t Simulator_IsOutputDefined(simulator* self, uint16_t idx) {
+	uint8_t ret_value = FALSE;
+	if(NULL != self) {
+		if(idx < self->num_outputs) ret_value = (TRUE == Simulator_IsUnknown(self, self->output_operands[idx])) ? FALSE : TRUE;
+	}
+	return ret_value;
+}
+
+//Clocks the linked state machine from the start state with Start held high until the done state raises Done.
+//Every operation of a state reads the registers as they were when the state was entered.
+uint8_t Simulator_Execute(simulator* self, const uint64_t* inputs, uint64_t* outputs, uint32_t* num_cycles) {
+	uint16_t idx, state_idx;
+	uint32_t op_idx, cycles;
+	sim_state* cur_state;
+	sim_operation* op;
+	uint8_t finished = FALSE;
+	if(NULL == self || NULL == inputs || NULL == outputs || 0 == self->num_states) return FAILURE;
+
+	memset(self->machine_values, 0, (self->num_machine_slots + 1) * sizeof(uint64_t));
+	for(idx = 0; idx < self->num_inputs; idx++) {
+		self->machine_values[self->input_operands[idx].machine_slot] = Simulator_Mask(inputs[idx], self->input_operands[idx].width);
+	}
+
+	state_idx = 0;
+	//The state graph is acyclic between Start and Done, a longer run means the transitions are broken
+	for(cycles = 1; cycles <= (uint32_t) self->num_states + 1; cycles++) {
+		cur_state = &self->states[state_idx];
+		if((self->latency + 1) == cur_state->cycle) {
+			finished = TRUE;
+			break;
+		}
+		for(op_idx = 0; op_idx < cur_state->num_ops; op_idx++) {
+			op = &self->operations[self->state_ops[cur_state->first_op + op_idx]];
+			self->machine_writes[op_idx] = Simulator_Compute(op, self->machine_values, TRUE);
+		}
+		if(0 == cur_state->num_next) break;
+		if(1 == cur_state->num_next || 0 != Simulator_Read(self->machine_values, cur_state->branch, TRUE)) {
+			state_idx = cur_state->next_state[0];
+		} else {
+			state_idx = cur_state->next_state[1];
+		}
+		for(op_idx = 0; op_idx < cur_state->num_ops; op_idx++) {
+			op = &self->operations[self->state_ops[cur_state->first_op + op_idx]];
+			self->machine_values[op->out.machine_slot] = self->machine_writes[op_idx];
+		}
+	}
+
+	for(idx = 0; idx < self->num_outputs; idx++) {
+		outputs[idx] = Simulator_Read(self->machine_values, self->output_operands[idx], TRUE);
+	}
+	if(NULL != num_cycles) *num_cycles = (TRUE == finished) ? cycles : 0;
+	return (TRUE == finished) ? SUCCESS : FAILURE;
+}
+
+//xorshift64* keeps the vectors reproducible from the seed on every platform. A quarter of the
+//values are corner cases, those are the ones that expose sign and width mistakes.
+void Simulator_RandomVector(simulator* self, uint64_t* inputs, uint64_t* seed) {
+	uint16_t idx;
+	uint64_t random;
+	uint8_t width;
+	if(NULL == self || NULL == inputs || NULL == seed) return;
+	if(0 == *seed) *seed = 0x9E3779B97F4A7C15ULL;
+	for(idx = 0; idx < self->num_inputs; idx++) {
+		*seed ^= *seed >> 12;
+		*seed ^= *seed << 25;
+		*seed ^= *seed >> 27;
+		random = *seed * 0x2545F4914F6CDD1DULL;
+		width = self->input_operands[idx].width;
+		if(0 == (random & 0x3)) {
+			switch((random >> 2) % 5) {
+			case 0:
+				random = 0;
+				break;
+			case 1:
+				random = 1;
+				break;
+			case 2:
+				random = UINT64_MAX;
+				break;
+			case 3:
+				random = (width > 0) ? (1ULL << (width - 1)) : 0;
+				break;
+			default:
+				random = (width > 0) ? ((1ULL << (width - 1)) - 1) : 0;
+				break;
+			}
+		} else {
+			random >>= 2;
+		}
+		inputs[idx] = Simulator_Mask(random, width);
+	}
+}
+
+//Runs every vector of the file and then num_random random vectors through both models and hands each
+//one to visit. Returns FAILURE when the vector file cannot be read.
+uint8_t Simulator_ForEachVector(simulator* self, char* vector_file, uint32_t num_random, uint64_t seed, simulator_visitor visit, void* context) {
+	uint64_t* inputs;
+	uint64_t* expected;
+	uint64_t* actual;
+	uint32_t num_vectors = 0, line_number = 0, random_idx = 0;
+	uint32_t cycles;
+	uint16_t num_values;
+	uint8_t file_done;
+	FILE* fp = NULL;
+	char* buff = NULL;
+	size_t buff_size = 256;
+	uint8_t ret_value = SUCCESS;
+
+	if(NULL == self || NULL == visit) return FAILURE;
+	inputs = (uint64_t*) calloc(self->num_inputs + 1, sizeof(uint64_t));
+	expected = (uint64_t*) calloc(self->num_outputs + 1, sizeof(uint64_t));
+	actual = (uint64_t*) calloc(self->num_outputs + 1, sizeof(uint64_t));
+	if(NULL == inputs || NULL == expected || NULL == actual) {
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR(Simulator_ForEachVector): Cannot allocate vectors\n");
+		ret_value = FAILURE;
+	}
+	if(SUCCESS == ret_value && NULL != vector_file) {
+		fp = fopen(vector_file, "r");
+		buff = (char*) malloc(buff_size * sizeof(char));
+		if(NULL == fp || NULL == buff) {
+			LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR: Cannot open test vector file\n");
+			ret_value = FAILURE;
+		}
+	}
+
+	file_done = (NULL == fp) ? TRUE : FALSE;
+	while(SUCCESS == ret_value) {
+		if(FALSE == file_done) {
+			if(NULL == Simulator_GetLine(&buff, &buff_size, fp)) {
+				file_done = TRUE;
+				continue;
+			}
+			line_number++;
+			if(SUCCESS != Simulator_ParseVector(self, buff, inputs, &num_values)) {
+				LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR: Bad test vector value on line %u\n", line_number);
+				ret_value = FAILURE;
+				break;
+			}
+			if(0 == num_values) continue;
+			if(num_values != self->num_inputs) {
+				LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR: Test vector on line %u has %d values, expected %d\n", line_number, num_values, self->num_inputs);
+				ret_value = FAILURE;
+				break;
+			}
+		} else if(random_idx < num_random) {
+			Simulator_RandomVector(self, inputs, &seed);
+			random_idx++;
+		} else {
+			break;
+		}
+
+		Simulator_Evaluate(self, inputs, expected);
+		if(SUCCESS != Simulator_Execute(self, inputs, actual, &cycles)) cycles = 0;
+		visit(self, context, num_vectors, inputs, expected, actual, cycles);
+		num_vectors++;
+	}
+
+	if(NULL != fp) fclose(fp);
+	free(buff);
+	free(inputs);
+	free(expected);
+	free(actual);
+	return ret_value;
+}
+
+//Compares the state machine against the behavioural model and reports the outputs that disagree.
+//Returns SUCCESS when every vector matched.
+uint8_t Simulator_RunVectors(simulator* self, char* vector_file, uint32_t num_random, uint64_t seed, FILE* report) {
+	sim_report summary = {.report = report, .num_vectors = 0, .num_mismatch = 0, .min_cycles = UINT32_MAX, .max_cycles = 0};
+	uint8_t ret_value;
+
+	if(NULL == self || NULL == report) return FAILURE;
+	ret_value = Simulator_ForEachVector(self, vector_file, num_random, seed, Simulator_CompareVector, &summary);
+	if(SUCCESS == ret_value) {
+		if(summary.num_mismatch > SIM_MAX_REPORTED_MISMATCHES) {
+			fprintf(report, "... %u further mismatching vectors not shown\n", summary.num_mismatch - SIM_MAX_REPORTED_MISMATCHES);
+		}
+		fprintf(report, "Simulation: %u vectors, %u mismatches", summary.num_vectors, summary.num_mismatch);
+		if(0 == summary.max_cycles) {
+			fprintf(report, "\n");
+		} else if(summary.min_cycles == summary.max_cycles) {
+			fprintf(report, ", %u cycles to Done\n", summary.min_cycles);
+		} else {
+			fprintf(report, ", %u to %u cycles to Done\n", summary.min_cycles, summary.max_cycles);
+		}
+		if(0 != summary.num_mismatch) ret_value = FAILURE;
+	}
+	return ret_value;
+}
+
+uint64_t Simulator_Mask(uint64_t value, uint8_t width) {
+	return (width >= 64) ? value : (value & ((1ULL << width) - 1));
+}
+
+int64_t Simulator_ToSigned(uint64_t value, uint8_t width) {
+	value = Simulator_Extend(value, width, net_signed, 64);
+	return (value > (uint64_t) INT64_MAX) ? -(int64_t) (~value) - 1 : (int64_t) value;
+}
+
+void Simulator_Destroy(simulator** self) {
+	if(NULL != *self) {
+		free((*self)->inputs);
+		free((*self)->input_operands);
+		free((*self)->outputs);
+		free((*self)->output_operands);
+		free((*self)->operations);
+		free((*self)->branch_taken);
+		free((*self)->behaviour_values);
+		free((*self)->behaviour_unknown);
+		free((*self)->branch_unknown);
+		free((*self)->machine_values);
+		free((*self)->machine_writes);
+		free((*self)->states);
+		free((*self)->state_ops);
+		free((*self));
+		*self = NULL;
+	}
+}
+
+static int Simulator_CompareName(const void* a, const void* b) {
+	return strcmp(((const sim_net*) a)->name, ((const sim_net*) b)->name);
+}
+
+static int Simulator_CompareStorageName(const void* a, const void* b) {
+	return strcmp(((const sim_net*) a)->storage_name, ((const sim_net*) b)->storage_name);
+}
+
+static int Simulator_CompareNet(const void* a, const void* b) {
+	uintptr_t net_a = (uintptr_t) ((const sim_net*) a)->value_net;
+	uintptr_t net_b = (uintptr_t) ((const sim_net*) b)->value_net;
+	return (net_a > net_b) - (net_a < net_b);
+}
+
+static int Simulator_CompareComponent(const void* a, const void* b) {
+	uintptr_t comp_a = (uintptr_t) ((const sim_component*) a)->op;
+	uintptr_t comp_b = (uintptr_t) ((const sim_component*) b)->op;
+	return (comp_a > comp_b) - (comp_a < comp_b);
+}
+
+static sim_operand Simulator_MakeOperand(net* value_net, sim_net* nets, uint16_t num_nets) {
+	sim_operand operand = {.behaviour_slot = SIM_NO_SLOT, .machine_slot = SIM_NO_SLOT, .width = 0, .sign = net_unsigned};
+	sim_net key;
+	sim_net* found;
+	if(NULL != value_net) {
+		key.value_net = value_net;
+		found = (sim_net*) bsearch(&key, nets, num_nets, sizeof(sim_net), Simulator_CompareNet);
+		if(NULL != found) {
+			operand.behaviour_slot = found->behaviour_slot;
+			operand.machine_slot = found->machine_slot;
+			operand.width = Net_GetWidth(value_net);
+			operand.sign = Net_GetSign(value_net);
+		}
+	}
+	return operand;
+}
+
+static uint16_t Simulator_FindOperation(sim_component* comps, uint16_t num_comps, component* op) {
+	sim_component key;
+	sim_component* found;
+	key.op = op;
+	found = (sim_component*) bsearch(&key, comps, num_comps, sizeof(sim_component), Simulator_CompareComponent);
+	return (NULL != found) ? found->list_idx : SIM_NO_SLOT;
+}
+
+//The branch nets an operation reads are driven by the if_else that opened the branch
+static uint16_t Simulator_GetGuard(component* op, sim_component* comps, uint16_t num_comps, transition_type* branch) {
+	uint8_t idx;
+	port cur_port;
+	for(idx = 0; idx < Component_GetNumInputs(op); idx++) {
+		cur_port = Component_GetInputPort(op, idx);
+		if(port_if == cur_port.type || port_else == cur_port.type) {
+			*branch = (port_if == cur_port.type) ? transition_if : transition_else;
+			return Simulator_FindOperation(comps, num_comps, Net_GetDriver(cur_port.port_net));
+		}
+	}
+	*branch = transition_all;
+	return SIM_NO_SLOT;
+}
+
+static uint8_t Simulator_CompileOperation(simulator* self, uint16_t op_idx, component* op, sim_net* nets, uint16_t num_nets, sim_component* comps, uint16_t num_comps) {
+	sim_operation* compiled = &self->operations[op_idx];
+	uint8_t idx;
+	port cur_port;
+	compiled->op = op;
+	compiled->type = Component_GetType(op);
+	compiled->a = Simulator_MakeOperand(NULL, nets, num_nets);
+	compiled->b = compiled->a;
+	compiled->control = compiled->a;
+	compiled->out = compiled->a;
+	compiled->guard = Simulator_GetGuard(op, comps, num_comps, &compiled->guard_branch);
+	if(SIM_NO_SLOT != compiled->guard && compiled->guard >= op_idx) {
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR(Simulator_CompileOperation): Operation precedes its condition\n");
+		return FAILURE;
+	}
+
+	for(idx = 0; idx < Component_GetNumInputs(op); idx++) {
+		cur_port = Component_GetInputPort(op, idx);
+		switch(cur_port.type) {
+		case datapath_a:
+		case port_conditional:
+			compiled->a = Simulator_MakeOperand(cur_port.port_net, nets, num_nets);
+			break;
+		case datapath_b:
+			compiled->b = Simulator_MakeOperand(cur_port.port_net, nets, num_nets);
+			break;
+		case mux_sel:
+		case shift_amount:
+			compiled->control = Simulator_MakeOperand(cur_port.port_net, nets, num_nets);
+			break;
+		default:
+			break;
+		}
+	}
+	if(component_if_else == compiled->type) return SUCCESS;
+
+	cur_port = Component_GetOutputPort(op, 0);
+	compiled->relation = cur_port.type;
+	compiled->out = Simulator_MakeOperand(cur_port.port_net, nets, num_nets);
+	compiled->sign = Resource_GetOperationSign(op);
+
+	compiled->width = Resource_GetOperationWidth(op);
+	return SUCCESS;
+}
+
+static uint8_t Simulator_CompileStates(simulator* self, state_machine* sm, sim_net* nets, uint16_t num_nets, sim_component* comps, uint16_t num_comps) {
+	uint16_t state_idx, op_idx, num_ops, list_idx;
+	uint32_t total_ops = 0;
+	state* cur_state;
+	component* op;
+	sim_state* compiled;
+	sim_operand branch = Simulator_MakeOperand(NULL, nets, num_nets);
+
+	self->latency = StateMachine_GetLatency(sm);
+	self->num_states = StateMachine_GetNumStates(sm);
+	for(state_idx = 0; state_idx < self->num_states; state_idx++) {
+		total_ops += State_GetNumOperations(StateMachine_GetState(sm, state_idx));
+	}
+	self->states = (sim_state*) calloc((self->num_states > 0) ? self->num_states : 1, sizeof(sim_state));
+	self->state_ops = (uint16_t*) calloc((total_ops > 0) ? total_ops : 1, sizeof(uint16_t));
+	if(NULL == self->states || NULL == self->state_ops) return FAILURE;
+
+	total_ops = 0;
+	for(state_idx = 0; state_idx < self->num_states; state_idx++) {
+		cur_state = StateMachine_GetState(sm, state_idx);
+		compiled = &self->states[state_idx];
+		compiled->cycle = State_GetCycle(cur_state);
+		compiled->num_next = State_GetNumStates(cur_state);
+		compiled->next_state[0] = State_GetStateNumber(State_GetNextState(cur_state, 0));
+		compiled->next_state[1] = State_GetStateNumber(State_GetNextState(cur_state, 1));
+		compiled->first_op = total_ops;
+		num_ops = State_GetNumOperations(cur_state);
+		for(op_idx = 0; op_idx < num_ops; op_idx++) {
+			op = State_GetOperation(cur_state, op_idx);
+			if(component_if_else == Component_GetType(op)) {
+				//Branching states without their own if_else test the last condition, as the Verilog does
+				branch = Simulator_MakeOperand(Component_GetInputPort(op, 0).port_net, nets, num_nets);
+				continue;
+			}
+			list_idx = Simulator_FindOperation(comps, num_comps, op);
+			if(SIM_NO_SLOT == list_idx || SIM_NO_SLOT == self->operations[list_idx].out.machine_slot) continue;
+			self->state_ops[total_ops] = list_idx;
+			total_ops++;
+		}
+		compiled->num_ops = total_ops - compiled->first_op;
+		compiled->branch = branch;
+		if(compiled->next_state[0] >= self->num_states || (compiled->num_next > 1 && compiled->next_state[1] >= self->num_states)) {
+			return FAILURE;
+		}
+	}
+	return SUCCESS;
+}
+
+static uint64_t Simulator_Read(const uint64_t* values, sim_operand operand, uint8_t use_machine) {
+	uint16_t slot = (TRUE == use_machine) ? operand.machine_slot : operand.behaviour_slot;
+	return (SIM_NO_SLOT == slot) ? 0 : Simulator_Mask(values[slot], operand.width);
+}
+
+static uint8_t Simulator_IsUnknown(simulator* self, sim_operand operand) {
+	return (SIM_NO_SLOT == operand.behaviour_slot) ? FALSE : self->behaviour_unknown[operand.behaviour_slot];
+}
+
+//x propagates through every operand the result depends on, a mux only depends on the leg it selects
+static uint8_t Simulator_IsResultUnknown(simulator* self, sim_operation* op) {
+	uint64_t divisor;
+	if(mux2x1 == op->type) {
+		if(TRUE == Simulator_IsUnknown(self, op->control)) return TRUE;
+		if(0 != Simulator_Read(self->behaviour_values, op->control, FALSE)) return Simulator_IsUnknown(self, op->a);
+		return Simulator_IsUnknown(self, op->b);
+	}
+	if(divider == op->type || modulo == op->type) {
+		divisor = Simulator_Read(self->behaviour_values, op->b, FALSE);
+		if(0 == divisor) return TRUE;
+	}
+	return Simulator_IsUnknown(self, op->a) | Simulator_IsUnknown(self, op->b) | Simulator_IsUnknown(self, op->control);
+}
+
+static uint64_t Simulator_Extend(uint64_t value, uint8_t width, net_sign sign, uint8_t to_width) {
+	value = Simulator_Mask(value, width);
+	if(net_signed == sign && width > 0 && width < 64 && 0 != (value & (1ULL << (width - 1)))) {
+		value |= ~((1ULL << width) - 1);
+	}
+	return Simulator_Mask(value, to_width);
+}
+
+//Verilog semantics of the printed assignment: operands extend to the context width, signed only when
+//every data operand is signed, and the result is truncated to the destination. Division by zero is
+//undefined in the hardware and yields zero here.
+static uint64_t Simulator_Compute(sim_operation* op, const uint64_t* values, uint8_t use_machine) {
+	uint64_t a, b, control, result = 0;
+	int64_t signed_a, signed_b;
+	uint8_t width = op->width;
+	net_sign a_sign = (net_signed == op->sign) ? op->a.sign : net_unsigned;
+	net_sign b_sign = (net_signed == op->sign) ? op->b.sign : net_unsigned;
+
+	a = Simulator_Extend(Simulator_Read(values, op->a, use_machine), op->a.width, a_sign, width);
+	b = Simulator_Extend(Simulator_Read(values, op->b, use_machine), op->b.width, b_sign, width);
+	control = Simulator_Read(values, op->control, use_machine);
+
+	switch(op->type) {
+	case load_register:
+		result = Simulator_Extend(a, op->a.width, op->a.sign, op->out.width);
+		break;
+	case adder:
+		result = a + b;
+		break;
+	case subtractor:
+		result = a - b;
+		break;
+	case multiplier:
+		result = a * b;
+		break;
+	case incrementer:
+		result = a + 1;
+		break;
+	case decrementer:
+		result = a - 1;
+		break;
+	case divider:
+	case modulo:
+		if(0 == b) {
+			result = 0;
+		} else if(net_signed == op->sign) {
+			signed_a = Simulator_ToSigned(a, width);
+			signed_b = Simulator_ToSigned(b, width);
+			if(-1 == signed_b) { //Avoids the INT64_MIN / -1 trap, the quotient wraps like the hardware
+				result = (divider == op->type) ? (0 - a) : 0;
+			} else {
+				result = (uint64_t) ((divider == op->type) ? (signed_a / signed_b) : (signed_a % signed_b));
+			}
+		} else {
+			result = (divider == op->type) ? (a / b) : (a % b);
+		}
+		break;
+	case comparator:
+		if(net_signed == op->sign) {
+			signed_a = Simulator_ToSigned(a, width);
+			signed_b = Simulator_ToSigned(b, width);
+			if(greater_than_out == op->relation) result = (signed_a > signed_b) ? 1 : 0;
+			else if(less_than_out == op->relation) result = (signed_a < signed_b) ? 1 : 0;
+			else result = (signed_a == signed_b) ? 1 : 0;
+		} else {
+			if(greater_than_out == op->relation) result = (a > b) ? 1 : 0;
+			else if(less_than_out == op->relation) result = (a < b) ? 1 : 0;
+			else result = (a == b) ? 1 : 0;
+		}
+		break;
+	case mux2x1:
+		result = (0 != control) ? a : b;
+		break;
+	case shift_left:
+		result = (control >= width) ? 0 : (a << control);
+		break;
+	case shift_right:
+		result = (control >= width) ? 0 : (Simulator_Mask(a, width) >> control);
+		break;
+	default:
+		break;
+	}
+	return Simulator_Mask(result, op->out.width);
+}
+
+static void Simulator_PrintValue(FILE* report, uint64_t value, net* value_net) {
+	if(net_signed == Net_GetSign(value_net)) {
+		fprintf(report, "%" PRId64, Simulator_ToSigned(value, Net_GetWidth(value_net)));
+	} else {
+		fprintf(report, "%" PRIu64, value);
+	}
+}
+
+static void Simulator_CompareVector(simulator* self, void* context, uint32_t vector_idx, const uint64_t* inputs, const uint64_t* expected, const uint64_t* actual, uint32_t num_cycles) {
+	sim_report* summary = (sim_report*) context;
+	uint16_t idx;
+	uint8_t matched = (0 != num_cycles) ? TRUE : FALSE;
+	for(idx = 0; idx < self->num_outputs; idx++) {
+		if(expected[idx] != actual[idx]) matched = FALSE;
+	}
+	if(0 != num_cycles) {
+		if(num_cycles < summary->min_cycles) summary->min_cycles = num_cycles;
+		if(num_cycles > summary->max_cycles) summary->max_cycles = num_cycles;
+	}
+	if(FALSE == matched) {
+		if(summary->num_mismatch < SIM_MAX_REPORTED_MISMATCHES) {
+			Simulator_ReportMismatch(self, summary->report, vector_idx, inputs, expected, actual, (0 != num_cycles) ? TRUE : FALSE);
+		}
+		summary->num_mismatch++;
+	}
+	summary->num_vectors++;
+}
+
+static void Simulator_ReportMismatch(simulator* self, FILE* report, uint32_t vector_idx, const uint64_t* inputs, const uint64_t* expected, const uint64_t* actual, uint8_t finished) {
+	uint16_t idx;
+	fprintf(report, "Mismatch in vector %u:", vector_idx);
+	for(idx = 0; idx < self->num_inputs; idx++) {
+		fprintf(report, " %s=", Net_GetNameRef(self->inputs[idx]));
+		Simulator_PrintValue(report, inputs[idx], self->inputs[idx]);
+	}
+	fprintf(report, "\n");
+	if(FALSE == finished) {
+		fprintf(report, "\tstate machine never reached Done\n");
+	}
+	for(idx = 0; idx < self->num_outputs; idx++) {
+		if(expected[idx] == actual[idx]) continue;
+		fprintf(report, "\t%s: expected ", Net_GetNameRef(self->outputs[idx]));
+		Simulator_PrintValue(report, expected[idx], self->outputs[idx]);
+		fprintf(report, ", state machine gave ");
+		Simulator_PrintValue(report, actual[idx], self->outputs[idx]);
+		fprintf(report, "\n");
+	}
+}
+
+//Reads a whole line, growing the buffer for lines longer than it
+static char* Simulator_GetLine(char** buff, size_t* buff_size, FILE* fp) {
+	size_t length = 0;
+	char* new_buff;
+	if(NULL == fgets(*buff, (int) *buff_size, fp)) return NULL;
+	length = strlen(*buff);
+	while(length > 0 && '\n' != (*buff)[length-1] && !feof(fp)) {
+		new_buff = (char*) realloc(*buff, 2 * (*buff_size) * sizeof(char));
+		if(NULL == new_buff) break;
+		*buff = new_buff;
+		*buff_size *= 2;
+		if(NULL == fgets(*buff + length, (int) (*buff_size - length), fp)) break;
+		length += strlen(*buff + length);
+	}
+	return *buff;
+}
+
+//One vector per line, one value per input in declaration order. Values are decimal, negative or 0x hex,
+//separated by spaces or commas. Anything after // or # is a comment.
+static uint8_t Simulator_ParseVector(simulator* self, char* line, uint64_t* inputs, uint16_t* num_values) {
+	char* cursor = line;
+	char* end_ptr;
+	char* comment;
+	uint64_t value;
+	*num_values = 0;
+	comment = strstr(line, "//");
+	if(NULL != comment) *comment = '\0';
+	comment = strchr(line, '#');
+	if(NULL != comment) *comment = '\0';
+
+	while('\0' != *cursor) {
+		if(' ' == *cursor || '\t' == *cursor || ',' == *cursor || '\r' == *cursor || '\n' == *cursor) {
+			cursor++;
+			continue;
+		}
+		if('-' == *cursor) {
+			value = (uint64_t) strtoll(cursor, &end_ptr, 0);
+		} else {
+			value = strtoull(cursor, &end_ptr, 0);
+		}
+		if(end_ptr == cursor || ('\0' != *end_ptr && NULL == strchr(" \t,\r\n", *end_ptr))) return FAILURE;
+		if(*num_values < self->num_inputs) {
+			inputs[*num_values] = Simulator_Mask(value, self->input_operands[*num_values].width);
+		}
+		(*num_values)++;
+		cursor = end_ptr;
+	}
+	return SUCCESS;
+}
@@ -0,0 +1,39 @@
+/*
+ * simulator.h
+ *
+ *  Created on: Dec 8, 2020
+ *      Author: cwhos
+ */
+
+#ifndef SIMULATOR_H_
+#define SIMULATOR_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "global.h"
+
+//Called once per vector with the behavioural outputs as expected and the state machine outputs as actual.
+//num_cycles is 0 when the state machine never reached Done.
+typedef void (*simulator_visitor)(simulator* sim, void* context, uint32_t vector_idx, const uint64_t* inputs,
+		const uint64_t* expected, const uint64_t* actual, uint32_t num_cycles);
+
+simulator* Simulator_Create(circuit* circ, state_machine* sm);
+
+uint16_t Simulator_GetNumInputs(simulator* self);
+uint16_t Simulator_GetNumOutputs(simulator* self);
+net* Simulator_GetInput(simulator* self, uint16_t idx);
+net* Simulator_GetOutput(simulator* self, uint16_t idx);
+
+uint8_t Simulator_Evaluate(simulator* self, const uint64_t* inputs, uint64_t* outputs);
+uint8_t Simulator_Execute(simulator* self, const uint64_t* inputs, uint64_t* outputs, uint32_t* num_cycles);
+void Simulator_RandomVector(simulator* self, uint64_t* inputs, uint64_t* seed);
+uint8_t Simulator_IsOutputDefined(simulator* self, uint16_t idx);
+uint8_t Simulator_ForEachVector(simulator* self, char* vector_file, uint32_t num_random, uint64_t seed, simulator_visitor visit, void* context);
+uint8_t Simulator_RunVectors(simulator* self, char* vector_file, uint32_t num_random, uint64_t seed, FILE* report);
+
+uint64_t Simulator_Mask(uint64_t value, uint8_t width);
+int64_t Simulator_ToSigned(uint64_t value, uint8_t width);
+
+void Simulator_Destroy(simulator** self);
+
+#endif /* SIMULATOR_H_ */
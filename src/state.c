@@ -7,38 +7,48 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 #include "state.h"
 #include "state_machine.h"
 #include "logger.h"
 #include "component.h"
 #include "file_writer.h"
+#include "string_builder.h"
+#include "stats.h"
 
 typedef struct struct_state {
-	uint8_t state_number;
+	uint16_t state_number;
 	uint8_t cycle;
 	state* next_state[2];
 	uint8_t num_states;
 	component** operations;
-	uint8_t num_operations;
+	uint16_t num_operations;
+	uint16_t max_operations;
 	condition state_condition;
+	state* join_state; //Where the branches of the if/else in this state meet again
 } state;
 
-const uint8_t max_ops = 32;
+const uint16_t initial_ops = 8;
+
+static uint8_t State_GrowOperations(state* self);
+static uint8_t State_BranchTaken(const link_branch* branch, condition cond);
 
 state* State_Create(uint8_t cycle) {
 
-	uint8_t idx;
+	uint16_t idx;
 	state* new_state = (state*) malloc(sizeof(state));
 	if(NULL != new_state) {
 		new_state->cycle = cycle;
-		new_state->state_number = 255;
+		new_state->state_number = 0xFFFF;
 		new_state->num_operations = 0;
+		new_state->max_operations = initial_ops;
 		new_state->num_states = 0;
 		new_state->next_state[0] = NULL;
 		new_state->next_state[1] = NULL;
-		new_state->operations = (component**) malloc(max_ops * sizeof(component*));
+		new_state->join_state = NULL;
+		new_state->operations = (component**) malloc(initial_ops * sizeof(component*));
 		if(new_state->operations != NULL) {
-			for(idx = 0; idx < max_ops; idx++) {
+			for(idx = 0; idx < initial_ops; idx++) {
 				new_state->operations[idx] = NULL;
 			}
 		} else {
@@ -54,70 +64,120 @@ void State_AddNextState(state* self, state* next_state) {
 			self->next_state[self->num_states] = next_state;
 			self->num_states++;
 		} else {
-			LogMessage("Error(): Adding too many states\n", ERROR_LEVEL);
+			LOG_MESSAGE(ERROR_LEVEL, "Error(): Adding too many states\n");
 		}
 	}
 }
 
 void State_AddOperation(state* self, component* operation) {
 	if(NULL != self && NULL != operation) {
-		if(max_ops > self->num_operations) {
+		if(self->num_operations >= self->max_operations && FAILURE == State_GrowOperations(self)) {
+			LOG_MESSAGE(ERROR_LEVEL, "ERROR(State_AddOperation): Hit max operations\n");
+			return;
+		}
+		self->operations[self->num_operations] = operation;
+		Component_SchedulePathFDS(operation, self->cycle);
+		self->num_operations++;
+	}
+}
+
+//Adds an operation whose schedule was restored, the time frames are already final and left alone
+uint8_t State_RestoreOperation(state* self, component* operation) {
+	uint8_t ret_value = FAILURE;
+	if(NULL != self && NULL != operation) {
+		if(self->num_operations < self->max_operations || SUCCESS == State_GrowOperations(self)) {
 			self->operations[self->num_operations] = operation;
-			Component_SchedulePathFDS(operation, self->cycle);
 			self->num_operations++;
-		} else {
-			LogMessage("ERROR(State_AddOperation): Hit max operations\n", ERROR_LEVEL);
+			ret_value = SUCCESS;
 		}
 	}
+	return ret_value;
+}
+
+static uint8_t State_GrowOperations(state* self) {
+	component** new_list = (0xFFFF > self->max_operations) ? (component**) realloc(self->operations, 2 * self->max_operations * sizeof(component*)) : NULL;
+	if(NULL == new_list) return FAILURE;
+	self->operations = new_list;
+	self->max_operations = (0x8000 > self->max_operations) ? (2 * self->max_operations) : 0xFFFF;
+	return SUCCESS;
 }
 
-uint8_t State_LinkState(state* self, state_machine* sm, uint8_t cycle, condition cond, uint8_t state_number) {
+//Operations outside any if/else run on every path, the others only on paths through their branch
+static uint8_t State_BranchTaken(const link_branch* branch, condition cond) {
+	if(transition_all == cond.type) return TRUE;
+	while(NULL != branch) {
+		if(branch->cond.net_condition == cond.net_condition && branch->cond.type == cond.type) return TRUE;
+		branch = branch->parent;
+	}
+	return FALSE;
+}
+
+uint16_t State_LinkState(state* self, state_machine* sm, uint8_t cycle, const link_branch* branch, uint16_t state_number) {
 	uint8_t has_if_else = FALSE;
-	uint8_t idx;
-	uint8_t cur_state_num = state_number;
+	uint16_t idx;
+	uint16_t cur_state_num = state_number;
 	component* cur_comp;
-	condition cur_cond;
-	condition next_condition = cond;
+	net* split_net = NULL;
+	const link_branch* next_branch = branch;
+	link_branch if_branch, else_branch;
+	state* join_split = NULL;
 	state* new_state = NULL;
 	if(NULL != self && NULL != sm) {
+		Stats_Enter(depth_link);
+		Stats_Count(counter_link_visits);
 		if(state_number < self->state_number) self->state_number = state_number;
 		cur_state_num++;
 		state* cur_cycle = StateMachine_GetCycle(sm, cycle);
 		if(NULL != cur_cycle) {
 			for(idx=0;idx < State_GetNumOperations(cur_cycle);idx++) {
 				cur_comp = State_GetOperation(cur_cycle,idx);
-				cur_cond = Component_GetCondition(cur_comp);
-				if(transition_all == cur_cond.type || cond.type == cur_cond.type) {
+				if(TRUE == State_BranchTaken(branch, Component_GetCondition(cur_comp))) {
 					State_AddOperation(self, cur_comp);
-				}
-				if(component_if_else == Component_GetType(cur_comp)) {
-					has_if_else = TRUE;
-					port temp;
-					temp = Component_GetInputPort(cur_comp, 0);
-					next_condition.net_condition = temp.port_net;
-					next_condition.type = transition_if;
+					if(component_if_else == Component_GetType(cur_comp)) {
+						has_if_else = TRUE;
+						split_net = Component_GetInputPort(cur_comp, 0).port_net;
+					}
 				}
 			}
-			if(transition_all != cond.type) {
-				if((cycle+1) == StateMachine_ConditionEnd(sm, cond) || (cycle == StateMachine_GetLatency(sm))) { //Next state should merge conditional or go to done state
-					new_state = StateMachine_Search(sm, cycle+1); //Search to check if state already exists
-					next_condition.net_condition = NULL; //End condition
-					next_condition.type = transition_all;
-				}
+			//Branches whose operations all ran by now, or every branch at the last cycle, meet in the next state
+			while(NULL != next_branch && ((cycle+1) == StateMachine_ConditionEnd(sm, next_branch->cond) || cycle == StateMachine_GetLatency(sm))) {
+				join_split = next_branch->split;
+				next_branch = next_branch->parent;
+			}
+			if(NULL != join_split) {
+				new_state = join_split->join_state;
 				if(NULL != new_state) State_AddNextState(self, new_state);
 			}
 		}
+		if(TRUE == has_if_else) {
+			if_branch.cond.net_condition = split_net;
+			if_branch.cond.type = transition_if;
+			if_branch.split = self;
+			if_branch.parent = next_branch;
+			else_branch = if_branch;
+			else_branch.cond.type = transition_else;
+			next_branch = &if_branch;
+		}
 		if(NULL == new_state && self->cycle <= StateMachine_GetLatency(sm)) {
-			new_state= State_Create(self->cycle+1);
-			State_AddNextState(self, new_state);
-			cur_state_num = State_LinkState(new_state, sm, cycle+1, next_condition, cur_state_num);
+			new_state = StateMachine_CreateState(sm, self->cycle+1);
+			if(NULL == new_state) {
+				cur_state_num = 0xFFFF;
+			} else {
+				if(NULL != join_split) join_split->join_state = new_state;
+				State_AddNextState(self, new_state);
+				cur_state_num = State_LinkState(new_state, sm, cycle+1, next_branch, cur_state_num);
+			}
 		}
-		if(TRUE == has_if_else) {
-			state* else_state = State_Create(self->cycle+1);
-			State_AddNextState(self, else_state);
-			next_condition.type = transition_else;
-			cur_state_num = State_LinkState(else_state, sm, cycle+1, next_condition, cur_state_num);
+		if(TRUE == has_if_else && 0xFFFF != cur_state_num) {
+			state* else_state = StateMachine_CreateState(sm, self->cycle+1);
+			if(NULL == else_state) {
+				cur_state_num = 0xFFFF;
+			} else {
+				State_AddNextState(self, else_state);
+				cur_state_num = State_LinkState(else_state, sm, cycle+1, &else_branch, cur_state_num);
+			}
 		}
+		Stats_Leave(depth_link);
 	}
 	return cur_state_num;
 }
@@ -126,6 +186,7 @@ state* State_Search(state* self, uint8_t cycle) {
 	state* ret = NULL;
 	uint8_t idx;
 	if(NULL != self) {
+		Stats_Count(counter_link_visits);
 		if(cycle > self->cycle) {
 			for(idx=0;idx<self->num_states;idx++) {
 				ret = State_Search(self->next_state[idx], cycle);
@@ -163,37 +224,90 @@ state* State_GetNextState(state* self, uint8_t idx) {
 	return ret_value;
 }
 
+//Next states are not freed here, branches merge so a state can have several predecessors.
+//The state machine that created a state owns it and frees it in StateMachine_Destroy
 void State_Destroy(state** self) {
 	if(NULL != (*self)) {
-		while((*self)->num_states > 0) {
-			(*self)->num_states--;
-			//State_Destroy(&((*self)->next_state[(*self)->num_states]));
-		}
 		free((*self)->operations);
 		free((*self));
 		(*self) = NULL;
 	}
 }
 
-uint8_t State_GetNumOperations(state* self) {
-	uint8_t ret_value = 0;
+void State_SetNextState(state* self, uint8_t idx, state* next_state) {
+	if(NULL != self && NULL != next_state && idx < self->num_states) {
+		self->next_state[idx] = next_state;
+	}
+}
+
+void State_RemoveNextState(state* self, uint8_t idx) {
+	if(NULL != self && idx < self->num_states) {
+		if(0 == idx) {
+			self->next_state[0] = self->next_state[1];
+		}
+		self->next_state[1] = NULL;
+		self->num_states--;
+	}
+}
+
+static int State_ComparePointers(const void* a, const void* b) {
+	uintptr_t ptr_a = (uintptr_t) (*(component* const*) a);
+	uintptr_t ptr_b = (uintptr_t) (*(component* const*) b);
+	return (ptr_a > ptr_b) - (ptr_a < ptr_b);
+}
+
+int State_CompareOperations(state* self, state* other) {
+	component** self_ops;
+	component** other_ops;
+	uint16_t idx;
+	int ret = 0;
+	if(NULL == self || NULL == other) return (NULL != self) - (NULL != other);
+	if(self->num_operations != other->num_operations) {
+		return (self->num_operations > other->num_operations) ? 1 : -1;
+	}
+	if(0 == self->num_operations) return 0;
+	self_ops = (component**) malloc(2 * self->num_operations * sizeof(component*));
+	if(NULL == self_ops) return State_ComparePointers(&self, &other);
+	other_ops = &self_ops[self->num_operations];
+	//Operation order within a state does not matter, compare them as sets
+	for(idx = 0; idx < self->num_operations; idx++) {
+		self_ops[idx] = self->operations[idx];
+		other_ops[idx] = other->operations[idx];
+	}
+	qsort(self_ops, self->num_operations, sizeof(component*), State_ComparePointers);
+	qsort(other_ops, other->num_operations, sizeof(component*), State_ComparePointers);
+	for(idx = 0; idx < self->num_operations && 0 == ret; idx++) {
+		ret = State_ComparePointers(&self_ops[idx], &other_ops[idx]);
+	}
+	free(self_ops);
+	return ret;
+}
+
+uint16_t State_GetNumOperations(state* self) {
+	uint16_t ret_value = 0;
 	if(NULL != self) {
 		ret_value = self->num_operations;
 	}
 	return ret_value;
 }
 
-component* State_GetOperation(state* self, uint8_t idx) {
-	component* ret_value;
-	if(NULL != self) {
+component* State_GetOperation(state* self, uint16_t idx) {
+	component* ret_value = NULL;
+	if(NULL != self && idx < self->num_operations) {
 		ret_value = self->operations[idx];
 	}
 
 	return ret_value;
 }
 
-uint8_t State_GetStateNumber(state* self) {
-	uint8_t ret = 0;
+void State_SetStateNumber(state* self, uint16_t state_number) {
+	if(NULL != self) {
+		self->state_number = state_number;
+	}
+}
+
+uint16_t State_GetStateNumber(state* self) {
+	uint16_t ret = 0;
 	if(NULL != self) {
 		ret = self->state_number;
 	}
@@ -201,14 +315,10 @@ uint8_t State_GetStateNumber(state* self) {
 }
 
 void State_TestPrint(state* self, FILE* output_file) {
-	uint8_t idx;
-	char line_buffer[128];
+	uint16_t idx;
 	if(NULL != self && NULL != output_file) {
 		fprintf(output_file, "\nCycle #%d\tState #%d\n", self->cycle, self->state_number);
-		for(idx=0;idx<self->num_operations;idx++) {
-			DeclareComponent(self->operations[idx], line_buffer, idx);
-			fprintf(output_file, "\t%s\n", line_buffer);
-		}
+		State_TestPrintOperations(self, output_file);
 		for(idx=0;idx<self->num_states;idx++) {
 			State_TestPrint(self->next_state[idx], output_file);
 		}
@@ -216,12 +326,16 @@ void State_TestPrint(state* self, FILE* output_file) {
 }
 
 void State_TestPrintOperations(state* self, FILE* output_file) {
-	uint8_t idx;
-	char line_buffer[128];
+	uint16_t idx;
+	string_builder* line_buffer;
 	if(NULL != self && NULL != output_file) {
+		line_buffer = StringBuilder_Create(128);
 		for(idx=0;idx<self->num_operations;idx++) {
+			StringBuilder_AppendChar(line_buffer, '\t');
 			DeclareComponent(self->operations[idx], line_buffer, idx);
-			fprintf(output_file, "\t%s\n", line_buffer);
+			StringBuilder_AppendChar(line_buffer, '\n');
 		}
+		StringBuilder_Flush(line_buffer, output_file);
+		StringBuilder_Destroy(&line_buffer);
 	}
 }
@@ -12,20 +12,32 @@
 #include "component.h"
 #include <stdio.h>
 
+//A branch taken on the way to a state while linking, with the branches enclosing it
+typedef struct struct_link_branch link_branch;
+struct struct_link_branch {
+	condition cond;
+	state* split; //State whose if/else opened the branch
+	const link_branch* parent;
+};
+
 state* State_Create(uint8_t cycle);
 void State_AddNextState(state* self, state* next_state);
 void State_AddOperation(state* self, component* operation);
+uint8_t State_RestoreOperation(state* self, component* operation);
 state* State_Search(state* self, uint8_t cycle);
-uint8_t State_LinkState(state* self, state_machine* sm, uint8_t cycle, condition cond, uint8_t state_number);
+uint16_t State_LinkState(state* self, state_machine* sm, uint8_t cycle, const link_branch* branch, uint16_t state_number);
 
 uint8_t State_GetCycle(state* self);
 state* State_GetNextState(state* self, uint8_t idx);
 uint8_t State_GetNumStates(state* self);
+void State_SetNextState(state* self, uint8_t idx, state* next_state);
+void State_RemoveNextState(state* self, uint8_t idx);
+int State_CompareOperations(state* self, state* other);
 void State_Destroy(state** self);
-uint8_t State_GetNumOperations(state* self);
-uint8_t State_GetStateNumber(state* self);
-component* State_GetOperation(state* self, uint8_t idx);
-void State_Print(state* self, uint8_t state_number, char* buffer);
+uint16_t State_GetNumOperations(state* self);
+uint16_t State_GetStateNumber(state* self);
+void State_SetStateNumber(state* self, uint16_t state_number);
+component* State_GetOperation(state* self, uint16_t idx);
 
 void State_TestPrint(state* self, FILE* output_file);
 void State_TestPrintOperations(state* self, FILE* output_file);
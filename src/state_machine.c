@@ -9,39 +9,93 @@
 #include "state_machine.h"
 #include "state.h"
 #include "logger.h"
+#include "trace.h"
+#include "stats.h"
 
 
 typedef struct struct_state_machine {
 	uint8_t latency;
 	state* head;
-	state** state_list;
-	uint8_t num_states;
-	uint8_t total_states;
+	state** state_list; //One state per cycle holding the scheduled operations
+	state** linked_states; //Every state created while linking, owned by the state machine
+	uint16_t num_states;
+	uint16_t max_states;
+	uint16_t total_states;
+	state_encoding encoding;
 } state_machine;
 
 void StateMachine_TestPrint(state_machine* self);
 void StateMachine_TestPrintCycle(state_machine* self);
+static void StateMachine_SortStates(state_machine* self);
+static uint16_t StateMachine_Renumber(state* cur_state, uint8_t* visited, state** linked_states, uint16_t state_number);
 
 
 state_machine* StateMachine_Create(uint8_t latency) {
 	uint8_t idx;
+	const uint16_t initial_states = 16;
 	state_machine* new_sm = (state_machine*) malloc(sizeof(state_machine));
 	if(NULL != new_sm) {
-		new_sm->state_list = (state**) malloc(latency * sizeof(state*));
-		for(idx = 0; idx < latency; idx++) {
-			new_sm->state_list[idx] = State_Create(idx+1);
-		}
+		new_sm->latency = latency;
 		new_sm->total_states = 0;
+		new_sm->encoding = encoding_binary;
 		new_sm->num_states = 0;
-		new_sm->head = State_Create(0);
-		new_sm->latency = latency;
-		if(NULL == new_sm->head || NULL == new_sm->state_list) {
+		new_sm->max_states = initial_states;
+		new_sm->linked_states = (state**) malloc(initial_states * sizeof(state*));
+		new_sm->state_list = (state**) calloc(latency, sizeof(state*));
+		if(NULL != new_sm->state_list) {
+			for(idx = 0; idx < latency; idx++) {
+				new_sm->state_list[idx] = State_Create(idx+1);
+			}
+		}
+		new_sm->head = NULL;
+		if(NULL != new_sm->linked_states) {
+			new_sm->head = StateMachine_CreateState(new_sm, 0);
+		}
+		if(NULL == new_sm->head || NULL == new_sm->state_list || NULL == new_sm->linked_states) {
 			StateMachine_Destroy(&new_sm);
 		}
 	}
 	return new_sm;
 }
 
+state* StateMachine_CreateState(state_machine* self, uint8_t cycle) {
+	state* new_state = NULL;
+	if(NULL != self) {
+		new_state = State_Create(cycle);
+		if(NULL != new_state && FAILURE == StateMachine_RegisterState(self, new_state)) {
+			State_Destroy(&new_state);
+		}
+	}
+	return new_state;
+}
+
+uint8_t StateMachine_RegisterState(state_machine* self, state* new_state) {
+	uint8_t ret_value = FAILURE;
+	uint16_t new_max;
+	state** new_list;
+	if(NULL != self && NULL != new_state) {
+		//State numbers stay below the 0xFFFF a state has before it is numbered, which also marks a failed link
+		if(self->num_states >= 0xFFFE) {
+			LOG_MESSAGE(ERROR_LEVEL, "ERROR(StateMachine_RegisterState): Too many states\n");
+			return FAILURE;
+		}
+		if(self->num_states >= self->max_states) {
+			new_max = (0x8000 > self->max_states) ? (2 * self->max_states) : 0xFFFF;
+			new_list = (state**) realloc(self->linked_states, new_max * sizeof(state*));
+			if(NULL == new_list) {
+				LOG_MESSAGE(ERROR_LEVEL, "ERROR(StateMachine_RegisterState): Could not grow state list\n");
+				return FAILURE;
+			}
+			self->linked_states = new_list;
+			self->max_states = new_max;
+		}
+		self->linked_states[self->num_states] = new_state;
+		self->num_states++;
+		ret_value = SUCCESS;
+	}
+	return ret_value;
+}
+
 void StateMachine_ScheduleOperation(state_machine* self, component* op, uint8_t cycle) {
 	state* schedule_state = NULL;
 	if(NULL != self && NULL != op && cycle > 0) {
@@ -53,41 +107,61 @@ void StateMachine_ScheduleOperation(state_machine* self, component* op, uint8_t
 	}
 }
 
-void StateMachine_Link(state_machine* self) {
-	condition initial_condition = {.type = transition_all, .net_condition = NULL};
+//Places an operation in the cycle a restored schedule puts it in, without updating any time frames
+uint8_t StateMachine_RestoreOperation(state_machine* self, component* op, uint8_t cycle) {
+	uint8_t ret_value = FAILURE;
+	if(NULL != self && NULL != op && cycle > 0 && self->latency >= cycle) {
+		ret_value = State_RestoreOperation(self->state_list[cycle-1], op);
+	}
+	return ret_value;
+}
+
+uint8_t StateMachine_Link(state_machine* self) {
+	uint8_t ret_value = FAILURE;
 	if(NULL != self) {
 		StateMachine_TestPrintCycle(self);
-		self->total_states = State_LinkState(self->head, self, 0, initial_condition, 0);
+		self->total_states = State_LinkState(self->head, self, 0, NULL, 0);
+		if(0xFFFF == self->total_states) {
+			LOG_MESSAGE(ERROR_LEVEL, "ERROR(StateMachine_Link): Could not create every linked state\n");
+			self->total_states = 0;
+			return FAILURE;
+		}
+		StateMachine_SortStates(self);
 		StateMachine_TestPrint(self);
+		ret_value = SUCCESS;
 	}
+	return ret_value;
 }
 
+//Cycle after the last operation under the condition, including the operations of if/else nested in it
 uint8_t StateMachine_ConditionEnd(state_machine* self, condition cond) {
-	uint8_t c_idx;
+	uint16_t c_idx;
 	uint8_t conditional_used = FALSE;
 	state* cur_cycle;
 	component* cur_comp;
+	condition nested_cond;
+	uint8_t nested_end;
 	uint8_t end_cycle = 0;
 	if(NULL != self && cond.type != transition_all) {
 		uint8_t idx = self->latency;
-		end_cycle = self->latency+1; //Has to end at the Done state
 		while(idx > 0) {
 			idx--;
 			cur_cycle = self->state_list[idx];
-			conditional_used = FALSE;
 			for(c_idx=0;c_idx < State_GetNumOperations(cur_cycle);c_idx++) {
 				cur_comp = State_GetOperation(cur_cycle, c_idx);
 				condition comp_cond = Component_GetCondition(cur_comp);
-				if(comp_cond.net_condition == cond.net_condition) { //If the cycle contains a condition with the same net then it is the last cycle to have the condition
-					end_cycle = idx+2;
-					conditional_used = TRUE;
-					break;
+				if(comp_cond.net_condition != cond.net_condition) continue;
+				if(FALSE == conditional_used) end_cycle = idx+2;
+				conditional_used = TRUE;
+				if(component_if_else == Component_GetType(cur_comp)) {
+					nested_cond.net_condition = Component_GetInputPort(cur_comp, 0).port_net;
+					nested_cond.type = transition_if;
+					nested_end = StateMachine_ConditionEnd(self, nested_cond);
+					if(nested_end > end_cycle) end_cycle = nested_end;
 				}
 			}
-			if(TRUE == conditional_used) {
-				break;
-			}
 		}
+		if(FALSE == conditional_used) end_cycle = self->latency+1; //Has to end at the Done state
 	}
 	return end_cycle;
 }
@@ -128,8 +202,7 @@ void StateMachine_AddState(state_machine* self, state* new_state) {
 	state* next_state;
 	if(NULL != self && NULL != new_state) {
 		//Add it to the list
-		self->state_list[self->num_states] = new_state;
-		self->num_states++;
+		if(FAILURE == StateMachine_RegisterState(self, new_state)) return;
 		new_cycle = State_GetCycle(new_state);
 		cur_state = self->head;
 		while(NULL != cur_state) {
@@ -161,21 +234,268 @@ state* StateMachine_FindState(state_machine* self, void* conditional, uint8_t cy
 	return NULL;
 }
 
-uint8_t StateMachine_GetNumStates(state_machine* self) {
-	uint8_t ret = 0;
+//Linked states are numbered in the order they are linked, keep the list in that order so it can be indexed by state number
+static void StateMachine_SortStates(state_machine* self) {
+	uint16_t idx, state_number;
+	state** sorted_states;
+	if(NULL != self && self->num_states > 0) {
+		sorted_states = (state**) calloc(self->num_states, sizeof(state*));
+		if(NULL == sorted_states) return;
+		for(idx = 0; idx < self->num_states; idx++) {
+			state_number = State_GetStateNumber(self->linked_states[idx]);
+			if(state_number < self->num_states && NULL == sorted_states[state_number]) {
+				sorted_states[state_number] = self->linked_states[idx];
+			} else {
+				LOG_MESSAGE(ERROR_LEVEL, "ERROR(StateMachine_SortStates): Linked states are not numbered consecutively\n");
+				free(sorted_states);
+				return;
+			}
+		}
+		free(self->linked_states);
+		self->linked_states = sorted_states;
+		self->max_states = self->num_states;
+	}
+}
+
+state* StateMachine_GetState(state_machine* self, uint16_t state_number) {
+	state* ret = NULL;
+	if(NULL != self) {
+		if(state_number < self->num_states) {
+			ret = self->linked_states[state_number];
+		}
+	}
+	return ret;
+}
+
+static uint16_t StateMachine_Renumber(state* cur_state, uint8_t* visited, state** linked_states, uint16_t state_number) {
+	uint8_t idx;
+	if(NULL != cur_state && FALSE == visited[State_GetStateNumber(cur_state)]) {
+		visited[State_GetStateNumber(cur_state)] = TRUE;
+		linked_states[state_number] = cur_state;
+		state_number++;
+		for(idx = 0; idx < State_GetNumStates(cur_state); idx++) {
+			state_number = StateMachine_Renumber(State_GetNextState(cur_state, idx), visited, linked_states, state_number);
+		}
+	}
+	return state_number;
+}
+
+typedef struct {
+	uint16_t state_idx;
+	uint16_t key[3];
+	state* key_state;
+} state_block;
+
+static int StateMachine_CompareSignature(const state_block* block_a, const state_block* block_b) {
+	int ret = (block_a->key[0] > block_b->key[0]) - (block_a->key[0] < block_b->key[0]);
+	if(0 == ret) ret = (block_a->key[1] > block_b->key[1]) - (block_a->key[1] < block_b->key[1]);
+	if(0 == ret) ret = State_CompareOperations(block_a->key_state, block_b->key_state);
+	return ret;
+}
+
+static int StateMachine_CompareTransitions(const state_block* block_a, const state_block* block_b) {
+	int ret = 0;
+	uint8_t idx;
+	for(idx = 0; idx < 3 && 0 == ret; idx++) {
+		ret = (block_a->key[idx] > block_b->key[idx]) - (block_a->key[idx] < block_b->key[idx]);
+	}
+	return ret;
+}
+
+static int StateMachine_SortSignature(const void* a, const void* b) {
+	const state_block* block_a = (const state_block*) a;
+	const state_block* block_b = (const state_block*) b;
+	int ret = StateMachine_CompareSignature(block_a, block_b);
+	if(0 == ret) ret = (block_a->state_idx > block_b->state_idx) - (block_a->state_idx < block_b->state_idx);
+	return ret;
+}
+
+static int StateMachine_SortTransitions(const void* a, const void* b) {
+	const state_block* block_a = (const state_block*) a;
+	const state_block* block_b = (const state_block*) b;
+	int ret = StateMachine_CompareTransitions(block_a, block_b);
+	if(0 == ret) ret = (block_a->state_idx > block_b->state_idx) - (block_a->state_idx < block_b->state_idx);
+	return ret;
+}
+
+/*
+ * Merges equivalent states using partition refinement. States start out grouped by their kind (wait, operation or done),
+ * number of transitions and set of operations. Groups are then split until every state in a group transitions to the
+ * same groups, at which point each group is replaced by its lowest numbered state.
+ */
+uint8_t StateMachine_Minimize(state_machine* self) {
+	uint16_t num_states, idx, num_blocks, prev_blocks;
+	uint16_t* block_id;
+	uint16_t* representative;
+	uint8_t* visited;
+	uint8_t next_idx, kind;
+	state_block* blocks;
+	state* cur_state;
+	state* next_state;
+	const uint16_t no_block = 0xFFFF;
+
+	if(NULL == self || self->num_states < 2) return SUCCESS;
+	num_states = self->num_states;
+	blocks = (state_block*) malloc(num_states * sizeof(state_block));
+	block_id = (uint16_t*) malloc(num_states * sizeof(uint16_t));
+	representative = (uint16_t*) malloc(num_states * sizeof(uint16_t));
+	visited = (uint8_t*) calloc(num_states, sizeof(uint8_t));
+	if(NULL == blocks || NULL == block_id || NULL == representative || NULL == visited) {
+		LOG_MESSAGE(ERROR_LEVEL, "ERROR(StateMachine_Minimize): Out of memory\n");
+		free(blocks);
+		free(block_id);
+		free(representative);
+		free(visited);
+		return FAILURE;
+	}
+
+	//Initial partition on state kind, transitions and operation set
+	for(idx = 0; idx < num_states; idx++) {
+		Stats_Count(counter_minimize_visits);
+		cur_state = self->linked_states[idx];
+		if(0 == State_GetCycle(cur_state)) {
+			kind = 0;
+		} else if(State_GetCycle(cur_state) > self->latency) {
+			kind = 2;
+		} else {
+			kind = 1;
+		}
+		blocks[idx].state_idx = idx;
+		blocks[idx].key[0] = kind;
+		blocks[idx].key[1] = State_GetNumStates(cur_state);
+		blocks[idx].key[2] = 0;
+		blocks[idx].key_state = cur_state;
+	}
+	qsort(blocks, num_states, sizeof(state_block), StateMachine_SortSignature);
+	num_blocks = 0;
+	for(idx = 0; idx < num_states; idx++) {
+		if(idx > 0 && 0 != StateMachine_CompareSignature(&blocks[idx-1], &blocks[idx])) num_blocks++;
+		block_id[blocks[idx].state_idx] = num_blocks;
+	}
+	num_blocks++;
+
+	//Refine until the transitions of every state in a block lead to the same blocks
+	do {
+		prev_blocks = num_blocks;
+		for(idx = 0; idx < num_states; idx++) {
+			Stats_Count(counter_minimize_visits);
+			cur_state = self->linked_states[idx];
+			blocks[idx].state_idx = idx;
+			blocks[idx].key[0] = block_id[idx];
+			for(next_idx = 0; next_idx < 2; next_idx++) {
+				next_state = State_GetNextState(cur_state, next_idx);
+				if(next_idx < State_GetNumStates(cur_state) && NULL != next_state) {
+					blocks[idx].key[next_idx+1] = block_id[State_GetStateNumber(next_state)];
+				} else {
+					blocks[idx].key[next_idx+1] = no_block;
+				}
+			}
+		}
+		qsort(blocks, num_states, sizeof(state_block), StateMachine_SortTransitions);
+		num_blocks = 0;
+		for(idx = 0; idx < num_states; idx++) {
+			if(idx > 0 && 0 != StateMachine_CompareTransitions(&blocks[idx-1], &blocks[idx])) num_blocks++;
+			block_id[blocks[idx].state_idx] = num_blocks;
+		}
+		num_blocks++;
+	} while(num_blocks != prev_blocks);
+
+	if(num_blocks < num_states) {
+		//Lowest numbered state of each block represents it
+		for(idx = 0; idx < num_blocks; idx++) {
+			representative[idx] = no_block;
+		}
+		for(idx = 0; idx < num_states; idx++) {
+			if(no_block == representative[block_id[idx]]) representative[block_id[idx]] = idx;
+		}
+		for(idx = 0; idx < num_states; idx++) {
+			cur_state = self->linked_states[idx];
+			if(representative[block_id[idx]] != idx) continue;
+			for(next_idx = 0; next_idx < State_GetNumStates(cur_state); next_idx++) {
+				next_state = State_GetNextState(cur_state, next_idx);
+				State_SetNextState(cur_state, next_idx, self->linked_states[representative[block_id[State_GetStateNumber(next_state)]]]);
+			}
+			if(2 == State_GetNumStates(cur_state) && State_GetNextState(cur_state, 0) == State_GetNextState(cur_state, 1)) {
+				State_RemoveNextState(cur_state, 1); //Both branches lead to the same state
+			}
+		}
+		for(idx = 0; idx < num_states; idx++) {
+			if(representative[block_id[idx]] != idx) {
+				State_Destroy(&(self->linked_states[idx]));
+			}
+		}
+		//Number the remaining states in link order so they print the same way linking numbered them
+		self->num_states = StateMachine_Renumber(self->head, visited, self->linked_states, 0);
+		for(idx = 0; idx < self->num_states; idx++) {
+			State_SetStateNumber(self->linked_states[idx], idx);
+		}
+		self->total_states = self->num_states;
+		LOG_MESSAGE(MESSAGE_LEVEL, "MSG(StateMachine_Minimize): Reduced %d states to %d\n", num_states, self->num_states);
+	}
+
+	free(blocks);
+	free(block_id);
+	free(representative);
+	free(visited);
+	return SUCCESS;
+}
+
+uint16_t StateMachine_GetNumStates(state_machine* self) {
+	uint16_t ret = 0;
 	if(NULL != self) {
 		ret = self->total_states;
 	}
 	return ret;
 }
 
+void StateMachine_SetEncoding(state_machine* self, state_encoding encoding) {
+	if(NULL != self && encoding < encoding_error) {
+		self->encoding = encoding;
+	}
+}
+
+state_encoding StateMachine_GetEncoding(state_machine* self) {
+	state_encoding ret = encoding_error;
+	if(NULL != self) {
+		ret = self->encoding;
+	}
+	return ret;
+}
+
+//Number of bits in the state register for the selected encoding
+uint16_t StateMachine_GetStateWidth(state_machine* self) {
+	uint16_t width = 1;
+	uint16_t max_code;
+	if(NULL != self) {
+		if(encoding_onehot == self->encoding) {
+			width = (self->total_states > 1) ? self->total_states : 1;
+		} else if(self->total_states > 1) {
+			max_code = self->total_states - 1;
+			width = 0;
+			while(0 != max_code) {
+				width++;
+				max_code >>= 1;
+			}
+		}
+	}
+	return width;
+}
+
 void StateMachine_Destroy(state_machine** self) {
+	uint8_t idx;
 	if(NULL != (*self)) {
-		State_Destroy(&(*self)->head);
-		while((*self)->num_states > 0) {
-			(*self)->num_states--;
-			State_Destroy(&((*self)->state_list[(*self)->num_states]));
+		if(NULL != (*self)->linked_states) {
+			while((*self)->num_states > 0) {
+				(*self)->num_states--;
+				State_Destroy(&((*self)->linked_states[(*self)->num_states]));
+			}
+		}
+		if(NULL != (*self)->state_list) {
+			for(idx = 0; idx < (*self)->latency; idx++) {
+				State_Destroy(&((*self)->state_list[idx]));
+			}
 		}
+		free((*self)->linked_states);
 		free((*self)->state_list);
 		free(*self);
 		*self = NULL;
@@ -185,11 +505,8 @@ void StateMachine_Destroy(state_machine** self) {
 void StateMachine_TestPrint(state_machine* self) {
 	FILE* fp;
 	if(NULL != self) {
-		fp = fopen("./test/StateMachine.txt", "w+");
-		if(NULL == fp) {
-			LogMessage("Error: Cannot open output file\n", ERROR_LEVEL);
-			return;
-		}
+		fp = Trace_Open(trace_state_machine, "StateMachine.txt");
+		if(NULL == fp) return;
 		State_TestPrint(self->head, fp);
 		fclose(fp);
 	}
@@ -199,11 +516,8 @@ void StateMachine_TestPrintCycle(state_machine* self) {
 	FILE* fp;
 	uint8_t idx;
 	if(NULL != self) {
-		fp = fopen("./test/StateMachineCycle.txt", "w+");
-		if(NULL == fp) {
-			LogMessage("Error: Cannot open output file\n", ERROR_LEVEL);
-			return;
-		}
+		fp = Trace_Open(trace_state_cycles, "StateMachineCycle.txt");
+		if(NULL == fp) return;
 		for(idx=0;idx<self->latency;idx++) {
 			fprintf(fp, "Cycle %d\n", idx+1);
 			State_TestPrintOperations(self->state_list[idx], fp);
@@ -12,15 +12,23 @@
 
 state_machine* StateMachine_Create(uint8_t latency);
 
+state* StateMachine_CreateState(state_machine* self, uint8_t cycle);
+uint8_t StateMachine_RegisterState(state_machine* self, state* new_state);
 void StateMachine_AddState(state_machine* self, state* new_state);
 void StateMachine_ScheduleOperation(state_machine* self, component* op, uint8_t cycle);
+uint8_t StateMachine_RestoreOperation(state_machine* self, component* op, uint8_t cycle);
 void StateMachine_InsertState(state_machine* self, state* new_state, transition state_transition);
 state* StateMachine_FindState(state_machine* self, void* conditional, uint8_t cycle);
 state* StateMachine_Search(state_machine* self, uint8_t cycle);
 uint8_t StateMachine_ConditionEnd(state_machine* self, condition cond);
-void StateMachine_Link(state_machine* self);
+uint8_t StateMachine_Link(state_machine* self);
+uint8_t StateMachine_Minimize(state_machine* self);
 uint8_t StateMachine_GetLatency(state_machine* self);
-uint8_t StateMachine_GetNumStates(state_machine* self);
+uint16_t StateMachine_GetNumStates(state_machine* self);
+void StateMachine_SetEncoding(state_machine* self, state_encoding encoding);
+state_encoding StateMachine_GetEncoding(state_machine* self);
+uint16_t StateMachine_GetStateWidth(state_machine* self);
+state* StateMachine_GetState(state_machine* self, uint16_t state_number);
 
 state* StateMachine_GetCycle(state_machine* self, uint8_t cycle);
 
@@ -0,0 +1,266 @@
+/*
+ * stats.c
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "stats.h"
+#include "string_builder.h"
+#include "timeline.h"
+
+typedef struct {
+	uint32_t calls;
+	double wall;
+	double cpu;
+	double max_wall;
+	double wall_start; //Start of the running call
+	double cpu_start;
+} phase_time;
+
+typedef struct struct_run_stats {
+	phase_time phases[num_phases];
+	uint64_t counters[num_counters];
+	uint16_t depths[num_depths];
+	uint16_t max_depths[num_depths];
+	uint16_t num_nets;
+	uint16_t num_components;
+	uint16_t num_states;
+	uint8_t schedule_length; //Last cycle with a busy operation, zero until the job is scheduled
+	uint16_t peak_usage[resource_none];
+	uint16_t bound_units[resource_none]; //Zero unless resources are bound
+} run_stats;
+
+static const char* const phase_names[num_phases] = {"read", "asap", "alap", "fds_iteration", "link", "minimize", "emit"};
+static const char* const resource_names[resource_none] = {"multiplier", "divider", "logical", "alu"};
+
+//Stats of the job running on this thread, NULL when it does not collect any
+static _Thread_local run_stats* bound_stats = NULL;
+
+static double Stats_Now(clockid_t clock);
+static void Stats_AppendMs(string_builder* sb, double seconds);
+static void Stats_PrintText(run_stats* self, string_builder* sb, long peak_kib);
+static void Stats_PrintJSON(run_stats* self, string_builder* sb, long peak_kib);
+
+run_stats* Stats_Create() {
+	return (run_stats*) calloc(1, sizeof(run_stats));
+}
+
+//Records the calling thread's statistics into self, NULL stops recording. Returns the previous stats.
+run_stats* Stats_Bind(run_stats* self) {
+	run_stats* prev_stats = bound_stats;
+	bound_stats = self;
+	return prev_stats;
+}
+
+void Stats_Destroy(run_stats** self) {
+	if(NULL != self && NULL != *self) {
+		if(bound_stats == *self) bound_stats = NULL;
+		free(*self);
+		*self = NULL;
+	}
+}
+
+static double Stats_Now(clockid_t clock) {
+	struct timespec now;
+	clock_gettime(clock, &now);
+	return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+}
+
+void Stats_BeginPhase(stats_phase phase) {
+	if(phase >= num_phases) return;
+	Timeline_Begin(phase_names[phase], NULL);
+	if(NULL != bound_stats) {
+		bound_stats->phases[phase].wall_start = Stats_Now(CLOCK_MONOTONIC);
+		bound_stats->phases[phase].cpu_start = Stats_Now(CLOCK_THREAD_CPUTIME_ID);
+	}
+}
+
+void Stats_EndPhase(stats_phase phase) {
+	phase_time* cur_phase;
+	double wall;
+	if(phase >= num_phases) return;
+	if(NULL != bound_stats) {
+		cur_phase = &bound_stats->phases[phase];
+		wall = Stats_Now(CLOCK_MONOTONIC) - cur_phase->wall_start;
+		cur_phase->cpu += Stats_Now(CLOCK_THREAD_CPUTIME_ID) - cur_phase->cpu_start;
+		cur_phase->wall += wall;
+		if(wall > cur_phase->max_wall) cur_phase->max_wall = wall;
+		cur_phase->calls++;
+	}
+	Timeline_End(phase_names[phase]);
+}
+
+void Stats_Count(stats_counter counter) {
+	if(NULL != bound_stats && counter < num_counters) {
+		bound_stats->counters[counter]++;
+	}
+}
+
+void Stats_Enter(stats_depth depth) {
+	if(NULL != bound_stats && depth < num_depths) {
+		bound_stats->depths[depth]++;
+		if(bound_stats->depths[depth] > bound_stats->max_depths[depth]) {
+			bound_stats->max_depths[depth] = bound_stats->depths[depth];
+		}
+	}
+}
+
+void Stats_Leave(stats_depth depth) {
+	if(NULL != bound_stats && depth < num_depths && 0 < bound_stats->depths[depth]) {
+		bound_stats->depths[depth]--;
+	}
+}
+
+void Stats_SetSize(run_stats* self, uint16_t num_nets, uint16_t num_components, uint16_t num_states) {
+	if(NULL != self) {
+		self->num_nets = num_nets;
+		self->num_components = num_components;
+		self->num_states = num_states;
+	}
+}
+
+//Peak usage is indexed by resource_type up to resource_none
+void Stats_SetSchedule(run_stats* self, uint8_t length, const uint16_t* peak_usage) {
+	uint8_t idx;
+	if(NULL != self && NULL != peak_usage) {
+		self->schedule_length = length;
+		for(idx = 0; idx < resource_none; idx++) self->peak_usage[idx] = peak_usage[idx];
+	}
+}
+
+void Stats_SetBinding(run_stats* self, const uint16_t* bound_units) {
+	uint8_t idx;
+	if(NULL != self && NULL != bound_units) {
+		for(idx = 0; idx < resource_none; idx++) self->bound_units[idx] = bound_units[idx];
+	}
+}
+
+static void Stats_AppendMs(string_builder* sb, double seconds) {
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.3f", seconds * 1000.0);
+	StringBuilder_AppendString(sb, buffer);
+}
+
+static void Stats_PrintText(run_stats* self, string_builder* sb, long peak_kib) {
+	uint8_t idx;
+	char line[96];
+	StringBuilder_AppendString(sb, "Synthesis statistics, times in ms\n\n");
+	StringBuilder_AppendString(sb, "Phase          Calls       Wall        CPU   Max wall\n");
+	for(idx = 0; idx < num_phases; idx++) {
+		snprintf(line, sizeof(line), "%-13s %6u %10.3f %10.3f %10.3f\n", phase_names[idx], self->phases[idx].calls,
+				self->phases[idx].wall * 1000.0, self->phases[idx].cpu * 1000.0, self->phases[idx].max_wall * 1000.0);
+		StringBuilder_AppendString(sb, line);
+	}
+	snprintf(line, sizeof(line), "\nNets: %u\nComponents: %u\nStates: %u\n", self->num_nets, self->num_components, self->num_states);
+	StringBuilder_AppendString(sb, line);
+	snprintf(line, sizeof(line), "Schedule length: %u cycles\nPeak units:", self->schedule_length);
+	StringBuilder_AppendString(sb, line);
+	for(idx = 0; idx < resource_none; idx++) {
+		snprintf(line, sizeof(line), "%s %s %u", (0 == idx) ? "" : ",", resource_names[idx], self->peak_usage[idx]);
+		StringBuilder_AppendString(sb, line);
+	}
+	StringBuilder_AppendString(sb, "\nBound units:");
+	for(idx = 0; idx < resource_none; idx++) {
+		snprintf(line, sizeof(line), "%s %s %u", (0 == idx) ? "" : ",", resource_names[idx], self->bound_units[idx]);
+		StringBuilder_AppendString(sb, line);
+	}
+	StringBuilder_AppendString(sb, "\n");
+	snprintf(line, sizeof(line), "Force evaluations: %llu\n", (unsigned long long) self->counters[counter_force_evaluations]);
+	StringBuilder_AppendString(sb, line);
+	snprintf(line, sizeof(line), "FDS candidates: %llu\n", (unsigned long long) self->counters[counter_fds_candidates]);
+	StringBuilder_AppendString(sb, line);
+	snprintf(line, sizeof(line), "Distribution graph rebuilds: %llu\n", (unsigned long long) self->counters[counter_distribution_rebuilds]);
+	StringBuilder_AppendString(sb, line);
+	snprintf(line, sizeof(line), "State visits: link %llu, minimize %llu\n", (unsigned long long) self->counters[counter_link_visits],
+			(unsigned long long) self->counters[counter_minimize_visits]);
+	StringBuilder_AppendString(sb, line);
+	snprintf(line, sizeof(line), "Max depth: schedule path %u, force %u, link %u\n", self->max_depths[depth_schedule_path],
+			self->max_depths[depth_force], self->max_depths[depth_link]);
+	StringBuilder_AppendString(sb, line);
+	snprintf(line, sizeof(line), "Peak memory: %ld KiB for the process\n", peak_kib);
+	StringBuilder_AppendString(sb, line);
+}
+
+static void Stats_PrintJSON(run_stats* self, string_builder* sb, long peak_kib) {
+	uint8_t idx;
+	StringBuilder_AppendString(sb, "{\n\t\"phases\": [\n");
+	for(idx = 0; idx < num_phases; idx++) {
+		StringBuilder_AppendString(sb, "\t\t{\"name\": \"");
+		StringBuilder_AppendString(sb, phase_names[idx]);
+		StringBuilder_AppendString(sb, "\", \"calls\": ");
+		StringBuilder_AppendUnsigned(sb, self->phases[idx].calls);
+		StringBuilder_AppendString(sb, ", \"wall_ms\": ");
+		Stats_AppendMs(sb, self->phases[idx].wall);
+		StringBuilder_AppendString(sb, ", \"cpu_ms\": ");
+		Stats_AppendMs(sb, self->phases[idx].cpu);
+		StringBuilder_AppendString(sb, ", \"max_wall_ms\": ");
+		Stats_AppendMs(sb, self->phases[idx].max_wall);
+		StringBuilder_AppendString(sb, (idx + 1 < num_phases) ? "},\n" : "}\n");
+	}
+	StringBuilder_AppendString(sb, "\t],\n\t\"nets\": ");
+	StringBuilder_AppendUnsigned(sb, self->num_nets);
+	StringBuilder_AppendString(sb, ",\n\t\"components\": ");
+	StringBuilder_AppendUnsigned(sb, self->num_components);
+	StringBuilder_AppendString(sb, ",\n\t\"states\": ");
+	StringBuilder_AppendUnsigned(sb, self->num_states);
+	StringBuilder_AppendString(sb, ",\n\t\"schedule_length\": ");
+	StringBuilder_AppendUnsigned(sb, self->schedule_length);
+	StringBuilder_AppendString(sb, ",\n\t\"peak_usage\": {");
+	for(idx = 0; idx < resource_none; idx++) {
+		StringBuilder_AppendString(sb, (0 == idx) ? "\"" : ", \"");
+		StringBuilder_AppendString(sb, resource_names[idx]);
+		StringBuilder_AppendString(sb, "\": ");
+		StringBuilder_AppendUnsigned(sb, self->peak_usage[idx]);
+	}
+	StringBuilder_AppendString(sb, "},\n\t\"bound_units\": {");
+	for(idx = 0; idx < resource_none; idx++) {
+		StringBuilder_AppendString(sb, (0 == idx) ? "\"" : ", \"");
+		StringBuilder_AppendString(sb, resource_names[idx]);
+		StringBuilder_AppendString(sb, "\": ");
+		StringBuilder_AppendUnsigned(sb, self->bound_units[idx]);
+	}
+	StringBuilder_AppendString(sb, "},\n\t\"force_evaluations\": ");
+	StringBuilder_AppendUnsigned(sb, self->counters[counter_force_evaluations]);
+	StringBuilder_AppendString(sb, ",\n\t\"fds_candidates\": ");
+	StringBuilder_AppendUnsigned(sb, self->counters[counter_fds_candidates]);
+	StringBuilder_AppendString(sb, ",\n\t\"distribution_rebuilds\": ");
+	StringBuilder_AppendUnsigned(sb, self->counters[counter_distribution_rebuilds]);
+	StringBuilder_AppendString(sb, ",\n\t\"link_visits\": ");
+	StringBuilder_AppendUnsigned(sb, self->counters[counter_link_visits]);
+	StringBuilder_AppendString(sb, ",\n\t\"minimize_visits\": ");
+	StringBuilder_AppendUnsigned(sb, self->counters[counter_minimize_visits]);
+	StringBuilder_AppendString(sb, ",\n\t\"max_depth\": {\"schedule_path\": ");
+	StringBuilder_AppendUnsigned(sb, self->max_depths[depth_schedule_path]);
+	StringBuilder_AppendString(sb, ", \"force\": ");
+	StringBuilder_AppendUnsigned(sb, self->max_depths[depth_force]);
+	StringBuilder_AppendString(sb, ", \"link\": ");
+	StringBuilder_AppendUnsigned(sb, self->max_depths[depth_link]);
+	StringBuilder_AppendString(sb, "},\n\t\"peak_rss_kib\": ");
+	StringBuilder_AppendInt(sb, peak_kib);
+	StringBuilder_AppendString(sb, "\n}\n");
+}
+
+//Peak memory is the resident set high-water mark of the whole process, shared by the jobs of a batch
+uint8_t Stats_Print(run_stats* self, FILE* fp, report_format format) {
+	struct rusage usage;
+	long peak_kib = 0;
+	uint8_t ret_value;
+	string_builder* sb;
+	if(NULL == self || NULL == fp) return FAILURE;
+	if(0 == getrusage(RUSAGE_SELF, &usage)) peak_kib = usage.ru_maxrss;
+	sb = StringBuilder_Create(1024);
+	if(NULL == sb) return FAILURE;
+	if(format_json == format) {
+		Stats_PrintJSON(self, sb, peak_kib);
+	} else {
+		Stats_PrintText(self, sb, peak_kib);
+	}
+	ret_value = StringBuilder_Flush(sb, fp);
+	StringBuilder_Destroy(&sb);
+	return ret_value;
+}
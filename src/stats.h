@@ -0,0 +1,63 @@
+/*
+ * stats.h
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#ifndef STATS_H_
+#define STATS_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "global.h"
+
+//Timed phases of one job, FDS iterations are timed one by one and reported in aggregate
+typedef enum {
+	phase_read=0,
+	phase_asap,
+	phase_alap,
+	phase_fds_iteration,
+	phase_link,
+	phase_minimize,
+	phase_emit,
+	num_phases
+} stats_phase;
+
+typedef enum {
+	counter_force_evaluations=0,
+	counter_fds_candidates,
+	counter_distribution_rebuilds,
+	counter_link_visits, //States linked or walked past by State_Search
+	counter_minimize_visits, //States examined by each partition refinement pass
+	num_counters
+} stats_counter;
+
+//Recursions whose deepest nesting is recorded
+typedef enum {
+	depth_schedule_path=0,
+	depth_force,
+	depth_link,
+	num_depths
+} stats_depth;
+
+typedef struct struct_run_stats run_stats;
+
+//Statistics are collected per job into the stats bound to the calling thread, nothing is recorded while none is.
+//Phases are recorded on the timeline as well when it is open.
+run_stats* Stats_Create();
+run_stats* Stats_Bind(run_stats* self);
+void Stats_Destroy(run_stats** self);
+
+void Stats_BeginPhase(stats_phase phase);
+void Stats_EndPhase(stats_phase phase);
+void Stats_Count(stats_counter counter);
+void Stats_Enter(stats_depth depth);
+void Stats_Leave(stats_depth depth);
+
+void Stats_SetSize(run_stats* self, uint16_t num_nets, uint16_t num_components, uint16_t num_states);
+void Stats_SetSchedule(run_stats* self, uint8_t length, const uint16_t* peak_usage);
+void Stats_SetBinding(run_stats* self, const uint16_t* bound_units);
+uint8_t Stats_Print(run_stats* self, FILE* fp, report_format format);
+
+#endif /* STATS_H_ */
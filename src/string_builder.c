@@ -0,0 +1,180 @@
+/*
+ * string_builder.c
+ *
+ *  Created on: Dec 4, 2020
+ *      Author: cwhos
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "string_builder.h"
+#include "logger.h"
+
+typedef struct struct_string_builder {
+	char* buffer;
+	size_t length;
+	size_t capacity;
+	uint8_t out_of_memory;
+} string_builder;
+
+static uint8_t StringBuilder_Reserve(string_builder* self, size_t extra);
+
+string_builder* StringBuilder_Create(size_t initial_capacity) {
+	string_builder* new_builder = (string_builder*) malloc(sizeof(string_builder));
+	if(NULL != new_builder) {
+		if(initial_capacity < 16) initial_capacity = 16;
+		new_builder->length = 0;
+		new_builder->capacity = initial_capacity;
+		new_builder->out_of_memory = FALSE;
+		new_builder->buffer = (char*) malloc(initial_capacity);
+		if(NULL == new_builder->buffer) {
+			StringBuilder_Destroy(&new_builder);
+		} else {
+			new_builder->buffer[0] = '\0';
+		}
+	}
+	return new_builder;
+}
+
+//Makes room for extra characters plus the terminator, doubling so appends stay amortized constant time
+static uint8_t StringBuilder_Reserve(string_builder* self, size_t extra) {
+	size_t new_capacity;
+	char* new_buffer;
+	if(self->out_of_memory) return FAILURE;
+	if(self->length + extra + 1 > self->capacity) {
+		new_capacity = self->capacity * 2;
+		while(self->length + extra + 1 > new_capacity) {
+			new_capacity *= 2;
+		}
+		new_buffer = (char*) realloc(self->buffer, new_capacity);
+		if(NULL == new_buffer) {
+			LOG_MESSAGE(ERROR_LEVEL, "ERROR(StringBuilder_Reserve): Out of memory\n");
+			self->out_of_memory = TRUE;
+			return FAILURE;
+		}
+		self->buffer = new_buffer;
+		self->capacity = new_capacity;
+	}
+	return SUCCESS;
+}
+
+void StringBuilder_AppendString(string_builder* self, const char* str) {
+	size_t str_length;
+	if(NULL != self && NULL != str) {
+		str_length = strlen(str);
+		if(SUCCESS == StringBuilder_Reserve(self, str_length)) {
+			memcpy(&self->buffer[self->length], str, str_length + 1);
+			self->length += str_length;
+		}
+	}
+}
+
+void StringBuilder_AppendChar(string_builder* self, char c) {
+	if(NULL != self) {
+		if(SUCCESS == StringBuilder_Reserve(self, 1)) {
+			self->buffer[self->length] = c;
+			self->length++;
+			self->buffer[self->length] = '\0';
+		}
+	}
+}
+
+void StringBuilder_AppendRepeat(string_builder* self, char c, size_t count) {
+	if(NULL != self && count > 0) {
+		if(SUCCESS == StringBuilder_Reserve(self, count)) {
+			memset(&self->buffer[self->length], c, count);
+			self->length += count;
+			self->buffer[self->length] = '\0';
+		}
+	}
+}
+
+void StringBuilder_AppendUnsigned(string_builder* self, unsigned long long value) {
+	char digits[24];
+	uint8_t num_digits = 0;
+	if(NULL != self) {
+		do {
+			digits[num_digits] = (char) ('0' + (value % 10));
+			num_digits++;
+			value /= 10;
+		} while(0 != value);
+		if(SUCCESS == StringBuilder_Reserve(self, num_digits)) {
+			while(num_digits > 0) {
+				num_digits--;
+				self->buffer[self->length] = digits[num_digits];
+				self->length++;
+			}
+			self->buffer[self->length] = '\0';
+		}
+	}
+}
+
+void StringBuilder_AppendInt(string_builder* self, long long value) {
+	if(NULL != self) {
+		if(value < 0) {
+			StringBuilder_AppendChar(self, '-');
+			StringBuilder_AppendUnsigned(self, (unsigned long long) (-(value + 1)) + 1);
+		} else {
+			StringBuilder_AppendUnsigned(self, (unsigned long long) value);
+		}
+	}
+}
+
+const char* StringBuilder_GetString(string_builder* self) {
+	const char* ret_value = "";
+	if(NULL != self) {
+		ret_value = self->buffer;
+	}
+	return ret_value;
+}
+
+size_t StringBuilder_GetLength(string_builder* self) {
+	size_t ret_value = 0;
+	if(NULL != self) {
+		ret_value = self->length;
+	}
+	return ret_value;
+}
+
+uint8_t StringBuilder_HasError(string_builder* self) {
+	uint8_t ret_value = TRUE;
+	if(NULL != self) {
+		ret_value = self->out_of_memory;
+	}
+	return ret_value;
+}
+
+void StringBuilder_Clear(string_builder* self) {
+	if(NULL != self) {
+		self->length = 0;
+		self->buffer[0] = '\0';
+	}
+}
+
+//Drops everything appended after the given length
+void StringBuilder_Truncate(string_builder* self, size_t length) {
+	if(NULL != self && length < self->length) {
+		self->length = length;
+		self->buffer[length] = '\0';
+	}
+}
+
+//Writes the whole buffer with a single call and empties it
+uint8_t StringBuilder_Flush(string_builder* self, FILE* fp) {
+	uint8_t ret_value = FAILURE;
+	if(NULL != self && NULL != fp && FALSE == self->out_of_memory) {
+		if(self->length == fwrite(self->buffer, 1, self->length, fp)) {
+			ret_value = SUCCESS;
+		}
+		StringBuilder_Clear(self);
+	}
+	return ret_value;
+}
+
+void StringBuilder_Destroy(string_builder** self) {
+	if(NULL != *self) {
+		free((*self)->buffer);
+		free((*self));
+		*self = NULL;
+	}
+}
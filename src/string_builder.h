@@ -0,0 +1,32 @@
+/*
+ * string_builder.h
+ *
+ *  Created on: Dec 4, 2020
+ *      Author: cwhos
+ */
+
+#ifndef STRING_BUILDER_H_
+#define STRING_BUILDER_H_
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "global.h"
+
+string_builder* StringBuilder_Create(size_t initial_capacity);
+
+void StringBuilder_AppendString(string_builder* self, const char* str);
+void StringBuilder_AppendChar(string_builder* self, char c);
+void StringBuilder_AppendInt(string_builder* self, long long value);
+void StringBuilder_AppendUnsigned(string_builder* self, unsigned long long value);
+void StringBuilder_AppendRepeat(string_builder* self, char c, size_t count);
+
+const char* StringBuilder_GetString(string_builder* self);
+size_t StringBuilder_GetLength(string_builder* self);
+uint8_t StringBuilder_HasError(string_builder* self);
+void StringBuilder_Clear(string_builder* self);
+void StringBuilder_Truncate(string_builder* self, size_t length);
+uint8_t StringBuilder_Flush(string_builder* self, FILE* fp);
+void StringBuilder_Destroy(string_builder** self);
+
+#endif /* STRING_BUILDER_H_ */
@@ -0,0 +1,359 @@
+/*
+ * synthesis.c
+ *
+ *  Created on: Dec 12, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "synthesis.h"
+#include "cache.h"
+#include "logger.h"
+#include "string_builder.h"
+#include "netlist_reader.h"
+#include "circuit.h"
+#include "state_machine.h"
+#include "file_writer.h"
+#include "model_writer.h"
+#include "simulator.h"
+#include "testbench_writer.h"
+#include "timing.h"
+#include "ir.h"
+#include "stats.h"
+#include "timeline.h"
+
+//Runs one input file through parsing, scheduling and every output the options ask for.
+//Messages meant for the user go to report, which is stdout for a single run.
+job_status Synthesis_Run(hlsyn_options* options, FILE* report) {
+	return Synthesis_RunStreams(options, NULL, NULL, report, NULL);
+}
+
+static job_status Synthesis_Execute(hlsyn_options* options, FILE* netlist, FILE* verilog, FILE* timing, FILE* report, synthesis_stats* stats);
+static job_status Synthesis_RunCached(hlsyn_options* options, FILE* netlist, FILE* verilog, FILE* report, synthesis_stats* stats);
+static uint8_t Synthesis_ReadInput(hlsyn_options* options, FILE* netlist, circuit* netlist_circuit, state_machine* sm, uint8_t* scheduled);
+static char* Synthesis_ReadAll(FILE* fp, size_t* size);
+static uint8_t Synthesis_WriteFile(char* file_name, const char* data, size_t size);
+static void Synthesis_PrintStats(hlsyn_options* options, run_stats* job_stats, FILE* report);
+
+//As Synthesis_Run, but reads the netlist from and writes the Verilog to open streams where they are not NULL
+//instead of the files named in options. stats may be NULL.
+job_status Synthesis_RunStreams(hlsyn_options* options, FILE* netlist, FILE* verilog, FILE* report, synthesis_stats* stats) {
+	job_status status;
+	if(NULL == options || NULL == report) return job_error;
+	Timeline_Begin("job", options->c_file);
+	if(TRUE == Cache_IsEnabled() && TRUE == Cache_IsCacheable(options)) {
+		status = Synthesis_RunCached(options, netlist, verilog, report, stats);
+	} else {
+		if(TRUE == Cache_IsEnabled()) Cache_CountBypass();
+		status = Synthesis_Execute(options, netlist, verilog, NULL, report, stats);
+	}
+	Timeline_End("job");
+	return status;
+}
+
+static char* Synthesis_ReadAll(FILE* fp, size_t* size) {
+	size_t capacity = 4096;
+	size_t num_read;
+	char* data = (char*) malloc(capacity);
+	char* new_data;
+	*size = 0;
+	while(NULL != data) {
+		num_read = fread(&data[*size], 1, capacity - *size, fp);
+		*size += num_read;
+		if(*size < capacity) break;
+		new_data = (char*) realloc(data, 2 * capacity);
+		if(NULL == new_data) {
+			free(data);
+			return NULL;
+		}
+		data = new_data;
+		capacity *= 2;
+	}
+	return data;
+}
+
+static uint8_t Synthesis_WriteFile(char* file_name, const char* data, size_t size) {
+	FILE* fp = fopen(file_name, "w+");
+	if(NULL == fp) {
+		LOG_MESSAGE(ERROR_LEVEL, "Error: Cannot open output file %s\n", file_name);
+		return FAILURE;
+	}
+	if(0 < size) fwrite(data, 1, size, fp);
+	return (0 == fclose(fp)) ? SUCCESS : FAILURE;
+}
+
+//Looks the job up by its netlist text and options. A hit writes the stored outputs without parsing or
+//scheduling, a miss runs the job on the text already read and stores what it produced.
+static job_status Synthesis_RunCached(hlsyn_options* options, FILE* netlist, FILE* verilog, FILE* report, synthesis_stats* stats) {
+	synthesis_stats job_stats = {.num_nets = 0, .num_components = 0, .num_states = 0, .seconds = 0.0, .cached = FALSE};
+	cache_entry entry;
+	string_builder* key;
+	FILE* source = netlist;
+	FILE* text_stream;
+	FILE* verilog_stream;
+	FILE* timing_stream = NULL;
+	FILE* report_stream;
+	char* netlist_text;
+	size_t netlist_size;
+	struct timespec start, end;
+	job_status status = job_success;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if(NULL == source) source = fopen(options->c_file, "rb");
+	if(NULL == source) return Synthesis_Execute(options, NULL, verilog, NULL, report, stats); //Reports the missing file
+	netlist_text = Synthesis_ReadAll(source, &netlist_size);
+	if(source != netlist) fclose(source);
+	if(NULL == netlist_text) return job_error;
+	if(0 < netlist_size && IR_MAGIC[0] == netlist_text[0]) { //Binary IR is not keyed, the key normalizes netlist text
+		Cache_CountBypass();
+		text_stream = fmemopen(netlist_text, netlist_size, "rb");
+		status = (NULL != text_stream) ? Synthesis_Execute(options, text_stream, verilog, NULL, report, stats) : job_error;
+		if(NULL != text_stream) fclose(text_stream);
+		free(netlist_text);
+		return status;
+	}
+	key = Cache_BuildKey(options, netlist_text, netlist_size);
+
+	if(NULL != key && SUCCESS == Cache_Lookup(key, &entry)) {
+		LOG_MESSAGE(MESSAGE_LEVEL, "MSG(Synthesis_RunCached): Cache hit for %s\n", options->c_file);
+		if(NULL != verilog) {
+			if(entry.verilog_size != fwrite(entry.verilog, 1, entry.verilog_size, verilog)) status = job_error;
+		} else if(SUCCESS != Synthesis_WriteFile(options->verilog_file, entry.verilog, entry.verilog_size)) {
+			status = job_error;
+		}
+		if(0 < entry.report_size) fwrite(entry.report, 1, entry.report_size, report);
+		if(NULL != options->timing_file && SUCCESS != Synthesis_WriteFile(options->timing_file, entry.timing, entry.timing_size)) {
+			status = job_error;
+		}
+		job_stats.num_nets = entry.num_nets;
+		job_stats.num_components = entry.num_components;
+		job_stats.num_states = entry.num_states;
+		job_stats.cached = TRUE;
+		CacheEntry_Free(&entry);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		job_stats.seconds = (double) (end.tv_sec - start.tv_sec) + (double) (end.tv_nsec - start.tv_nsec) * 1e-9;
+	} else {
+		//The outputs are captured so they can be stored, then passed on
+		memset(&entry, 0, sizeof(cache_entry));
+		text_stream = fmemopen(netlist_text, netlist_size, "r");
+		verilog_stream = open_memstream(&entry.verilog, &entry.verilog_size);
+		report_stream = open_memstream(&entry.report, &entry.report_size);
+		if(NULL != options->timing_file) timing_stream = open_memstream(&entry.timing, &entry.timing_size);
+		if(NULL == text_stream || NULL == verilog_stream || NULL == report_stream || (NULL != options->timing_file && NULL == timing_stream)) {
+			status = job_error;
+		} else {
+			status = Synthesis_Execute(options, text_stream, verilog_stream, timing_stream, report_stream, &job_stats);
+		}
+		if(NULL != text_stream) fclose(text_stream);
+		if(NULL != verilog_stream) fclose(verilog_stream);
+		if(NULL != timing_stream) fclose(timing_stream);
+		if(NULL != report_stream) fclose(report_stream);
+		if(0 < entry.report_size) fwrite(entry.report, 1, entry.report_size, report);
+		if(0 < entry.verilog_size) {
+			if(NULL != verilog) {
+				fwrite(entry.verilog, 1, entry.verilog_size, verilog);
+			} else if(SUCCESS != Synthesis_WriteFile(options->verilog_file, entry.verilog, entry.verilog_size)) {
+				status = job_error;
+			}
+		}
+		if(0 < entry.timing_size && SUCCESS != Synthesis_WriteFile(options->timing_file, entry.timing, entry.timing_size)) {
+			status = job_error;
+		}
+		if(job_success == status && NULL != key) {
+			entry.num_nets = job_stats.num_nets;
+			entry.num_components = job_stats.num_components;
+			entry.num_states = job_stats.num_states;
+			Cache_Store(key, &entry);
+		}
+		CacheEntry_Free(&entry);
+	}
+
+	if(NULL != stats) *stats = job_stats;
+	StringBuilder_Destroy(&key);
+	free(netlist_text);
+	return status;
+}
+
+//Parses, schedules and writes every output of one job. A timing stream that is not NULL takes the timing report
+//instead of the file named in options.
+static job_status Synthesis_Execute(hlsyn_options* options, FILE* netlist, FILE* verilog, FILE* timing, FILE* report, synthesis_stats* stats) {
+	uint16_t num_registers, num_shared_registers;
+	simulator* sim;
+	uint8_t simulate;
+	const uint32_t default_testbench_vectors = 16;
+	job_status status = job_success;
+	circuit* netlist_circuit;
+	state_machine* sm;
+	uint8_t read_result;
+	uint8_t scheduled = FALSE;
+	struct timespec start, end;
+	run_stats* job_stats = NULL;
+	run_stats* prev_stats = NULL;
+	uint16_t peak_usage[resource_none];
+	uint16_t bound_units[resource_none];
+	uint8_t schedule_length;
+
+	if(NULL == options || NULL == report) return job_error;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if(NULL != options->stats_file) {
+		job_stats = Stats_Create();
+		if(NULL == job_stats) return job_error;
+		prev_stats = Stats_Bind(job_stats);
+	}
+
+	netlist_circuit = Circuit_Create(options->latency);
+	sm = StateMachine_Create(options->latency);
+	if(NULL == netlist_circuit || NULL == sm) {
+		Circuit_Destroy(&netlist_circuit);
+		StateMachine_Destroy(&sm);
+		Stats_Bind(prev_stats);
+		Stats_Destroy(&job_stats);
+		return job_error;
+	}
+	StateMachine_SetEncoding(sm, options->fsm_encoding);
+
+	Stats_BeginPhase(phase_read);
+	read_result = Synthesis_ReadInput(options, netlist, netlist_circuit, sm, &scheduled);
+	Stats_EndPhase(phase_read);
+	if(SUCCESS != read_result) {
+		status = job_read_failed;
+	} else if(FALSE == scheduled && SUCCESS != Circuit_ScheduleForceDirected(netlist_circuit, sm)) {
+		status = job_schedule_failed;
+	} else if(NULL != job_stats && SUCCESS == Circuit_GetScheduleUsage(netlist_circuit, peak_usage, &schedule_length)) {
+		Stats_SetSchedule(job_stats, schedule_length, peak_usage);
+	}
+	//Saved before linking, which adds operations to the linked states and moves if/else time frames again
+	if(NULL != options->ir_file && job_read_failed != status) {
+		if(SUCCESS != Ir_WriteFile(options->ir_file, netlist_circuit, (job_success == status) ? sm : NULL)) status = job_error;
+	}
+	if(job_success == status) {
+		Stats_BeginPhase(phase_link);
+		if(SUCCESS != StateMachine_Link(sm)) status = job_error;
+		Stats_EndPhase(phase_link);
+	}
+	if(job_success == status) {
+		Stats_BeginPhase(phase_minimize);
+		StateMachine_Minimize(sm);
+		Stats_EndPhase(phase_minimize);
+		if(TRUE == options->share_registers) {
+			if(SUCCESS == Circuit_ShareRegisters(netlist_circuit, sm, &num_registers, &num_shared_registers)) {
+				fprintf(report, "Registers: %d before sharing, %d after\n", num_registers, num_shared_registers);
+			}
+		}
+		if(TRUE == options->bind_resources && SUCCESS == Circuit_BindResources(netlist_circuit, sm) && NULL != job_stats) {
+			Circuit_GetBindingUsage(netlist_circuit, bound_units);
+			Stats_SetBinding(job_stats, bound_units);
+		}
+		Stats_BeginPhase(phase_emit);
+		if(NULL != verilog) {
+			if(SUCCESS != PrintStateMachineStream(verilog, netlist_circuit, sm)) status = job_error;
+		} else {
+			PrintStateMachine(options->verilog_file, netlist_circuit, sm);
+		}
+		Stats_EndPhase(phase_emit);
+		if(NULL != options->c_model_file) {
+			PrintCModel(options->c_model_file, netlist_circuit, sm);
+		}
+		if(NULL != timing) {
+			if(SUCCESS != PrintTimingReportStream(timing, netlist_circuit, sm, options->format)) status = job_error;
+		} else if(NULL != options->timing_file) {
+			PrintTimingReport(options->timing_file, netlist_circuit, sm, options->format);
+		}
+		simulate = (0 < options->num_random_vectors || NULL != options->vector_file) ? TRUE : FALSE;
+		if(TRUE == simulate || NULL != options->testbench_file) {
+			sim = Simulator_Create(netlist_circuit, sm);
+			if(NULL == sim) {
+				status = job_simulation_failed;
+			} else {
+				if(NULL != options->testbench_file) {
+					PrintTestbench(options->testbench_file, netlist_circuit, sm, sim, options->vector_file,
+							(TRUE == simulate) ? options->num_random_vectors : default_testbench_vectors, options->seed);
+				}
+				if(TRUE == simulate && SUCCESS != Simulator_RunVectors(sim, options->vector_file, options->num_random_vectors, options->seed, report)) {
+					status = job_simulation_failed;
+				}
+			}
+			Simulator_Destroy(&sim);
+		}
+	}
+
+	if(NULL != stats) {
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		stats->num_nets = Circuit_GetNumNet(netlist_circuit);
+		stats->num_components = Circuit_GetNumComponent(netlist_circuit);
+		stats->num_states = StateMachine_GetNumStates(sm);
+		stats->cached = FALSE;
+		stats->seconds = (double) (end.tv_sec - start.tv_sec) + (double) (end.tv_nsec - start.tv_nsec) * 1e-9;
+	}
+	if(NULL != job_stats) {
+		Stats_Bind(prev_stats);
+		Stats_SetSize(job_stats, Circuit_GetNumNet(netlist_circuit), Circuit_GetNumComponent(netlist_circuit), StateMachine_GetNumStates(sm));
+		Synthesis_PrintStats(options, job_stats, report);
+		Stats_Destroy(&job_stats);
+	}
+	Circuit_Destroy(&netlist_circuit);
+	StateMachine_Destroy(&sm);
+	return status;
+}
+
+//Statistics are written as far as the job got, a file name of "-" appends them to the report
+static void Synthesis_PrintStats(hlsyn_options* options, run_stats* job_stats, FILE* report) {
+	FILE* fp = report;
+	if(0 != strcmp(options->stats_file, "-")) {
+		fp = fopen(options->stats_file, "w+");
+		if(NULL == fp) {
+			LOG_MESSAGE(ERROR_LEVEL, "Error: Cannot open statistics file %s\n", options->stats_file);
+			return;
+		}
+	}
+	if(SUCCESS != Stats_Print(job_stats, fp, options->format)) {
+		LOG_MESSAGE(ERROR_LEVEL, "Error: Failed writing statistics\n");
+	}
+	if(fp != report) fclose(fp);
+}
+
+//Reads the netlist text or binary IR from netlist, or from options->c_file when netlist is NULL. scheduled is set
+//when the IR carried a schedule for this latency and the state machine already holds it.
+static uint8_t Synthesis_ReadInput(hlsyn_options* options, FILE* netlist, circuit* netlist_circuit, state_machine* sm, uint8_t* scheduled) {
+	uint8_t ret_value;
+	FILE* fp = netlist;
+	*scheduled = FALSE;
+	if(NULL == fp) {
+		fp = fopen(options->c_file, "rb");
+		if(NULL == fp) {
+			LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "Error: File Open\n");
+			return FAILURE;
+		}
+	}
+	if(TRUE == Ir_IsIr(fp)) {
+		ret_value = Ir_Read(fp, netlist_circuit, sm, scheduled);
+	} else {
+		ret_value = ReadNetlistStream(fp, netlist_circuit);
+	}
+	if(fp != netlist) fclose(fp);
+	return ret_value;
+}
+
+const char* Synthesis_GetStatusName(job_status status) {
+	const char* name = "error";
+	switch(status) {
+	case job_success:
+		name = "ok";
+		break;
+	case job_read_failed:
+		name = "parse failed";
+		break;
+	case job_schedule_failed:
+		name = "schedule failed";
+		break;
+	case job_simulation_failed:
+		name = "simulation failed";
+		break;
+	default:
+		break;
+	}
+	return name;
+}
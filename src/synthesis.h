@@ -0,0 +1,36 @@
+/*
+ * synthesis.h
+ *
+ *  Created on: Dec 12, 2020
+ *      Author: cwhos
+ */
+
+#ifndef SYNTHESIS_H_
+#define SYNTHESIS_H_
+
+#include <stdio.h>
+#include "global.h"
+#include "options.h"
+
+typedef enum {
+	job_success=0,
+	job_read_failed,
+	job_schedule_failed,
+	job_simulation_failed,
+	job_error
+} job_status;
+
+//Summary of one job, filled in as far as the job got
+typedef struct {
+	uint16_t num_nets;
+	uint16_t num_components;
+	uint16_t num_states;
+	double seconds;
+	uint8_t cached; //The outputs came from the result cache
+} synthesis_stats;
+
+job_status Synthesis_Run(hlsyn_options* options, FILE* report);
+job_status Synthesis_RunStreams(hlsyn_options* options, FILE* netlist, FILE* verilog, FILE* report, synthesis_stats* stats);
+const char* Synthesis_GetStatusName(job_status status);
+
+#endif /* SYNTHESIS_H_ */
@@ -0,0 +1,233 @@
+/*
+ * testbench_writer.c
+ *
+ *  Created on: Dec 10, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include "testbench_writer.h"
+#include "circuit.h"
+#include "net.h"
+#include "simulator.h"
+#include "state_machine.h"
+#include "string_builder.h"
+#include "logger.h"
+
+typedef struct {
+	string_builder* sb;
+	uint32_t num_vectors;
+} testbench_context;
+
+static void Testbench_DeclareSignal(net* self, const char* keyword, string_builder* sb);
+static void Testbench_AppendLiteral(net* self, uint64_t value, string_builder* sb);
+static void Testbench_PrintVector(simulator* sim, void* context, uint32_t vector_idx, const uint64_t* inputs,
+		const uint64_t* expected, const uint64_t* actual, uint32_t num_cycles);
+
+//Writes a self-checking testbench for module HLSM. Each vector is applied, Start is pulsed and the outputs
+//are compared against the behavioural evaluation of the netlist once Done rises. The cycle count of every
+//vector is printed and checked against the one the state machine simulation measured.
+void PrintTestbench(char* file_name, circuit* circ, state_machine* sm, simulator* sim, char* vector_file, uint32_t num_random, uint64_t seed) {
+	FILE* fp;
+	uint16_t idx;
+	net* cur_net;
+	string_builder* tb_buffer;
+	testbench_context context;
+	uint8_t ret_value;
+
+	if(NULL == file_name || NULL == circ || NULL == sm || NULL == sim) return;
+	LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Writing testbench to file\n");
+
+	tb_buffer = StringBuilder_Create(4096);
+	if(NULL == tb_buffer) {
+		LOG_MESSAGE(ERROR_LEVEL, "Error: Cannot allocate output buffer\n");
+		return;
+	}
+
+	StringBuilder_AppendString(tb_buffer, "`timescale 1ns/1ps\n\n");
+	StringBuilder_AppendString(tb_buffer, "module HLSM_tb();\n\n");
+	StringBuilder_AppendString(tb_buffer, "\treg Clk, Rst, Start;\n");
+	for(idx = 0; idx < Simulator_GetNumInputs(sim); idx++) {
+		Testbench_DeclareSignal(Simulator_GetInput(sim, idx), "reg", tb_buffer);
+	}
+	StringBuilder_AppendString(tb_buffer, "\twire Done;\n");
+	for(idx = 0; idx < Simulator_GetNumOutputs(sim); idx++) {
+		Testbench_DeclareSignal(Simulator_GetOutput(sim, idx), "wire", tb_buffer);
+	}
+	StringBuilder_AppendString(tb_buffer, "\tinteger cycles;\n");
+	StringBuilder_AppendString(tb_buffer, "\tinteger errors;\n\n");
+
+	StringBuilder_AppendString(tb_buffer, "\tHLSM uut(.Clk(Clk), .Rst(Rst), .Start(Start), ");
+	for(idx = 0; idx < Simulator_GetNumInputs(sim); idx++) {
+		StringBuilder_AppendChar(tb_buffer, '.');
+		StringBuilder_AppendString(tb_buffer, Net_GetNameRef(Simulator_GetInput(sim, idx)));
+		StringBuilder_AppendChar(tb_buffer, '(');
+		StringBuilder_AppendString(tb_buffer, Net_GetNameRef(Simulator_GetInput(sim, idx)));
+		StringBuilder_AppendString(tb_buffer, "), ");
+	}
+	StringBuilder_AppendString(tb_buffer, ".Done(Done)");
+	for(idx = 0; idx < Simulator_GetNumOutputs(sim); idx++) {
+		StringBuilder_AppendString(tb_buffer, ", .");
+		StringBuilder_AppendString(tb_buffer, Net_GetNameRef(Simulator_GetOutput(sim, idx)));
+		StringBuilder_AppendChar(tb_buffer, '(');
+		StringBuilder_AppendString(tb_buffer, Net_GetNameRef(Simulator_GetOutput(sim, idx)));
+		StringBuilder_AppendChar(tb_buffer, ')');
+	}
+	StringBuilder_AppendString(tb_buffer, ");\n\n");
+	StringBuilder_AppendString(tb_buffer, "\talways #5 Clk = ~Clk;\n\n");
+
+	//The expected values assume every register starts at zero, the RTL has no datapath reset
+	StringBuilder_AppendString(tb_buffer, "\ttask clear_registers;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\tbegin\n");
+	for(idx = 0; idx < Circuit_GetNumNet(circ); idx++) {
+		cur_net = Circuit_GetNet(circ, idx);
+		if(net_input == Net_GetType(cur_net) || 1 != Net_GetUsage(cur_net) || NULL != Net_GetStorage(cur_net)) continue;
+		StringBuilder_AppendString(tb_buffer, "\t\t\tuut.");
+		StringBuilder_AppendString(tb_buffer, Net_GetNameRef(cur_net));
+		StringBuilder_AppendString(tb_buffer, " = 0;\n");
+	}
+	StringBuilder_AppendString(tb_buffer, "\t\tend\n");
+	StringBuilder_AppendString(tb_buffer, "\tendtask\n\n");
+
+	StringBuilder_AppendString(tb_buffer, "\ttask run_vector;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\tbegin\n");
+	StringBuilder_AppendString(tb_buffer, "\t\t\tclear_registers;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\t\tStart = 1;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\t\t@(posedge Clk); #1;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\t\tStart = 0;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\t\tcycles = 1;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\t\twhile(Done !== 1'b1 && cycles < ");
+	StringBuilder_AppendUnsigned(tb_buffer, (unsigned long long) StateMachine_GetNumStates(sm) + 1);
+	StringBuilder_AppendString(tb_buffer, ") begin\n");
+	StringBuilder_AppendString(tb_buffer, "\t\t\t\t@(posedge Clk); #1;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\t\t\tcycles = cycles + 1;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\t\tend\n");
+	StringBuilder_AppendString(tb_buffer, "\t\tend\n");
+	StringBuilder_AppendString(tb_buffer, "\tendtask\n\n");
+
+	StringBuilder_AppendString(tb_buffer, "\tinitial begin\n");
+	StringBuilder_AppendString(tb_buffer, "\t\tClk = 0;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\tRst = 1;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\tStart = 0;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\terrors = 0;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\t@(posedge Clk); #1;\n");
+	StringBuilder_AppendString(tb_buffer, "\t\tRst = 0;\n");
+
+	context.sb = tb_buffer;
+	context.num_vectors = 0;
+	ret_value = Simulator_ForEachVector(sim, vector_file, num_random, seed, Testbench_PrintVector, &context);
+
+	StringBuilder_AppendString(tb_buffer, "\n\t\tif(0 == errors) $display(\"PASS: ");
+	StringBuilder_AppendUnsigned(tb_buffer, context.num_vectors);
+	StringBuilder_AppendString(tb_buffer, " vectors\");\n");
+	StringBuilder_AppendString(tb_buffer, "\t\telse $display(\"FAIL: %0d errors in ");
+	StringBuilder_AppendUnsigned(tb_buffer, context.num_vectors);
+	StringBuilder_AppendString(tb_buffer, " vectors\", errors);\n");
+	StringBuilder_AppendString(tb_buffer, "\t\t$finish;\n");
+	StringBuilder_AppendString(tb_buffer, "\tend\n");
+	StringBuilder_AppendString(tb_buffer, "endmodule\n");
+
+	if(SUCCESS != ret_value) {
+		LOG_MESSAGE(ERROR_LEVEL, "Error: Testbench not written\n");
+	} else {
+		fp = fopen(file_name, "w+");
+		if(NULL == fp) {
+			LOG_MESSAGE(ERROR_LEVEL, "Error: Cannot open testbench file\n");
+		} else {
+			if(SUCCESS != StringBuilder_Flush(tb_buffer, fp)) {
+				LOG_MESSAGE(ERROR_LEVEL, "Error: Could not print to file\n");
+			}
+			fclose(fp);
+		}
+	}
+	StringBuilder_Destroy(&tb_buffer);
+}
+
+static void Testbench_DeclareSignal(net* self, const char* keyword, string_builder* sb) {
+	StringBuilder_AppendChar(sb, '\t');
+	StringBuilder_AppendString(sb, keyword);
+	if(net_signed == Net_GetSign(self)) {
+		StringBuilder_AppendString(sb, " signed");
+	}
+	StringBuilder_AppendString(sb, " [");
+	StringBuilder_AppendInt(sb, Net_GetWidth(self) - 1);
+	StringBuilder_AppendString(sb, ":0] ");
+	StringBuilder_AppendString(sb, Net_GetNameRef(self));
+	StringBuilder_AppendString(sb, ";\n");
+}
+
+//Sized hex literal with every bit spelled out, signed nets get a signed literal so $display prints them signed
+static void Testbench_AppendLiteral(net* self, uint64_t value, string_builder* sb) {
+	uint8_t width = Net_GetWidth(self);
+	int8_t digit_idx;
+	StringBuilder_AppendUnsigned(sb, width);
+	StringBuilder_AppendString(sb, (net_signed == Net_GetSign(self)) ? "'sh" : "'h");
+	value = Simulator_Mask(value, width);
+	for(digit_idx = (int8_t) ((width + 3) / 4 - 1); digit_idx >= 0; digit_idx--) {
+		StringBuilder_AppendChar(sb, "0123456789ABCDEF"[(value >> (4 * digit_idx)) & 0xF]);
+	}
+}
+
+static void Testbench_PrintVector(simulator* sim, void* context, uint32_t vector_idx, const uint64_t* inputs,
+		const uint64_t* expected, const uint64_t* actual, uint32_t num_cycles) {
+	testbench_context* tb = (testbench_context*) context;
+	string_builder* sb = tb->sb;
+	uint16_t idx;
+	uint8_t all_defined = TRUE;
+	net* cur_net;
+
+	StringBuilder_AppendString(sb, "\n\t\t//Vector ");
+	StringBuilder_AppendUnsigned(sb, vector_idx);
+	StringBuilder_AppendChar(sb, '\n');
+	for(idx = 0; idx < Simulator_GetNumInputs(sim); idx++) {
+		cur_net = Simulator_GetInput(sim, idx);
+		StringBuilder_AppendString(sb, "\t\t");
+		StringBuilder_AppendString(sb, Net_GetNameRef(cur_net));
+		StringBuilder_AppendString(sb, " = ");
+		Testbench_AppendLiteral(cur_net, inputs[idx], sb);
+		StringBuilder_AppendString(sb, ";\n");
+	}
+	StringBuilder_AppendString(sb, "\t\trun_vector;\n");
+	StringBuilder_AppendString(sb, "\t\t$display(\"Vector ");
+	StringBuilder_AppendUnsigned(sb, vector_idx);
+	StringBuilder_AppendString(sb, ": %0d cycles\", cycles);\n");
+
+	for(idx = 0; idx < Simulator_GetNumOutputs(sim); idx++) {
+		cur_net = Simulator_GetOutput(sim, idx);
+		if(FALSE == Simulator_IsOutputDefined(sim, idx)) { //Depends on a division by zero, the RTL result is x
+			all_defined = FALSE;
+			continue;
+		}
+		StringBuilder_AppendString(sb, "\t\tif(");
+		StringBuilder_AppendString(sb, Net_GetNameRef(cur_net));
+		StringBuilder_AppendString(sb, " !== ");
+		Testbench_AppendLiteral(cur_net, expected[idx], sb);
+		StringBuilder_AppendString(sb, ") begin\n");
+		StringBuilder_AppendString(sb, "\t\t\t$display(\"ERROR: Vector ");
+		StringBuilder_AppendUnsigned(sb, vector_idx);
+		StringBuilder_AppendChar(sb, ' ');
+		StringBuilder_AppendString(sb, Net_GetNameRef(cur_net));
+		StringBuilder_AppendString(sb, " = %0d, expected %0d\", ");
+		StringBuilder_AppendString(sb, Net_GetNameRef(cur_net));
+		StringBuilder_AppendString(sb, ", ");
+		Testbench_AppendLiteral(cur_net, expected[idx], sb);
+		StringBuilder_AppendString(sb, ");\n");
+		StringBuilder_AppendString(sb, "\t\t\terrors = errors + 1;\n");
+		StringBuilder_AppendString(sb, "\t\tend\n");
+	}
+
+	//Undefined branch conditions may take either path, the cycle count is only known when every output is
+	if(TRUE == all_defined && 0 != num_cycles) {
+		StringBuilder_AppendString(sb, "\t\tif(cycles != ");
+		StringBuilder_AppendUnsigned(sb, num_cycles);
+		StringBuilder_AppendString(sb, ") begin\n");
+		StringBuilder_AppendString(sb, "\t\t\t$display(\"ERROR: Vector ");
+		StringBuilder_AppendUnsigned(sb, vector_idx);
+		StringBuilder_AppendString(sb, " took %0d cycles, expected ");
+		StringBuilder_AppendUnsigned(sb, num_cycles);
+		StringBuilder_AppendString(sb, "\", cycles);\n");
+		StringBuilder_AppendString(sb, "\t\t\terrors = errors + 1;\n");
+		StringBuilder_AppendString(sb, "\t\tend\n");
+	}
+	tb->num_vectors++;
+}
@@ -0,0 +1,15 @@
+/*
+ * testbench_writer.h
+ *
+ *  Created on: Dec 10, 2020
+ *      Author: cwhos
+ */
+
+#ifndef TESTBENCH_WRITER_H_
+#define TESTBENCH_WRITER_H_
+
+#include "global.h"
+
+void PrintTestbench(char* file_name, circuit* circ, state_machine* sm, simulator* sim, char* vector_file, uint32_t num_random, uint64_t seed);
+
+#endif /* TESTBENCH_WRITER_H_ */
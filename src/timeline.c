@@ -0,0 +1,232 @@
+/*
+ * timeline.c
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "timeline.h"
+#include "logger.h"
+
+#define TIMELINE_MAX_EVENTS (1u << 20) //Per thread, later spans are dropped whole
+
+typedef struct {
+	const char* name; //String constant of the instrumented code
+	char* detail;
+	double ts; //Microseconds since the timeline was opened
+	char phase; //'B' begins a span, 'E' ends the innermost one
+} timeline_event;
+
+typedef struct struct_thread_events {
+	uint32_t tid;
+	char thread_name[32];
+	timeline_event* events;
+	uint32_t num_events;
+	uint32_t max_events;
+	uint32_t skipped_depth; //Open spans that were dropped, their ends are dropped too
+	uint64_t dropped;
+	struct struct_thread_events* next;
+} thread_events;
+
+typedef struct struct_timeline {
+	FILE* fp;
+	char* file_name;
+	double start;
+	pthread_mutex_t lock;
+	thread_events* threads;
+	uint32_t num_threads;
+} timeline;
+
+timeline hlsyn_timeline = {.fp = NULL, .file_name = NULL, .start = 0.0, .lock = PTHREAD_MUTEX_INITIALIZER, .threads = NULL, .num_threads = 0};
+
+//Events of the calling thread, each thread only ever appends to its own
+static _Thread_local thread_events* local_events = NULL;
+
+static double Timeline_Now();
+static thread_events* Timeline_Local();
+static uint8_t Timeline_Append(thread_events* self, const char* name, const char* detail, char phase);
+static void Timeline_WriteString(FILE* fp, const char* str);
+
+static double Timeline_Now() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double) now.tv_sec * 1e6 + (double) now.tv_nsec * 1e-3;
+}
+
+//Creates the file at once so a bad path fails before any work is done. The events are written by Timeline_Close.
+uint8_t Timeline_Open(const char* file_name) {
+	char* new_name;
+	if(NULL == file_name || NULL != hlsyn_timeline.fp) return FAILURE;
+	new_name = (char*) malloc(strlen(file_name) + 1);
+	if(NULL == new_name) return FAILURE;
+	strcpy(new_name, file_name);
+	hlsyn_timeline.fp = fopen(file_name, "w+");
+	if(NULL == hlsyn_timeline.fp) {
+		LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR: Cannot open trace event file %s\n", file_name);
+		free(new_name);
+		return FAILURE;
+	}
+	hlsyn_timeline.file_name = new_name;
+	hlsyn_timeline.start = Timeline_Now();
+	return SUCCESS;
+}
+
+uint8_t Timeline_IsEnabled() {
+	return (NULL != hlsyn_timeline.fp) ? TRUE : FALSE;
+}
+
+static thread_events* Timeline_Local() {
+	thread_events* self = local_events;
+	if(NULL == self) {
+		self = (thread_events*) calloc(1, sizeof(thread_events));
+		if(NULL == self) return NULL;
+		pthread_mutex_lock(&hlsyn_timeline.lock);
+		hlsyn_timeline.num_threads++;
+		self->tid = hlsyn_timeline.num_threads;
+		self->next = hlsyn_timeline.threads;
+		hlsyn_timeline.threads = self;
+		pthread_mutex_unlock(&hlsyn_timeline.lock);
+		local_events = self;
+	}
+	return self;
+}
+
+static uint8_t Timeline_Append(thread_events* self, const char* name, const char* detail, char phase) {
+	timeline_event* new_events;
+	timeline_event* event;
+	uint32_t new_max;
+	if(self->num_events >= self->max_events) {
+		new_max = (0 == self->max_events) ? 256 : 2 * self->max_events;
+		if(new_max > TIMELINE_MAX_EVENTS) return FAILURE;
+		new_events = (timeline_event*) realloc(self->events, new_max * sizeof(timeline_event));
+		if(NULL == new_events) return FAILURE;
+		self->events = new_events;
+		self->max_events = new_max;
+	}
+	event = &self->events[self->num_events];
+	event->name = name;
+	event->detail = NULL;
+	if(NULL != detail) {
+		event->detail = (char*) malloc(strlen(detail) + 1);
+		if(NULL != event->detail) strcpy(event->detail, detail);
+	}
+	event->phase = phase;
+	event->ts = Timeline_Now() - hlsyn_timeline.start;
+	self->num_events++;
+	return SUCCESS;
+}
+
+//Names the calling thread's row in the viewer
+void Timeline_NameThread(const char* name) {
+	thread_events* self;
+	if(NULL == hlsyn_timeline.fp || NULL == name) return;
+	self = Timeline_Local();
+	if(NULL != self) {
+		strncpy(self->thread_name, name, sizeof(self->thread_name) - 1);
+		self->thread_name[sizeof(self->thread_name) - 1] = '\0';
+	}
+}
+
+//Starts a span on the calling thread. name must outlive the timeline, detail is copied and may be NULL.
+void Timeline_Begin(const char* name, const char* detail) {
+	thread_events* self;
+	if(NULL == hlsyn_timeline.fp) return;
+	self = Timeline_Local();
+	if(NULL == self) return;
+	if(0 < self->skipped_depth || SUCCESS != Timeline_Append(self, name, detail, 'B')) {
+		self->skipped_depth++;
+		self->dropped++;
+	}
+}
+
+void Timeline_End(const char* name) {
+	thread_events* self;
+	if(NULL == hlsyn_timeline.fp) return;
+	self = Timeline_Local();
+	if(NULL == self) return;
+	if(0 < self->skipped_depth) {
+		self->skipped_depth--;
+	} else if(SUCCESS != Timeline_Append(self, name, NULL, 'E')) {
+		self->dropped++; //The viewer closes the span at the end of the trace
+	}
+}
+
+static void Timeline_WriteString(FILE* fp, const char* str) {
+	const unsigned char* cur = (const unsigned char*) str;
+	fputc('"', fp);
+	for(; '\0' != *cur; cur++) {
+		if('"' == *cur || '\\' == *cur) {
+			fputc('\\', fp);
+			fputc(*cur, fp);
+		} else if(*cur < 0x20) {
+			fprintf(fp, "\\u%04x", *cur);
+		} else {
+			fputc(*cur, fp);
+		}
+	}
+	fputc('"', fp);
+}
+
+//Writes every recorded span and stops recording. Threads that recorded spans must have finished.
+uint8_t Timeline_Close() {
+	thread_events* cur_thread;
+	thread_events* next_thread;
+	timeline_event* event;
+	uint32_t idx;
+	uint64_t dropped = 0;
+	uint8_t first = TRUE;
+	uint8_t ret_value = SUCCESS;
+	FILE* fp = hlsyn_timeline.fp;
+	int pid = (int) getpid();
+
+	if(NULL == fp) return SUCCESS;
+	hlsyn_timeline.fp = NULL;
+	fputs("{\"traceEvents\": [\n", fp);
+	for(cur_thread = hlsyn_timeline.threads; NULL != cur_thread; cur_thread = next_thread) {
+		next_thread = cur_thread->next;
+		if('\0' != cur_thread->thread_name[0]) {
+			fprintf(fp, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": %u, \"args\": {\"name\": ", (TRUE == first) ? "" : ",\n",
+					pid, cur_thread->tid);
+			Timeline_WriteString(fp, cur_thread->thread_name);
+			fputs("}}", fp);
+			first = FALSE;
+		}
+		for(idx = 0; idx < cur_thread->num_events; idx++) {
+			event = &cur_thread->events[idx];
+			fprintf(fp, "%s{\"name\": ", (TRUE == first) ? "" : ",\n");
+			Timeline_WriteString(fp, event->name);
+			fprintf(fp, ", \"cat\": \"hlsyn\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": %d, \"tid\": %u", event->phase, event->ts, pid, cur_thread->tid);
+			if(NULL != event->detail) {
+				fputs(", \"args\": {\"detail\": ", fp);
+				Timeline_WriteString(fp, event->detail);
+				fputc('}', fp);
+			}
+			fputc('}', fp);
+			first = FALSE;
+			free(event->detail);
+		}
+		dropped += cur_thread->dropped;
+		free(cur_thread->events);
+		free(cur_thread);
+	}
+	fprintf(fp, "\n], \"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped_spans\": %llu}}\n", (unsigned long long) dropped);
+	if(0 != fclose(fp)) {
+		LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR: Cannot write trace event file %s\n", hlsyn_timeline.file_name);
+		ret_value = FAILURE;
+	}
+	if(0 < dropped) {
+		LOG_MESSAGE(WARNING_LEVEL, "WARNING: %llu spans did not fit in the trace event buffers\n", (unsigned long long) dropped);
+	}
+	hlsyn_timeline.threads = NULL;
+	hlsyn_timeline.num_threads = 0;
+	free(hlsyn_timeline.file_name);
+	hlsyn_timeline.file_name = NULL;
+	local_events = NULL;
+	return ret_value;
+}
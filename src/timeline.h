@@ -0,0 +1,23 @@
+/*
+ * timeline.h
+ *
+ *  Created on: Dec 13, 2020
+ *      Author: cwhos
+ */
+
+#ifndef TIMELINE_H_
+#define TIMELINE_H_
+
+#include <stdint.h>
+#include "global.h"
+
+//Spans recorded per thread and written as Chrome trace_event JSON, which Perfetto and chrome://tracing open.
+//Nothing is recorded until Timeline_Open, a span outside an open timeline costs one pointer test.
+uint8_t Timeline_Open(const char* file_name);
+uint8_t Timeline_IsEnabled();
+void Timeline_NameThread(const char* name);
+void Timeline_Begin(const char* name, const char* detail);
+void Timeline_End(const char* name);
+uint8_t Timeline_Close();
+
+#endif /* TIMELINE_H_ */
@@ -0,0 +1,328 @@
+/*
+ * timing.c
+ *
+ *  Created on: Dec 11, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "timing.h"
+#include "circuit.h"
+#include "component.h"
+#include "net.h"
+#include "resource.h"
+#include "state.h"
+#include "state_machine.h"
+#include "string_builder.h"
+#include "logger.h"
+
+typedef struct {
+	uint16_t state_number;
+	uint8_t cycle;
+	uint16_t num_operations;
+	component* limiting_op; //NULL when only the state register is updated
+	float operation_ns;
+	float register_ns;
+} state_timing;
+
+static uint8_t Timing_WidthIndex(uint8_t width);
+static uint8_t Timing_RegisterWidth(component* op);
+static void Timing_AnalyzeState(state* cur_state, uint8_t latency, float state_register_ns, state_timing* timing);
+static void Timing_AppendFloat(string_builder* sb, float value, uint8_t precision);
+static void Timing_AppendOperation(string_builder* sb, component* op, uint8_t json);
+static void Timing_PrintText(string_builder* sb, state_timing* timings, uint16_t num_states, uint16_t critical_idx, float period);
+static void Timing_PrintJSON(string_builder* sb, state_timing* timings, uint16_t num_states, uint16_t critical_idx, float period, uint8_t latency);
+
+//The delay tables hold one entry per datapath width of 1, 2, 8, 16, 32 and 64 bits
+static uint8_t Timing_WidthIndex(uint8_t width) {
+	if(width <= 1) return 0;
+	if(width <= 2) return 1;
+	if(width <= 8) return 2;
+	if(width <= 16) return 3;
+	if(width <= 32) return 4;
+	return 5;
+}
+
+float Timing_GetDelay(component_type type, uint8_t width) {
+	uint8_t idx = Timing_WidthIndex(width);
+	float delay = 0.0f;
+	switch(type) {
+	case adder:
+		delay = add_delays[idx];
+		break;
+	case subtractor:
+		delay = sub_delays[idx];
+		break;
+	case multiplier:
+		delay = mul_delays[idx];
+		break;
+	case comparator:
+		delay = comp_delays[idx];
+		break;
+	case mux2x1:
+		delay = mux2x1_delays[idx];
+		break;
+	case shift_right:
+		delay = shr_delays[idx];
+		break;
+	case shift_left:
+		delay = shl_delays[idx];
+		break;
+	case divider:
+		delay = div_delays[idx];
+		break;
+	case modulo:
+		delay = mod_delays[idx];
+		break;
+	case incrementer:
+		delay = inc_delays[idx];
+		break;
+	case decrementer:
+		delay = dec_delays[idx];
+		break;
+	default: //Register loads and branches add no logic in front of the register
+		break;
+	}
+	return delay;
+}
+
+float Timing_GetRegisterDelay(uint8_t width) {
+	return reg_delays[Timing_WidthIndex(width)];
+}
+
+//Combinational delay in front of the destination register. A shared unit runs at its widest operation and
+//selects its operands through a tree of 2x1 multiplexers, one level for every doubling of its operations.
+float Timing_GetOperationDelay(component* op) {
+	float delay = 0.0f;
+	resource* unit;
+	uint8_t width;
+	uint16_t num_ops;
+	if(NULL != op) {
+		unit = Component_GetResource(op);
+		if(NULL == unit) {
+			delay = Timing_GetDelay(Component_GetType(op), Resource_GetOperationWidth(op));
+		} else {
+			width = Resource_GetPortWidth(unit, datapath_a);
+			delay = Timing_GetDelay(Component_GetType(op), width);
+			for(num_ops = Resource_GetNumOperations(unit); num_ops > 1; num_ops = (num_ops + 1) / 2) {
+				delay += Timing_GetDelay(mux2x1, width);
+			}
+		}
+	}
+	return delay;
+}
+
+//Register to register delay of the operation, a shared variable is written into its storage register
+static uint8_t Timing_RegisterWidth(component* op) {
+	net* out_net = Component_GetOutputPort(op, 0).port_net;
+	if(NULL != Net_GetStorage(out_net)) out_net = Net_GetStorage(out_net);
+	return Net_GetWidth(out_net);
+}
+
+float Timing_GetPathDelay(component* op) {
+	float delay = 0.0f;
+	if(NULL != op && component_if_else != Component_GetType(op) && 0 < Component_GetNumOutputs(op)) {
+		delay = Timing_GetOperationDelay(op) + Timing_GetRegisterDelay(Timing_RegisterWidth(op));
+	}
+	return delay;
+}
+
+//The emitted RTL assigns every result at the end of the state it is scheduled in, so every path is a single clock
+static void Timing_AnalyzeState(state* cur_state, uint8_t latency, float state_register_ns, state_timing* timing) {
+	uint16_t op_idx;
+	component* op;
+	float path;
+	timing->state_number = State_GetStateNumber(cur_state);
+	timing->cycle = State_GetCycle(cur_state);
+	timing->num_operations = 0;
+	timing->limiting_op = NULL;
+	timing->operation_ns = 0.0f;
+	timing->register_ns = state_register_ns;
+	if(0 == timing->cycle || timing->cycle > latency) return;
+
+	for(op_idx = 0; op_idx < State_GetNumOperations(cur_state); op_idx++) {
+		op = State_GetOperation(cur_state, op_idx);
+		if(component_if_else == Component_GetType(op)) continue;
+		timing->num_operations++;
+		path = Timing_GetPathDelay(op);
+		if(path > timing->operation_ns + timing->register_ns) {
+			timing->limiting_op = op;
+			timing->operation_ns = Timing_GetOperationDelay(op);
+			timing->register_ns = path - timing->operation_ns;
+		}
+	}
+}
+
+static void Timing_AppendFloat(string_builder* sb, float value, uint8_t precision) {
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+	StringBuilder_AppendString(sb, buffer);
+}
+
+//The operation as the behavioural RTL prints it, without the closing semicolon
+static void Timing_AppendOperation(string_builder* sb, component* op, uint8_t json) {
+	string_builder* op_text = StringBuilder_Create(64);
+	const char* text;
+	size_t length;
+	size_t idx;
+	if(NULL == op_text) return;
+	Component_PrintOperation(op, op_text);
+	text = StringBuilder_GetString(op_text);
+	length = StringBuilder_GetLength(op_text);
+	while(length > 0 && (';' == text[length-1] || ' ' == text[length-1])) length--;
+	for(idx = 0; idx < length; idx++) {
+		if(TRUE == json && ('"' == text[idx] || '\\' == text[idx])) StringBuilder_AppendChar(sb, '\\');
+		StringBuilder_AppendChar(sb, text[idx]);
+	}
+	StringBuilder_Destroy(&op_text);
+}
+
+static void Timing_PrintText(string_builder* sb, state_timing* timings, uint16_t num_states, uint16_t critical_idx, float period) {
+	uint16_t idx;
+	char line[64];
+	StringBuilder_AppendString(sb, "Timing report for module HLSM\n");
+	StringBuilder_AppendString(sb, "Every path starts and ends at a register and completes in one clock, delays in ns.\n\n");
+	StringBuilder_AppendString(sb, "State  Cycle  Ops  Logic     Register  Path      Limiting operation\n");
+	for(idx = 0; idx < num_states; idx++) {
+		snprintf(line, sizeof(line), "%5u  %5u  %3u  %8.3f  %8.3f  %8.3f  ", timings[idx].state_number, timings[idx].cycle,
+				timings[idx].num_operations, timings[idx].operation_ns, timings[idx].register_ns,
+				timings[idx].operation_ns + timings[idx].register_ns);
+		StringBuilder_AppendString(sb, line);
+		if(NULL != timings[idx].limiting_op) {
+			Timing_AppendOperation(sb, timings[idx].limiting_op, FALSE);
+		} else {
+			StringBuilder_AppendString(sb, "state register");
+		}
+		StringBuilder_AppendChar(sb, '\n');
+	}
+	StringBuilder_AppendString(sb, "\nCritical path: ");
+	Timing_AppendFloat(sb, period, 3);
+	StringBuilder_AppendString(sb, " ns in state ");
+	StringBuilder_AppendUnsigned(sb, timings[critical_idx].state_number);
+	StringBuilder_AppendString(sb, ", ");
+	if(NULL != timings[critical_idx].limiting_op) {
+		Timing_AppendOperation(sb, timings[critical_idx].limiting_op, FALSE);
+	} else {
+		StringBuilder_AppendString(sb, "state register");
+	}
+	StringBuilder_AppendString(sb, "\nEstimated fmax: ");
+	Timing_AppendFloat(sb, 1000.0f / period, 2);
+	StringBuilder_AppendString(sb, " MHz\n");
+}
+
+static void Timing_PrintJSON(string_builder* sb, state_timing* timings, uint16_t num_states, uint16_t critical_idx, float period, uint8_t latency) {
+	uint16_t idx;
+	StringBuilder_AppendString(sb, "{\n");
+	StringBuilder_AppendString(sb, "\t\"module\": \"HLSM\",\n");
+	StringBuilder_AppendString(sb, "\t\"latency\": ");
+	StringBuilder_AppendUnsigned(sb, latency);
+	StringBuilder_AppendString(sb, ",\n\t\"states\": [\n");
+	for(idx = 0; idx < num_states; idx++) {
+		StringBuilder_AppendString(sb, "\t\t{\"state\": ");
+		StringBuilder_AppendUnsigned(sb, timings[idx].state_number);
+		StringBuilder_AppendString(sb, ", \"cycle\": ");
+		StringBuilder_AppendUnsigned(sb, timings[idx].cycle);
+		StringBuilder_AppendString(sb, ", \"operations\": ");
+		StringBuilder_AppendUnsigned(sb, timings[idx].num_operations);
+		StringBuilder_AppendString(sb, ", \"logic_ns\": ");
+		Timing_AppendFloat(sb, timings[idx].operation_ns, 3);
+		StringBuilder_AppendString(sb, ", \"register_ns\": ");
+		Timing_AppendFloat(sb, timings[idx].register_ns, 3);
+		StringBuilder_AppendString(sb, ", \"path_ns\": ");
+		Timing_AppendFloat(sb, timings[idx].operation_ns + timings[idx].register_ns, 3);
+		StringBuilder_AppendString(sb, ", \"limiting_operation\": ");
+		if(NULL != timings[idx].limiting_op) {
+			StringBuilder_AppendChar(sb, '"');
+			Timing_AppendOperation(sb, timings[idx].limiting_op, TRUE);
+			StringBuilder_AppendChar(sb, '"');
+		} else {
+			StringBuilder_AppendString(sb, "null");
+		}
+		StringBuilder_AppendString(sb, (idx + 1 < num_states) ? "},\n" : "}\n");
+	}
+	StringBuilder_AppendString(sb, "\t],\n\t\"critical_state\": ");
+	StringBuilder_AppendUnsigned(sb, timings[critical_idx].state_number);
+	StringBuilder_AppendString(sb, ",\n\t\"critical_path_ns\": ");
+	Timing_AppendFloat(sb, period, 3);
+	StringBuilder_AppendString(sb, ",\n\t\"limiting_operation\": ");
+	if(NULL != timings[critical_idx].limiting_op) {
+		StringBuilder_AppendChar(sb, '"');
+		Timing_AppendOperation(sb, timings[critical_idx].limiting_op, TRUE);
+		StringBuilder_AppendChar(sb, '"');
+	} else {
+		StringBuilder_AppendString(sb, "null");
+	}
+	StringBuilder_AppendString(sb, ",\n\t\"fmax_mhz\": ");
+	Timing_AppendFloat(sb, 1000.0f / period, 2);
+	StringBuilder_AppendString(sb, "\n}\n");
+}
+
+//Writes the worst register to register path of every state and the clock frequency the slowest one allows.
+//A file name of "-" writes the report to stdout.
+void PrintTimingReport(char* file_name, circuit* circ, state_machine* sm, report_format format) {
+	FILE* fp;
+	if(NULL == file_name || NULL == circ || NULL == sm) return;
+	if(0 == strcmp(file_name, "-")) {
+		PrintTimingReportStream(stdout, circ, sm, format);
+		return;
+	}
+	fp = fopen(file_name, "w+");
+	if(NULL == fp) {
+		LOG_MESSAGE(ERROR_LEVEL, "Error: Cannot open timing report file\n");
+		return;
+	}
+	PrintTimingReportStream(fp, circ, sm, format);
+	fclose(fp);
+}
+
+//Writes the timing report to an open stream, which stays open
+uint8_t PrintTimingReportStream(FILE* fp, circuit* circ, state_machine* sm, report_format format) {
+	uint8_t ret_value = SUCCESS;
+	uint16_t idx;
+	uint16_t num_states;
+	uint16_t critical_idx = 0;
+	float state_register_ns;
+	float period = 0.0f;
+	state_timing* timings;
+	string_builder* report_buffer;
+
+	if(NULL == fp || NULL == circ || NULL == sm) return FAILURE;
+	num_states = StateMachine_GetNumStates(sm);
+	if(0 == num_states) return SUCCESS;
+	LOG_MESSAGE(MESSAGE_LEVEL, "MSG: Writing timing report\n");
+
+	timings = (state_timing*) malloc(num_states * sizeof(state_timing));
+	report_buffer = StringBuilder_Create(1024);
+	if(NULL == timings || NULL == report_buffer) {
+		LOG_MESSAGE(ERROR_LEVEL, "Error: Cannot allocate timing report\n");
+		free(timings);
+		StringBuilder_Destroy(&report_buffer);
+		return FAILURE;
+	}
+
+	//Every state at least updates the state register
+	state_register_ns = Timing_GetRegisterDelay((uint8_t) ((StateMachine_GetStateWidth(sm) > 64) ? 64 : StateMachine_GetStateWidth(sm)));
+	for(idx = 0; idx < num_states; idx++) {
+		Timing_AnalyzeState(StateMachine_GetState(sm, idx), StateMachine_GetLatency(sm), state_register_ns, &timings[idx]);
+		if(timings[idx].operation_ns + timings[idx].register_ns > period) {
+			period = timings[idx].operation_ns + timings[idx].register_ns;
+			critical_idx = idx;
+		}
+	}
+
+	if(format_json == format) {
+		Timing_PrintJSON(report_buffer, timings, num_states, critical_idx, period, StateMachine_GetLatency(sm));
+	} else {
+		Timing_PrintText(report_buffer, timings, num_states, critical_idx, period);
+	}
+
+	if(SUCCESS != StringBuilder_Flush(report_buffer, fp)) {
+		LOG_MESSAGE(ERROR_LEVEL, "Error: Failed writing timing report\n");
+		ret_value = FAILURE;
+	}
+	free(timings);
+	StringBuilder_Destroy(&report_buffer);
+	return ret_value;
+}
@@ -0,0 +1,22 @@
+/*
+ * timing.h
+ *
+ *  Created on: Dec 11, 2020
+ *      Author: cwhos
+ */
+
+#ifndef TIMING_H_
+#define TIMING_H_
+
+#include <stdint.h>
+#include "global.h"
+
+float Timing_GetDelay(component_type type, uint8_t width);
+float Timing_GetRegisterDelay(uint8_t width);
+float Timing_GetOperationDelay(component* op);
+float Timing_GetPathDelay(component* op);
+
+void PrintTimingReport(char* file_name, circuit* circ, state_machine* sm, report_format format);
+uint8_t PrintTimingReportStream(FILE* fp, circuit* circ, state_machine* sm, report_format format);
+
+#endif /* TIMING_H_ */
@@ -0,0 +1,102 @@
+/*
+ * trace.c
+ *
+ *  Created on: Dec 12, 2020
+ *      Author: cwhos
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "trace.h"
+#include "logger.h"
+
+typedef struct struct_trace {
+	char* directory;
+	uint8_t artifacts;
+} trace;
+
+trace hlsyn_trace = {.directory = NULL, .artifacts = trace_none};
+
+typedef struct {
+	const char* name;
+	uint8_t artifacts;
+} trace_name;
+
+static const trace_name trace_names[] = {
+	{"time-frames", trace_time_frames},
+	{"distribution", trace_distribution},
+	{"fds", trace_force_schedule},
+	{"state-machine", trace_state_machine},
+	{"state-cycles", trace_state_cycles},
+	{"fds-iterations", trace_fds_iterations},
+	{"default", trace_default},
+	{"all", trace_all}
+};
+
+//Enables the artifacts in directory, creating it when missing. A NULL directory turns tracing off.
+uint8_t Trace_Configure(const char* directory, uint8_t artifacts) {
+	char* new_directory = NULL;
+	free(hlsyn_trace.directory);
+	hlsyn_trace.directory = NULL;
+	hlsyn_trace.artifacts = trace_none;
+	if(NULL == directory || trace_none == artifacts) return SUCCESS;
+
+	if(0 != mkdir(directory, 0777) && EEXIST != errno) {
+		LOG_MESSAGE(CIRCUIT_ERROR_LEVEL, "ERROR: Cannot create trace directory %s\n", directory);
+		return FAILURE;
+	}
+	new_directory = (char*) malloc(strlen(directory) + 1);
+	if(NULL == new_directory) return FAILURE;
+	strcpy(new_directory, directory);
+	hlsyn_trace.directory = new_directory;
+	hlsyn_trace.artifacts = artifacts;
+	return SUCCESS;
+}
+
+//Parses a comma separated list of artifact names, trace_error on an unknown name
+uint8_t Trace_ReadArtifacts(char* list) {
+	uint8_t artifacts = trace_none;
+	uint8_t idx;
+	size_t length;
+	char* cur = list;
+	if(NULL == list) return trace_error;
+	while('\0' != *cur) {
+		length = strcspn(cur, ",");
+		for(idx = 0; idx < sizeof(trace_names) / sizeof(trace_names[0]); idx++) {
+			if(strlen(trace_names[idx].name) == length && 0 == strncmp(cur, trace_names[idx].name, length)) break;
+		}
+		if(idx >= sizeof(trace_names) / sizeof(trace_names[0])) return trace_error;
+		artifacts |= trace_names[idx].artifacts;
+		cur += length;
+		if(',' == *cur) cur++;
+	}
+	return (trace_none == artifacts) ? trace_error : artifacts;
+}
+
+uint8_t Trace_IsEnabled(trace_artifact artifact) {
+	return (0 != (hlsyn_trace.artifacts & artifact)) ? TRUE : FALSE;
+}
+
+//Opens file_name in the trace directory if artifact is enabled, NULL otherwise
+FILE* Trace_Open(trace_artifact artifact, const char* file_name) {
+	FILE* fp = NULL;
+	char* path;
+	size_t dir_length;
+	if(TRUE == Trace_IsEnabled(artifact) && NULL != file_name) {
+		dir_length = strlen(hlsyn_trace.directory);
+		path = (char*) malloc(dir_length + strlen(file_name) + 2);
+		if(NULL == path) return NULL;
+		strcpy(path, hlsyn_trace.directory);
+		if(dir_length > 0 && '/' != path[dir_length-1]) strcat(path, "/");
+		strcat(path, file_name);
+		fp = fopen(path, "w+");
+		if(NULL == fp) {
+			LOG_MESSAGE(ERROR_LEVEL, "Error: Cannot open trace file %s\n", path);
+		}
+		free(path);
+	}
+	return fp;
+}
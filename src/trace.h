@@ -0,0 +1,34 @@
+/*
+ * trace.h
+ *
+ *  Created on: Dec 12, 2020
+ *      Author: cwhos
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include "global.h"
+
+//Debug artifacts the scheduler can dump, none is written unless it was enabled
+typedef enum {
+	trace_none = 0x00,
+	trace_time_frames = 0x01,
+	trace_distribution = 0x02,
+	trace_force_schedule = 0x04,
+	trace_state_machine = 0x08,
+	trace_state_cycles = 0x10,
+	trace_fds_iterations = 0x20,
+	trace_default = 0x1F,
+	trace_all = 0x3F,
+	trace_error = 0x80
+} trace_artifact;
+
+uint8_t Trace_Configure(const char* directory, uint8_t artifacts);
+uint8_t Trace_ReadArtifacts(char* list);
+uint8_t Trace_IsEnabled(trace_artifact artifact);
+FILE* Trace_Open(trace_artifact artifact, const char* file_name);
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,42 @@
+input Int32 i0, i1, i2, i3, i4, i5, i6, i7, i8, i9
+output Int32 z0
+
+variable Int32 v0, v1, v2, v3, v4, v5, v6, v7, v8, v9, v10, v11, v12, v13, v14, v15
+variable Int1 c0, c1, c2, c3
+
+c0 = i0 > i1
+if ( c0 ) {
+	v0 = i0 + i1
+	v1 = v0 - i2
+	c1 = v1 > i3
+	if ( c1 ) {
+		v2 = v1 + i3
+		v3 = v2 - i4
+		c2 = v3 > i5
+		if ( c2 ) {
+			v4 = v3 + i5
+			v5 = v4 - i6
+			c3 = v5 > i7
+			if ( c3 ) {
+				v6 = v5 + i7
+				v7 = v6 - i8
+				z0 = v7 + i7
+			}
+			else {
+				z0 = i7 - i8
+			}
+			z0 = v7 + i5
+		}
+		else {
+			z0 = i5 - i6
+		}
+		z0 = v7 + i3
+	}
+	else {
+		z0 = i3 - i4
+	}
+	z0 = v7 + i1
+}
+else {
+	z0 = i1 - i2
+}
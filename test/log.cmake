@@ -0,0 +1,35 @@
+# Run by the async_log test with cmake -P. Synthesises a netlist whose net name is longer than a log ring record,
+# once logging synchronously and once with --async-log, and fails unless both logs are the same and hold the
+# whole name. Messages too long for a record must reach the log file intact, not cut at the record size.
+
+set( long_name "v" )
+foreach( idx RANGE 63 )
+    string( APPEND long_name "_long_net" )
+endforeach()
+set( netlist ${WORK_DIR}/log_long_name.c )
+
+file( MAKE_DIRECTORY ${WORK_DIR} )
+file( WRITE ${netlist} "input Int32 a, b, c\noutput Int32 z\n\nvariable Int32 ${long_name}\n\n"
+    "${long_name} = a + b\nz = ${long_name} * c\n" )
+foreach( mode sync async )
+    set( log_file ${WORK_DIR}/log_${mode}.txt )
+    set( options "" )
+    if(mode STREQUAL "async")
+        set( options --async-log )
+    endif()
+    file( REMOVE ${log_file} )
+    execute_process( COMMAND ${HLSYN} ${netlist} 4 ${WORK_DIR}/log_${mode}.v --log ${log_file} --log-level message ${options}
+        RESULT_VARIABLE run_result OUTPUT_VARIABLE run_output ERROR_VARIABLE run_output )
+    if(NOT run_result EQUAL 0 OR NOT EXISTS ${log_file})
+        message( FATAL_ERROR "Synthesis with ${mode} logging failed (${run_result}): ${run_output}" )
+    endif()
+    file( READ ${log_file} ${mode}_log )
+endforeach()
+string( FIND "${sync_log}" "${long_name}" name_pos )
+if(name_pos EQUAL -1)
+    message( FATAL_ERROR "The log does not name the net ${long_name}" )
+endif()
+if(NOT sync_log STREQUAL async_log)
+    message( FATAL_ERROR "The --async-log output differs from the synchronous log:\n${async_log}" )
+endif()
+message( "Synchronous and --async-log output match" )
@@ -0,0 +1,100 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, Done, z, x);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] a;
+	input signed [31:0] b;
+	input signed [31:0] c;
+
+	output reg Done;
+	output reg signed [31:0] z;
+	output reg signed [31:0] x;
+
+	reg signed [31:0] d;
+	reg signed [31:0] f;
+	reg signed [31:0] g;
+	reg signed [31:0] zrin;
+	reg [2:0] state;
+
+	wire signed [31:0] Alu_0_a;
+	wire signed [31:0] Alu_0_b;
+	wire signed [31:0] Alu_0_y;
+	assign Alu_0_a = (state == 3'd1 || state == 3'd3) ? a : zrin;
+	assign Alu_0_b = (state == 3'd1 || state == 3'd3) ? b : f;
+	assign Alu_0_y = Alu_0_a + Alu_0_b;
+
+	wire signed [31:0] Comp_0_a;
+	wire signed [31:0] Comp_0_b;
+	wire [0:0] Comp_0_y;
+	assign Comp_0_a = a;
+	assign Comp_0_b = b;
+	assign Comp_0_y = Comp_0_a < Comp_0_b;
+
+	wire signed [31:0] Alu_1_a;
+	wire signed [31:0] Alu_1_b;
+	wire [0:0] Alu_1_sub;
+	wire signed [31:0] Alu_1_y;
+	assign Alu_1_a = (state == 3'd1) ? a : f;
+	assign Alu_1_b = (state == 3'd1) ? c : d;
+	assign Alu_1_sub = state == 3'd3 || state == 3'd6;
+	assign Alu_1_y = Alu_1_sub ? Alu_1_a - Alu_1_b : Alu_1_a + Alu_1_b;
+
+	wire signed [31:0] Mul_0_a;
+	wire signed [31:0] Mul_0_b;
+	wire signed [31:0] Mul_0_y;
+	assign Mul_0_a = a;
+	assign Mul_0_b = c;
+	assign Mul_0_y = Mul_0_a * Mul_0_b;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 3'd0;
+		 end else begin
+			 case(state)
+			 3'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 3'd0;
+				 end else begin
+					 state <= 3'd1;
+				 end
+				 end
+			 3'd1: begin
+				 zrin <= Alu_1_y;
+				 f <= Mul_0_y;
+				 d <= Alu_0_y;
+				 g <= Comp_0_y;
+				 state <= 3'd2;
+				 end
+			 3'd2: begin
+				 if(g) begin 
+					 state <= 3'd3;
+				 end else begin 
+					 state <= 3'd6;
+				 end
+				 end
+			 3'd3: begin
+				 x <= Alu_1_y;
+				 zrin <= Alu_0_y;
+				 state <= 3'd4;
+				 end
+			 3'd4: begin
+				 z <= Alu_0_y;
+				 state <= 3'd5;
+				 end
+			 3'd5: begin
+				 Done <= 1;
+				 state <= 3'd0;
+				 end
+			 3'd6: begin
+				 x <= Alu_1_y;
+				 state <= 3'd4;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
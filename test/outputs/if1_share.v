@@ -0,0 +1,70 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, Done, z, x);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] a;
+	input signed [31:0] b;
+	input signed [31:0] c;
+
+	output reg Done;
+	output reg signed [31:0] z;
+	output reg signed [31:0] x;
+
+	reg signed [31:0] d;
+	reg signed [31:0] f;
+	reg signed [31:0] g;
+	reg signed [31:0] zrin;
+	reg [2:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 3'd0;
+		 end else begin
+			 case(state)
+			 3'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 3'd0;
+				 end else begin
+					 state <= 3'd1;
+				 end
+				 end
+			 3'd1: begin
+				 zrin <= a + c;
+				 f <= a * c;
+				 d <= a + b;
+				 g <= a < b;
+				 state <= 3'd2;
+				 end
+			 3'd2: begin
+				 if(g) begin 
+					 state <= 3'd3;
+				 end else begin 
+					 state <= 3'd6;
+				 end
+				 end
+			 3'd3: begin
+				 x <= f - d;
+				 zrin <= a + b;
+				 state <= 3'd4;
+				 end
+			 3'd4: begin
+				 z <= zrin + f;
+				 state <= 3'd5;
+				 end
+			 3'd5: begin
+				 Done <= 1;
+				 state <= 3'd0;
+				 end
+			 3'd6: begin
+				 x <= f - d;
+				 state <= 3'd4;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,80 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, zero, one, t, Done, z, x, x);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] a;
+	input signed [31:0] b;
+	input signed [31:0] c;
+	input signed [31:0] zero;
+	input signed [31:0] one;
+	input signed [0:0] t;
+
+	output reg Done;
+	output reg signed [31:0] z;
+	output reg signed [31:0] x;
+
+	reg signed [31:0] e;
+	reg signed [31:0] g;
+	reg signed [31:0] d;
+	reg signed [31:0] f;
+	reg [3:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 d <= a + b;
+				 if(t) begin 
+					 state <= 4'd2;
+				 end else begin 
+					 state <= 4'd6;
+				 end
+				 end
+			 4'd2: begin
+				 d <= a - one;
+				 f <= a + c;
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 x <= f - d;
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 4'd6: begin
+				 e <= a + c;
+				 f <= a * c;
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 g <= d > e;
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 z <= g ? d : e;
+				 x <= f - d;
+				 state <= 4'd5;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,119 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, zero, one, t, Done, z, x, x);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] a;
+	input signed [31:0] b;
+	input signed [31:0] c;
+	input signed [31:0] zero;
+	input signed [31:0] one;
+	input signed [0:0] t;
+
+	output reg Done;
+	output reg signed [31:0] z;
+	output reg signed [31:0] x;
+
+	reg signed [31:0] e;
+	reg signed [31:0] g;
+	reg signed [31:0] d;
+	reg signed [31:0] f;
+	reg [3:0] state;
+
+	wire signed [31:0] Alu_0_a;
+	wire signed [31:0] Alu_0_b;
+	wire [0:0] Alu_0_sub;
+	wire signed [31:0] Alu_0_y;
+	assign Alu_0_a = (state == 4'd1 || state == 4'd2 || state == 4'd6) ? a : f;
+	assign Alu_0_b = (state == 4'd1) ? b : (state == 4'd2) ? one : (state == 4'd6) ? c : d;
+	assign Alu_0_sub = state == 4'd2 || state == 4'd3 || state == 4'd8;
+	assign Alu_0_y = Alu_0_sub ? Alu_0_a - Alu_0_b : Alu_0_a + Alu_0_b;
+
+	wire signed [31:0] Alu_1_a;
+	wire signed [31:0] Alu_1_b;
+	wire signed [31:0] Alu_1_y;
+	assign Alu_1_a = a;
+	assign Alu_1_b = c;
+	assign Alu_1_y = Alu_1_a + Alu_1_b;
+
+	wire signed [31:0] Mul_0_a;
+	wire signed [31:0] Mul_0_b;
+	wire signed [31:0] Mul_0_y;
+	assign Mul_0_a = a;
+	assign Mul_0_b = c;
+	assign Mul_0_y = Mul_0_a * Mul_0_b;
+
+	wire signed [31:0] Comp_0_a;
+	wire signed [31:0] Comp_0_b;
+	wire [0:0] Comp_0_y;
+	assign Comp_0_a = d;
+	assign Comp_0_b = e;
+	assign Comp_0_y = Comp_0_a > Comp_0_b;
+
+	wire signed [31:0] Mux2x1_0_a;
+	wire signed [31:0] Mux2x1_0_b;
+	wire [0:0] Mux2x1_0_sel;
+	wire signed [31:0] Mux2x1_0_y;
+	assign Mux2x1_0_a = d;
+	assign Mux2x1_0_b = e;
+	assign Mux2x1_0_sel = |g;
+	assign Mux2x1_0_y = Mux2x1_0_sel ? Mux2x1_0_a : Mux2x1_0_b;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 d <= Alu_0_y;
+				 if(t) begin 
+					 state <= 4'd2;
+				 end else begin 
+					 state <= 4'd6;
+				 end
+				 end
+			 4'd2: begin
+				 d <= Alu_0_y;
+				 f <= Alu_1_y;
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 x <= Alu_0_y;
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 4'd6: begin
+				 e <= Alu_0_y;
+				 f <= Mul_0_y;
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 g <= Comp_0_y;
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 z <= Mux2x1_0_y;
+				 x <= Alu_0_y;
+				 state <= 4'd5;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,147 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, d, e, f, g, h, sa, one, two, four, Done, avg);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] a;
+	input signed [31:0] b;
+	input signed [31:0] c;
+	input signed [31:0] d;
+	input signed [31:0] e;
+	input signed [31:0] f;
+	input signed [31:0] g;
+	input signed [31:0] h;
+	input signed [31:0] sa;
+	input signed [31:0] one;
+	input signed [31:0] two;
+	input signed [31:0] four;
+
+	output reg Done;
+	output reg signed [31:0] avg;
+
+	reg signed [31:0] t1;
+	reg signed [0:0] csa1;
+	reg signed [0:0] csa2;
+	reg signed [0:0] csa3;
+	reg [3:0] state;
+
+	wire signed [31:0] Alu_0_a;
+	wire signed [31:0] Alu_0_b;
+	wire signed [31:0] Alu_0_y;
+	assign Alu_0_a = (state == 4'd1) ? a : t1;
+	assign Alu_0_b = (state == 4'd1) ? b : (state == 4'd2) ? c : (state == 4'd3) ? d : (state == 4'd4) ? e : (state == 4'd5) ? f : (state == 4'd6) ? g : h;
+	assign Alu_0_y = Alu_0_a + Alu_0_b;
+
+	wire signed [31:0] Comp_0_a;
+	wire signed [31:0] Comp_0_b;
+	wire [0:0] Comp_0_y;
+	assign Comp_0_a = sa;
+	assign Comp_0_b = one;
+	assign Comp_0_y = Comp_0_a > Comp_0_b;
+
+	wire signed [31:0] Comp_1_a;
+	wire signed [31:0] Comp_1_b;
+	wire [0:0] Comp_1_y;
+	assign Comp_1_a = sa;
+	assign Comp_1_b = two;
+	assign Comp_1_y = Comp_1_a > Comp_1_b;
+
+	wire signed [31:0] Comp_2_a;
+	wire signed [31:0] Comp_2_b;
+	wire [0:0] Comp_2_y;
+	assign Comp_2_a = sa;
+	assign Comp_2_b = four;
+	assign Comp_2_y = Comp_2_a > Comp_2_b;
+
+	wire signed [31:0] SHR_0_a;
+	wire [31:0] SHR_0_b;
+	wire signed [31:0] SHR_0_y;
+	assign SHR_0_a = t1;
+	assign SHR_0_b = one;
+	assign SHR_0_y = SHR_0_a >> SHR_0_b;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 csa1 <= Comp_0_y;
+				 csa2 <= Comp_1_y;
+				 csa3 <= Comp_2_y;
+				 t1 <= Alu_0_y;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 t1 <= Alu_0_y;
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 t1 <= Alu_0_y;
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 t1 <= Alu_0_y;
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 t1 <= Alu_0_y;
+				 state <= 4'd6;
+				 end
+			 4'd6: begin
+				 t1 <= Alu_0_y;
+				 if(csa1) begin 
+					 state <= 4'd7;
+				 end else begin 
+					 state <= 4'd13;
+				 end
+				 end
+			 4'd7: begin
+				 t1 <= Alu_0_y;
+				 if(csa2) begin 
+					 state <= 4'd8;
+				 end else begin 
+					 state <= 4'd11;
+				 end
+				 end
+			 4'd8: begin
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 state <= 4'd10;
+				 end
+			 4'd10: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 4'd11: begin
+				 t1 <= SHR_0_y;
+				 if(csa3) begin 
+					 state <= 4'd12;
+				 end else begin 
+					 state <= 4'd9;
+				 end
+				 end
+			 4'd12: begin
+				 avg <= SHR_0_y;
+				 state <= 4'd10;
+				 end
+			 4'd13: begin
+				 t1 <= Alu_0_y;
+				 state <= 4'd8;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,112 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, d, e, f, g, h, sa, one, two, four, Done, avg);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] a;
+	input signed [31:0] b;
+	input signed [31:0] c;
+	input signed [31:0] d;
+	input signed [31:0] e;
+	input signed [31:0] f;
+	input signed [31:0] g;
+	input signed [31:0] h;
+	input signed [31:0] sa;
+	input signed [31:0] one;
+	input signed [31:0] two;
+	input signed [31:0] four;
+
+	output reg Done;
+	output reg signed [31:0] avg;
+
+	reg signed [31:0] t1;
+	reg signed [0:0] csa1;
+	reg signed [0:0] csa2;
+	reg signed [0:0] csa3;
+	reg [3:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 csa1 <= sa > one;
+				 csa2 <= sa > two;
+				 csa3 <= sa > four;
+				 t1 <= a + b;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 t1 <= t1 + c;
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 t1 <= t1 + d;
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 t1 <= t1 + e;
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 t1 <= t1 + f;
+				 state <= 4'd6;
+				 end
+			 4'd6: begin
+				 t1 <= t1 + g;
+				 if(csa1) begin 
+					 state <= 4'd7;
+				 end else begin 
+					 state <= 4'd13;
+				 end
+				 end
+			 4'd7: begin
+				 t1 <= t1 + h;
+				 if(csa2) begin 
+					 state <= 4'd8;
+				 end else begin 
+					 state <= 4'd11;
+				 end
+				 end
+			 4'd8: begin
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 state <= 4'd10;
+				 end
+			 4'd10: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 4'd11: begin
+				 t1 <= t1 >> one;
+				 if(csa3) begin 
+					 state <= 4'd12;
+				 end else begin 
+					 state <= 4'd9;
+				 end
+				 end
+			 4'd12: begin
+				 avg <= t1 >> one;
+				 state <= 4'd10;
+				 end
+			 4'd13: begin
+				 t1 <= t1 + h;
+				 state <= 4'd8;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,102 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, one, Done, z, x);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] a;
+	input signed [31:0] b;
+	input signed [31:0] c;
+	input signed [31:0] one;
+
+	output reg Done;
+	output reg signed [31:0] z;
+	output reg signed [31:0] x;
+
+	reg signed [31:0] d;
+	reg signed [31:0] e;
+	reg signed [31:0] f;
+	reg signed [31:0] g;
+	reg signed [31:0] h;
+	reg signed [0:0] dLTe;
+	reg signed [0:0] dEQe;
+	reg signed [0:0] dLTEe;
+	reg [3:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 f <= a - b;
+				 d <= a + b;
+				 e <= a + c;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 dEQe <= d == e;
+				 dLTe <= d > e;
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 dLTEe <= dEQe + dLTe;
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 if(dLTEe) begin 
+					 state <= 4'd5;
+				 end else begin 
+					 state <= 4'd11;
+				 end
+				 end
+			 4'd5: begin
+				 if(dLTe) begin 
+					 state <= 4'd6;
+				 end else begin 
+					 state <= 4'd10;
+				 end
+				 end
+			 4'd6: begin
+				 h <= f + one;
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 h <= f + e;
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 x <= h << one;
+				 z <= h >> one;
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 4'd10: begin
+				 state <= 4'd7;
+				 end
+			 4'd11: begin
+				 state <= 4'd12;
+				 end
+			 4'd12: begin
+				 state <= 4'd13;
+				 end
+			 4'd13: begin
+				 state <= 4'd8;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,151 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, one, Done, z, x);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] a;
+	input signed [31:0] b;
+	input signed [31:0] c;
+	input signed [31:0] one;
+
+	output reg Done;
+	output reg signed [31:0] z;
+	output reg signed [31:0] x;
+
+	reg signed [31:0] d;
+	reg signed [31:0] e;
+	reg signed [31:0] f;
+	reg signed [31:0] g;
+	reg signed [31:0] h;
+	reg signed [0:0] dLTe;
+	reg signed [0:0] dEQe;
+	reg signed [0:0] dLTEe;
+	reg [3:0] state;
+
+	wire signed [31:0] Alu_0_a;
+	wire signed [31:0] Alu_0_b;
+	wire signed [31:0] Alu_0_y;
+	assign Alu_0_a = (state == 4'd1) ? a : (state == 4'd3) ? {{31{dEQe[0]}}, dEQe} : f;
+	assign Alu_0_b = (state == 4'd1) ? b : (state == 4'd3) ? {{31{dLTe[0]}}, dLTe} : (state == 4'd6) ? one : e;
+	assign Alu_0_y = Alu_0_a + Alu_0_b;
+
+	wire signed [31:0] Alu_1_a;
+	wire signed [31:0] Alu_1_b;
+	wire signed [31:0] Alu_1_y;
+	assign Alu_1_a = a;
+	assign Alu_1_b = c;
+	assign Alu_1_y = Alu_1_a + Alu_1_b;
+
+	wire signed [31:0] Alu_2_a;
+	wire signed [31:0] Alu_2_b;
+	wire signed [31:0] Alu_2_y;
+	assign Alu_2_a = a;
+	assign Alu_2_b = b;
+	assign Alu_2_y = Alu_2_a - Alu_2_b;
+
+	wire signed [31:0] Comp_0_a;
+	wire signed [31:0] Comp_0_b;
+	wire [0:0] Comp_0_y;
+	assign Comp_0_a = d;
+	assign Comp_0_b = e;
+	assign Comp_0_y = Comp_0_a == Comp_0_b;
+
+	wire signed [31:0] Comp_1_a;
+	wire signed [31:0] Comp_1_b;
+	wire [0:0] Comp_1_y;
+	assign Comp_1_a = d;
+	assign Comp_1_b = e;
+	assign Comp_1_y = Comp_1_a > Comp_1_b;
+
+	wire signed [31:0] SHL_0_a;
+	wire [31:0] SHL_0_b;
+	wire signed [31:0] SHL_0_y;
+	assign SHL_0_a = h;
+	assign SHL_0_b = one;
+	assign SHL_0_y = SHL_0_a << SHL_0_b;
+
+	wire signed [31:0] SHR_0_a;
+	wire [31:0] SHR_0_b;
+	wire signed [31:0] SHR_0_y;
+	assign SHR_0_a = h;
+	assign SHR_0_b = one;
+	assign SHR_0_y = SHR_0_a >> SHR_0_b;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 f <= Alu_2_y;
+				 d <= Alu_0_y;
+				 e <= Alu_1_y;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 dEQe <= Comp_0_y;
+				 dLTe <= Comp_1_y;
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 dLTEe <= Alu_0_y;
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 if(dLTEe) begin 
+					 state <= 4'd5;
+				 end else begin 
+					 state <= 4'd11;
+				 end
+				 end
+			 4'd5: begin
+				 if(dLTe) begin 
+					 state <= 4'd6;
+				 end else begin 
+					 state <= 4'd10;
+				 end
+				 end
+			 4'd6: begin
+				 h <= Alu_0_y;
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 h <= Alu_0_y;
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 x <= SHL_0_y;
+				 z <= SHR_0_y;
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 4'd10: begin
+				 state <= 4'd7;
+				 end
+			 4'd11: begin
+				 state <= 4'd12;
+				 end
+			 4'd12: begin
+				 state <= 4'd13;
+				 end
+			 4'd13: begin
+				 state <= 4'd8;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
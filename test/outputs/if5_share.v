@@ -0,0 +1,255 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, i0, i1, i2, i3, i4, i5, i6, i7, i8, i9, Done, z0, z0, z0, z0, z0, z0, z0, z0);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] i0;
+	input signed [31:0] i1;
+	input signed [31:0] i2;
+	input signed [31:0] i3;
+	input signed [31:0] i4;
+	input signed [31:0] i5;
+	input signed [31:0] i6;
+	input signed [31:0] i7;
+	input signed [31:0] i8;
+	input signed [31:0] i9;
+
+	output reg Done;
+	output reg signed [31:0] z0;
+
+	reg signed [31:0] v0;
+	reg signed [31:0] v7;
+	reg signed [0:0] c0;
+	reg signed [0:0] c1;
+	reg signed [0:0] c2;
+	reg signed [0:0] c3;
+	reg [5:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 6'd0;
+		 end else begin
+			 case(state)
+			 6'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 6'd0;
+				 end else begin
+					 state <= 6'd1;
+				 end
+				 end
+			 6'd1: begin
+				 c0 <= i0 > i1;
+				 state <= 6'd2;
+				 end
+			 6'd2: begin
+				 if(c0) begin 
+					 state <= 6'd3;
+				 end else begin 
+					 state <= 6'd41;
+				 end
+				 end
+			 6'd3: begin
+				 v0 <= i0 + i1;
+				 state <= 6'd4;
+				 end
+			 6'd4: begin
+				 v0 <= v0 - i2;
+				 state <= 6'd5;
+				 end
+			 6'd5: begin
+				 c1 <= v0 > i3;
+				 state <= 6'd6;
+				 end
+			 6'd6: begin
+				 if(c1) begin 
+					 state <= 6'd7;
+				 end else begin 
+					 state <= 6'd30;
+				 end
+				 end
+			 6'd7: begin
+				 v0 <= v0 + i3;
+				 state <= 6'd8;
+				 end
+			 6'd8: begin
+				 v0 <= v0 - i4;
+				 state <= 6'd9;
+				 end
+			 6'd9: begin
+				 c2 <= v0 > i5;
+				 state <= 6'd10;
+				 end
+			 6'd10: begin
+				 if(c2) begin 
+					 state <= 6'd11;
+				 end else begin 
+					 state <= 6'd23;
+				 end
+				 end
+			 6'd11: begin
+				 v0 <= v0 + i5;
+				 state <= 6'd12;
+				 end
+			 6'd12: begin
+				 v0 <= v0 - i6;
+				 state <= 6'd13;
+				 end
+			 6'd13: begin
+				 c3 <= v0 > i7;
+				 state <= 6'd14;
+				 end
+			 6'd14: begin
+				 if(c3) begin 
+					 state <= 6'd15;
+				 end else begin 
+					 state <= 6'd20;
+				 end
+				 end
+			 6'd15: begin
+				 v0 <= v0 + i7;
+				 state <= 6'd16;
+				 end
+			 6'd16: begin
+				 v7 <= v0 - i8;
+				 state <= 6'd17;
+				 end
+			 6'd17: begin
+				 z0 <= v7 + i7;
+				 z0 <= v7 + i5;
+				 z0 <= v7 + i3;
+				 z0 <= v7 + i1;
+				 state <= 6'd18;
+				 end
+			 6'd18: begin
+				 state <= 6'd19;
+				 end
+			 6'd19: begin
+				 Done <= 1;
+				 state <= 6'd0;
+				 end
+			 6'd20: begin
+				 z0 <= i7 - i8;
+				 state <= 6'd21;
+				 end
+			 6'd21: begin
+				 state <= 6'd22;
+				 end
+			 6'd22: begin
+				 z0 <= v7 + i5;
+				 z0 <= v7 + i3;
+				 z0 <= v7 + i1;
+				 state <= 6'd18;
+				 end
+			 6'd23: begin
+				 z0 <= i5 - i6;
+				 state <= 6'd24;
+				 end
+			 6'd24: begin
+				 state <= 6'd25;
+				 end
+			 6'd25: begin
+				 state <= 6'd26;
+				 end
+			 6'd26: begin
+				 state <= 6'd27;
+				 end
+			 6'd27: begin
+				 state <= 6'd28;
+				 end
+			 6'd28: begin
+				 state <= 6'd29;
+				 end
+			 6'd29: begin
+				 z0 <= v7 + i3;
+				 z0 <= v7 + i1;
+				 state <= 6'd18;
+				 end
+			 6'd30: begin
+				 state <= 6'd31;
+				 end
+			 6'd31: begin
+				 state <= 6'd32;
+				 end
+			 6'd32: begin
+				 state <= 6'd33;
+				 end
+			 6'd33: begin
+				 z0 <= i3 - i4;
+				 state <= 6'd34;
+				 end
+			 6'd34: begin
+				 state <= 6'd35;
+				 end
+			 6'd35: begin
+				 state <= 6'd36;
+				 end
+			 6'd36: begin
+				 state <= 6'd37;
+				 end
+			 6'd37: begin
+				 state <= 6'd38;
+				 end
+			 6'd38: begin
+				 state <= 6'd39;
+				 end
+			 6'd39: begin
+				 state <= 6'd40;
+				 end
+			 6'd40: begin
+				 z0 <= v7 + i1;
+				 state <= 6'd18;
+				 end
+			 6'd41: begin
+				 state <= 6'd42;
+				 end
+			 6'd42: begin
+				 state <= 6'd43;
+				 end
+			 6'd43: begin
+				 state <= 6'd44;
+				 end
+			 6'd44: begin
+				 z0 <= i1 - i2;
+				 state <= 6'd45;
+				 end
+			 6'd45: begin
+				 state <= 6'd46;
+				 end
+			 6'd46: begin
+				 state <= 6'd47;
+				 end
+			 6'd47: begin
+				 state <= 6'd48;
+				 end
+			 6'd48: begin
+				 state <= 6'd49;
+				 end
+			 6'd49: begin
+				 state <= 6'd50;
+				 end
+			 6'd50: begin
+				 state <= 6'd51;
+				 end
+			 6'd51: begin
+				 state <= 6'd52;
+				 end
+			 6'd52: begin
+				 state <= 6'd53;
+				 end
+			 6'd53: begin
+				 state <= 6'd54;
+				 end
+			 6'd54: begin
+				 state <= 6'd55;
+				 end
+			 6'd55: begin
+				 state <= 6'd18;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,57 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, d, e, Done, i);
+
+
+	input Clk, Rst, Start;
+	input signed [15:0] a;
+	input signed [15:0] b;
+	input signed [15:0] c;
+	input signed [15:0] d;
+	input signed [15:0] e;
+
+	output reg Done;
+	output reg signed [15:0] i;
+
+	reg signed [15:0] f;
+	reg [2:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 3'd0;
+		 end else begin
+			 case(state)
+			 3'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 3'd0;
+				 end else begin
+					 state <= 3'd1;
+				 end
+				 end
+			 3'd1: begin
+				 f <= a + b;
+				 state <= 3'd2;
+				 end
+			 3'd2: begin
+				 f <= f + c;
+				 state <= 3'd3;
+				 end
+			 3'd3: begin
+				 f <= f + d;
+				 state <= 3'd4;
+				 end
+			 3'd4: begin
+				 i <= f + e;
+				 state <= 3'd5;
+				 end
+			 3'd5: begin
+				 Done <= 1;
+				 state <= 3'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,72 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, d, e, Done, i);
+
+
+	input Clk, Rst, Start;
+	input signed [15:0] a;
+	input signed [15:0] b;
+	input signed [15:0] c;
+	input signed [15:0] d;
+	input signed [15:0] e;
+
+	output reg Done;
+	output reg signed [15:0] i;
+
+	reg signed [15:0] f;
+	reg [3:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 f <= a * b;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 f <= f * c;
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 f <= f * d;
+				 state <= 4'd6;
+				 end
+			 4'd6: begin
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 i <= f * e;
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 state <= 4'd10;
+				 end
+			 4'd10: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,56 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, d, e, f, g, h, Done, i, j, k, l);
+
+
+	input Clk, Rst, Start;
+	input signed [15:0] a;
+	input signed [15:0] b;
+	input signed [15:0] c;
+	input signed [15:0] d;
+	input signed [15:0] e;
+	input signed [15:0] f;
+	input signed [15:0] g;
+	input signed [15:0] h;
+
+	output reg Done;
+	output reg signed [15:0] i;
+	output reg signed [15:0] j;
+	output reg signed [15:0] k;
+	output reg signed [15:0] l;
+
+	reg [1:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 2'd0;
+		 end else begin
+			 case(state)
+			 2'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 2'd0;
+				 end else begin
+					 state <= 2'd1;
+				 end
+				 end
+			 2'd1: begin
+				 i <= a * b;
+				 j <= c * d;
+				 k <= e * f;
+				 l <= g * h;
+				 state <= 2'd2;
+				 end
+			 2'd2: begin
+				 state <= 2'd3;
+				 end
+			 2'd3: begin
+				 Done <= 1;
+				 state <= 2'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
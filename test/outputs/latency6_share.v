@@ -0,0 +1,68 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, d, e, f, g, Done, k, l);
+
+
+	input Clk, Rst, Start;
+	input signed [15:0] a;
+	input signed [15:0] b;
+	input signed [15:0] c;
+	input signed [15:0] d;
+	input signed [15:0] e;
+	input signed [15:0] f;
+	input signed [15:0] g;
+
+	output reg Done;
+	output reg signed [15:0] k;
+	output reg signed [15:0] l;
+
+	reg signed [15:0] h;
+	reg signed [15:0] i;
+	reg [2:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 3'd0;
+		 end else begin
+			 case(state)
+			 3'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 3'd0;
+				 end else begin
+					 state <= 3'd1;
+				 end
+				 end
+			 3'd1: begin
+				 l <= f / g;
+				 h <= a * b;
+				 i <= c * d;
+				 state <= 3'd2;
+				 end
+			 3'd2: begin
+				 state <= 3'd3;
+				 end
+			 3'd3: begin
+				 h <= h + i;
+				 state <= 3'd4;
+				 end
+			 3'd4: begin
+				 k <= h / e;
+				 state <= 3'd5;
+				 end
+			 3'd5: begin
+				 state <= 3'd6;
+				 end
+			 3'd6: begin
+				 state <= 3'd7;
+				 end
+			 3'd7: begin
+				 Done <= 1;
+				 state <= 3'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -1 +1,61 @@
-TODO: Implement file write
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, Done, z, x);
+
+
+	input Clk, Rst, Start;
+	input [15:0] a;
+	input [15:0] b;
+	input [15:0] c;
+
+	output reg Done;
+	output reg [7:0] z;
+	output reg [15:0] x;
+
+	reg [7:0] d;
+	reg [7:0] e;
+	reg [7:0] f;
+	reg [7:0] g;
+	reg [2:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 3'd0;
+		 end else begin
+			 case(state)
+			 3'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 3'd0;
+				 end else begin
+					 state <= 3'd1;
+				 end
+				 end
+			 3'd1: begin
+				 d <= a + b;
+				 e <= a + c;
+				 f <= a * c;
+				 state <= 3'd2;
+				 end
+			 3'd2: begin
+				 g <= d > e;
+				 state <= 3'd3;
+				 end
+			 3'd3: begin
+				 z <= g ? d : e;
+				 x <= f - d;
+				 state <= 3'd4;
+				 end
+			 3'd4: begin
+				 state <= 3'd5;
+				 end
+			 3'd5: begin
+				 Done <= 1;
+				 state <= 3'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,100 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, Done, z, x);
+
+
+	input Clk, Rst, Start;
+	input [15:0] a;
+	input [15:0] b;
+	input [15:0] c;
+
+	output reg Done;
+	output reg [7:0] z;
+	output reg [15:0] x;
+
+	reg [7:0] d;
+	reg [7:0] e;
+	reg [7:0] f;
+	reg [7:0] g;
+	reg [2:0] state;
+
+	wire [15:0] Alu_0_a;
+	wire [15:0] Alu_0_b;
+	wire [0:0] Alu_0_sub;
+	wire [15:0] Alu_0_y;
+	assign Alu_0_a = (state == 3'd1) ? a : {{8{1'b0}}, f};
+	assign Alu_0_b = (state == 3'd1) ? b : {{8{1'b0}}, d};
+	assign Alu_0_sub = state == 3'd3;
+	assign Alu_0_y = Alu_0_sub ? Alu_0_a - Alu_0_b : Alu_0_a + Alu_0_b;
+
+	wire [15:0] Alu_1_a;
+	wire [15:0] Alu_1_b;
+	wire [15:0] Alu_1_y;
+	assign Alu_1_a = a;
+	assign Alu_1_b = c;
+	assign Alu_1_y = Alu_1_a + Alu_1_b;
+
+	wire [15:0] Mul_0_a;
+	wire [15:0] Mul_0_b;
+	wire [15:0] Mul_0_y;
+	assign Mul_0_a = a;
+	assign Mul_0_b = c;
+	assign Mul_0_y = Mul_0_a * Mul_0_b;
+
+	wire [7:0] Comp_0_a;
+	wire [7:0] Comp_0_b;
+	wire [0:0] Comp_0_y;
+	assign Comp_0_a = d;
+	assign Comp_0_b = e;
+	assign Comp_0_y = Comp_0_a > Comp_0_b;
+
+	wire [7:0] Mux2x1_0_a;
+	wire [7:0] Mux2x1_0_b;
+	wire [0:0] Mux2x1_0_sel;
+	wire [7:0] Mux2x1_0_y;
+	assign Mux2x1_0_a = d;
+	assign Mux2x1_0_b = e;
+	assign Mux2x1_0_sel = |g;
+	assign Mux2x1_0_y = Mux2x1_0_sel ? Mux2x1_0_a : Mux2x1_0_b;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 3'd0;
+		 end else begin
+			 case(state)
+			 3'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 3'd0;
+				 end else begin
+					 state <= 3'd1;
+				 end
+				 end
+			 3'd1: begin
+				 d <= Alu_0_y;
+				 e <= Alu_1_y;
+				 f <= Mul_0_y;
+				 state <= 3'd2;
+				 end
+			 3'd2: begin
+				 g <= Comp_0_y;
+				 state <= 3'd3;
+				 end
+			 3'd3: begin
+				 z <= Mux2x1_0_y;
+				 x <= Alu_0_y;
+				 state <= 3'd4;
+				 end
+			 3'd4: begin
+				 state <= 3'd5;
+				 end
+			 3'd5: begin
+				 Done <= 1;
+				 state <= 3'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,73 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, Done, z, x);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] a;
+	input signed [31:0] b;
+	input signed [31:0] c;
+
+	output reg Done;
+	output reg signed [31:0] z;
+	output reg signed [31:0] x;
+
+	reg signed [31:0] d;
+	reg signed [31:0] e;
+	reg signed [31:0] f;
+	reg signed [31:0] g;
+	reg signed [31:0] h;
+	reg [0:0] dLTe;
+	reg [0:0] dEQe;
+	reg [2:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 3'd0;
+		 end else begin
+			 case(state)
+			 3'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 3'd0;
+				 end else begin
+					 state <= 3'd1;
+				 end
+				 end
+			 3'd1: begin
+				 f <= a - b;
+				 d <= a + b;
+				 e <= a + c;
+				 state <= 3'd2;
+				 end
+			 3'd2: begin
+				 dEQe <= d == e;
+				 dLTe <= d < e;
+				 state <= 3'd3;
+				 end
+			 3'd3: begin
+				 g <= dLTe ? d : e;
+				 state <= 3'd4;
+				 end
+			 3'd4: begin
+				 x <= g << dLTe;
+				 h <= dEQe ? g : f;
+				 state <= 3'd5;
+				 end
+			 3'd5: begin
+				 z <= h >> dEQe;
+				 state <= 3'd6;
+				 end
+			 3'd6: begin
+				 state <= 3'd7;
+				 end
+			 3'd7: begin
+				 Done <= 1;
+				 state <= 3'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,131 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, Done, z, x);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] a;
+	input signed [31:0] b;
+	input signed [31:0] c;
+
+	output reg Done;
+	output reg signed [31:0] z;
+	output reg signed [31:0] x;
+
+	reg signed [31:0] d;
+	reg signed [31:0] e;
+	reg signed [31:0] f;
+	reg signed [31:0] g;
+	reg signed [31:0] h;
+	reg [0:0] dLTe;
+	reg [0:0] dEQe;
+	reg [2:0] state;
+
+	wire signed [31:0] Alu_0_a;
+	wire signed [31:0] Alu_0_b;
+	wire signed [31:0] Alu_0_y;
+	assign Alu_0_a = a;
+	assign Alu_0_b = b;
+	assign Alu_0_y = Alu_0_a + Alu_0_b;
+
+	wire signed [31:0] Alu_1_a;
+	wire signed [31:0] Alu_1_b;
+	wire signed [31:0] Alu_1_y;
+	assign Alu_1_a = a;
+	assign Alu_1_b = c;
+	assign Alu_1_y = Alu_1_a + Alu_1_b;
+
+	wire signed [31:0] Alu_2_a;
+	wire signed [31:0] Alu_2_b;
+	wire signed [31:0] Alu_2_y;
+	assign Alu_2_a = a;
+	assign Alu_2_b = b;
+	assign Alu_2_y = Alu_2_a - Alu_2_b;
+
+	wire signed [31:0] Comp_0_a;
+	wire signed [31:0] Comp_0_b;
+	wire [0:0] Comp_0_y;
+	assign Comp_0_a = d;
+	assign Comp_0_b = e;
+	assign Comp_0_y = Comp_0_a == Comp_0_b;
+
+	wire signed [31:0] Comp_1_a;
+	wire signed [31:0] Comp_1_b;
+	wire [0:0] Comp_1_y;
+	assign Comp_1_a = d;
+	assign Comp_1_b = e;
+	assign Comp_1_y = Comp_1_a < Comp_1_b;
+
+	wire signed [31:0] Mux2x1_0_a;
+	wire signed [31:0] Mux2x1_0_b;
+	wire [0:0] Mux2x1_0_sel;
+	wire signed [31:0] Mux2x1_0_y;
+	assign Mux2x1_0_a = (state == 3'd3) ? d : g;
+	assign Mux2x1_0_b = (state == 3'd3) ? e : f;
+	assign Mux2x1_0_sel = (state == 3'd3) ? dLTe : dEQe;
+	assign Mux2x1_0_y = Mux2x1_0_sel ? Mux2x1_0_a : Mux2x1_0_b;
+
+	wire signed [31:0] SHL_0_a;
+	wire [0:0] SHL_0_b;
+	wire signed [31:0] SHL_0_y;
+	assign SHL_0_a = g;
+	assign SHL_0_b = dLTe;
+	assign SHL_0_y = SHL_0_a << SHL_0_b;
+
+	wire signed [31:0] SHR_0_a;
+	wire [0:0] SHR_0_b;
+	wire signed [31:0] SHR_0_y;
+	assign SHR_0_a = h;
+	assign SHR_0_b = dEQe;
+	assign SHR_0_y = SHR_0_a >> SHR_0_b;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 3'd0;
+		 end else begin
+			 case(state)
+			 3'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 3'd0;
+				 end else begin
+					 state <= 3'd1;
+				 end
+				 end
+			 3'd1: begin
+				 f <= Alu_2_y;
+				 d <= Alu_0_y;
+				 e <= Alu_1_y;
+				 state <= 3'd2;
+				 end
+			 3'd2: begin
+				 dEQe <= Comp_0_y;
+				 dLTe <= Comp_1_y;
+				 state <= 3'd3;
+				 end
+			 3'd3: begin
+				 g <= Mux2x1_0_y;
+				 state <= 3'd4;
+				 end
+			 3'd4: begin
+				 x <= SHL_0_y;
+				 h <= Mux2x1_0_y;
+				 state <= 3'd5;
+				 end
+			 3'd5: begin
+				 z <= SHR_0_y;
+				 state <= 3'd6;
+				 end
+			 3'd6: begin
+				 state <= 3'd7;
+				 end
+			 3'd7: begin
+				 Done <= 1;
+				 state <= 3'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
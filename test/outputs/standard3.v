@@ -0,0 +1,89 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, d, e, f, g, h, num, Done, avg);
+
+
+	input Clk, Rst, Start;
+	input signed [7:0] a;
+	input signed [7:0] b;
+	input signed [7:0] c;
+	input signed [7:0] d;
+	input signed [7:0] e;
+	input signed [7:0] f;
+	input signed [7:0] g;
+	input signed [7:0] h;
+	input signed [7:0] num;
+
+	output reg Done;
+	output reg signed [7:0] avg;
+
+	reg signed [31:0] t1;
+	reg signed [31:0] t2;
+	reg signed [31:0] t3;
+	reg signed [31:0] t4;
+	reg signed [31:0] t5;
+	reg signed [31:0] t6;
+	reg signed [31:0] t7;
+	reg [3:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 t1 <= a + b;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 t2 <= t1 + c;
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 t3 <= t2 + d;
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 t4 <= t3 + e;
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 t5 <= t4 + f;
+				 state <= 4'd6;
+				 end
+			 4'd6: begin
+				 t6 <= t5 + g;
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 t7 <= t6 + h;
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 avg <= t7 / num;
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 state <= 4'd10;
+				 end
+			 4'd10: begin
+				 state <= 4'd11;
+				 end
+			 4'd11: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
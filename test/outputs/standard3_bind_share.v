@@ -0,0 +1,97 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, d, e, f, g, h, num, Done, avg);
+
+
+	input Clk, Rst, Start;
+	input signed [7:0] a;
+	input signed [7:0] b;
+	input signed [7:0] c;
+	input signed [7:0] d;
+	input signed [7:0] e;
+	input signed [7:0] f;
+	input signed [7:0] g;
+	input signed [7:0] h;
+	input signed [7:0] num;
+
+	output reg Done;
+	output reg signed [7:0] avg;
+
+	reg signed [31:0] t1;
+	reg [3:0] state;
+
+	wire signed [31:0] Alu_0_a;
+	wire signed [31:0] Alu_0_b;
+	wire signed [31:0] Alu_0_y;
+	assign Alu_0_a = (state == 4'd1) ? {{24{a[7]}}, a} : t1;
+	assign Alu_0_b = (state == 4'd1) ? {{24{b[7]}}, b} : (state == 4'd2) ? {{24{c[7]}}, c} : (state == 4'd3) ? {{24{d[7]}}, d} : (state == 4'd4) ? {{24{e[7]}}, e} : (state == 4'd5) ? {{24{f[7]}}, f} : (state == 4'd6) ? {{24{g[7]}}, g} : {{24{h[7]}}, h};
+	assign Alu_0_y = Alu_0_a + Alu_0_b;
+
+	wire signed [31:0] Div_0_a;
+	wire signed [31:0] Div_0_b;
+	wire signed [31:0] Div_0_y;
+	assign Div_0_a = t1;
+	assign Div_0_b = {{24{num[7]}}, num};
+	assign Div_0_y = Div_0_a / Div_0_b;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 t1 <= Alu_0_y;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 t1 <= Alu_0_y;
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 t1 <= Alu_0_y;
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 t1 <= Alu_0_y;
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 t1 <= Alu_0_y;
+				 state <= 4'd6;
+				 end
+			 4'd6: begin
+				 t1 <= Alu_0_y;
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 t1 <= Alu_0_y;
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 avg <= Div_0_y;
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 state <= 4'd10;
+				 end
+			 4'd10: begin
+				 state <= 4'd11;
+				 end
+			 4'd11: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
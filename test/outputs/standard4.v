@@ -0,0 +1,73 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, d, zero, Done, z);
+
+
+	input Clk, Rst, Start;
+	input [63:0] a;
+	input [63:0] b;
+	input [63:0] c;
+	input [63:0] d;
+	input [63:0] zero;
+
+	output reg Done;
+	output reg [63:0] z;
+
+	reg [63:0] e;
+	reg [63:0] f;
+	reg [63:0] g;
+	reg [0:0] gEQz;
+	reg [3:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 g <= a % b;
+				 e <= a / b;
+				 f <= c / d;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 gEQz <= g == zero;
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 z <= gEQz ? e : f;
+				 state <= 4'd6;
+				 end
+			 4'd6: begin
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
@@ -0,0 +1,110 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, d, zero, Done, z);
+
+
+	input Clk, Rst, Start;
+	input [63:0] a;
+	input [63:0] b;
+	input [63:0] c;
+	input [63:0] d;
+	input [63:0] zero;
+
+	output reg Done;
+	output reg [63:0] z;
+
+	reg [63:0] e;
+	reg [63:0] f;
+	reg [63:0] g;
+	reg [0:0] gEQz;
+	reg [3:0] state;
+
+	wire [63:0] Div_0_a;
+	wire [63:0] Div_0_b;
+	wire [63:0] Div_0_y;
+	assign Div_0_a = a;
+	assign Div_0_b = b;
+	assign Div_0_y = Div_0_a / Div_0_b;
+
+	wire [63:0] Div_1_a;
+	wire [63:0] Div_1_b;
+	wire [63:0] Div_1_y;
+	assign Div_1_a = c;
+	assign Div_1_b = d;
+	assign Div_1_y = Div_1_a / Div_1_b;
+
+	wire [63:0] Mod_0_a;
+	wire [63:0] Mod_0_b;
+	wire [63:0] Mod_0_y;
+	assign Mod_0_a = a;
+	assign Mod_0_b = b;
+	assign Mod_0_y = Mod_0_a % Mod_0_b;
+
+	wire [63:0] Comp_0_a;
+	wire [63:0] Comp_0_b;
+	wire [0:0] Comp_0_y;
+	assign Comp_0_a = g;
+	assign Comp_0_b = zero;
+	assign Comp_0_y = Comp_0_a == Comp_0_b;
+
+	wire [63:0] Mux2x1_0_a;
+	wire [63:0] Mux2x1_0_b;
+	wire [0:0] Mux2x1_0_sel;
+	wire [63:0] Mux2x1_0_y;
+	assign Mux2x1_0_a = e;
+	assign Mux2x1_0_b = f;
+	assign Mux2x1_0_sel = gEQz;
+	assign Mux2x1_0_y = Mux2x1_0_sel ? Mux2x1_0_a : Mux2x1_0_b;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 g <= Mod_0_y;
+				 e <= Div_0_y;
+				 f <= Div_1_y;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 gEQz <= Comp_0_y;
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 z <= Mux2x1_0_y;
+				 state <= 4'd6;
+				 end
+			 4'd6: begin
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
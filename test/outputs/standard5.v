@@ -0,0 +1,96 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, d, e, f, g, h, sa, Done, avg);
+
+
+	input Clk, Rst, Start;
+	input [31:0] a;
+	input [31:0] b;
+	input [31:0] c;
+	input [31:0] d;
+	input [31:0] e;
+	input [31:0] f;
+	input [31:0] g;
+	input [31:0] h;
+	input [31:0] sa;
+
+	output reg Done;
+	output reg [31:0] avg;
+
+	reg [31:0] t1;
+	reg [31:0] t2;
+	reg [31:0] t3;
+	reg [31:0] t4;
+	reg [31:0] t5;
+	reg [31:0] t6;
+	reg [31:0] t7;
+	reg [31:0] t7div2;
+	reg [31:0] t7div4;
+	reg [3:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 t1 <= a + b;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 t2 <= t1 + c;
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 t3 <= t2 + d;
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 t4 <= t3 + e;
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 t5 <= t4 + f;
+				 state <= 4'd6;
+				 end
+			 4'd6: begin
+				 t6 <= t5 + g;
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 t7 <= t6 + h;
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 t7div2 <= t7 >> sa;
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 t7div4 <= t7div2 >> sa;
+				 state <= 4'd10;
+				 end
+			 4'd10: begin
+				 avg <= t7div4 >> sa;
+				 state <= 4'd11;
+				 end
+			 4'd11: begin
+				 state <= 4'd12;
+				 end
+			 4'd12: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
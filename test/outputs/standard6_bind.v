@@ -0,0 +1,245 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, a, b, c, d, e, f, g, h, i, j, l, m, n, o, p, q, r, s, t, u, v, w, x, y, z, aa, bb, cc, dd, ee, ff, gg, hh, ii, Done, final);
+
+
+	input Clk, Rst, Start;
+	input [31:0] a;
+	input [31:0] b;
+	input [31:0] c;
+	input [31:0] d;
+	input [31:0] e;
+	input [31:0] f;
+	input [31:0] g;
+	input [31:0] h;
+	input [31:0] i;
+	input [31:0] j;
+	input [31:0] l;
+	input [31:0] m;
+	input [31:0] n;
+	input [31:0] o;
+	input [31:0] p;
+	input [31:0] q;
+	input [31:0] r;
+	input [31:0] s;
+	input [31:0] t;
+	input [31:0] u;
+	input [31:0] v;
+	input [31:0] w;
+	input [31:0] x;
+	input [31:0] y;
+	input [31:0] z;
+	input [31:0] aa;
+	input [31:0] bb;
+	input [31:0] cc;
+	input [31:0] dd;
+	input [31:0] ee;
+	input [31:0] ff;
+	input [31:0] gg;
+	input [31:0] hh;
+	input [31:0] ii;
+
+	output reg Done;
+	output reg [31:0] final;
+
+	reg [31:0] t1;
+	reg [31:0] t2;
+	reg [31:0] t3;
+	reg [31:0] t4;
+	reg [31:0] t5;
+	reg [31:0] t6;
+	reg [31:0] t7;
+	reg [31:0] t8;
+	reg [31:0] t9;
+	reg [31:0] t10;
+	reg [31:0] t11;
+	reg [31:0] t12;
+	reg [31:0] t13;
+	reg [31:0] t14;
+	reg [31:0] t15;
+	reg [31:0] t16;
+	reg [31:0] t17;
+	reg [31:0] t18;
+	reg [31:0] t19;
+	reg [31:0] t20;
+	reg [31:0] t21;
+	reg [31:0] t22;
+	reg [31:0] t23;
+	reg [31:0] t24;
+	reg [31:0] t25;
+	reg [31:0] t26;
+	reg [31:0] t27;
+	reg [31:0] t28;
+	reg [31:0] t29;
+	reg [31:0] t30;
+	reg [31:0] t31;
+	reg [31:0] t32;
+	reg [31:0] t33;
+	reg [5:0] state;
+
+	wire [31:0] Alu_0_a;
+	wire [31:0] Alu_0_b;
+	wire [31:0] Alu_0_y;
+	assign Alu_0_a = (state == 6'd1) ? a : (state == 6'd2) ? t1 : (state == 6'd3) ? t2 : (state == 6'd4) ? t3 : (state == 6'd5) ? t4 : (state == 6'd6) ? t5 : (state == 6'd7) ? t6 : (state == 6'd8) ? t7 : (state == 6'd9) ? t8 : (state == 6'd10) ? t9 : (state == 6'd11) ? t10 : (state == 6'd12) ? t11 : (state == 6'd13) ? t12 : (state == 6'd14) ? t13 : (state == 6'd15) ? t14 : (state == 6'd16) ? t15 : (state == 6'd17) ? t16 : (state == 6'd18) ? t17 : (state == 6'd19) ? t18 : (state == 6'd20) ? t19 : (state == 6'd21) ? t20 : (state == 6'd22) ? t21 : (state == 6'd23) ? t22 : (state == 6'd24) ? t23 : (state == 6'd25) ? t24 : (state == 6'd26) ? t25 : (state == 6'd27) ? t26 : (state == 6'd28) ? t27 : (state == 6'd29) ? t28 : (state == 6'd30) ? t29 : (state == 6'd31) ? t30 : (state == 6'd32) ? t31 : (state == 6'd33) ? t32 : t33;
+	assign Alu_0_b = (state == 6'd1) ? b : (state == 6'd2) ? c : (state == 6'd3) ? d : (state == 6'd4) ? e : (state == 6'd5) ? f : (state == 6'd6) ? g : (state == 6'd7) ? h : (state == 6'd8) ? i : (state == 6'd9) ? j : (state == 6'd10) ? l : (state == 6'd11) ? m : (state == 6'd12) ? n : (state == 6'd13) ? o : (state == 6'd14) ? p : (state == 6'd15) ? q : (state == 6'd16) ? r : (state == 6'd17) ? s : (state == 6'd18) ? t : (state == 6'd19) ? u : (state == 6'd20) ? v : (state == 6'd21) ? w : (state == 6'd22) ? x : (state == 6'd23) ? y : (state == 6'd24) ? z : (state == 6'd25) ? aa : (state == 6'd26) ? bb : (state == 6'd27) ? cc : (state == 6'd28) ? dd : (state == 6'd29) ? ee : (state == 6'd30) ? ff : (state == 6'd31) ? gg : (state == 6'd32) ? hh : (state == 6'd33) ? ii : t1;
+	assign Alu_0_y = Alu_0_a + Alu_0_b;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 6'd0;
+		 end else begin
+			 case(state)
+			 6'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 6'd0;
+				 end else begin
+					 state <= 6'd1;
+				 end
+				 end
+			 6'd1: begin
+				 t1 <= Alu_0_y;
+				 state <= 6'd2;
+				 end
+			 6'd2: begin
+				 t2 <= Alu_0_y;
+				 state <= 6'd3;
+				 end
+			 6'd3: begin
+				 t3 <= Alu_0_y;
+				 state <= 6'd4;
+				 end
+			 6'd4: begin
+				 t4 <= Alu_0_y;
+				 state <= 6'd5;
+				 end
+			 6'd5: begin
+				 t5 <= Alu_0_y;
+				 state <= 6'd6;
+				 end
+			 6'd6: begin
+				 t6 <= Alu_0_y;
+				 state <= 6'd7;
+				 end
+			 6'd7: begin
+				 t7 <= Alu_0_y;
+				 state <= 6'd8;
+				 end
+			 6'd8: begin
+				 t8 <= Alu_0_y;
+				 state <= 6'd9;
+				 end
+			 6'd9: begin
+				 t9 <= Alu_0_y;
+				 state <= 6'd10;
+				 end
+			 6'd10: begin
+				 t10 <= Alu_0_y;
+				 state <= 6'd11;
+				 end
+			 6'd11: begin
+				 t11 <= Alu_0_y;
+				 state <= 6'd12;
+				 end
+			 6'd12: begin
+				 t12 <= Alu_0_y;
+				 state <= 6'd13;
+				 end
+			 6'd13: begin
+				 t13 <= Alu_0_y;
+				 state <= 6'd14;
+				 end
+			 6'd14: begin
+				 t14 <= Alu_0_y;
+				 state <= 6'd15;
+				 end
+			 6'd15: begin
+				 t15 <= Alu_0_y;
+				 state <= 6'd16;
+				 end
+			 6'd16: begin
+				 t16 <= Alu_0_y;
+				 state <= 6'd17;
+				 end
+			 6'd17: begin
+				 t17 <= Alu_0_y;
+				 state <= 6'd18;
+				 end
+			 6'd18: begin
+				 t18 <= Alu_0_y;
+				 state <= 6'd19;
+				 end
+			 6'd19: begin
+				 t19 <= Alu_0_y;
+				 state <= 6'd20;
+				 end
+			 6'd20: begin
+				 t20 <= Alu_0_y;
+				 state <= 6'd21;
+				 end
+			 6'd21: begin
+				 t21 <= Alu_0_y;
+				 state <= 6'd22;
+				 end
+			 6'd22: begin
+				 t22 <= Alu_0_y;
+				 state <= 6'd23;
+				 end
+			 6'd23: begin
+				 t23 <= Alu_0_y;
+				 state <= 6'd24;
+				 end
+			 6'd24: begin
+				 t24 <= Alu_0_y;
+				 state <= 6'd25;
+				 end
+			 6'd25: begin
+				 t25 <= Alu_0_y;
+				 state <= 6'd26;
+				 end
+			 6'd26: begin
+				 t26 <= Alu_0_y;
+				 state <= 6'd27;
+				 end
+			 6'd27: begin
+				 t27 <= Alu_0_y;
+				 state <= 6'd28;
+				 end
+			 6'd28: begin
+				 t28 <= Alu_0_y;
+				 state <= 6'd29;
+				 end
+			 6'd29: begin
+				 t29 <= Alu_0_y;
+				 state <= 6'd30;
+				 end
+			 6'd30: begin
+				 t30 <= Alu_0_y;
+				 state <= 6'd31;
+				 end
+			 6'd31: begin
+				 t31 <= Alu_0_y;
+				 state <= 6'd32;
+				 end
+			 6'd32: begin
+				 t32 <= Alu_0_y;
+				 state <= 6'd33;
+				 end
+			 6'd33: begin
+				 t33 <= Alu_0_y;
+				 state <= 6'd34;
+				 end
+			 6'd34: begin
+				 final <= Alu_0_y;
+				 state <= 6'd35;
+				 end
+			 6'd35: begin
+				 Done <= 1;
+				 state <= 6'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
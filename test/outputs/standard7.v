@@ -0,0 +1,88 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, u, x, y, dx, a, three, Done, u1, x1, y1, c);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] u;
+	input signed [31:0] x;
+	input signed [31:0] y;
+	input signed [31:0] dx;
+	input signed [31:0] a;
+	input signed [31:0] three;
+
+	output reg Done;
+	output reg signed [31:0] u1;
+	output reg signed [31:0] x1;
+	output reg signed [31:0] y1;
+	output reg signed [31:0] c;
+
+	reg signed [31:0] t1;
+	reg signed [31:0] t2;
+	reg signed [31:0] t3;
+	reg signed [31:0] t4;
+	reg signed [31:0] t5;
+	reg signed [31:0] t6;
+	reg signed [31:0] t7;
+	reg signed [31:0] vx1;
+	reg [3:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 t5 <= three * y;
+				 t7 <= u * dx;
+				 x1 <= x + dx;
+				 t1 <= three * x;
+				 vx1 <= x + dx;
+				 t2 <= u * dx;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 c <= vx1 < a;
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 y1 <= y + t7;
+				 t6 <= t5 * dx;
+				 t3 <= t1 * t2;
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 t4 <= u - t3;
+				 state <= 4'd6;
+				 end
+			 4'd6: begin
+				 u1 <= t4 - t6;
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
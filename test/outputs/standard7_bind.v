@@ -0,0 +1,139 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, u, x, y, dx, a, three, Done, u1, x1, y1, c);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] u;
+	input signed [31:0] x;
+	input signed [31:0] y;
+	input signed [31:0] dx;
+	input signed [31:0] a;
+	input signed [31:0] three;
+
+	output reg Done;
+	output reg signed [31:0] u1;
+	output reg signed [31:0] x1;
+	output reg signed [31:0] y1;
+	output reg signed [31:0] c;
+
+	reg signed [31:0] t1;
+	reg signed [31:0] t2;
+	reg signed [31:0] t3;
+	reg signed [31:0] t4;
+	reg signed [31:0] t5;
+	reg signed [31:0] t6;
+	reg signed [31:0] t7;
+	reg signed [31:0] vx1;
+	reg [3:0] state;
+
+	wire signed [31:0] Alu_0_a;
+	wire signed [31:0] Alu_0_b;
+	wire [0:0] Alu_0_sub;
+	wire signed [31:0] Alu_0_y;
+	assign Alu_0_a = (state == 4'd1) ? x : (state == 4'd3) ? y : (state == 4'd5) ? u : t4;
+	assign Alu_0_b = (state == 4'd1) ? dx : (state == 4'd3) ? t7 : (state == 4'd5) ? t3 : t6;
+	assign Alu_0_sub = state == 4'd5 || state == 4'd6;
+	assign Alu_0_y = Alu_0_sub ? Alu_0_a - Alu_0_b : Alu_0_a + Alu_0_b;
+
+	wire signed [31:0] Alu_1_a;
+	wire signed [31:0] Alu_1_b;
+	wire signed [31:0] Alu_1_y;
+	assign Alu_1_a = x;
+	assign Alu_1_b = dx;
+	assign Alu_1_y = Alu_1_a + Alu_1_b;
+
+	wire signed [31:0] Mul_0_a;
+	wire signed [31:0] Mul_0_b;
+	wire signed [31:0] Mul_0_y;
+	assign Mul_0_a = (state == 4'd1) ? three : t1;
+	assign Mul_0_b = (state == 4'd1) ? x : t2;
+	assign Mul_0_y = Mul_0_a * Mul_0_b;
+
+	wire signed [31:0] Mul_1_a;
+	wire signed [31:0] Mul_1_b;
+	wire signed [31:0] Mul_1_y;
+	assign Mul_1_a = (state == 4'd1) ? u : t5;
+	assign Mul_1_b = dx;
+	assign Mul_1_y = Mul_1_a * Mul_1_b;
+
+	wire signed [31:0] Mul_2_a;
+	wire signed [31:0] Mul_2_b;
+	wire signed [31:0] Mul_2_y;
+	assign Mul_2_a = three;
+	assign Mul_2_b = y;
+	assign Mul_2_y = Mul_2_a * Mul_2_b;
+
+	wire signed [31:0] Mul_3_a;
+	wire signed [31:0] Mul_3_b;
+	wire signed [31:0] Mul_3_y;
+	assign Mul_3_a = u;
+	assign Mul_3_b = dx;
+	assign Mul_3_y = Mul_3_a * Mul_3_b;
+
+	wire signed [31:0] Comp_0_a;
+	wire signed [31:0] Comp_0_b;
+	wire [0:0] Comp_0_y;
+	assign Comp_0_a = vx1;
+	assign Comp_0_b = a;
+	assign Comp_0_y = Comp_0_a < Comp_0_b;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 t5 <= Mul_2_y;
+				 t7 <= Mul_3_y;
+				 x1 <= Alu_0_y;
+				 t1 <= Mul_0_y;
+				 vx1 <= Alu_1_y;
+				 t2 <= Mul_1_y;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 c <= Comp_0_y;
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 y1 <= Alu_0_y;
+				 t6 <= Mul_1_y;
+				 t3 <= Mul_0_y;
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 t4 <= Alu_0_y;
+				 state <= 4'd6;
+				 end
+			 4'd6: begin
+				 u1 <= Alu_0_y;
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
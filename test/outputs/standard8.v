@@ -0,0 +1,92 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, x0, x1, x2, x3, y0, c0, five, ten, Done, d1, d2, e, f, g, h);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] x0;
+	input signed [31:0] x1;
+	input signed [31:0] x2;
+	input signed [31:0] x3;
+	input signed [31:0] y0;
+	input signed [31:0] c0;
+	input signed [31:0] five;
+	input signed [31:0] ten;
+
+	output reg Done;
+	output reg signed [31:0] d1;
+	output reg signed [31:0] d2;
+	output reg signed [31:0] e;
+	output reg signed [31:0] f;
+	output reg signed [31:0] g;
+	output reg signed [31:0] h;
+
+	reg signed [31:0] t1;
+	reg signed [31:0] t2;
+	reg signed [31:0] t3;
+	reg signed [31:0] vd1;
+	reg signed [31:0] ve;
+	reg signed [31:0] vf;
+	reg signed [31:0] vg;
+	reg [3:0] state;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 g <= x0 - ten;
+				 vg <= x0 - ten;
+				 t1 <= x0 + x1;
+				 t2 <= x1 + x2;
+				 t3 <= x3 + c0;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 d1 <= t1 * c0;
+				 e <= t2 * t3;
+				 vd1 <= t1 * c0;
+				 ve <= t2 * t3;
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 vf <= ve * y0;
+				 d2 <= vd1 * five;
+				 f <= ve * y0;
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 state <= 4'd6;
+				 end
+			 4'd6: begin
+				 h <= vf + vg;
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
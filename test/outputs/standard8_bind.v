@@ -0,0 +1,155 @@
+`timescale 1ns/1ps
+
+module HLSM(Clk, Rst, Start, x0, x1, x2, x3, y0, c0, five, ten, Done, d1, d2, e, f, g, h);
+
+
+	input Clk, Rst, Start;
+	input signed [31:0] x0;
+	input signed [31:0] x1;
+	input signed [31:0] x2;
+	input signed [31:0] x3;
+	input signed [31:0] y0;
+	input signed [31:0] c0;
+	input signed [31:0] five;
+	input signed [31:0] ten;
+
+	output reg Done;
+	output reg signed [31:0] d1;
+	output reg signed [31:0] d2;
+	output reg signed [31:0] e;
+	output reg signed [31:0] f;
+	output reg signed [31:0] g;
+	output reg signed [31:0] h;
+
+	reg signed [31:0] t1;
+	reg signed [31:0] t2;
+	reg signed [31:0] t3;
+	reg signed [31:0] vd1;
+	reg signed [31:0] ve;
+	reg signed [31:0] vf;
+	reg signed [31:0] vg;
+	reg [3:0] state;
+
+	wire signed [31:0] Alu_0_a;
+	wire signed [31:0] Alu_0_b;
+	wire signed [31:0] Alu_0_y;
+	assign Alu_0_a = (state == 4'd1) ? x0 : vf;
+	assign Alu_0_b = (state == 4'd1) ? x1 : vg;
+	assign Alu_0_y = Alu_0_a + Alu_0_b;
+
+	wire signed [31:0] Alu_1_a;
+	wire signed [31:0] Alu_1_b;
+	wire signed [31:0] Alu_1_y;
+	assign Alu_1_a = x1;
+	assign Alu_1_b = x2;
+	assign Alu_1_y = Alu_1_a + Alu_1_b;
+
+	wire signed [31:0] Alu_2_a;
+	wire signed [31:0] Alu_2_b;
+	wire signed [31:0] Alu_2_y;
+	assign Alu_2_a = x3;
+	assign Alu_2_b = c0;
+	assign Alu_2_y = Alu_2_a + Alu_2_b;
+
+	wire signed [31:0] Alu_3_a;
+	wire signed [31:0] Alu_3_b;
+	wire signed [31:0] Alu_3_y;
+	assign Alu_3_a = x0;
+	assign Alu_3_b = ten;
+	assign Alu_3_y = Alu_3_a - Alu_3_b;
+
+	wire signed [31:0] Alu_4_a;
+	wire signed [31:0] Alu_4_b;
+	wire signed [31:0] Alu_4_y;
+	assign Alu_4_a = x0;
+	assign Alu_4_b = ten;
+	assign Alu_4_y = Alu_4_a - Alu_4_b;
+
+	wire signed [31:0] Mul_0_a;
+	wire signed [31:0] Mul_0_b;
+	wire signed [31:0] Mul_0_y;
+	assign Mul_0_a = (state == 4'd2) ? t1 : vd1;
+	assign Mul_0_b = (state == 4'd2) ? c0 : five;
+	assign Mul_0_y = Mul_0_a * Mul_0_b;
+
+	wire signed [31:0] Mul_1_a;
+	wire signed [31:0] Mul_1_b;
+	wire signed [31:0] Mul_1_y;
+	assign Mul_1_a = (state == 4'd2) ? t1 : ve;
+	assign Mul_1_b = (state == 4'd2) ? c0 : y0;
+	assign Mul_1_y = Mul_1_a * Mul_1_b;
+
+	wire signed [31:0] Mul_2_a;
+	wire signed [31:0] Mul_2_b;
+	wire signed [31:0] Mul_2_y;
+	assign Mul_2_a = (state == 4'd2) ? t2 : ve;
+	assign Mul_2_b = (state == 4'd2) ? t3 : y0;
+	assign Mul_2_y = Mul_2_a * Mul_2_b;
+
+	wire signed [31:0] Mul_3_a;
+	wire signed [31:0] Mul_3_b;
+	wire signed [31:0] Mul_3_y;
+	assign Mul_3_a = t2;
+	assign Mul_3_b = t3;
+	assign Mul_3_y = Mul_3_a * Mul_3_b;
+
+	 always @(posedge Clk) begin
+		 if(Rst) begin
+			 state <= 4'd0;
+		 end else begin
+			 case(state)
+			 4'd0: begin
+				 Done <= 0;
+				 if(~Start) begin
+					 state <= 4'd0;
+				 end else begin
+					 state <= 4'd1;
+				 end
+				 end
+			 4'd1: begin
+				 g <= Alu_3_y;
+				 vg <= Alu_4_y;
+				 t1 <= Alu_0_y;
+				 t2 <= Alu_1_y;
+				 t3 <= Alu_2_y;
+				 state <= 4'd2;
+				 end
+			 4'd2: begin
+				 d1 <= Mul_0_y;
+				 e <= Mul_2_y;
+				 vd1 <= Mul_1_y;
+				 ve <= Mul_3_y;
+				 state <= 4'd3;
+				 end
+			 4'd3: begin
+				 state <= 4'd4;
+				 end
+			 4'd4: begin
+				 vf <= Mul_2_y;
+				 d2 <= Mul_0_y;
+				 f <= Mul_1_y;
+				 state <= 4'd5;
+				 end
+			 4'd5: begin
+				 state <= 4'd6;
+				 end
+			 4'd6: begin
+				 h <= Alu_0_y;
+				 state <= 4'd7;
+				 end
+			 4'd7: begin
+				 state <= 4'd8;
+				 end
+			 4'd8: begin
+				 state <= 4'd9;
+				 end
+			 4'd9: begin
+				 Done <= 1;
+				 state <= 4'd0;
+				 end
+			 endcase
+		 end
+	 end
+endmodule
+
+`default_nettype wire
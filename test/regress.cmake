@@ -0,0 +1,162 @@
+# Run by the regress and regress_update targets with cmake -P. Every case of regression.txt is synthesised
+# with --stats and checked against the netlist on SIMULATE random vectors, any mismatch fails the case
+# even when updating. Its Verilog must match the golden file, and its schedule quality and scheduler work
+# must stay within the stored limits. Work is limited by the counters of --stats rather than wall time, so
+# a slow or loaded machine cannot fail a case. A golden of - marks a netlist that must fail. Cases run with
+# --bind also limit the functional units bound per class, and a class gets units exactly when its peak usage
+# is nonzero. Logical units can outnumber the logical peak, comparators, shifters and muxes do not share. Cases
+# run with --share-registers limit the registers left after sharing. With
+# UPDATE=ON the goldens are rewritten from the current outputs and the limits reset to the measured values. With
+# CASE set to a case name only that case is run, which is how ctest runs each case as its own test.
+
+include( ${CMAKE_CURRENT_LIST_DIR}/regress_case.cmake )
+
+set( quality_keys states length multiplier divider logical alu )
+set( work_keys force_evaluations fds_candidates distribution_rebuilds )
+set( binding_keys multiplier_units divider_units logical_units alu_units )
+set( sharing_keys registers )
+set( cases_file ${TEST_DIR}/regression.txt )
+
+file( MAKE_DIRECTORY ${WORK_DIR} )
+file( STRINGS ${cases_file} lines )
+set( num_cases 0 )
+set( num_failures 0 )
+set( updated "" )
+set( golden_copies "" )
+
+foreach( line ${lines} )
+    if(line MATCHES "^#" OR line STREQUAL "")
+        set( updated "${updated}${line}\n" )
+        continue()
+    endif()
+    separate_arguments( fields UNIX_COMMAND "${line}" )
+    list( GET fields 0 netlist )
+    list( GET fields 1 latency )
+    list( GET fields 2 golden )
+    regress_case_name( "${line}" case_name )
+    if(DEFINED CASE AND NOT case_name STREQUAL CASE)
+        set( updated "${updated}${line}\n" )
+        continue()
+    endif()
+    list( REMOVE_AT fields 0 1 2 )
+    set( options_field "" )
+    set( options "" )
+    if(fields MATCHES "^options=([^;]+)")
+        set( options_field " ${CMAKE_MATCH_0}" )
+        string( REPLACE "," ";" options "${CMAKE_MATCH_1}" )
+        list( REMOVE_AT fields 0 )
+    endif()
+    set( verilog ${WORK_DIR}/${case_name}.v )
+    set( stats_file ${WORK_DIR}/${case_name}.stats.json )
+    file( REMOVE ${verilog} ${stats_file} )
+    foreach( key ${quality_keys} ${work_keys} ${binding_keys} ${sharing_keys} )
+        unset( measured_${key} )
+    endforeach()
+    math( EXPR num_cases "${num_cases} + 1" )
+
+    execute_process( COMMAND ${HLSYN} ${TEST_DIR}/${netlist} ${latency} ${verilog} ${options} --stats ${stats_file} --report-format json
+        --simulate ${SIMULATE} RESULT_VARIABLE run_result OUTPUT_VARIABLE run_output ERROR_VARIABLE run_output )
+    set( problems "" )
+    set( new_line "${netlist} ${latency} ${golden}${options_field}" )
+    set( case_keys ${quality_keys} ${work_keys} )
+    list( FIND options "--bind" bind_idx )
+    if(NOT bind_idx EQUAL -1)
+        list( APPEND case_keys ${binding_keys} )
+    endif()
+    list( FIND options "--share-registers" share_idx )
+    if(NOT share_idx EQUAL -1)
+        list( APPEND case_keys ${sharing_keys} )
+    endif()
+
+    if(golden STREQUAL "-")
+        if(EXISTS ${verilog})
+            set( problems "${problems} synthesised but is expected to fail;" )
+        endif()
+    elseif(NOT EXISTS ${verilog} OR NOT EXISTS ${stats_file})
+        set( problems "${problems} failed (${run_result}): ${run_output};" )
+    elseif(NOT run_output MATCHES "Simulation: [0-9]+ vectors, 0 mismatches")
+        set( problems "${problems} state machine does not match the netlist: ${run_output};" )
+    else()
+        file( READ ${stats_file} stats )
+        string( REGEX MATCH "\"states\": ([0-9]+)" match "${stats}" )
+        set( measured_states ${CMAKE_MATCH_1} )
+        string( REGEX MATCH "\"schedule_length\": ([0-9]+)" match "${stats}" )
+        set( measured_length ${CMAKE_MATCH_1} )
+        foreach( class multiplier divider logical alu )
+            string( REGEX MATCH "\"${class}\": ([0-9]+)" match "${stats}" )
+            set( measured_${class} ${CMAKE_MATCH_1} )
+        endforeach()
+        foreach( key ${work_keys} )
+            string( REGEX MATCH "\"${key}\": ([0-9]+)" match "${stats}" )
+            set( measured_${key} ${CMAKE_MATCH_1} )
+        endforeach()
+        if(NOT bind_idx EQUAL -1)
+            string( REGEX MATCH "\"bound_units\": {[^}]*}" bound_units "${stats}" )
+            foreach( class multiplier divider logical alu )
+                string( REGEX MATCH "\"${class}\": ([0-9]+)" match "${bound_units}" )
+                set( measured_${class}_units ${CMAKE_MATCH_1} )
+                if(measured_${class} EQUAL 0 AND measured_${class}_units GREATER 0)
+                    set( problems "${problems} ${measured_${class}_units} ${class} units bound for no ${class} operation;" )
+                elseif(measured_${class} GREATER 0 AND measured_${class}_units EQUAL 0)
+                    set( problems "${problems} no ${class} unit bound for a peak of ${measured_${class}};" )
+                endif()
+            endforeach()
+        endif()
+        if(NOT share_idx EQUAL -1 AND run_output MATCHES "Registers: [0-9]+ before sharing, ([0-9]+) after")
+            set( measured_registers ${CMAKE_MATCH_1} )
+        endif()
+
+        if(UPDATE)
+            list( APPEND golden_copies "${verilog}>${TEST_DIR}/${golden}" )
+            foreach( key ${case_keys} )
+                set( new_line "${new_line} ${key}=${measured_${key}}" )
+            endforeach()
+        else()
+            execute_process( COMMAND ${CMAKE_COMMAND} -E compare_files ${verilog} ${TEST_DIR}/${golden} RESULT_VARIABLE differs )
+            if(NOT differs EQUAL 0)
+                set( problems "${problems} Verilog differs from ${golden};" )
+            endif()
+            foreach( limit_field ${fields} )
+                if(limit_field MATCHES "^([a-z_]+)=([0-9]+)$")
+                    set( key ${CMAKE_MATCH_1} )
+                    set( limit ${CMAKE_MATCH_2} )
+                    if(NOT DEFINED measured_${key})
+                        set( problems "${problems} unknown limit ${key};" )
+                    elseif(measured_${key} GREATER limit)
+                        set( problems "${problems} ${key} ${measured_${key}} above ${limit};" )
+                    endif()
+                else()
+                    set( problems "${problems} bad limit ${limit_field};" )
+                endif()
+            endforeach()
+        endif()
+    endif()
+
+    if(problems STREQUAL "")
+        message( "PASS ${case_name} at latency ${latency}" )
+    else()
+        message( "FAIL ${case_name} at latency ${latency}:${problems}" )
+        math( EXPR num_failures "${num_failures} + 1" )
+    endif()
+    set( updated "${updated}${new_line}\n" )
+endforeach()
+
+if(UPDATE)
+    if(num_failures GREATER 0)
+        message( FATAL_ERROR "${num_failures} of ${num_cases} cases failed, ${cases_file} was not updated" )
+    endif()
+    foreach( copy ${golden_copies} )
+        string( REPLACE ">" ";" copy "${copy}" )
+        list( GET copy 0 source )
+        list( GET copy 1 destination )
+        configure_file( ${source} ${destination} COPYONLY )
+    endforeach()
+    file( WRITE ${cases_file} "${updated}" )
+    message( "Updated the goldens and limits of ${num_cases} cases in ${cases_file}" )
+elseif(num_failures GREATER 0)
+    message( FATAL_ERROR "${num_failures} of ${num_cases} regression cases failed" )
+elseif(num_cases EQUAL 0)
+    message( FATAL_ERROR "No regression case ${CASE} in ${cases_file}" )
+else()
+    message( "All ${num_cases} regression cases passed" )
+endif()
@@ -0,0 +1,18 @@
+# Name of the regression case on a line of regression.txt, shared by regress.cmake and the ctest cases. It is the
+# netlist path followed by the options of the case, standard/hls_test1.c with options=--bind is standard_hls_test1_bind.
+function( regress_case_name line out_var )
+    separate_arguments( fields UNIX_COMMAND "${line}" )
+    list( GET fields 0 netlist )
+    string( REGEX REPLACE "\\.c$" "" name "${netlist}" )
+    string( REPLACE "/" "_" name "${name}" )
+    foreach( field ${fields} )
+        if(field MATCHES "^options=(.+)$")
+            string( REPLACE "," ";" options "${CMAKE_MATCH_1}" )
+            foreach( option ${options} )
+                string( REGEX REPLACE "^-+" "" option "${option}" )
+                string( APPEND name "_${option}" )
+            endforeach()
+        endif()
+    endforeach()
+    set( ${out_var} ${name} PARENT_SCOPE )
+endfunction()
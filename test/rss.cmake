@@ -0,0 +1,57 @@
+# Run by the batch_rss test with cmake -P. Runs JOBS batch jobs cycling over the cases of regression.txt that
+# synthesise, on one worker, and fails when the peak RSS after the last job exceeds the peak after the first
+# WARMUP jobs by more than GROWTH_KIB. Memory that jobs do not give back shows up as growth with the job count.
+
+set( cases_file ${TEST_DIR}/regression.txt )
+set( manifest ${WORK_DIR}/rss_manifest.txt )
+set( warmup_stats ${WORK_DIR}/rss_warmup.json )
+set( last_stats ${WORK_DIR}/rss_last.json )
+
+file( MAKE_DIRECTORY ${WORK_DIR} )
+file( REMOVE ${warmup_stats} ${last_stats} )
+file( STRINGS ${cases_file} lines REGEX "^[^#]" )
+set( jobs "" )
+foreach( line ${lines} )
+    separate_arguments( fields UNIX_COMMAND "${line}" )
+    list( GET fields 0 netlist )
+    list( GET fields 1 latency )
+    list( GET fields 2 golden )
+    if(NOT golden STREQUAL "-")
+        list( APPEND jobs "${TEST_DIR}/${netlist} ${latency} ${WORK_DIR}/rss_job.v" )
+    endif()
+endforeach()
+list( LENGTH jobs num_cases )
+if(num_cases EQUAL 0)
+    message( FATAL_ERROR "No synthesisable case in ${cases_file}" )
+endif()
+
+set( content "" )
+math( EXPR warmup_job "${WARMUP} - 1" )
+math( EXPR last_job "${JOBS} - 1" )
+foreach( job RANGE ${last_job} )
+    math( EXPR case_idx "${job} % ${num_cases}" )
+    list( GET jobs ${case_idx} job_line )
+    if(job EQUAL warmup_job)
+        set( job_line "${job_line} --stats ${warmup_stats} --report-format json" )
+    elseif(job EQUAL last_job)
+        set( job_line "${job_line} --stats ${last_stats} --report-format json" )
+    endif()
+    string( APPEND content "${job_line}\n" )
+endforeach()
+file( WRITE ${manifest} "${content}" )
+
+execute_process( COMMAND ${HLSYN} --batch ${manifest} --jobs 1 RESULT_VARIABLE run_result OUTPUT_QUIET ERROR_VARIABLE run_output )
+if(NOT run_result EQUAL 0 OR NOT EXISTS ${warmup_stats} OR NOT EXISTS ${last_stats})
+    message( FATAL_ERROR "Batch of ${JOBS} jobs failed (${run_result}): ${run_output}" )
+endif()
+foreach( stage warmup last )
+    file( READ ${${stage}_stats} stats )
+    string( REGEX MATCH "\"peak_rss_kib\": ([0-9]+)" match "${stats}" )
+    set( ${stage}_kib ${CMAKE_MATCH_1} )
+endforeach()
+math( EXPR growth "${last_kib} - ${warmup_kib}" )
+if(growth GREATER GROWTH_KIB)
+    message( FATAL_ERROR "Peak RSS grew by ${growth} KiB from ${warmup_kib} KiB after job ${WARMUP} to ${last_kib} KiB after job ${JOBS}, "
+        "more than ${GROWTH_KIB} KiB" )
+endif()
+message( "Peak RSS ${warmup_kib} KiB after job ${WARMUP}, ${last_kib} KiB after job ${JOBS}" )
@@ -0,0 +1,49 @@
+# Run by the testbench test with cmake -P. Synthesises a few designs with --testbench and runs each generated
+# testbench against its emitted module in Icarus Verilog, failing unless every testbench reports PASS. Without
+# IVERILOG and VVP the test reports that it was skipped.
+
+set( designs
+    "standard/hls_test1.c 4"
+    "standard/hls_test7.c 8 --bind"
+    "latency/hls_test6.c 6"
+    "if/hls_test3.c 9 --share-registers"
+    "if/hls_test4.c 8 --fsm-encoding onehot" )
+
+if(NOT IVERILOG OR NOT VVP)
+    message( "Skipped, iverilog not found" )
+    return()
+endif()
+file( MAKE_DIRECTORY ${WORK_DIR} )
+set( num_failures 0 )
+foreach( design ${designs} )
+    separate_arguments( fields UNIX_COMMAND "${design}" )
+    list( GET fields 0 netlist )
+    list( GET fields 1 latency )
+    list( REMOVE_AT fields 0 1 )
+    string( REGEX REPLACE "\\.c$" "" name "${netlist}" )
+    string( REPLACE "/" "_" name "tb_${name}" )
+    set( module ${WORK_DIR}/${name}.v )
+    set( testbench ${WORK_DIR}/${name}_tb.v )
+    set( simulation ${WORK_DIR}/${name}.vvp )
+    file( REMOVE ${module} ${testbench} ${simulation} )
+
+    execute_process( COMMAND ${HLSYN} ${TEST_DIR}/${netlist} ${latency} ${module} ${fields} --testbench ${testbench}
+        RESULT_VARIABLE run_result OUTPUT_VARIABLE run_output ERROR_VARIABLE run_output )
+    if(run_result EQUAL 0)
+        execute_process( COMMAND ${IVERILOG} -o ${simulation} ${testbench} ${module}
+            RESULT_VARIABLE run_result OUTPUT_VARIABLE run_output ERROR_VARIABLE run_output )
+    endif()
+    if(run_result EQUAL 0)
+        execute_process( COMMAND ${VVP} -n ${simulation}
+            RESULT_VARIABLE run_result OUTPUT_VARIABLE run_output ERROR_VARIABLE run_output )
+    endif()
+    if(run_result EQUAL 0 AND run_output MATCHES "PASS: [0-9]+ vectors")
+        message( "PASS ${design}" )
+    else()
+        message( "FAIL ${design} (${run_result}): ${run_output}" )
+        math( EXPR num_failures "${num_failures} + 1" )
+    endif()
+endforeach()
+if(num_failures GREATER 0)
+    message( FATAL_ERROR "${num_failures} testbenches failed" )
+endif()